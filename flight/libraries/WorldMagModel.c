@@ -157,6 +157,14 @@ static WMMtype_Ellipsoid *Ellip = NULL;
 static WMMtype_MagneticModel *MagneticModel = NULL;
 static float decimal_date;
 
+#ifdef WMM_TILE_CACHE
+// field vectors at the corners of recently used tiles, see WMM_GetMagVectorCached()
+static WMMtype_Tile TileCache[WMM_TILE_CACHE_SIZE];
+static uint8_t next_tile;
+#endif
+
+static void WMM_SetMainFieldCoeffs();
+
 /**************************************************************************************
 *   Example use - very simple - only two exposed functions
 *
@@ -166,6 +174,10 @@ static float decimal_date;
 *	e.g. Iceland in may of 2012 = WMM_GetMagVector(65.0, -20.0, 0.0, 5, 5, 2012, B);
 *	Alt is above the WGS-84 Ellipsoid
 *	B is the NED (XYZ) magnetic vector in nTesla
+*
+*	With WMM_TILE_CACHE defined, WMM_GetMagVectorCached() takes the same arguments,
+*	for callers evaluating the model repeatedly around the same place. It interpolates
+*	between the field vectors at the corners of a WMM_TILE_DEG tile, computed once per tile.
 **************************************************************************************/
 
 int WMM_Initialize()
@@ -264,6 +276,8 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
     if (returned >= 0) {
         if (WMM_DateToYear(Month, Day, Year) < 0) {
             returned = -8; // error
+        } else {
+            WMM_SetMainFieldCoeffs();
         }
     }
 
@@ -272,9 +286,9 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
         if (WMM_Geomag(CoordSpherical, CoordGeodetic, GeoMagneticElements) < 0) {
             returned = -9; // error
         } else { // set the returned values
-            B[0] = GeoMagneticElements->X;
-            B[1] = GeoMagneticElements->Y;
-            B[2] = GeoMagneticElements->Z;
+            B[0] = GeoMagneticElements->X * 1e-2f;
+            B[1] = GeoMagneticElements->Y * 1e-2f;
+            B[2] = GeoMagneticElements->Z * 1e-2f;
         }
     }
 
@@ -303,13 +317,89 @@ int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, u
         Ellip = NULL;
     }
 
-    B[0] = GeoMagneticElements->X * 1e-2f;
-    B[1] = GeoMagneticElements->Y * 1e-2f;
-    B[2] = GeoMagneticElements->Z * 1e-2f;
-
     return returned;
 }
 
+#ifdef WMM_TILE_CACHE
+int WMM_GetMagVectorCached(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3])
+{
+    // same return values as WMM_GetMagVector()
+
+    if (Lat < -90.0f) {
+        return -1; // error
+    }
+    if (Lat > 90.0f) {
+        return -2; // error
+    }
+    if (Lon < -180.0f) {
+        return -3; // error
+    }
+    if (Lon > 180.0f) {
+        return -4; // error
+    }
+
+    // interpolation does not hold up where the meridians converge
+    if (fabsf(Lat) > WMM_TILE_MAX_LAT) {
+        return WMM_GetMagVector(Lat, Lon, AltEllipsoid, Month, Day, Year, B);
+    }
+
+    if (WMM_DateToYear(Month, Day, Year) < 0) {
+        return -8; // error
+    }
+
+    if (Lon >= 180.0f) {
+        Lon -= 360.0f;
+    }
+    int16_t lat0 = (int16_t)floorf(Lat / WMM_TILE_DEG);
+    int16_t lon0 = (int16_t)floorf(Lon / WMM_TILE_DEG);
+
+    WMMtype_Tile *tile = NULL;
+    for (uint8_t i = 0; i < WMM_TILE_CACHE_SIZE; i++) {
+        if (TileCache[i].valid && TileCache[i].lat0 == lat0 && TileCache[i].lon0 == lon0 &&
+            TileCache[i].date == decimal_date && fabsf(TileCache[i].alt - AltEllipsoid) <= WMM_TILE_ALT) {
+            tile = &TileCache[i];
+            break;
+        }
+    }
+
+    if (!tile) {
+        // replace the oldest tile by the one around this position
+        tile = &TileCache[next_tile];
+        next_tile = (next_tile + 1) % WMM_TILE_CACHE_SIZE;
+
+        tile->valid = false;
+        tile->lat0  = lat0;
+        tile->lon0  = lon0;
+        tile->alt   = AltEllipsoid;
+        tile->date  = decimal_date;
+        for (uint8_t i = 0; i < 2; i++) {
+            for (uint8_t j = 0; j < 2; j++) {
+                float cornerLon = (lon0 + j) * WMM_TILE_DEG;
+                if (cornerLon > 180.0f) {
+                    cornerLon -= 360.0f;
+                }
+                int returned = WMM_GetMagVector((lat0 + i) * WMM_TILE_DEG, cornerLon, AltEllipsoid, Month, Day, Year, tile->B[i][j]);
+                if (returned < 0) {
+                    return returned;
+                }
+            }
+        }
+        tile->valid = true;
+    }
+
+    // bilinear interpolation between the corners
+    float fLat = Lat / WMM_TILE_DEG - tile->lat0;
+    float fLon = Lon / WMM_TILE_DEG - tile->lon0;
+    for (uint8_t k = 0; k < 3; k++) {
+        float south = tile->B[0][0][k] + fLon * (tile->B[0][1][k] - tile->B[0][0][k]);
+        float north = tile->B[1][0][k] + fLon * (tile->B[1][1][k] - tile->B[1][0][k]);
+        B[k] = south + fLat * (north - south);
+    }
+
+    return 0; // OK
+}
+#endif /* WMM_TILE_CACHE */
+
 int WMM_Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_GeoMagneticElements *GeoMagneticElements)
 /*
    The main subroutine that calls a sequence of WMM sub-functions to calculate the magnetic field elements for a single point.
@@ -1166,7 +1256,26 @@ int WMM_SecVarSummationSpecial(WMMtype_SphericalHarmonicVariables *
 }
 
 /**
- * @brief Comput the MainFieldCoeffH accounting for the date
+ * @brief Move the main field coefficients of MagneticModel to decimal_date
+ */
+static void WMM_SetMainFieldCoeffs()
+{
+    uint16_t a = MagneticModel->nMaxSecVar;
+    uint16_t b = (a * (a + 1) / 2 + a);
+
+    for (uint16_t index = 0; index < NUMTERMS; index++) {
+        MagneticModel->Main_Field_Coeff_G[index] = CoeffFile[index][2];
+        MagneticModel->Main_Field_Coeff_H[index] = CoeffFile[index][3];
+        // index 0 is not a term of the model (n starts at 1)
+        if (index >= 1 && index <= b) {
+            MagneticModel->Main_Field_Coeff_G[index] += (decimal_date - MagneticModel->epoch) * WMM_get_secular_var_coeff_g(index);
+            MagneticModel->Main_Field_Coeff_H[index] += (decimal_date - MagneticModel->epoch) * WMM_get_secular_var_coeff_h(index);
+        }
+    }
+}
+
+/**
+ * @brief Get the MainFieldCoeffG accounting for the date
  */
 float WMM_get_main_field_coeff_g(uint16_t index)
 {
@@ -1174,57 +1283,19 @@ float WMM_get_main_field_coeff_g(uint16_t index)
         return 0;
     }
 
-    uint16_t n, m, sum_index, a, b;
-
-    float coeff = CoeffFile[index][2];
-
-    a = MagneticModel->nMaxSecVar;
-    b = (a * (a + 1) / 2 + a);
-    for (n = 1; n <= MagneticModel->nMax; n++) {
-        for (m = 0; m <= n; m++) {
-            sum_index = (n * (n + 1) / 2 + m);
-
-            /* Hacky for now, will solve for which conditions need summing analytically */
-            if (sum_index != index) {
-                continue;
-            }
-
-            if (index <= b) {
-                coeff += (decimal_date - MagneticModel->epoch) * WMM_get_secular_var_coeff_g(sum_index);
-            }
-        }
-    }
-
-    return coeff;
+    return MagneticModel->Main_Field_Coeff_G[index];
 }
 
+/**
+ * @brief Get the MainFieldCoeffH accounting for the date
+ */
 float WMM_get_main_field_coeff_h(uint16_t index)
 {
     if (index >= NUMTERMS) {
         return 0;
     }
 
-    uint16_t n, m, sum_index, a, b;
-    float coeff = CoeffFile[index][3];
-
-    a = MagneticModel->nMaxSecVar;
-    b = (a * (a + 1) / 2 + a);
-    for (n = 1; n <= MagneticModel->nMax; n++) {
-        for (m = 0; m <= n; m++) {
-            sum_index = (n * (n + 1) / 2 + m);
-
-            /* Hacky for now, will solve for which conditions need summing analytically */
-            if (sum_index != index) {
-                continue;
-            }
-
-            if (index <= b) {
-                coeff += (decimal_date - MagneticModel->epoch) * WMM_get_secular_var_coeff_h(sum_index);
-            }
-        }
-    }
-
-    return coeff;
+    return MagneticModel->Main_Field_Coeff_H[index];
 }
 
 float WMM_get_secular_var_coeff_g(uint16_t index)
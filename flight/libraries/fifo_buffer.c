@@ -93,6 +93,21 @@ void fifoBuf_removeData(t_fifo_buffer *buf, uint16_t len)
     buf->rd = rd;
 }
 
+uint16_t fifoBuf_getDataRef(t_fifo_buffer *buf, const uint8_t **data)
+{ // get a pointer to the oldest bytes in the buffer without copying them
+  // returns the number of bytes that follow it before the buffer wraps around
+    uint16_t rd = buf->rd;
+    uint16_t wr = buf->wr;
+
+    *data = buf->buf_ptr + rd;
+
+    if (wr < rd) {
+        return buf->buf_size - rd;
+    }
+
+    return wr - rd;
+}
+
 int16_t fifoBuf_getBytePeek(t_fifo_buffer *buf)
 { // get a data byte from the buffer without removing it
     uint16_t rd = buf->rd;
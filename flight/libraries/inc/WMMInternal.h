@@ -37,13 +37,21 @@
 #define NUMPCUP                                 92              // NUMTERMS +1
 #define NUMPCUPS                                13             // WMM_MAX_MODEL_DEGREES +1
 
+// tile cache of WMM_GetMagVectorCached(), with WMM_TILE_CACHE defined
+#define WMM_TILE_DEG                            1.0f           // tile size in degrees of latitude and longitude
+#define WMM_TILE_ALT                            500.0f         // a tile is reused up to this altitude difference, in m
+#define WMM_TILE_MAX_LAT                        80.0f          // the full model is used beyond this latitude
+#ifndef WMM_TILE_CACHE_SIZE
+#define WMM_TILE_CACHE_SIZE                     2
+#endif
+
 // internal structure definitions
 typedef struct {
     float EditionDate;
     float epoch; // Base time of Geomagnetic model epoch (yrs)
     char  ModelName[20];
-// float Main_Field_Coeff_G[NUMTERMS];	// C - Gauss coefficients of main geomagnetic model (nT)
-// float Main_Field_Coeff_H[NUMTERMS];	// C - Gauss coefficients of main geomagnetic model (nT)
+    float Main_Field_Coeff_G[NUMTERMS]; // C - Gauss coefficients of main geomagnetic model at the date (nT)
+    float Main_Field_Coeff_H[NUMTERMS]; // C - Gauss coefficients of main geomagnetic model at the date (nT)
 // float Secular_Var_Coeff_G[NUMTERMS];	// CD - Gauss coefficients of secular geomagnetic model (nT/yr)
 // float Secular_Var_Coeff_H[NUMTERMS];	// CD - Gauss coefficients of secular geomagnetic model (nT/yr)
     uint16_t nMax; // Maximum degree of spherical harmonic model
@@ -115,6 +123,15 @@ typedef struct {
     float GVdot; /*16. Yearly rate of chnage in grid variation */
 } WMMtype_GeoMagneticElements;
 
+typedef struct {
+    int16_t lat0; // south west corner, in tiles
+    int16_t lon0;
+    float   alt; // altitude the corners were computed at
+    float   date; // decimal year the corners were computed for
+    float   B[2][2][3]; // field vector at the [lat][lon] corners
+    bool    valid;
+} WMMtype_Tile;
+
 // Internal Function Prototypes
 void WMM_Set_Coeff_Array();
 int WMM_GeodeticToSpherical(WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_CoordSpherical *CoordSpherical);
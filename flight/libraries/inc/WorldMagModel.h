@@ -30,5 +30,8 @@
 // Exposed Function Prototypes
 int WMM_Initialize();
 int WMM_GetMagVector(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3]);
+#ifdef WMM_TILE_CACHE
+int WMM_GetMagVectorCached(float Lat, float Lon, float AltEllipsoid, uint16_t Month, uint16_t Day, uint16_t Year, float B[3]);
+#endif
 
 #endif /* WORLDMAGMODEL_H_ */
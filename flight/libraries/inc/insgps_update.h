@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ * @addtogroup AHRS
+ * @{
+ * @addtogroup INSGPS
+ * @{
+ * @brief INSGPS is a joint attitude and position estimation EKF
+ *
+ * @file       insgps_update.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Measurement update shared by the 13 and 16 state INSGPS.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef INSGPS_UPDATE_H_
+#define INSGPS_UPDATE_H_
+
+#include <stdint.h>
+
+#define INSGPS_MAX_STATES 16
+
+// *************  INSSerialUpdateRow *************
+// Applies a single measurement to P (numx by numx, row major) and X
+// H is the measurement row, nonzero from hmin to hmax only
+// error is the measurement minus the predicted measurement
+//
+// Only the upper triangle of P is read and written, so a sequence of
+// measurements must be followed by INSMirrorUpper() before the lower
+// triangle is used again.
+// Rows and columns where H*P is zero are left alone. These are the states
+// that are not correlated with the measurement, e.g. the attitude after
+// INSPosVelReset() for a GPS measurement.
+// All inner loops run over consecutive elements of a row.
+// ************************************************
+static inline void INSSerialUpdateRow(const int8_t numx, float *P, float *X,
+                                      const float *H, const int8_t hmin, const int8_t hmax,
+                                      const float R, const float error)
+{
+    float HP[INSGPS_MAX_STATES], HPHR;
+    float Km[INSGPS_MAX_STATES];
+    int8_t i, j, k, lo, hi;
+
+    for (j = 0; j < numx; j++) { // Find HP = H*P
+        HP[j] = 0.0f;
+    }
+    for (k = hmin; k <= hmax; k++) {
+        const float Hk   = H[k];
+        const float *Pkj = &P[k * numx];
+
+        for (j = 0; j < k; j++) { // column k above the diagonal, P[j][k] == P[k][j]
+            HP[j] += Hk * P[j * numx + k];
+        }
+        for (j = k; j < numx; j++) {
+            HP[j] += Hk * Pkj[j];
+        }
+    }
+
+    for (lo = 0; lo < numx && HP[lo] == 0.0f; lo++) {}
+    for (hi = numx - 1; hi > lo && HP[hi] == 0.0f; hi--) {}
+
+    HPHR = R; // Find  HPHR = H*P*H' + R
+    for (k = hmin; k <= hmax; k++) {
+        HPHR += HP[k] * H[k];
+    }
+    const float invHPHR = 1.0f / HPHR;
+    for (k = lo; k <= hi; k++) {
+        Km[k] = HP[k] * invHPHR; // find K = HP/HPHR
+    }
+    for (i = lo; i <= hi; i++) { // Find P(m)= P(m-1) + K*HP
+        const float Ki = Km[i];
+        float *Pij     = &P[i * numx];
+
+        for (j = i; j <= hi; j++) {
+            Pij[j] = Pij[j] - Ki * HP[j];
+        }
+    }
+
+    for (i = lo; i <= hi; i++) { // Find X(m)= X(m-1) + K*Error
+        X[i] = X[i] + Km[i] * error;
+    }
+}
+
+// *************  INSMirrorUpper *******************
+// Copies the upper triangle of P to the lower triangle
+// ************************************************
+static inline void INSMirrorUpper(const int8_t numx, float *P)
+{
+    int8_t i, j;
+
+    for (i = 1; i < numx; i++) {
+        for (j = 0; j < i; j++) {
+            P[i * numx + j] = P[j * numx + i];
+        }
+    }
+}
+
+#endif /* INSGPS_UPDATE_H_ */
+
+/**
+ * @}
+ * @}
+ */
@@ -26,13 +26,15 @@
 #ifndef INSTRUMENTATION_H
 #define INSTRUMENTATION_H
 #include <perfcounter.h>
+#include <perfcounterstats.h>
 /**
  * Initialize the instrumentationUAVObject wrapper
  */
 void InstrumentationInit();
 
 /**
- * publish all counters to UAVObjects
+ * publish all counters to UAVObjects, and every second the counter
+ * statistics since the previous publication
  */
 void InstrumentationPublishAllCounters();
 
@@ -48,6 +48,13 @@ typedef struct {
 #define COUNT   1
 #define DATA    5
 
+/* Capability flags, byte 16 of the per device Rep_Capabilities packet */
+#define DFU_CAPS                 16
+#define DFU_CAP_DELTA_UPLOAD     0x01
+
+/* Rep_PageCRCs: first page(4) pages(2) entries(1) then offset(4) size(4) crc(4) */
+#define DFU_PAGE_CRCS_PER_PACKET 4
+
 /* Exported functions ------------------------------------------------------- */
 void processComand(uint8_t *Receive_Buffer);
 void DataDownload(DownloadAction);
@@ -37,6 +37,9 @@
 #define SSP_RX_ACK        6
 #define SSP_RX_SYNCH      7
 
+#define SSP_MAX_WINDOW    16  // largest number of unacknowledged packets in windowed mode
+#define SSP_ACK_BUF_SIZE  8   // length + seq. no. + selective ack bitmap + CRC
+
 typedef enum decodeState_ {
     decode_len1_e = 0,
     decode_seqNo_e,
@@ -68,6 +71,9 @@ typedef struct {
     int16_t (*pfSerialRead)(void); // function to call to read a byte from serial hardware
     void (*pfSerialWrite)(uint8_t); // function used to write a byte to serial hardware for transmission
     uint32_t (*pfGetTime)(void); // function returns time in number of seconds that has elapsed from a given reference point
+    uint8_t  windowSize; // packets allowed in flight, offered to the other end on synchronise. 0 or 1 = stop and wait
+    uint8_t  *txWindowBuf; // optional, windowSize * (txBufSize + 2) bytes. Without it sends stay one packet at a time
+    uint8_t  *rxWindowBuf; // optional, (windowSize - 1) * (rxBufSize + 2) bytes to keep packets received out of order
 } PortConfig_t;
 
 typedef struct Port_tag {
@@ -99,6 +105,21 @@ typedef struct Port_tag {
     uint32_t RxError;
     uint32_t TxError;
     uint16_t flags;
+    // sliding window state, only used once a window has been negotiated by ssp_Synchronise
+    uint8_t  windowSize; // window offered to the other end
+    uint8_t  window; // negotiated window, 0 = stop and wait
+    uint8_t  *txWindowBuf; // one packet per transmit slot
+    uint8_t  *rxWindowBuf; // one packet per out of order receive slot
+    uint8_t  txSlots; // number of transmit slots in use
+    uint8_t  txHead; // oldest unacknowledged slot
+    uint8_t  txCount; // number of unacknowledged slots
+    uint16_t txAcked; // slots acknowledged, possibly out of order
+    uint16_t txFastRetry; // slots already resent because a later packet was acknowledged
+    uint8_t  txSlotSeqNo[SSP_MAX_WINDOW];
+    uint8_t  txSlotRetry[SSP_MAX_WINDOW];
+    uint32_t txSlotTimeout[SSP_MAX_WINDOW];
+    uint8_t  rxSlotSeqNo[SSP_MAX_WINDOW]; // sequence number kept in each receive slot, 0 = free
+    uint8_t  ackBuf[SSP_ACK_BUF_SIZE]; // ACKs are built here so they never overwrite a packet waiting for its own ACK
 } Port_t;
 
 /** Public Data **/
@@ -112,6 +133,8 @@ int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
 void ssp_Init(Port_t *thisport, const PortConfig_t *const info);
 int16_t ssp_ReceiveByte(Port_t *thisport);
 uint16_t ssp_Synchronise(Port_t *thisport);
+uint16_t ssp_TxWindowFree(Port_t *thisport);
+uint8_t ssp_Window(Port_t *thisport);
 
 /** EXTERNAL FUNCTIONS **/
 
@@ -30,6 +30,7 @@
  */
 
 #include "insgps.h"
+#include "insgps_update.h"
 #include <math.h>
 #include <stdint.h>
 #include <pios_math.h>
@@ -530,46 +531,21 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 // - or see Simon, "Optimal State Estimation," 1st Ed, p.150
 // The SensorsUsed variable is a bitwise mask indicating which sensors
 // should be used in the update.
+// Each measurement only touches the states in its H row and the states
+// correlated with them, see INSSerialUpdateRow().
 // ************************************************
 void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
                   float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
                   uint16_t SensorsUsed)
 {
-    float HP[NUMX], HPHR, Error;
-    uint8_t i, j, k, m;
-    float Km[NUMX];
+    uint8_t m;
 
     for (m = 0; m < NUMV; m++) {
         if (SensorsUsed & (0x01 << m)) { // use this sensor for update
-            for (j = 0; j < NUMX; j++) { // Find Hp = H*P
-                HP[j] = 0;
-            }
-
-            for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
-                for (j = 0; j < NUMX; j++) { // Find Hp = H*P
-                    HP[j] += H[m][k] * P[k][j];
-                }
-            }
-            HPHR = R[m]; // Find  HPHR = H*P*H' + R
-            for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
-                HPHR += HP[k] * H[m][k];
-            }
-            float invHPHR = 1.0f / HPHR;
-            for (k = 0; k < NUMX; k++) {
-                Km[k] = HP[k] * invHPHR; // find K = HP/HPHR
-            }
-            for (i = 0; i < NUMX; i++) { // Find P(m)= P(m-1) + K*HP
-                for (j = i; j < NUMX; j++) {
-                    P[i][j] = P[j][i] = P[i][j] - Km[i] * HP[j];
-                }
-            }
-
-            Error = Z[m] - Y[m];
-            for (i = 0; i < NUMX; i++) { // Find X(m)= X(m-1) + K*Error
-                X[i] = X[i] + Km[i] * Error;
-            }
+            INSSerialUpdateRow(NUMX, P[0], X, H[m], HrowMin[m], HrowMax[m], R[m], Z[m] - Y[m]);
         }
     }
+    INSMirrorUpper(NUMX, P[0]);
 }
 
 // *************  RungeKutta **********************
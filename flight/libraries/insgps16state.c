@@ -30,6 +30,7 @@
  */
 
 #include "insgps.h"
+#include "insgps_update.h"
 #include <math.h>
 #include <stdint.h>
 
@@ -64,7 +65,10 @@ float F[NUMX][NUMX], G[NUMX][NUMW], H[NUMV][NUMX]; // linearized system matrices
 float Be[3]; // local magnetic unit vector in NED frame
 float P[NUMX][NUMX], X[NUMX]; // covariance matrix and state vector
 float Q[NUMW], R[NUMV]; // input noise and measurement noise variances
-float K[NUMX][NUMV]; // feedback gain matrix
+
+// nonzero columns of the H rows set in LinearizeH()
+static int8_t HrowMin[NUMV] = { 0, 1, 2, 3, 4, 5, 6, 6, 6, 2 };
+static int8_t HrowMax[NUMV] = { 0, 1, 2, 3, 4, 5, 9, 9, 9, 2 };
 
 // *************  Exposed Functions ****************
 // *************************************************
@@ -567,44 +571,22 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 // - or see Simon, "Optimal State Estimation," 1st Ed, p.150
 // The SensorsUsed variable is a bitwise mask indicating which sensors
 // should be used in the update.
+// Each measurement only touches the states in its H row and the states
+// correlated with them, see INSSerialUpdateRow().
 // ************************************************
 
 void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
                   float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
                   uint16_t SensorsUsed)
 {
-    float HP[NUMX], HPHR, Error;
-    uint8_t i, j, k, m;
+    uint8_t m;
 
     for (m = 0; m < NUMV; m++) {
         if (SensorsUsed & (0x01 << m)) { // use this sensor for update
-            for (j = 0; j < NUMX; j++) { // Find Hp = H*P
-                HP[j] = 0.0f;
-                for (k = 0; k < NUMX; k++) {
-                    HP[j] += H[m][k] * P[k][j];
-                }
-            }
-            HPHR = R[m]; // Find  HPHR = H*P*H' + R
-            for (k = 0; k < NUMX; k++) {
-                HPHR += HP[k] * H[m][k];
-            }
-
-            for (k = 0; k < NUMX; k++) {
-                K[k][m] = HP[k] / HPHR; // find K = HP/HPHR
-            }
-            for (i = 0; i < NUMX; i++) { // Find P(m)= P(m-1) + K*HP
-                for (j = i; j < NUMX; j++) {
-                    P[i][j] = P[j][i] =
-                                  P[i][j] - K[i][m] * HP[j];
-                }
-            }
-
-            Error = Z[m] - Y[m];
-            for (i = 0; i < NUMX; i++) { // Find X(m)= X(m-1) + K*Error
-                X[i] = X[i] + K[i][m] * Error;
-            }
+            INSSerialUpdateRow(NUMX, P[0], X, H[m], HrowMin[m], HrowMax[m], R[m], Z[m] - Y[m]);
         }
     }
+    INSMirrorUpper(NUMX, P[0]);
 }
 
 // *************  RungeKutta **********************
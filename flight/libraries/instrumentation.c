@@ -28,13 +28,22 @@
 #include <instrumentation.h>
 #include <pios_instrumentation.h>
 
+// counter statistics are published at a lower rate than the counters
+#define STATS_PUBLISH_PERIOD_MS 1000
+
 static uint8_t publishedCountersInstances = 0;
+static uint8_t publishedStatsInstances    = 0;
+static uint32_t lastSnapshotTS;
 static void counterCallback(const pios_perf_counter_t *counter, const int8_t index, void *context);
+static void statsCallback(const pios_perf_counter_t *counter, const int8_t index, void *context);
 static xSemaphoreHandle sem;
 void InstrumentationInit()
 {
     PerfCounterInitialize();
+    PerfCounterStatsInitialize();
     publishedCountersInstances = 1;
+    publishedStatsInstances    = 1;
+    lastSnapshotTS = PIOS_DELAY_GetRaw();
     vSemaphoreCreateBinary(sem);
 }
 
@@ -44,6 +53,12 @@ void InstrumentationPublishAllCounters()
         return;
     }
     PIOS_Instrumentation_ForEachCounter(&counterCallback, NULL);
+
+    uint32_t period = PIOS_DELAY_DiffuS(lastSnapshotTS) / 1000;
+    if (period >= STATS_PUBLISH_PERIOD_MS) {
+        lastSnapshotTS = PIOS_DELAY_GetRaw();
+        PIOS_Instrumentation_ForEachSnapshot(&statsCallback, &period);
+    }
     xSemaphoreGive(sem);
 }
 
@@ -60,3 +75,26 @@ void counterCallback(const pios_perf_counter_t *counter, const int8_t index, __a
     data.Counter.Value = counter->value;
     PerfCounterInstSet(index, &data);
 }
+
+void statsCallback(const pios_perf_counter_t *counter, const int8_t index, void *context)
+{
+    if (publishedStatsInstances < index + 1) {
+        PerfCounterStatsCreateInstance();
+        publishedStatsInstances++;
+    }
+    PerfCounterStatsData data;
+    data.Id     = counter->id;
+    data.Type   = counter->type;
+    data.Period = *(uint32_t *)context;
+    data.Count  = counter->count;
+    data.Total  = counter->total;
+    data.Task   = UINT8_MAX;
+#ifdef PIOS_INCLUDE_TASK_MONITOR
+    int32_t task_id = PIOS_TASK_MONITOR_GetTaskId(counter->task);
+    if (task_id >= 0 && task_id < UINT8_MAX) {
+        data.Task = task_id;
+    }
+#endif
+    memcpy(data.Histogram, counter->histogram, sizeof(data.Histogram));
+    PerfCounterStatsInstSet(index, &data);
+}
@@ -53,6 +53,7 @@ uint32_t SizeOfTransfer  = 0;
 uint32_t Expected_CRC    = 0;
 uint8_t SizeOfLastPacket = 0;
 uint32_t Next_Packet     = 0;
+uint8_t DeltaUpload      = 0;
 uint8_t TransferType;
 uint32_t Count = 0;
 uint32_t Data;
@@ -75,6 +76,8 @@ extern int32_t platform_senddata(const uint8_t *msg, uint16_t msg_len);
 static uint32_t baseOfAdressType(uint8_t type);
 static uint8_t isBiggerThanAvailable(uint8_t type, uint32_t size);
 static void OPDfuIni(uint8_t discover);
+static bool getPage(uint32_t index, uint32_t *offset, uint32_t *size);
+static uint16_t numberOfPages(void);
 bool flash_read(uint8_t *buffer, uint32_t adr, DFUProgType type);
 /* Private functions ---------------------------------------------------------*/
 void sendData(uint8_t *buf, uint16_t size);
@@ -191,6 +194,7 @@ void processComand(uint8_t *xReceive_Buffer)
                 TransferType     = Data0;
                 SizeOfTransfer   = Count;
                 Next_Packet      = 1;
+                DeltaUpload      = 0;
                 Expected_CRC     = unpack_uint32(&xReceive_Buffer[DATA + 2]);
                 SizeOfLastPacket = Data1;
 
@@ -223,7 +227,8 @@ void processComand(uint8_t *xReceive_Buffer)
                 if (Count > SizeOfTransfer) {
                     DeviceState = too_many_packets;
                     Aditionals  = Count;
-                } else if (Count == Next_Packet - 1) {
+                } else if ((Count == Next_Packet - 1) || (DeltaUpload && Count >= Next_Packet - 1 && Count < SizeOfTransfer)) {
+                    // a delta upload only sends the packets of the erased pages
                     uint8_t numberOfWords = 14;
                     if (Count == SizeOfTransfer - 1) { // is this the last packet?
                         numberOfWords = SizeOfLastPacket;
@@ -238,6 +243,11 @@ void processComand(uint8_t *xReceive_Buffer)
                             Data   = unpack_uint32(&xReceive_Buffer[DATA + offset]);
                             aux    = baseOfAdressType(TransferType) + (uint32_t)(
                                 Count * 14 * 4 + x * 4);
+                            if (DeltaUpload && *(uint32_t *)PIOS_BL_HELPER_FLASH_If_Read(aux) == Data) {
+                                // packets straddling a page that was not erased
+                                result = 1;
+                                continue;
+                            }
                             result = 0;
                             for (int retry = 0; retry < MAX_WRI_RETRYS; ++retry) {
                                 if (result == 0) {
@@ -259,7 +269,7 @@ void processComand(uint8_t *xReceive_Buffer)
                         Aditionals  = (uint32_t)Command;
                     }
 
-                    ++Next_Packet;
+                    Next_Packet = Count + 2;
                 } else {
                     DeviceState = wrong_packet_received;
                     Aditionals  = Count;
@@ -297,6 +307,7 @@ void processComand(uint8_t *xReceive_Buffer)
             pack_uint32(devicesTable[Data0 - 1].FW_Crc, &Buffer[10]);
             Buffer[14] = devicesTable[Data0 - 1].devID >> 8;
             Buffer[15] = devicesTable[Data0 - 1].devID;
+            Buffer[DFU_CAPS] = (devicesTable[Data0 - 1].programmingType == Self_flash) ? DFU_CAP_DELTA_UPLOAD : 0;
         }
         sendData(Buffer + 1, 63);
         break;
@@ -318,11 +329,17 @@ void processComand(uint8_t *xReceive_Buffer)
         break;
     case Abort_Operation:
         Next_Packet = 0;
+        DeltaUpload = 0;
         DeviceState = DFUidle;
         break;
 
     case Op_END:
-        if (DeviceState == uploading) {
+        if (DeviceState == uploading && DeltaUpload) {
+            // pages that were not sent are still in place, only the image CRC tells
+            Next_Packet = 0;
+            DeltaUpload = 0;
+            DeviceState = (Expected_CRC == CalcFirmCRC()) ? Last_operation_Success : CRC_Fail;
+        } else if (DeviceState == uploading) {
             if (Next_Packet - 1 == SizeOfTransfer) {
                 Next_Packet = 0;
                 if ((TransferType != FW) || (Expected_CRC == CalcFirmCRC())) {
@@ -378,6 +395,65 @@ void processComand(uint8_t *xReceive_Buffer)
         break;
     case Status_Rep:
 
+        break;
+    case Req_PageCRCs:
+        // CRC of each erase unit of the firmware bank, DFU_PAGE_CRCS_PER_PACKET at a time
+        memset(Buffer, 0, sizeof(Buffer));
+        Buffer[0] = 0x01;
+        Buffer[1] = Rep_PageCRCs;
+        pack_uint32(Count, &Buffer[2]);
+        if ((DeviceState == DFUidle) && (currentProgrammingDestination == Self_flash)) {
+            uint32_t offset;
+            uint32_t size;
+            uint16_t pages = numberOfPages();
+            Buffer[6] = pages >> 8;
+            Buffer[7] = pages;
+            for (uint8_t x = 0; x < DFU_PAGE_CRCS_PER_PACKET && getPage(Count + x, &offset, &size); ++x) {
+                uint32_t crcSize = 0;
+                if (offset < currentDevice.sizeOfCode) {
+                    crcSize = (offset + size > currentDevice.sizeOfCode) ? currentDevice.sizeOfCode - offset : size;
+                }
+                pack_uint32(offset, &Buffer[9 + 12 * x]);
+                pack_uint32(size, &Buffer[13 + 12 * x]);
+                pack_uint32(PIOS_BL_HELPER_CRC_Calc(baseOfAdressType(FW) + offset, crcSize), &Buffer[17 + 12 * x]);
+                Buffer[8] = x + 1;
+            }
+        }
+        sendData(Buffer + 1, 63);
+        break;
+    case Delta_Start:
+        // same as an upload start but nothing is erased, the host erases the pages it changes
+        if ((DeviceState == DFUidle) && (Next_Packet == 0) && (Data0 == FW)
+            && (currentProgrammingDestination == Self_flash)) {
+            TransferType     = Data0;
+            SizeOfTransfer   = Count;
+            Expected_CRC     = unpack_uint32(&xReceive_Buffer[DATA + 2]);
+            SizeOfLastPacket = Data1;
+            if (isBiggerThanAvailable(TransferType, (SizeOfTransfer - 1)
+                                      * 14 * 4 + SizeOfLastPacket * 4) == true) {
+                DeviceState = outsideDevCapabilities;
+                Aditionals  = (uint32_t)Command;
+            } else {
+                Next_Packet = 1;
+                DeltaUpload = 1;
+                DeviceState = uploading;
+            }
+        } else {
+            DeviceState = Last_operation_failed;
+            Aditionals  = (uint32_t)Command;
+        }
+        break;
+    case Erase_Page:
+        // Count is the offset of the page in the firmware bank
+        if ((DeviceState == uploading) && DeltaUpload) {
+            if (Count >= currentDevice.sizeOfCode + currentDevice.sizeOfDescription) {
+                DeviceState = outsideDevCapabilities;
+                Aditionals  = Count;
+            } else if (PIOS_BL_HELPER_FLASH_Erase_Page(baseOfAdressType(FW) + Count) != 1) {
+                DeviceState = Last_operation_failed;
+                Aditionals  = (uint32_t)Command;
+            }
+        }
         break;
     }
     if (EchoReqFlag == 1) {
@@ -405,6 +481,48 @@ void OPDfuIni(uint8_t discover)
         // TODO check other devices trough spi or whatever
     }
 }
+/**
+ * Erase unit number index of the firmware bank (code and description),
+ * as an offset from the start of the bank and a size
+ */
+static bool getPage(uint32_t index, uint32_t *offset, uint32_t *size)
+{
+    uint32_t base    = baseOfAdressType(FW);
+    uint32_t end     = base + currentDevice.sizeOfCode + currentDevice.sizeOfDescription;
+    uint32_t address = base;
+    uint32_t pageStart;
+    uint32_t pageSize;
+
+    while (true) {
+        if ((address >= end) || !PIOS_BL_HELPER_FLASH_Get_Page(address, &pageStart, &pageSize)) {
+            return false;
+        }
+        if (index == 0) {
+            break;
+        }
+        --index;
+        address = pageStart + pageSize;
+    }
+    *offset = address - base;
+    *size   = ((pageStart + pageSize < end) ? pageStart + pageSize : end) - address;
+    return true;
+}
+
+static uint16_t numberOfPages(void)
+{
+    uint32_t end     = baseOfAdressType(FW) + currentDevice.sizeOfCode + currentDevice.sizeOfDescription;
+    uint32_t address = baseOfAdressType(FW);
+    uint32_t pageStart;
+    uint32_t pageSize;
+    uint16_t pages   = 0;
+
+    while ((address < end) && PIOS_BL_HELPER_FLASH_Get_Page(address, &pageStart, &pageSize)) {
+        ++pages;
+        address = pageStart + pageSize;
+    }
+    return pages;
+}
+
 uint32_t baseOfAdressType(DFUTransfer type)
 {
     switch (type) {
@@ -54,6 +54,20 @@
 *               needs to be some measure of time that increments as time passes by.  The timeout values for a given
 *               port should the units used/returned by the get time function.
 *
+* Sliding window
+* Stop and wait caps the throughput at one packet per round trip. When both ends are configured with a
+* windowSize > 1 the synchronise packet carries a two byte payload: 'W' and the offered window. A peer that
+* knows about windows answers the synch ACK with the same payload and the smaller of both windows, an older
+* peer ignores the payload and sends a plain ACK, in which case both ends stay in stop and wait.
+* In windowed mode:
+*   - up to 'window' data packets may be waiting for an ACK, each with its own timeout and retry count.
+*   - the ACK sequence number is cumulative, the last packet delivered in order. It may carry a 16 bit
+*     selective ACK bitmap, bit n set = packet (ack + 2 + n) was received and kept by the other end.
+*   - packets received ahead of a gap are kept if a receive window buffer was configured, dropped otherwise.
+*   - the callback is always called in sequence order.
+* After an SSP_TX_TIMEOUT in windowed mode the sequence numbers of both ends no longer match, the caller has
+* to call ssp_Synchronise again before sending more data, ssp_Window tells if a window is in use.
+*
 * All of the state information of a communication port is contained in a Port_t structure. This allows this
 * module to operature on multiple communication ports with a single code base.
 *
@@ -85,6 +99,9 @@
 #define SEQNUM   1
 #define DATA     2
 
+#define SEQ_SPAN       127 // number of data sequence numbers, 1..127
+#define WINDOW_REQUEST 'W' // first payload byte of a synch request (or its ACK) offering a window
+
 // Make larger sized integers from smaller sized integers
 #define MAKEWORD16(ub, lb)          ((uint16_t)0x0000 | ((uint16_t)(ub) << 8) | (uint16_t)(lb))
 #define MAKEWORD32(uw, lw)          ((uint32_t)(0x0UL | ((uint32_t)(uw) << 16) | (uint32_t)(lw)))
@@ -115,11 +132,24 @@ static int16_t sf_DecodeState(Port_t *thisport, uint8_t c);
 static int16_t sf_ReceiveState(Port_t *thisport, uint8_t c);
 
 static void sf_SendPacket(Port_t *thisport);
+static void sf_SendBuffer(Port_t *thisport, const uint8_t *buf);
 static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber);
 static void sf_MakePacket(uint8_t *buf, const uint8_t *pdata, uint16_t length,
                           uint8_t seqNo);
 static int16_t sf_ReceivePacket(Port_t *thisport);
 
+static uint8_t sf_NextSeqNo(uint8_t seqNo);
+static uint8_t sf_SeqDistance(uint8_t from, uint8_t to);
+static void sf_OpenWindow(Port_t *thisport, uint8_t window);
+static uint8_t *sf_TxSlotBuf(Port_t *thisport, uint8_t slot);
+static uint8_t *sf_RxSlotBuf(Port_t *thisport, uint8_t slot);
+static void sf_ResendSlot(Port_t *thisport, uint8_t slot);
+static int16_t sf_WindowSendProcess(Port_t *thisport);
+static int16_t sf_WindowSendData(Port_t *thisport, const uint8_t *data, const uint16_t length);
+static int16_t sf_WindowReceiveData(Port_t *thisport);
+static void sf_WindowReceiveAck(Port_t *thisport);
+static void sf_SendWindowAck(Port_t *thisport);
+
 /* Flag bit masks...*/
 #define SENT_SYNCH       (0x01)
 #define ACK_RECEIVED     (0x02)
@@ -196,6 +226,11 @@ void ssp_Init(Port_t *thisport, const PortConfig_t *const info)
     thisport->rxSeqNo = 255;
     thisport->txSeqNo = 255;
     thisport->SendState     = SSP_IDLE;
+    thisport->flags         = 0;
+    thisport->windowSize    = (info->windowSize > SSP_MAX_WINDOW) ? SSP_MAX_WINDOW : info->windowSize;
+    thisport->txWindowBuf   = info->txWindowBuf;
+    thisport->rxWindowBuf   = info->rxWindowBuf;
+    sf_OpenWindow(thisport, 0);
 }
 
 /*!
@@ -213,6 +248,10 @@ int16_t ssp_SendProcess(Port_t *thisport)
 {
     int16_t value = SSP_TX_WAITING;
 
+    if (thisport->window) {
+        return sf_WindowSendProcess(thisport);
+    }
+
     if (thisport->SendState == SSP_AWAITING_ACK) {
         if (sf_CheckTimeout(thisport) == TRUE) {
             if (thisport->retryCount < thisport->maxRetryCount) {
@@ -315,6 +354,7 @@ uint16_t ssp_SendDataBlock(Port_t *thisport, uint8_t *data, uint16_t length)
  * \return	SSP_TX_BUFOVERRUN = tried to send too much data
  * \return	SSP_TX_WAITING = data sent and waiting for an ack to arrive
  * \return	SSP_TX_BUSY = a packet has already been sent, but not yet acked
+ *                          (windowed mode: the window is full)
  *
  * \note
  *
@@ -324,6 +364,10 @@ int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
 {
     int16_t value = SSP_TX_WAITING;
 
+    if (thisport->window) {
+        return sf_WindowSendData(thisport, data, length);
+    }
+
     if ((length + 2) > thisport->txBufSize) {
         // TRYING to send too much data.
         value = SSP_TX_BUFOVERRUN;
@@ -391,12 +435,17 @@ int16_t ssp_SendData(Port_t *thisport, const uint8_t *data,
 uint16_t ssp_Synchronise(Port_t *thisport)
 {
     int16_t packet_status;
+    const uint8_t request[] = { WINDOW_REQUEST, thisport->windowSize };
+
+    // back to stop and wait until the other end accepts a window again
+    sf_OpenWindow(thisport, 0);
 
 #ifndef USE_SENDPACKET_DATA
     thisport->txSeqNo = 0; // make this zero to cause the other end to re-synch with us
     SETBIT(thisport->flags, SENT_SYNCH);
     // TODO - should this be using ssp_SendPacketData()??
-    sf_MakePacket(thisport->txBuf, NULL, 0, thisport->txSeqNo); // construct the packet
+    // construct the packet, older receivers ignore the window request
+    sf_MakePacket(thisport->txBuf, request, (thisport->windowSize > 1) ? sizeof(request) : 0, thisport->txSeqNo);
     sf_SendPacket(thisport);
     sf_SetSendTimeout(thisport);
     thisport->SendState = SSP_AWAITING_ACK;
@@ -421,16 +470,27 @@ uint16_t ssp_Synchronise(Port_t *thisport)
  * Packet should be formed through the use of sf_MakePacket before calling this function.
  */
 static void sf_SendPacket(Port_t *thisport)
+{
+    sf_SendBuffer(thisport, thisport->txBuf);
+    thisport->retryCount++;
+}
+
+/*!
+ * \brief   sends out a preformatted packet from any buffer
+ * \param   thisport = which port to use.
+ * \param	buf = packet formed by sf_MakePacket
+ * \return  none.
+ */
+static void sf_SendBuffer(Port_t *thisport, const uint8_t *buf)
 {
     // add 3 to packet data length for: 1 length + 2 CRC (packet overhead)
-    uint8_t packetLen = thisport->txBuf[LENGTH] + 3;
+    uint16_t packetLen = buf[LENGTH] + 3;
 
     // use the raw serial write function so the SYNC byte does not get 'escaped'
     thisport->pfSerialWrite(SYNC);
-    for (uint8_t x = 0; x < packetLen; x++) {
-        sf_write_byte(thisport, thisport->txBuf[x]);
+    for (uint16_t x = 0; x < packetLen; x++) {
+        sf_write_byte(thisport, buf[x]);
     }
-    thisport->retryCount++;
 }
 
 /*!
@@ -486,8 +546,8 @@ static void sf_SendAckPacket(Port_t *thisport, uint8_t seqNumber)
     uint8_t AckSeqNumber = SETBIT(seqNumber, ACK_BIT);
 
     // create the packet, note we pass AckSequenceNumber directly
-    sf_MakePacket(thisport->txBuf, NULL, 0, AckSeqNumber);
-    sf_SendPacket(thisport);
+    sf_MakePacket(thisport->ackBuf, NULL, 0, AckSeqNumber);
+    sf_SendBuffer(thisport, thisport->ackBuf);
     // we don't set the timeout for an ACK because we don't ACK our ACKs in this protocol
 }
 
@@ -753,9 +813,18 @@ static int16_t sf_ReceivePacket(Port_t *thisport)
     int16_t value = FALSE;
 
     if (ISBITSET(thisport->rxBuf[SEQNUM], ACK_BIT)) {
-        // Received an ACK packet, need to check if it matches the previous sent packet
-        if ((thisport->rxBuf[SEQNUM] & 0x7F) == (thisport->txSeqNo & 0x7f)) {
-            // It matches the last packet sent by us
+        if (ISBITSET(thisport->flags, SENT_SYNCH) && (thisport->rxBuf[SEQNUM] & 0x7F) == 0) {
+            // ACK of our synch request, the payload tells if the other end accepted a window
+            CLEARBIT(thisport->flags, SENT_SYNCH);
+            if (thisport->rxBufLen >= 2 && thisport->rxBuf[DATA] == WINDOW_REQUEST) {
+                sf_OpenWindow(thisport, thisport->rxBuf[DATA + 1]);
+            }
+            SETBIT(thisport->txSeqNo, ACK_BIT);
+            thisport->SendState = SSP_ACKED;
+        } else if (thisport->window) {
+            sf_WindowReceiveAck(thisport);
+        } else if ((thisport->rxBuf[SEQNUM] & 0x7F) == (thisport->txSeqNo & 0x7f)) {
+            // Received an ACK packet that matches the previous sent packet
             SETBIT(thisport->txSeqNo, ACK_BIT);
             thisport->SendState = SSP_ACKED;
 
@@ -769,9 +838,22 @@ static int16_t sf_ReceivePacket(Port_t *thisport)
 #ifdef ACTIVE_SYNCH
             thisport->sendSynch = TRUE;
 #endif
-            sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
+            if (thisport->rxBufLen >= 2 && thisport->rxBuf[DATA] == WINDOW_REQUEST) {
+                sf_OpenWindow(thisport, thisport->rxBuf[DATA + 1]);
+            } else {
+                sf_OpenWindow(thisport, 0);
+            }
+            if (thisport->window) {
+                const uint8_t accept[] = { WINDOW_REQUEST, thisport->window };
+                sf_MakePacket(thisport->ackBuf, accept, sizeof(accept), ACK_BIT);
+                sf_SendBuffer(thisport, thisport->ackBuf);
+            } else {
+                sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
+            }
             thisport->rxSeqNo   = 0;
             value = FALSE;
+        } else if (thisport->window) {
+            value = sf_WindowReceiveData(thisport);
         } else if (thisport->rxBuf[SEQNUM] == thisport->rxSeqNo) {
             // Already seen this packet, just ack it, don't act on the packet.
             sf_SendAckPacket(thisport, thisport->rxBuf[SEQNUM]);
@@ -793,3 +875,293 @@ static int16_t sf_ReceivePacket(Port_t *thisport)
     }
     return value;
 }
+
+/*!
+ * \brief   number of packets that can be sent right now without getting SSP_TX_BUSY
+ * \param   thisport = which port to use
+ * \return  free transmit slots, 0 or 1 in stop and wait mode
+ */
+uint16_t ssp_TxWindowFree(Port_t *thisport)
+{
+    if (thisport->window) {
+        return thisport->txSlots - thisport->txCount;
+    }
+    return thisport->SendState == SSP_IDLE;
+}
+
+/*!
+ * \brief   negotiated window, 0 = stop and wait
+ */
+uint8_t ssp_Window(Port_t *thisport)
+{
+    return thisport->window;
+}
+
+/*!
+ * \brief   next data sequence number, 1..127 then back to 1
+ */
+static uint8_t sf_NextSeqNo(uint8_t seqNo)
+{
+    return ((seqNo & 0x7F) % SEQ_SPAN) + 1;
+}
+
+/*!
+ * \brief   number of sequence steps from 'from' to 'to'
+ *
+ * \note
+ * 0 and 127 are the same position, 0 only shows up right after a synchronise.
+ */
+static uint8_t sf_SeqDistance(uint8_t from, uint8_t to)
+{
+    return ((to & 0x7F) % SEQ_SPAN + SEQ_SPAN - (from & 0x7F) % SEQ_SPAN) % SEQ_SPAN;
+}
+
+/*!
+ * \brief   switches between stop and wait and windowed mode, drops anything in flight
+ * \param   thisport = which port to use
+ * \param	window = window offered by the other end, 0 = stop and wait
+ */
+static void sf_OpenWindow(Port_t *thisport, uint8_t window)
+{
+    if (window > thisport->windowSize) {
+        window = thisport->windowSize;
+    }
+    if (window < 2) {
+        window = 0;
+    }
+    thisport->window      = window;
+    thisport->txSlots     = (thisport->txWindowBuf != NULL) ? window : 1;
+    thisport->txHead      = 0;
+    thisport->txCount     = 0;
+    thisport->txAcked     = 0;
+    thisport->txFastRetry = 0;
+    memset(thisport->rxSlotSeqNo, 0, sizeof(thisport->rxSlotSeqNo));
+    if (window) {
+        // both ends count from the synchronise packet again
+        thisport->txSeqNo = 0;
+        thisport->rxSeqNo = 0;
+    }
+}
+
+static uint8_t *sf_TxSlotBuf(Port_t *thisport, uint8_t slot)
+{
+    if (thisport->txWindowBuf == NULL) {
+        return thisport->txBuf;
+    }
+    return thisport->txWindowBuf + slot * (thisport->txBufSize + 2);
+}
+
+static uint8_t *sf_RxSlotBuf(Port_t *thisport, uint8_t slot)
+{
+    return thisport->rxWindowBuf + slot * (thisport->rxBufSize + 2);
+}
+
+static void sf_ResendSlot(Port_t *thisport, uint8_t slot)
+{
+    sf_SendBuffer(thisport, sf_TxSlotBuf(thisport, slot));
+    thisport->txSlotRetry[slot]++;
+    thisport->txSlotTimeout[slot] = thisport->pfGetTime() + thisport->timeoutLen;
+}
+
+/*!
+ * \brief   windowed version of ssp_SendProcess, every slot has its own timeout.
+ * \return  SSP_TX_ACKED once all the slots have been acknowledged, otherwise same as ssp_SendProcess
+ */
+static int16_t sf_WindowSendProcess(Port_t *thisport)
+{
+    uint32_t current_time;
+
+    if (thisport->SendState == SSP_ACKED) {
+        SETBIT(thisport->flags, ACK_RECEIVED);
+        thisport->SendState = SSP_IDLE;
+        return SSP_TX_ACKED;
+    }
+    if (thisport->txCount == 0) {
+        thisport->SendState = SSP_IDLE;
+        return SSP_TX_IDLE;
+    }
+
+    current_time = thisport->pfGetTime();
+    for (uint8_t n = 0; n < thisport->txCount; n++) {
+        uint8_t slot = (thisport->txHead + n) % thisport->txSlots;
+        if (ISBITSET(thisport->txAcked, 1 << slot) || current_time <= thisport->txSlotTimeout[slot]) {
+            continue;
+        }
+        if (thisport->txSlotRetry[slot] < thisport->maxRetryCount) {
+            sf_ResendSlot(thisport, slot);
+        } else {
+            // Give up on the whole window, the other end will not deliver anything past this packet
+            thisport->txCount     = 0;
+            thisport->txAcked     = 0;
+            thisport->txFastRetry = 0;
+            CLEARBIT(thisport->flags, ACK_RECEIVED);
+            thisport->SendState   = SSP_IDLE;
+            return SSP_TX_TIMEOUT;
+        }
+    }
+    return SSP_TX_WAITING;
+}
+
+/*!
+ * \brief   windowed version of ssp_SendData, queues the packet in the next free slot.
+ */
+static int16_t sf_WindowSendData(Port_t *thisport, const uint8_t *data, const uint16_t length)
+{
+    uint8_t slot;
+
+    if ((length + 2) > thisport->txBufSize) {
+        return SSP_TX_BUFOVERRUN;
+    }
+    if (thisport->txCount >= thisport->txSlots) {
+        return SSP_TX_BUSY;
+    }
+
+    slot = (thisport->txHead + thisport->txCount) % thisport->txSlots;
+    thisport->txSeqNo = sf_NextSeqNo(thisport->txSeqNo);
+    thisport->txSlotSeqNo[slot] = thisport->txSeqNo;
+    thisport->txSlotRetry[slot] = 0;
+    thisport->txCount++;
+    CLEARBIT(thisport->flags, ACK_RECEIVED);
+    thisport->SendState = SSP_AWAITING_ACK;
+
+    sf_MakePacket(sf_TxSlotBuf(thisport, slot), data, length, thisport->txSeqNo);
+    sf_ResendSlot(thisport, slot);
+    return SSP_TX_WAITING;
+}
+
+/*!
+ * \brief   delivers an in sequence packet and everything kept behind it, keeps packets ahead of a gap.
+ * \return  true = at least one new packet was delivered
+ */
+static int16_t sf_WindowReceiveData(Port_t *thisport)
+{
+    uint8_t seqNo    = thisport->rxBuf[SEQNUM];
+    uint8_t distance = sf_SeqDistance(sf_NextSeqNo(thisport->rxSeqNo), seqNo);
+    uint8_t rxSlots  = thisport->window - 1;
+    int16_t value    = FALSE;
+
+    if (distance == 0) {
+        thisport->rxSeqNo = seqNo;
+        if (thisport->pfCallBack != NULL) {
+            thisport->pfCallBack(&(thisport->rxBuf[DATA]), thisport->rxBufLen);
+        }
+        value = TRUE;
+
+        // the gap is filled, hand over what was received after it. Slots are not kept in order.
+        uint8_t found = (thisport->rxWindowBuf != NULL);
+        while (found) {
+            found = FALSE;
+            for (uint8_t slot = 0; slot < rxSlots; slot++) {
+                if (thisport->rxSlotSeqNo[slot] == sf_NextSeqNo(thisport->rxSeqNo)) {
+                    uint8_t *buf = sf_RxSlotBuf(thisport, slot);
+                    thisport->rxSeqNo = thisport->rxSlotSeqNo[slot];
+                    thisport->rxSlotSeqNo[slot] = 0;
+                    if (thisport->pfCallBack != NULL) {
+                        thisport->pfCallBack(&buf[DATA], buf[LENGTH] - 1);
+                    }
+                    found = TRUE;
+                }
+            }
+        }
+    } else if (distance < thisport->window && thisport->rxWindowBuf != NULL) {
+        uint8_t freeSlot = 0xFF;
+        for (uint8_t slot = 0; slot < rxSlots; slot++) {
+            if (thisport->rxSlotSeqNo[slot] == seqNo) {
+                freeSlot = 0xFF;
+                break;
+            } else if (thisport->rxSlotSeqNo[slot] == 0 && freeSlot == 0xFF) {
+                freeSlot = slot;
+            }
+        }
+        if (freeSlot != 0xFF) {
+            memcpy(sf_RxSlotBuf(thisport, freeSlot), thisport->rxBuf, thisport->rxBufLen + DATA);
+            thisport->rxSlotSeqNo[freeSlot] = seqNo;
+        }
+    }
+    // anything else is a packet we already delivered, the ACK below tells the sender again
+    sf_SendWindowAck(thisport);
+    return value;
+}
+
+/*!
+ * \brief   sends a cumulative ACK, with the selective ACK bitmap when packets are kept out of order
+ */
+static void sf_SendWindowAck(Port_t *thisport)
+{
+    uint8_t expected  = sf_NextSeqNo(thisport->rxSeqNo);
+    uint16_t received = 0;
+    uint8_t sack[2];
+
+    for (uint8_t slot = 0; slot < thisport->window - 1; slot++) {
+        if (thisport->rxSlotSeqNo[slot] != 0) {
+            uint8_t distance = sf_SeqDistance(expected, thisport->rxSlotSeqNo[slot]);
+            if (distance >= 1 && distance <= SSP_MAX_WINDOW) {
+                SETBIT(received, 1 << (distance - 1));
+            }
+        }
+    }
+    sack[0] = LOWERBYTE(received);
+    sack[1] = UPPERBYTE(received);
+    sf_MakePacket(thisport->ackBuf, sack, received ? sizeof(sack) : 0, thisport->rxSeqNo | ACK_BIT);
+    sf_SendBuffer(thisport, thisport->ackBuf);
+}
+
+/*!
+ * \brief   releases the slots covered by a cumulative/selective ACK and slides the window
+ */
+static void sf_WindowReceiveAck(Port_t *thisport)
+{
+    uint8_t cumulative = thisport->rxBuf[SEQNUM] & 0x7F;
+    uint8_t expected   = sf_NextSeqNo(cumulative);
+    uint16_t received  = 0;
+    uint8_t lastKept   = 0;
+    uint8_t resend     = 0;
+    uint8_t slot;
+    uint8_t n;
+
+    if (thisport->rxBufLen >= 2) {
+        received = MAKEWORD16(thisport->rxBuf[DATA + 1], thisport->rxBuf[DATA]);
+    }
+
+    for (n = 0; n < thisport->txCount; n++) {
+        uint8_t distance;
+        slot = (thisport->txHead + n) % thisport->txSlots;
+        if (sf_SeqDistance(thisport->txSlotSeqNo[slot], cumulative) < thisport->window) {
+            SETBIT(thisport->txAcked, 1 << slot);
+            continue;
+        }
+        distance = sf_SeqDistance(expected, thisport->txSlotSeqNo[slot]);
+        if (distance >= 1 && distance <= SSP_MAX_WINDOW && ISBITSET(received, 1 << (distance - 1))) {
+            SETBIT(thisport->txAcked, 1 << slot);
+            lastKept = n + 1;
+        }
+    }
+
+    // a packet sent before one that made it through is most likely lost, resend it once right away.
+    // An ACK that does not move the window means the other end got a packet it could not deliver,
+    // then the oldest one is the suspect.
+    if (lastKept > 0) {
+        resend = lastKept - 1;
+    } else if (thisport->txCount > 0 && ISBITCLEAR(thisport->txAcked, 1 << thisport->txHead)) {
+        resend = 1;
+    }
+    for (n = 0; n < resend; n++) {
+        slot = (thisport->txHead + n) % thisport->txSlots;
+        if (ISBITCLEAR(thisport->txAcked, 1 << slot) && ISBITCLEAR(thisport->txFastRetry, 1 << slot)) {
+            SETBIT(thisport->txFastRetry, 1 << slot);
+            sf_ResendSlot(thisport, slot);
+        }
+    }
+
+    if (thisport->txCount > 0 && ISBITSET(thisport->txAcked, 1 << thisport->txHead)) {
+        while (thisport->txCount > 0 && ISBITSET(thisport->txAcked, 1 << thisport->txHead)) {
+            CLEARBIT(thisport->txAcked, 1 << thisport->txHead);
+            CLEARBIT(thisport->txFastRetry, 1 << thisport->txHead);
+            thisport->txHead = (thisport->txHead + 1) % thisport->txSlots;
+            thisport->txCount--;
+        }
+        if (thisport->txCount == 0) {
+            thisport->SendState = SSP_ACKED;
+        }
+    }
+}
@@ -124,6 +124,7 @@ SRC += $(PIOSCOMMON)/pios_callbackscheduler.c
 SRC += $(PIOSCOMMON)/pios_notify.c
 SRC += $(PIOSCOMMON)/pios_instrumentation.c
 SRC += $(PIOSCOMMON)/pios_mem.c
+SRC += $(PIOSCOMMON)/pios_mempool.c
 ## Misc library functions
 SRC += $(FLIGHTLIB)/fifo_buffer.c
 
@@ -53,7 +53,7 @@ static void usb2ComBridgeSetCtrlLine(uint32_t com_id, uint32_t mask, uint32_t st
 
 #define TASK_PRIORITY        (tskIDLE_PRIORITY + 1)
 
-#define BRIDGE_BUF_LEN       10
+#define BRIDGE_PORT_DELAY    500
 
 // ****************
 // Private variables
@@ -61,14 +61,23 @@ static void usb2ComBridgeSetCtrlLine(uint32_t com_id, uint32_t mask, uint32_t st
 static xTaskHandle com2UsbBridgeTaskHandle;
 static xTaskHandle usb2ComBridgeTaskHandle;
 
-static uint8_t *com2usb_buf;
-static uint8_t *usb2com_buf;
-
 static uint32_t usart_port;
 static uint32_t vcp_port;
 
 static bool bridge_enabled = false;
 
+// Counter 0xC0B00001 bytes moved per usart -> vcp transfer
+// Counter 0xC0B00002 usart -> vcp transfer time, including waits for room at the vcp
+// Counter 0xC0B00003 bytes moved per vcp -> usart transfer
+// Counter 0xC0B00004 vcp -> usart transfer time, including waits for room at the usart
+#define PIOS_INSTRUMENT_MODULE
+#include <pios_instrumentation_helper.h>
+
+PERF_DEFINE_COUNTER(counterCom2UsbBytes);
+PERF_DEFINE_COUNTER(counterCom2UsbLatency);
+PERF_DEFINE_COUNTER(counterUsb2ComBytes);
+PERF_DEFINE_COUNTER(counterUsb2ComLatency);
+
 /**
  * Initialise the module
  * \return -1 if initialisation failed
@@ -123,10 +132,10 @@ static int32_t comUsbBridgeInitialize(void)
 #endif
 
     if (bridge_enabled) {
-        com2usb_buf = pios_malloc(BRIDGE_BUF_LEN);
-        PIOS_Assert(com2usb_buf);
-        usb2com_buf = pios_malloc(BRIDGE_BUF_LEN);
-        PIOS_Assert(usb2com_buf);
+        PERF_INIT_COUNTER(counterCom2UsbBytes, 0xC0B00001);
+        PERF_INIT_COUNTER(counterCom2UsbLatency, 0xC0B00002);
+        PERF_INIT_COUNTER(counterUsb2ComBytes, 0xC0B00003);
+        PERF_INIT_COUNTER(counterUsb2ComLatency, 0xC0B00004);
         HwSettingsConnectCallback(&updateSettings);
         updateSettings(0);
     }
@@ -145,12 +154,17 @@ static void com2UsbBridgeTask(__attribute__((unused)) void *parameters)
     volatile uint32_t tx_errors = 0;
 
     while (1) {
-        uint32_t rx_bytes;
-
-        rx_bytes = PIOS_COM_ReceiveBuffer(usart_port, com2usb_buf, BRIDGE_BUF_LEN, 500);
-        if (rx_bytes > 0) {
-            /* Bytes available to transfer */
-            if (PIOS_COM_SendBuffer(vcp_port, com2usb_buf, rx_bytes) != (int32_t)rx_bytes) {
+        const uint8_t *rx_data;
+
+        /* The bytes are moved from the usart rx buffer into the vcp tx buffer,
+         * whatever does not fit stays in the usart buffer for the next round */
+        if (PIOS_COM_ReceiveBufferRef(usart_port, &rx_data, BRIDGE_PORT_DELAY) > 0) {
+            PERF_TIMED_SECTION_START(counterCom2UsbLatency);
+            int32_t tx_bytes = PIOS_COM_ForwardBuffer(usart_port, vcp_port, BRIDGE_PORT_DELAY);
+            PERF_TIMED_SECTION_END(counterCom2UsbLatency);
+            if (tx_bytes > 0) {
+                PERF_TRACK_VALUE(counterCom2UsbBytes, tx_bytes);
+            } else {
                 /* Error on transmit */
                 tx_errors++;
             }
@@ -164,12 +178,15 @@ static void usb2ComBridgeTask(__attribute__((unused)) void *parameters)
     volatile uint32_t tx_errors = 0;
 
     while (1) {
-        uint32_t rx_bytes;
-
-        rx_bytes = PIOS_COM_ReceiveBuffer(vcp_port, usb2com_buf, BRIDGE_BUF_LEN, 500);
-        if (rx_bytes > 0) {
-            /* Bytes available to transfer */
-            if (PIOS_COM_SendBuffer(usart_port, usb2com_buf, rx_bytes) != (int32_t)rx_bytes) {
+        const uint8_t *rx_data;
+
+        if (PIOS_COM_ReceiveBufferRef(vcp_port, &rx_data, BRIDGE_PORT_DELAY) > 0) {
+            PERF_TIMED_SECTION_START(counterUsb2ComLatency);
+            int32_t tx_bytes = PIOS_COM_ForwardBuffer(vcp_port, usart_port, BRIDGE_PORT_DELAY);
+            PERF_TIMED_SECTION_END(counterUsb2ComLatency);
+            if (tx_bytes > 0) {
+                PERF_TRACK_VALUE(counterUsb2ComBytes, tx_bytes);
+            } else {
                 /* Error on transmit */
                 tx_errors++;
             }
@@ -56,7 +56,6 @@
 #define RETRY_TIMEOUT_MS  20
 #define EVENT_QUEUE_SIZE  10
 #define MAX_PORT_DELAY    200
-#define SERIAL_RX_BUF_LEN 100
 #define PPM_INPUT_TIMEOUT 100
 
 
@@ -80,9 +79,6 @@ typedef struct {
     xQueueHandle uavtalkEventQueue;
     xQueueHandle radioEventQueue;
 
-    // The raw serial Rx buffer
-    uint8_t  serialRxBuf[SERIAL_RX_BUF_LEN];
-
     // Error statistics.
     uint32_t telemetryTxRetries;
     uint32_t radioTxRetries;
@@ -118,6 +114,19 @@ static void registerObject(UAVObjHandle obj);
 
 static RadioComBridgeData *data;
 
+// Raw serial mode only:
+// Counter 0x8AD10001 bytes moved per radio -> telemetry port transfer
+// Counter 0x8AD10002 radio -> telemetry port transfer time, including waits for room at the port
+// Counter 0x8AD10003 bytes moved per telemetry port -> radio transfer
+// Counter 0x8AD10004 telemetry port -> radio transfer time, including waits for room at the radio
+#define PIOS_INSTRUMENT_MODULE
+#include <pios_instrumentation_helper.h>
+
+PERF_DEFINE_COUNTER(counterRadioRxBytes);
+PERF_DEFINE_COUNTER(counterRadioRxLatency);
+PERF_DEFINE_COUNTER(counterSerialRxBytes);
+PERF_DEFINE_COUNTER(counterSerialRxLatency);
+
 /**
  * @brief Start the module
  *
@@ -195,6 +204,11 @@ static int32_t RadioComBridgeStart(void)
 #endif
         }
         if (!data->parseUAVTalk) {
+            PERF_INIT_COUNTER(counterRadioRxBytes, 0x8AD10001);
+            PERF_INIT_COUNTER(counterRadioRxLatency, 0x8AD10002);
+            PERF_INIT_COUNTER(counterSerialRxBytes, 0x8AD10003);
+            PERF_INIT_COUNTER(counterSerialRxLatency, 0x8AD10004);
+
             // If the user wants raw serial communication, we need to spawn another thread to handle it.
             xTaskCreate(serialRxTask, "serialRxTask", STACK_SIZE_BYTES, NULL, TASK_PRIORITY, &(data->serialRxTaskHandle));
 #ifdef PIOS_INCLUDE_WDG
@@ -402,22 +416,28 @@ static void radioRxTask(__attribute__((unused)) void *parameters)
 #ifdef PIOS_INCLUDE_WDG
         PIOS_WDG_UpdateFlag(PIOS_WDG_RADIORX);
 #endif
-        if (PIOS_COM_RADIO) {
+        if (PIOS_COM_RADIO && data->parseUAVTalk) {
             uint8_t serial_data[16];
             uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(PIOS_COM_RADIO, serial_data, sizeof(serial_data), MAX_PORT_DELAY);
             if (bytes_to_process > 0) {
-                if (data->parseUAVTalk) {
-                    // Pass the data through the UAVTalk parser.
-                    ProcessRadioStream(data->radioUAVTalkCon, data->telemUAVTalkCon, serial_data, bytes_to_process);
-                } else if (PIOS_COM_TELEMETRY) {
-                    // Send the data straight to the telemetry port.
-                    // Following call can fail with -2 error code (buffer full) or -3 error code (could not acquire send mutex)
-                    // It is the caller responsibility to retry in such cases...
-                    int32_t ret   = -2;
-                    uint8_t count = 5;
-                    while (count-- > 0 && ret < -1) {
-                        ret = PIOS_COM_SendBufferNonBlocking(PIOS_COM_TELEMETRY, serial_data, bytes_to_process);
+                // Pass the data through the UAVTalk parser.
+                ProcessRadioStream(data->radioUAVTalkCon, data->telemUAVTalkCon, serial_data, bytes_to_process);
+            }
+        } else if (PIOS_COM_RADIO) {
+            const uint8_t *rx_data;
+            if (PIOS_COM_ReceiveBufferRef(PIOS_COM_RADIO, &rx_data, MAX_PORT_DELAY) > 0) {
+                if (PIOS_COM_TELEMETRY) {
+                    // Move the data straight from the radio buffer into the telemetry port buffer.
+                    // What does not fit stays in the radio buffer until the port drained some.
+                    PERF_TIMED_SECTION_START(counterRadioRxLatency);
+                    int32_t ret = PIOS_COM_ForwardBuffer(PIOS_COM_RADIO, PIOS_COM_TELEMETRY, MAX_PORT_DELAY);
+                    PERF_TIMED_SECTION_END(counterRadioRxLatency);
+                    if (ret > 0) {
+                        PERF_TRACK_VALUE(counterRadioRxBytes, ret);
                     }
+                } else {
+                    // Nowhere to send it to, drop the data.
+                    PIOS_COM_ReceiveBufferRelease(PIOS_COM_RADIO, UINT16_MAX);
                 }
             }
         } else {
@@ -504,17 +524,17 @@ static void serialRxTask(__attribute__((unused)) void *parameters)
         PIOS_WDG_UpdateFlag(PIOS_WDG_SERIALRX);
 #endif
         if (inputPort && PIOS_COM_RADIO) {
-            // Receive some data.
-            uint16_t bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, data->serialRxBuf, sizeof(data->serialRxBuf), MAX_PORT_DELAY);
-
-            if (bytes_to_process > 0) {
-                // Send the data over the radio link.
-                // Following call can fail with -2 error code (buffer full) or -3 error code (could not acquire send mutex)
-                // It is the caller responsibility to retry in such cases...
-                int32_t ret   = -2;
-                uint8_t count = 5;
-                while (count-- > 0 && ret < -1) {
-                    ret = PIOS_COM_SendBufferNonBlocking(PIOS_COM_RADIO, data->serialRxBuf, bytes_to_process);
+            const uint8_t *rx_data;
+
+            // Wait for some data.
+            if (PIOS_COM_ReceiveBufferRef(inputPort, &rx_data, MAX_PORT_DELAY) > 0) {
+                // Move the data straight from the port buffer into the radio buffer.
+                // What does not fit stays in the port buffer until the radio drained some.
+                PERF_TIMED_SECTION_START(counterSerialRxLatency);
+                int32_t ret = PIOS_COM_ForwardBuffer(inputPort, PIOS_COM_RADIO, MAX_PORT_DELAY);
+                PERF_TIMED_SECTION_END(counterSerialRxLatency);
+                if (ret > 0) {
+                    PERF_TRACK_VALUE(counterSerialRxBytes, ret);
                 }
             }
         } else {
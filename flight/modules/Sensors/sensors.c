@@ -114,9 +114,10 @@ typedef struct {
     uint32_t   count;
 } sensor_fetch_context;
 
-#define MAX_SENSOR_DATA_SIZE (sizeof(PIOS_SENSORS_3Axis_SensorsWithTemp) + MAX_SENSORS_PER_INSTANCE * sizeof(Vector3i16))
+#define MAX_SENSOR_DATA_SIZE (sizeof(PIOS_SENSORS_3Axis_SensorsBatch) + PIOS_SENSORS_MAX_BATCH * MAX_SENSORS_PER_INSTANCE * sizeof(Vector3i16))
 typedef union {
     PIOS_SENSORS_3Axis_SensorsWithTemp sensorSample3Axis;
+    PIOS_SENSORS_3Axis_SensorsBatch    sensorBatch3Axis;
     PIOS_SENSORS_1Axis_SensorsWithTemp sensorSample1Axis;
 } sensor_data;
 
@@ -139,6 +140,7 @@ static void SensorsTask(void *parameters);
 static void settingsUpdatedCb(UAVObjEvent *objEv);
 
 static void accumulateSamples(sensor_fetch_context *sensor_context, sensor_data *sample);
+static void accumulateBatch(sensor_fetch_context *sensor_context, sensor_data *batch);
 static void processSamples3d(sensor_fetch_context *sensor_context, const PIOS_SENSORS_Instance *sensor);
 static void processSamples1d(PIOS_SENSORS_1Axis_SensorsWithTemp *sample, const PIOS_SENSORS_Instance *sensor);
 
@@ -321,7 +323,11 @@ static void SensorsTask(__attribute__((unused)) void *parameters)
                 while (xQueueReceive(queue,
                                      (void *)source_data,
                                      (is_primary && !sensor_context.count) ? sensor_period_ticks : 0) == pdTRUE) {
-                    accumulateSamples(&sensor_context, source_data);
+                    if (sensor->driver->is_batched) {
+                        accumulateBatch(&sensor_context, source_data);
+                    } else {
+                        accumulateSamples(&sensor_context, source_data);
+                    }
                 }
                 if (sensor_context.count) {
                     processSamples3d(&sensor_context, sensor);
@@ -374,6 +380,24 @@ static void accumulateSamples(sensor_fetch_context *sensor_context, sensor_data
     sensor_context->count++;
 }
 
+static void accumulateBatch(sensor_fetch_context *sensor_context, sensor_data *batch)
+{
+    const PIOS_SENSORS_3Axis_SensorsBatch *b = &batch->sensorBatch3Axis;
+    const Vector3i16 *sample = b->sample;
+
+    for (uint32_t n = 0; n < b->samples; n++) {
+        for (uint32_t i = 0; i < b->count; i++, sample++) {
+            if (i < MAX_SENSORS_PER_INSTANCE) {
+                sensor_context->accum[i].x += sample->x;
+                sensor_context->accum[i].y += sample->y;
+                sensor_context->accum[i].z += sample->z;
+            }
+        }
+    }
+    sensor_context->temperature += b->temperature * (int32_t)b->samples;
+    sensor_context->count += b->samples;
+}
+
 static void processSamples3d(sensor_fetch_context *sensor_context, const PIOS_SENSORS_Instance *sensor)
 {
     float samples[3];
@@ -81,6 +81,15 @@ typedef struct stateFilterStruct {
     void *localdata;
 } stateFilter;
 
+// Runs a single stage of the filter chain, see StateEstimationSetStageHook()
+typedef filterResult (*stateEstimationStageHook)(stateFilter *filter, stateEstimation *state);
+
+int32_t StateEstimationInitialize(void);
+int32_t StateEstimationStart(void);
+void StateEstimationSetStageHook(stateEstimationStageHook hook);
+#ifdef SIM_REPLAY
+const char *StateEstimationFilterName(const stateFilter *filter);
+#endif
 
 int32_t filterMagInitialize(stateFilter *handle);
 int32_t filterBaroiInitialize(stateFilter *handle);
@@ -143,6 +143,7 @@ static volatile RevoSettingsData revoSettings;
 static volatile sensorUpdates updatedSensors;
 static volatile int32_t fusionAlgorithm  = -1;
 static const filterPipeline *filterChain = NULL;
+static stateEstimationStageHook stageHook = NULL;
 
 // different filters available to state estimation
 static stateFilter magFilter;
@@ -158,6 +159,27 @@ static stateFilter cfmFilter;
 static stateFilter ekf13iFilter;
 static stateFilter ekf13Filter;
 
+#ifdef SIM_REPLAY
+// filter names, for tools that report on single stages of a chain
+static const struct {
+    const stateFilter *filter;
+    const char *name;
+} filterNames[] = {
+    { &magFilter,        "mag"        },
+    { &baroFilter,       "baro"       },
+    { &baroiFilter,      "baroi"      },
+    { &velocityFilter,   "velocity"   },
+    { &altitudeFilter,   "altitude"   },
+    { &airFilter,        "air"        },
+    { &stationaryFilter, "stationary" },
+    { &llaFilter,        "lla"        },
+    { &cfFilter,         "cf"         },
+    { &cfmFilter,        "cfm"        },
+    { &ekf13iFilter,     "ekf13i"     },
+    { &ekf13Filter,      "ekf13"      },
+};
+#endif /* SIM_REPLAY */
+
 // this is a hack to provide a computational shortcut for faster gyro state progression
 static float gyroRaw[3];
 static float gyroDelta[3];
@@ -342,6 +364,34 @@ int32_t StateEstimationStart(void)
 
 MODULE_INITCALL(StateEstimationInitialize, StateEstimationStart);
 
+/**
+ * Install a hook that runs each stage of the filter chain in place of a direct
+ * call to its filter function, e.g. to time the stages in a host build.
+ * The hook must call filter->filter(filter, state) and return its result.
+ * \param[in] hook the hook, or NULL to call the filters directly
+ */
+void StateEstimationSetStageHook(stateEstimationStageHook hook)
+{
+    stageHook = hook;
+}
+
+#ifdef SIM_REPLAY
+/**
+ * Get the name of a filter of the chains
+ * \param[in] filter the filter as passed to the stage hook
+ * \returns the name or "unknown"
+ */
+const char *StateEstimationFilterName(const stateFilter *filter)
+{
+    for (uint8_t i = 0; i < NELEMENTS(filterNames); i++) {
+        if (filterNames[i].filter == filter) {
+            return filterNames[i].name;
+        }
+    }
+    return "unknown";
+}
+#endif /* SIM_REPLAY */
+
 
 /**
  * Module callback
@@ -451,7 +501,12 @@ static void StateEstimationCb(void)
     // we are not done, re-dispatch self execution
 
     while (current) {
-        filterResult result = current->filter->filter((stateFilter *)current->filter, &states);
+        filterResult result;
+        if (stageHook) {
+            result = stageHook((stateFilter *)current->filter, &states);
+        } else {
+            result = current->filter->filter((stateFilter *)current->filter, &states);
+        }
         if (result > alarm) {
             alarm = result;
         }
@@ -73,6 +73,13 @@
 #include <oplinkstatus.h>
 #endif
 
+// The pool statistics come with the task diagnostics
+#if defined(PIOS_INCLUDE_MEMPOOL) && defined(DIAG_TASKS)
+#define DIAG_MEMPOOL
+#include <mempoolstats.h>
+#include <pios_mempool.h>
+#endif
+
 // Flight Libraries
 #include <sanitycheck.h>
 
@@ -116,6 +123,9 @@ static void taskMonitorForEachCallback(uint16_t task_id, const struct pios_task_
 static void callbackSchedulerForEachCallback(int16_t callback_id, const struct pios_callback_info *callback_info, void *context);
 #endif
 static void updateStats();
+#ifdef DIAG_MEMPOOL
+static void updateMemPoolStats();
+#endif
 static void updateSystemAlarms();
 static void systemTask(void *parameters);
 #ifdef DIAG_I2C_WDG_STATS
@@ -135,6 +145,8 @@ int32_t SystemModStart(void)
     // Initialize vars
     stackOverflow = STACKOVERFLOW_NONE;
     mallocFailed  = false;
+    // Set up the small block pool, if any, before the tasks allocate from it
+    pios_mem_init();
     // Create system task
     xTaskCreate(systemTask, "System", STACK_SIZE_BYTES / 4, NULL, TASK_PRIORITY, &systemTaskHandle);
 
@@ -160,6 +172,9 @@ int32_t SystemModInitialize(void)
     I2CStatsInitialize();
     WatchdogStatusInitialize();
 #endif
+#ifdef DIAG_MEMPOOL
+    MemPoolStatsInitialize();
+#endif
 
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
     InstrumentationInit();
@@ -240,6 +255,9 @@ static void systemTask(__attribute__((unused)) void *parameters)
         updateI2Cstats();
         updateWDGstats();
 #endif
+#ifdef DIAG_MEMPOOL
+        updateMemPoolStats();
+#endif
 
 #ifdef PIOS_INCLUDE_INSTRUMENTATION
         InstrumentationPublishAllCounters();
@@ -513,6 +531,31 @@ static void updateWDGstats()
 }
 #endif /* ifdef DIAG_I2C_WDG_STATS */
 
+#ifdef DIAG_MEMPOOL
+/**
+ * Called periodically to update the block pool statistics
+ */
+static void updateMemPoolStats()
+{
+    MemPoolStatsData poolStats;
+    struct pios_mempool_stats stats[MEMPOOLSTATS_BLOCKSIZE_NUMELEM];
+
+    memset(&poolStats, 0, sizeof(poolStats));
+    vPortEnterCritical();
+    uint8_t classes = PIOS_MEMPOOL_GetStats(stats, MEMPOOLSTATS_BLOCKSIZE_NUMELEM);
+    vPortExitCritical();
+
+    for (uint8_t i = 0; i < classes; i++) {
+        poolStats.BlockSize[i] = stats[i].block_size;
+        poolStats.Blocks[i]    = stats[i].blocks;
+        poolStats.Used[i]      = stats[i].used;
+        poolStats.MaxUsed[i]   = stats[i].max_used;
+        poolStats.Failed[i]    = stats[i].failed;
+    }
+    MemPoolStatsSet(&poolStats);
+}
+#endif /* DIAG_MEMPOOL */
+
 /**
  * Called periodically to update the system stats
  */
@@ -675,6 +718,9 @@ void vApplicationIdleHook(void)
 #ifdef PIOS_INCLUDE_WS2811
     LedNotificationExtLedsRun();
 #endif
+#ifdef PIOS_INCLUDE_LOCKSTEP
+    vPortLockstepIdle();
+#endif
 }
 /**
  * Called by the RTOS when a stack overflow is detected.
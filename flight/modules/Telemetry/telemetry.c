@@ -53,6 +53,14 @@
  * PIOS_TELEM_PRIORITY_QUEUE is defined then two queues are created, one normal
  * priority and the other high priority.
  *
+ * The queues do not carry the events themselves: object events are collected
+ * in a pending set with at most one entry per object instance, holding the
+ * kinds of events waiting for it, and only the index of a new entry is queued.
+ * The entries are found through a small hash of the object handle and
+ * instance. Further events for an instance already waiting are merged into its entry,
+ * so a stalled link sends the latest data once instead of filling the queues
+ * with stale duplicates.
+ *
  * The "Tx" tasks read events first from the priority queue and then from
  * the normal queue, passing each event to processObjEvent() which ultimately
  * passes each event to the UAVTalk library which results in the appropriate
@@ -96,15 +104,36 @@
 #define MAX_RETRIES               2
 #define STATS_UPDATE_PERIOD_MS    4000
 #define CONNECTION_TIMEOUT_MS     8000
+#define PENDING_HASH_SIZE         32 // power of two
+#define PENDING_NONE              0xFF
 
 #ifdef PIOS_INCLUDE_RFM22B
 #define HAS_RADIO
 #endif
 
+#if MAX_QUEUE_SIZE >= PENDING_NONE
+#error "The telemetry queues carry 8 bit pending event indices"
+#endif
+
 // Private types
+typedef struct {
+    UAVObjHandle obj;
+    uint16_t     instId;
+    uint8_t      events; // UAVObjEventType bits waiting to be processed
+    uint8_t      next; // next entry of the same hash bucket or of the free list
+} pendingEvent;
+
 typedef struct {
     // Determine port on which to communicate telemetry information
     uint32_t (*getPort)();
+    // Event callback feeding the pending set of this channel
+    UAVObjEventCallback eventCallback;
+    // Object instances waiting to be processed, their indices are queued
+    pendingEvent *pending;
+    // First entry of each hash bucket of the pending set
+    uint8_t pendingHash[PENDING_HASH_SIZE];
+    // First unused entry of the pending set
+    uint8_t pendingFree;
     // Main telemetry queue
     xQueueHandle queue;
 
@@ -125,6 +154,7 @@ typedef struct {
 static channelContext localChannel;
 static int32_t transmitLocalData(uint8_t *data, int32_t length);
 static void registerLocalObject(UAVObjHandle obj);
+static void localObjEvent(UAVObjEvent *ev);
 static uint32_t localPort();
 #endif /* ifdef HAS_RADIO */
 
@@ -134,6 +164,7 @@ static void updateSettings(channelContext *channel);
 static channelContext radioChannel;
 static int32_t transmitRadioData(uint8_t *data, int32_t length);
 static void registerRadioObject(UAVObjHandle obj);
+static void radioObjEvent(UAVObjEvent *ev);
 static uint32_t radioPort();
 static uint32_t radio_port;
 
@@ -152,6 +183,16 @@ static void updateObject(
 static void processObjEvent(
     channelContext *channel,
     UAVObjEvent *ev);
+static void queueObjEvent(
+    channelContext *channel,
+    UAVObjEvent *ev);
+static void processPendingEvent(
+    channelContext *channel,
+    uint8_t index);
+static void connectObject(
+    channelContext *channel,
+    UAVObjHandle obj,
+    uint8_t eventMask);
 static int32_t setUpdatePeriod(
     channelContext *channel,
     UAVObjHandle obj,
@@ -175,12 +216,6 @@ int32_t TelemetryStart(void)
     if (localPort()) {
         UAVObjIterate(&registerLocalObject);
 
-        // Listen to objects of interest
-#ifdef PIOS_TELEM_PRIORITY_QUEUE
-        GCSTelemetryStatsConnectQueue(localChannel.priorityQueue);
-#else /* PIOS_TELEM_PRIORITY_QUEUE */
-        GCSTelemetryStatsConnectQueue(localChannel.queue);
-#endif /* PIOS_TELEM_PRIORITY_QUEUE */
         // Start telemetry tasks
         xTaskCreate(telemetryTxTask,
                     "TelTx",
@@ -204,13 +239,6 @@ int32_t TelemetryStart(void)
     // Start the telemetry tasks associated with Radio/USB
     UAVObjIterate(&registerRadioObject);
 
-    // Listen to objects of interest
-#ifdef PIOS_TELEM_PRIORITY_QUEUE
-    GCSTelemetryStatsConnectQueue(radioChannel.priorityQueue);
-#else /* PIOS_TELEM_PRIORITY_QUEUE */
-    GCSTelemetryStatsConnectQueue(radioChannel.queue);
-#endif /* PIOS_TELEM_PRIORITY_QUEUE */
-
     xTaskCreate(telemetryTxTask,
                 "RadioTx",
                 STACK_SIZE_RADIO_TX_BYTES / 4,
@@ -234,28 +262,32 @@ int32_t TelemetryStart(void)
 /* Intialise a telemetry channel */
 void TelemetryInitializeChannel(channelContext *channel)
 {
+    // Create the pending set, the queues can hold all of its entries
+    channel->pending = (pendingEvent *)pios_malloc(MAX_QUEUE_SIZE * sizeof(pendingEvent));
+    PIOS_Assert(channel->pending);
+    memset(channel->pending, 0, MAX_QUEUE_SIZE * sizeof(pendingEvent));
+    for (uint8_t i = 0; i < MAX_QUEUE_SIZE; i++) {
+        channel->pending[i].next = (i + 1 < MAX_QUEUE_SIZE) ? i + 1 : PENDING_NONE;
+    }
+    channel->pendingFree = 0;
+    memset(channel->pendingHash, PENDING_NONE, sizeof(channel->pendingHash));
+
     // Create object queues
     channel->queue = xQueueCreate(MAX_QUEUE_SIZE,
-                                  sizeof(UAVObjEvent));
+                                  sizeof(uint8_t));
 
 #if defined(PIOS_TELEM_PRIORITY_QUEUE)
     channel->priorityQueue = xQueueCreate(MAX_QUEUE_SIZE,
-                                          sizeof(UAVObjEvent));
+                                          sizeof(uint8_t));
 #endif /* PIOS_TELEM_PRIORITY_QUEUE */
 
     // Create periodic event that will be used to update the telemetry stats
     UAVObjEvent ev;
     memset(&ev, 0, sizeof(UAVObjEvent));
 
-#ifdef PIOS_TELEM_PRIORITY_QUEUE
-    EventPeriodicQueueCreate(&ev,
-                             channel->priorityQueue,
-                             STATS_UPDATE_PERIOD_MS);
-#else /* PIOS_TELEM_PRIORITY_QUEUE */
-    EventPeriodicQueueCreate(&ev,
-                             channel->queue,
-                             STATS_UPDATE_PERIOD_MS);
-#endif /* PIOS_TELEM_PRIORITY_QUEUE */
+    EventPeriodicCallbackCreate(&ev,
+                                channel->eventCallback,
+                                STATS_UPDATE_PERIOD_MS);
 }
 
 /**
@@ -294,6 +326,7 @@ int32_t TelemetryInitialize(void)
 #ifdef HAS_RADIO
     // Set channel port handlers
     localChannel.getPort = localPort;
+    localChannel.eventCallback = localObjEvent;
 
     // Set the local telemetry baud rate
     updateSettings(&localChannel);
@@ -309,6 +342,7 @@ int32_t TelemetryInitialize(void)
 
     // Set channel port handlers
     radioChannel.getPort = radioPort;
+    radioChannel.eventCallback = radioObjEvent;
 
     // Set the channel port baud rate
     updateSettings(&radioChannel);
@@ -333,11 +367,7 @@ static void registerLocalObject(UAVObjHandle obj)
 {
     if (UAVObjIsMetaobject(obj)) {
         // Only connect change notifications for meta objects.  No periodic updates
-#ifdef PIOS_TELEM_PRIORITY_QUEUE
-        UAVObjConnectQueue(obj, localChannel.priorityQueue, EV_MASK_ALL_UPDATES);
-#else /* PIOS_TELEM_PRIORITY_QUEUE */
-        UAVObjConnectQueue(obj, localChannel.queue, EV_MASK_ALL_UPDATES);
-#endif /* PIOS_TELEM_PRIORITY_QUEUE */
+        connectObject(&localChannel, obj, EV_MASK_ALL_UPDATES);
     } else {
         // Setup object for periodic updates
         updateObject(
@@ -352,11 +382,7 @@ static void registerRadioObject(UAVObjHandle obj)
 {
     if (UAVObjIsMetaobject(obj)) {
         // Only connect change notifications for meta objects.  No periodic updates
-#ifdef PIOS_TELEM_PRIORITY_QUEUE
-        UAVObjConnectQueue(obj, radioChannel.priorityQueue, EV_MASK_ALL_UPDATES);
-#else /* PIOS_TELEM_PRIORITY_QUEUE */
-        UAVObjConnectQueue(obj, radioChannel.queue, EV_MASK_ALL_UPDATES);
-#endif /* PIOS_TELEM_PRIORITY_QUEUE */
+        connectObject(&radioChannel, obj, EV_MASK_ALL_UPDATES);
     } else {
         // Setup object for periodic updates
         updateObject(
@@ -467,14 +493,149 @@ static void updateObject(
         break;
     }
 
-    // note that all setting objects have implicitly IsPriority=true
+    connectObject(channel, obj, eventMask);
+}
+
+/**
+ * Connect the object events to the pending set of the channel
+ * \param[in] telemetry channel context
+ * \param[in] obj Object to connect
+ * \param[in] eventMask Events to listen to
+ */
+static void connectObject(
+    channelContext *channel,
+    UAVObjHandle obj,
+    uint8_t eventMask)
+{
+    // The connection handshake listens to every update of GCSTelemetryStats,
+    // whatever its telemetry settings are
+    if (obj == GCSTelemetryStatsHandle()) {
+        eventMask = EV_MASK_ALL_UPDATES;
+    }
+    UAVObjConnectCallback(obj, channel->eventCallback, eventMask, true);
+}
+
+#ifdef HAS_RADIO
+static void localObjEvent(UAVObjEvent *ev)
+{
+    queueObjEvent(&localChannel, ev);
+}
+#endif /* HAS_RADIO */
+
+static void radioObjEvent(UAVObjEvent *ev)
+{
+    queueObjEvent(&radioChannel, ev);
+}
+
+/**
+ * Hash bucket of an object instance in the pending set
+ */
+static inline uint8_t pendingBucket(UAVObjHandle obj, uint16_t instId)
+{
+    uintptr_t h = (uintptr_t)obj;
+
+    return ((h >> 3) ^ (h >> 8) ^ instId) & (PENDING_HASH_SIZE - 1);
+}
+
+/**
+ * Add an event to the pending set, called from the context of the task
+ * raising the event. An instance already waiting only records the kind of
+ * event, its transmission will send the latest data.
+ * \param[in] telemetry channel context
+ * \param[in] ev The event
+ */
+static void queueObjEvent(
+    channelContext *channel,
+    UAVObjEvent *ev)
+{
+    uint8_t bucket = pendingBucket(ev->obj, ev->instId);
+    uint8_t index;
+
+    vPortEnterCritical();
+    for (index = channel->pendingHash[bucket]; index != PENDING_NONE; index = channel->pending[index].next) {
+        pendingEvent *entry = &channel->pending[index];
+        if (entry->obj == ev->obj && entry->instId == ev->instId) {
+            entry->events |= ev->event;
+            vPortExitCritical();
+            return;
+        }
+    }
+    index = channel->pendingFree;
+    if (index != PENDING_NONE) {
+        pendingEvent *entry = &channel->pending[index];
+        channel->pendingFree = entry->next;
+        entry->obj    = ev->obj;
+        entry->instId = ev->instId;
+        entry->events = ev->event;
+        entry->next   = channel->pendingHash[bucket];
+        channel->pendingHash[bucket] = index;
+    }
+    vPortExitCritical();
+
+    if (index == PENDING_NONE) {
+        // Every entry is waiting, the event is lost. Periodic updates are
+        // low priority and do not count as failures, as with the event queues.
+        if (!ev->lowPriority) {
+            ++txErrors;
+        }
+        return;
+    }
+
 #ifdef PIOS_TELEM_PRIORITY_QUEUE
-    if (UAVObjIsPriority(obj)) {
-        UAVObjConnectQueue(obj, channel->priorityQueue, eventMask);
-    } else
+    // note that all setting objects have implicitly IsPriority=true, the
+    // stats, handshake and metaobject updates always go first
+    if (ev->obj == 0 || ev->obj == GCSTelemetryStatsHandle() ||
+        UAVObjIsMetaobject(ev->obj) || UAVObjIsPriority(ev->obj)) {
+        xQueueSend(channel->priorityQueue, &index, 0);
+        return;
+    }
 #endif /* PIOS_TELEM_PRIORITY_QUEUE */
+    // will not fail, the queues can hold all the entries of the pending set
+    xQueueSend(channel->queue, &index, 0);
+}
 
-    UAVObjConnectQueue(obj, channel->queue, eventMask);
+/**
+ * Take an entry out of the pending set and process the events it holds,
+ * each kind of event once
+ * \param[in] telemetry channel context
+ * \param[in] index The pending set entry
+ */
+static void processPendingEvent(
+    channelContext *channel,
+    uint8_t index)
+{
+    pendingEvent *entry = &channel->pending[index];
+    UAVObjEvent ev;
+    uint8_t events;
+    uint8_t *link;
+
+    vPortEnterCritical();
+    ev.obj    = entry->obj;
+    ev.instId = entry->instId;
+    events    = entry->events;
+    // unlink the entry from its bucket and return it to the free list
+    for (link = &channel->pendingHash[pendingBucket(ev.obj, ev.instId)]; *link != index; link = &channel->pending[*link].next) {
+        ;
+    }
+    *link = entry->next;
+    entry->next = channel->pendingFree;
+    channel->pendingFree = index;
+    vPortExitCritical();
+    ev.lowPriority = false;
+
+    if (events == EV_NONE) {
+        // periodic telemetry stats update
+        ev.event = EV_NONE;
+        processObjEvent(channel, &ev);
+        return;
+    }
+    for (uint8_t event = EV_UNPACKED; event && events; event <<= 1) {
+        if (events & event) {
+            events  &= ~event;
+            ev.event = (UAVObjEventType)event;
+            processObjEvent(channel, &ev);
+        }
+    }
 }
 
 
@@ -587,7 +748,7 @@ static void processObjEvent(
 static void telemetryTxTask(void *parameters)
 {
     channelContext *channel = (channelContext *)parameters;
-    UAVObjEvent ev;
+    uint8_t index;
 
     /* Check for a bad context */
     if (!channel) {
@@ -602,24 +763,24 @@ static void telemetryTxTask(void *parameters)
 
 #ifdef PIOS_TELEM_PRIORITY_QUEUE
         // empty priority queue, non-blocking
-        while (xQueueReceive(channel->priorityQueue, &ev, 0) == pdTRUE) {
+        while (xQueueReceive(channel->priorityQueue, &index, 0) == pdTRUE) {
             // Process event
-            processObjEvent(channel, &ev);
+            processPendingEvent(channel, index);
         }
         // check regular queue and process update - non-blocking
-        if (xQueueReceive(channel->queue, &ev, 0) == pdTRUE) {
+        if (xQueueReceive(channel->queue, &index, 0) == pdTRUE) {
             // Process event
-            processObjEvent(channel, &ev);
+            processPendingEvent(channel, index);
             // if both queues are empty, wait on priority queue for updates (1 tick) then repeat cycle
-        } else if (xQueueReceive(channel->priorityQueue, &ev, 1) == pdTRUE) {
+        } else if (xQueueReceive(channel->priorityQueue, &index, 1) == pdTRUE) {
             // Process event
-            processObjEvent(channel, &ev);
+            processPendingEvent(channel, index);
         }
 #else
         // wait on queue for updates (1 tick) then repeat cycle
-        if (xQueueReceive(channel->queue, &ev, 1) == pdTRUE) {
+        if (xQueueReceive(channel->queue, &index, 1) == pdTRUE) {
             // Process event
-            processObjEvent(channel, &ev);
+            processPendingEvent(channel, index);
         }
 #endif /* PIOS_TELEM_PRIORITY_QUEUE */
     }
@@ -747,16 +908,9 @@ static int32_t setUpdatePeriod(
     ev.event  = EV_UPDATED_PERIODIC;
     ev.lowPriority = true;
 
-#ifdef PIOS_TELEM_PRIORITY_QUEUE
-    xQueueHandle targetQueue = UAVObjIsPriority(obj) ? channel->priorityQueue :
-                               channel->queue;
-#else /* PIOS_TELEM_PRIORITY_QUEUE */
-    xQueueHandle targetQueue = channel->queue;
-#endif /* PIOS_TELEM_PRIORITY_QUEUE */
-
-    ret = EventPeriodicQueueUpdate(&ev, targetQueue, updatePeriodMs);
+    ret = EventPeriodicCallbackUpdate(&ev, channel->eventCallback, updatePeriodMs);
     if (ret == -1) {
-        ret = EventPeriodicQueueCreate(&ev, targetQueue, updatePeriodMs);
+        ret = EventPeriodicCallbackCreate(&ev, channel->eventCallback, updatePeriodMs);
     }
     return ret;
 }
@@ -783,16 +937,9 @@ static int32_t setLoggingPeriod(
     ev.event  = EV_LOGGING_PERIODIC;
     ev.lowPriority = true;
 
-#ifdef PIOS_TELEM_PRIORITY_QUEUE
-    xQueueHandle targetQueue = UAVObjIsPriority(obj) ? channel->priorityQueue :
-                               channel->queue;
-#else /* PIOS_TELEM_PRIORITY_QUEUE */
-    xQueueHandle targetQueue = channel->queue;
-#endif /* PIOS_TELEM_PRIORITY_QUEUE */
-
-    ret = EventPeriodicQueueUpdate(&ev, targetQueue, updatePeriodMs);
+    ret = EventPeriodicCallbackUpdate(&ev, channel->eventCallback, updatePeriodMs);
     if (ret == -1) {
-        ret = EventPeriodicQueueCreate(&ev, targetQueue, updatePeriodMs);
+        ret = EventPeriodicCallbackCreate(&ev, channel->eventCallback, updatePeriodMs);
     }
     return ret;
 }
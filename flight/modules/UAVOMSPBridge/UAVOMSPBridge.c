@@ -66,6 +66,7 @@
 #include "magstate.h"
 
 #include "pios_sensors.h"
+#include "msp_protocol.h"
 
 
 #define PIOS_INCLUDE_MSP_BRIDGE
@@ -173,25 +174,6 @@ static const uint8_t msp_boxes[] = {
     [MSP_STATUS_ICON_ACROPLUS] = MSP_BOX_ID_ACROPLUS,
 };
 
-typedef enum {
-    MSP_IDLE,
-    MSP_HEADER_START,
-    MSP_HEADER_M,
-    MSP_HEADER_SIZE,
-    MSP_HEADER_CMD,
-    MSP_FILLBUF,
-    MSP_CHECKSUM,
-    MSP_DISCARD,
-    MSP_MAYBE_UAVTALK2,
-    MSP_MAYBE_UAVTALK3,
-    MSP_MAYBE_UAVTALK4,
-    MSP_MAYBE_UAVTALK_SLOW2,
-    MSP_MAYBE_UAVTALK_SLOW3,
-    MSP_MAYBE_UAVTALK_SLOW4,
-    MSP_MAYBE_UAVTALK_SLOW5,
-    MSP_MAYBE_UAVTALK_SLOW6
-} msp_state;
-
 
 typedef struct __attribute__((packed)) {
     uint8_t values[3];
@@ -234,16 +216,7 @@ struct msp_bridge {
 
     UAVObjHandle current_pid_bank;
 
-    msp_state    state;
-    uint8_t      cmd_size;
-    uint8_t      cmd_id;
-    uint8_t      cmd_i;
-    uint8_t      checksum;
-    union {
-        uint8_t   data[0];
-        // Specific packed data structures go here.
-        msp_pid_t piditems[PID_ITEM_COUNT];
-    } cmd_data;
+    struct msp_protocol protocol;
 };
 
 #if defined(PIOS_MSP_STACK_SIZE)
@@ -255,6 +228,8 @@ struct msp_bridge {
 
 #define MAX_ALARM_LEN        30
 
+#define RX_BUF_LEN           16
+
 #define BOOT_DISPLAY_TIME_MS (10 * 1000)
 
 static bool module_enabled = false;
@@ -262,62 +237,14 @@ static struct msp_bridge *msp;
 static int32_t uavoMSPBridgeInitialize(void);
 static void uavoMSPBridgeTask(void *parameters);
 
-static void msp_send(struct msp_bridge *m, uint8_t cmd, const uint8_t *data, size_t len)
+static void msp_send(void *context, const uint8_t *frame, uint16_t len)
 {
-    uint8_t buf[5];
-    uint8_t cs = (uint8_t)(len) ^ cmd;
-
-    buf[0] = '$';
-    buf[1] = 'M';
-    buf[2] = '>';
-    buf[3] = (uint8_t)(len);
-    buf[4] = cmd;
-
-    PIOS_COM_SendBuffer(m->com, buf, sizeof(buf));
-
-    if (len > 0) {
-        PIOS_COM_SendBuffer(m->com, data, len);
-
-        for (unsigned i = 0; i < len; i++) {
-            cs ^= data[i];
-        }
-    }
-
-    cs    ^= 0;
-
-    buf[0] = cs;
-    PIOS_COM_SendBuffer(m->com, buf, 1);
-}
-
-static msp_state msp_state_size(struct msp_bridge *m, uint8_t b)
-{
-    m->cmd_size = b;
-    m->checksum = b;
-    return MSP_HEADER_CMD;
-}
-
-static msp_state msp_state_cmd(struct msp_bridge *m, uint8_t b)
-{
-    m->cmd_i     = 0;
-    m->cmd_id    = b;
-    m->checksum ^= m->cmd_id;
-
-    if (m->cmd_size > sizeof(m->cmd_data)) {
-        // Too large a body.  Let's ignore it.
-        return MSP_DISCARD;
-    }
-
-    return m->cmd_size == 0 ? MSP_CHECKSUM : MSP_FILLBUF;
-}
+    struct msp_bridge *m = (struct msp_bridge *)context;
 
-static msp_state msp_state_fill_buf(struct msp_bridge *m, uint8_t b)
-{
-    m->cmd_data.data[m->cmd_i++] = b;
-    m->checksum ^= b;
-    return m->cmd_i == m->cmd_size ? MSP_CHECKSUM : MSP_FILLBUF;
+    PIOS_COM_SendBuffer(m->com, frame, len);
 }
 
-static void msp_send_attitude(struct msp_bridge *m)
+static int16_t msp_encode_attitude(__attribute__((unused)) void *context, uint8_t *buf)
 {
     union {
         uint8_t buf[0];
@@ -337,13 +264,16 @@ static void msp_send_attitude(struct msp_bridge *m)
     // Yaw is just -180 -> 180
     data.att.h = attState.Yaw;
 
-    msp_send(m, MSP_ATTITUDE, data.buf, sizeof(data));
+    memcpy(buf, data.buf, sizeof(data));
+    return sizeof(data);
 }
 
 #define IS_STAB_MODE(d, m) (((d).Roll == (m)) && ((d).Pitch == (m)))
 
-static void msp_send_status(struct msp_bridge *m)
+static int16_t msp_encode_status(void *context, uint8_t *buf)
 {
+    struct msp_bridge *m = (struct msp_bridge *)context;
+
     union {
         uint8_t buf[0];
         struct {
@@ -436,10 +366,11 @@ static void msp_send_status(struct msp_bridge *m)
         data.status.flags |= (1 << MSP_STATUS_ICON_AIRMODE);
     }
 
-    msp_send(m, MSP_STATUS, data.buf, sizeof(data));
+    memcpy(buf, data.buf, sizeof(data));
+    return sizeof(data);
 }
 
-static void msp_send_analog(struct msp_bridge *m)
+static int16_t msp_encode_analog(__attribute__((unused)) void *context, uint8_t *buf)
 {
     union {
         uint8_t buf[0];
@@ -455,6 +386,7 @@ static void msp_send_analog(struct msp_bridge *m)
 
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
     if (FlightBatteryStateHandle() != NULL) {
+        struct msp_bridge *m = (struct msp_bridge *)context;
         FlightBatteryStateData batState;
         FlightBatteryStateGet(&batState);
 
@@ -502,10 +434,11 @@ static void msp_send_analog(struct msp_bridge *m)
         data.status.rssi = 1023;
     }
 
-    msp_send(m, MSP_ANALOG, data.buf, sizeof(data));
+    memcpy(buf, data.buf, sizeof(data));
+    return sizeof(data);
 }
 
-static void msp_send_raw_gps(struct msp_bridge *m)
+static int16_t msp_encode_raw_gps(__attribute__((unused)) void *context, uint8_t *buf)
 {
     union {
         uint8_t buf[0];
@@ -533,8 +466,11 @@ static void msp_send_raw_gps(struct msp_bridge *m)
         data.raw_gps.speed   = (uint16_t)gps_data.Groundspeed;
         data.raw_gps.ground_course = (int16_t)(gps_data.Heading * 10.0f);
 
-        msp_send(m, MSP_RAW_GPS, data.buf, sizeof(data));
+        memcpy(buf, data.buf, sizeof(data));
+        return sizeof(data);
     }
+
+    return -1;
 }
 
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
@@ -544,7 +480,7 @@ static inline float Sq(float x)
     return x * x;
 }
 
-static void msp_send_comp_gps(struct msp_bridge *m)
+static int16_t msp_encode_comp_gps(__attribute__((unused)) void *context, uint8_t *buf)
 {
     union {
         uint8_t buf[0];
@@ -577,10 +513,11 @@ static void msp_send_comp_gps(struct msp_bridge *m)
     // here, CC3D implementation could use raw gps data (GPSPositionSensorData) and locally cached GPSPositionSensorData at arming time as TakeOffLocation.
 
 
-    msp_send(m, MSP_COMP_GPS, data.buf, sizeof(data));
+    memcpy(buf, data.buf, sizeof(data));
+    return sizeof(data);
 }
 
-static void msp_send_altitude(struct msp_bridge *m)
+static int16_t msp_encode_altitude(__attribute__((unused)) void *context, uint8_t *buf)
 {
     union {
         uint8_t buf[0];
@@ -609,7 +546,8 @@ static void msp_send_altitude(struct msp_bridge *m)
         data.altitude.vario = 0;
     }
 
-    msp_send(m, MSP_ALTITUDE, data.buf, sizeof(data));
+    memcpy(buf, data.buf, sizeof(data));
+    return sizeof(data);
 }
 #endif /* PIOS_EXCLUDE_ADVANCED_FEATURES */
 
@@ -632,7 +570,7 @@ static uint16_t msp_scale_rc_thr(float percent)
 }
 
 // MSP RC order is Roll/Pitch/Yaw/Throttle/AUX1/AUX2/AUX3/AUX4
-static void msp_send_channels(struct msp_bridge *m)
+static int16_t msp_encode_channels(__attribute__((unused)) void *context, uint8_t *buf)
 {
     AccessoryDesiredData acc0, acc1, acc2, acc3;
     ManualControlCommandData manualState;
@@ -659,17 +597,20 @@ static void msp_send_channels(struct msp_bridge *m)
         }
     };
 
-    msp_send(m, MSP_RC, data.buf, sizeof(data));
+    memcpy(buf, data.buf, sizeof(data));
+    return sizeof(data);
 }
 
-static void msp_send_boxids(struct msp_bridge *m) // This is actually sending a map of MSP_STATUS.flag bits to BOX ids.
+static int16_t msp_encode_boxids(__attribute__((unused)) void *context, uint8_t *buf) // This is actually sending a map of MSP_STATUS.flag bits to BOX ids.
 {
-    msp_send(m, MSP_BOXIDS, msp_boxes, sizeof(msp_boxes));
+    memcpy(buf, msp_boxes, sizeof(msp_boxes));
+    return sizeof(msp_boxes);
 }
 
-static void msp_send_pidnames(struct msp_bridge *m)
+static int16_t msp_encode_pidnames(__attribute__((unused)) void *context, uint8_t *buf)
 {
-    msp_send(m, MSP_PIDNAMES, (const uint8_t *)msp_pidnames, sizeof(msp_pidnames) - 1); // without terminating 0
+    memcpy(buf, msp_pidnames, sizeof(msp_pidnames) - 1); // without terminating 0
+    return sizeof(msp_pidnames) - 1;
 }
 
 static void pid_native2msp(const float *native, msp_pid_t *piditem, float scale, unsigned numelem)
@@ -713,8 +654,10 @@ static UAVObjHandle get_current_pid_bank_handle()
     return 0;
 }
 
-static void msp_send_pid(struct msp_bridge *m)
+static int16_t msp_encode_pid(void *context, uint8_t *buf)
 {
+    struct msp_bridge *m = (struct msp_bridge *)context;
+
     m->current_pid_bank = get_current_pid_bank_handle();
 
     StabilizationBankData bankData;
@@ -732,25 +675,32 @@ static void msp_send_pid(struct msp_bridge *m)
     pid_native2msp((float *)&bankData.PitchPI, &piditems[PIDAPITCH], 10, 2);
     pid_native2msp((float *)&bankData.YawPI, &piditems[PIDAYAW], 10, 2);
 
-    msp_send(m, MSP_PID, (const uint8_t *)piditems, sizeof(piditems));
+    memcpy(buf, piditems, sizeof(piditems));
+    return sizeof(piditems);
 }
 
-static void msp_set_pid(struct msp_bridge *m)
+static bool msp_set_pid(void *context, const uint8_t *data, uint8_t len)
 {
+    struct msp_bridge *m = (struct msp_bridge *)context;
+    msp_pid_t piditems[PID_ITEM_COUNT];
+
     if (m->current_pid_bank == 0) {
-        return;
+        return false;
     }
 
+    memset(piditems, 0, sizeof(piditems));
+    memcpy(piditems, data, len < sizeof(piditems) ? len : sizeof(piditems));
+
     StabilizationBankData bankData;
     UAVObjGetData(m->current_pid_bank, &bankData);
 
-    pid_msp2native(&m->cmd_data.piditems[PIDROLL], (float *)&bankData.RollRatePID, 10000, 3);
-    pid_msp2native(&m->cmd_data.piditems[PIDPITCH], (float *)&bankData.PitchRatePID, 10000, 3);
-    pid_msp2native(&m->cmd_data.piditems[PIDYAW], (float *)&bankData.YawRatePID, 10000, 3);
+    pid_msp2native(&piditems[PIDROLL], (float *)&bankData.RollRatePID, 10000, 3);
+    pid_msp2native(&piditems[PIDPITCH], (float *)&bankData.PitchRatePID, 10000, 3);
+    pid_msp2native(&piditems[PIDYAW], (float *)&bankData.YawRatePID, 10000, 3);
 
-    pid_msp2native(&m->cmd_data.piditems[PIDAROLL], (float *)&bankData.RollPI, 10, 2);
-    pid_msp2native(&m->cmd_data.piditems[PIDAPITCH], (float *)&bankData.PitchPI, 10, 2);
-    pid_msp2native(&m->cmd_data.piditems[PIDAYAW], (float *)&bankData.YawPI, 10, 2);
+    pid_msp2native(&piditems[PIDAROLL], (float *)&bankData.RollPI, 10, 2);
+    pid_msp2native(&piditems[PIDAPITCH], (float *)&bankData.PitchPI, 10, 2);
+    pid_msp2native(&piditems[PIDAYAW], (float *)&bankData.YawPI, 10, 2);
 
     UAVObjSetData(m->current_pid_bank, &bankData);
 
@@ -765,7 +715,7 @@ static void msp_set_pid(struct msp_bridge *m)
         }
     }
 
-    msp_send(m, MSP_SET_PID, 0, 0); // send ack.
+    return true; // send ack.
 }
 
 #define ALARM_OK    0
@@ -775,7 +725,7 @@ static void msp_set_pid(struct msp_bridge *m)
 
 #define MS2TICKS(m) ((m) / (portTICK_RATE_MS))
 
-static void msp_send_alarms(__attribute__((unused)) struct msp_bridge *m)
+static int16_t msp_encode_alarms(__attribute__((unused)) void *context, uint8_t *buf)
 {
     union {
         uint8_t buf[0];
@@ -796,8 +746,8 @@ static void msp_send_alarms(__attribute__((unused)) struct msp_bridge *m)
         const char *boot_reason = AlarmBootReason(alarm.RebootCause);
         strncpy((char *)data.alarm.msg, boot_reason, MAX_ALARM_LEN);
         data.alarm.msg[MAX_ALARM_LEN - 1] = '\0';
-        msp_send(m, MSP_ALARMS, data.buf, strlen((char *)data.alarm.msg) + 1);
-        return;
+        memcpy(buf, data.buf, strlen((char *)data.alarm.msg) + 1);
+        return strlen((char *)data.alarm.msg) + 1;
     }
 #endif
 
@@ -823,151 +773,28 @@ static void msp_send_alarms(__attribute__((unused)) struct msp_bridge *m)
         break;
     }
 
-    msp_send(m, MSP_ALARMS, data.buf, len + 1);
+    memcpy(buf, data.buf, len + 1);
+    return len + 1;
 }
 
-static msp_state msp_state_checksum(struct msp_bridge *m, uint8_t b)
-{
-    if ((m->checksum ^ b) != 0) {
-        return MSP_IDLE;
-    }
-
-    // Respond to interesting things.
-    switch (m->cmd_id) {
-    case MSP_RAW_GPS:
-        msp_send_raw_gps(m);
-        break;
+// Replies are cached for period_ms, the OSD may poll much faster than that.
+static const struct msp_message msp_messages[] = {
+    { .cmd = MSP_RAW_GPS,   .max_len = 16, .period_ms = 200, .encode = msp_encode_raw_gps   },
 #ifndef PIOS_EXCLUDE_ADVANCED_FEATURES
-    case MSP_COMP_GPS:
-        msp_send_comp_gps(m);
-        break;
-    case MSP_ALTITUDE:
-        msp_send_altitude(m);
-        break;
+    { .cmd = MSP_COMP_GPS,  .max_len = 5,  .period_ms = 200, .encode = msp_encode_comp_gps  },
+    { .cmd = MSP_ALTITUDE,  .max_len = 6,  .period_ms = 50,  .encode = msp_encode_altitude  },
 #endif /* PIOS_EXCLUDE_ADVANCED_FEATURES */
-    case MSP_ATTITUDE:
-        msp_send_attitude(m);
-        break;
-    case MSP_STATUS:
-        msp_send_status(m);
-        break;
-    case MSP_ANALOG:
-        msp_send_analog(m);
-        break;
-    case MSP_RC:
-        msp_send_channels(m);
-        break;
-    case MSP_BOXIDS:
-        msp_send_boxids(m);
-        break;
-    case MSP_ALARMS:
-        msp_send_alarms(m);
-        break;
-    case MSP_PID:
-        msp_send_pid(m);
-        break;
-    case MSP_SET_PID:
-        msp_set_pid(m);
-        break;
-    case MSP_PIDNAMES:
-        msp_send_pidnames(m);
-        break;
-    }
-
-    return MSP_IDLE;
-}
-
-static msp_state msp_state_discard(struct msp_bridge *m, __attribute__((unused)) uint8_t b)
-{
-    return m->cmd_i++ == m->cmd_size ? MSP_IDLE : MSP_DISCARD;
-}
-
-/**
- * Process incoming bytes from an MSP query thing.
- * @param[in] b received byte
- * @return true if we should continue processing bytes
- */
-static bool msp_receive_byte(struct msp_bridge *m, uint8_t b)
-{
-    switch (m->state) {
-    case MSP_IDLE:
-        switch (b) {
-        case 0xe0: // uavtalk matching first part of 0x3c @ 57600 baud
-            m->state = MSP_MAYBE_UAVTALK_SLOW2;
-            break;
-        case '<': // uavtalk matching with 0x3c 0x2x 0xxx 0x0x
-            m->state = MSP_MAYBE_UAVTALK2;
-            break;
-        case '$':
-            m->state = MSP_HEADER_START;
-            break;
-        default:
-            m->state = MSP_IDLE;
-        }
-        break;
-    case MSP_HEADER_START:
-        m->state = b == 'M' ? MSP_HEADER_M : MSP_IDLE;
-        break;
-    case MSP_HEADER_M:
-        m->state = b == '<' ? MSP_HEADER_SIZE : MSP_IDLE;
-        break;
-    case MSP_HEADER_SIZE:
-        m->state = msp_state_size(m, b);
-        break;
-    case MSP_HEADER_CMD:
-        m->state = msp_state_cmd(m, b);
-        break;
-    case MSP_FILLBUF:
-        m->state = msp_state_fill_buf(m, b);
-        break;
-    case MSP_CHECKSUM:
-        m->state = msp_state_checksum(m, b);
-        break;
-    case MSP_DISCARD:
-        m->state = msp_state_discard(m, b);
-        break;
-    case MSP_MAYBE_UAVTALK2:
-        // e.g. 3c 20 1d 00
-        // second possible uavtalk byte
-        m->state = (b & 0xf0) == 0x20 ? MSP_MAYBE_UAVTALK3 : MSP_IDLE;
-        break;
-    case MSP_MAYBE_UAVTALK3:
-        // third possible uavtalk byte can be anything
-        m->state = MSP_MAYBE_UAVTALK4;
-        break;
-    case MSP_MAYBE_UAVTALK4:
-        m->state = MSP_IDLE;
-        // If this looks like the fourth possible uavtalk byte, we're done
-        if ((b & 0xf0) == 0) {
-            PIOS_COM_TELEM_RF = m->com;
-            return false;
-        }
-        break;
-    case MSP_MAYBE_UAVTALK_SLOW2:
-        m->state = b == 0x18 ? MSP_MAYBE_UAVTALK_SLOW3 : MSP_IDLE;
-        break;
-    case MSP_MAYBE_UAVTALK_SLOW3:
-        m->state = b == 0x98 ? MSP_MAYBE_UAVTALK_SLOW4 : MSP_IDLE;
-        break;
-    case MSP_MAYBE_UAVTALK_SLOW4:
-        m->state = b == 0x7e ? MSP_MAYBE_UAVTALK_SLOW5 : MSP_IDLE;
-        break;
-    case MSP_MAYBE_UAVTALK_SLOW5:
-        m->state = b == 0x00 ? MSP_MAYBE_UAVTALK_SLOW6 : MSP_IDLE;
-        break;
-    case MSP_MAYBE_UAVTALK_SLOW6:
-        m->state = MSP_IDLE;
-        // If this looks like the sixth possible 57600 baud uavtalk byte, we're done
-        if (b == 0x60) {
-            PIOS_COM_ChangeBaud(m->com, 57600);
-            PIOS_COM_TELEM_RF = m->com;
-            return false;
-        }
-        break;
-    }
-
-    return true;
-}
+    { .cmd = MSP_ATTITUDE,  .max_len = 6,  .period_ms = 20,  .encode = msp_encode_attitude  },
+    { .cmd = MSP_STATUS,    .max_len = 11, .period_ms = 100, .encode = msp_encode_status    },
+    { .cmd = MSP_ANALOG,    .max_len = 7,  .period_ms = 100, .encode = msp_encode_analog    },
+    { .cmd = MSP_RC,        .max_len = 16, .period_ms = 50,  .encode = msp_encode_channels  },
+    { .cmd = MSP_BOXIDS,    .max_len = sizeof(msp_boxes), .period_ms = MSP_NO_CACHE, .encode = msp_encode_boxids },
+    { .cmd = MSP_ALARMS,    .max_len = MAX_ALARM_LEN + 1, .period_ms = 500, .encode = msp_encode_alarms },
+    // also selects the bank MSP_SET_PID writes to, so it is never cached
+    { .cmd = MSP_PID,       .max_len = PID_ITEM_COUNT * sizeof(msp_pid_t), .period_ms = MSP_NO_CACHE, .encode = msp_encode_pid },
+    { .cmd = MSP_SET_PID,   .handle  = msp_set_pid },
+    { .cmd = MSP_PIDNAMES,  .max_len = sizeof(msp_pidnames) - 1, .period_ms = MSP_NO_CACHE, .encode = msp_encode_pidnames },
+};
 
 /**
  * Module start routine automatically called after initialization routine
@@ -1034,6 +861,12 @@ static int32_t uavoMSPBridgeInitialize(void)
 
             msp->com = pios_com_msp_id;
 
+            if (msp_protocol_init(&msp->protocol, msp_messages, NELEMENTS(msp_messages), msp_send, msp) < 0) {
+                pios_free(msp);
+                msp = NULL;
+                return -1;
+            }
+
             // now figure out enabled features: registered sensors, ADC routing, GPS
 
 #ifdef PIOS_EXCLUDE_ADVANCED_FEATURES
@@ -1095,10 +928,19 @@ MODULE_INITCALL(uavoMSPBridgeInitialize, uavoMSPBridgeStart);
 static void uavoMSPBridgeTask(__attribute__((unused)) void *parameters)
 {
     while (1) {
-        uint8_t b = 0;
-        uint16_t count = PIOS_COM_ReceiveBuffer(msp->com, &b, 1, ~0);
+        uint8_t b[RX_BUF_LEN];
+        // Until the peer is known to speak MSP, read one byte at a time.
+        // UAVTalk detection then stops reading at the detection byte, and
+        // the telemetry link receives the bytes that follow it.
+        uint16_t count = PIOS_COM_ReceiveBuffer(msp->com, b, msp->protocol.confirmed ? sizeof(b) : 1, ~0);
         if (count) {
-            if (!msp_receive_byte(msp, b)) {
+            msp_result_t result = msp_protocol_receive(&msp->protocol, b, count, xTaskGetTickCount() * portTICK_RATE_MS);
+            if (result != MSP_RESULT_CONTINUE) {
+                if (result == MSP_RESULT_UAVTALK_57600) {
+                    PIOS_COM_ChangeBaud(msp->com, 57600);
+                }
+                PIOS_COM_TELEM_RF = msp->com;
+
                 // Returning is considered risky here as
                 // that's unusual and this is an edge case.
                 while (1) {
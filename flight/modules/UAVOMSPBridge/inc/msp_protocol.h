@@ -0,0 +1,130 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup UAVOMSPBridge UAVO to MSP Bridge Module
+ * @{
+ *
+ * @file       msp_protocol.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      MSP framing and reply scheduling, independent of the UAVObjects
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef MSP_PROTOCOL_H
+#define MSP_PROTOCOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Largest command body we accept, MSP_SET_PID
+#define MSP_CMD_BUF_LEN   30
+// Largest reply body, MSP_PIDNAMES
+#define MSP_MAX_REPLY_LEN 64
+
+// Refresh period of replies that are encoded on every request
+#define MSP_NO_CACHE      0
+
+/**
+ * Encodes the body of a reply.
+ * @param[in] context the context given to msp_protocol_init()
+ * @param[out] buf room for max_len bytes
+ * @return length of the body, or < 0 when there is nothing to reply
+ */
+typedef int16_t (*msp_encoder_t)(void *context, uint8_t *buf);
+
+/**
+ * Handles a command that carries a body.
+ * @param[in] context the context given to msp_protocol_init()
+ * @param[in] data body of the command
+ * @param[in] len length of the body
+ * @return true to acknowledge the command with an empty reply
+ */
+typedef bool (*msp_handler_t)(void *context, const uint8_t *data, uint8_t len);
+
+/**
+ * Transmits a complete frame.
+ */
+typedef void (*msp_send_t)(void *context, const uint8_t *frame, uint16_t len);
+
+/**
+ * One entry of the message table. Requests are answered from a cached copy
+ * of the encoded reply, which is refreshed when it is older than period_ms,
+ * so an OSD polling faster than that costs a copy instead of several
+ * UAVObject reads.
+ */
+struct msp_message {
+    uint8_t       cmd;
+    uint8_t       max_len; // largest body the encoder writes
+    uint16_t      period_ms; // MSP_NO_CACHE to encode on every request
+    msp_encoder_t encode;
+    msp_handler_t handle;
+};
+
+typedef enum {
+    MSP_RESULT_CONTINUE,
+    MSP_RESULT_UAVTALK, // UAVTalk was seen at the current baud rate
+    MSP_RESULT_UAVTALK_57600, // UAVTalk at 57600 baud was seen
+} msp_result_t;
+
+struct msp_cache;
+
+struct msp_protocol {
+    const struct msp_message *messages;
+    uint8_t    num_messages;
+    struct msp_cache *cache;
+
+    msp_send_t send;
+    void      *context;
+
+    bool       confirmed; // a request with a valid checksum was received
+    uint8_t    state;
+    uint8_t    cmd_size;
+    uint8_t    cmd_id;
+    uint8_t    cmd_i;
+    uint8_t    checksum;
+    uint8_t    cmd_data[MSP_CMD_BUF_LEN];
+};
+
+/**
+ * Prepare the protocol state and allocate the reply cache.
+ * @return 0 on success, -1 when the cache could not be allocated
+ */
+int32_t msp_protocol_init(struct msp_protocol *p, const struct msp_message *messages, uint8_t num_messages, msp_send_t send, void *context);
+
+/**
+ * Parse received bytes and answer the complete requests.
+ * @param[in] now_ms current time, to age the cached replies
+ * @return MSP_RESULT_CONTINUE, or the UAVTalk result that ends the bridge;
+ *         bytes following the UAVTalk start are not parsed
+ */
+msp_result_t msp_protocol_receive(struct msp_protocol *p, const uint8_t *buf, uint16_t len, uint32_t now_ms);
+
+/**
+ * Drop all cached replies, e.g. after a command changed what they show.
+ */
+void msp_protocol_invalidate(struct msp_protocol *p);
+
+#endif /* MSP_PROTOCOL_H */
+
+/**
+ * @}
+ * @}
+ */
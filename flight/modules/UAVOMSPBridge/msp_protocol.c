@@ -0,0 +1,318 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup UAVOMSPBridge UAVO to MSP Bridge Module
+ * @{
+ *
+ * @file       msp_protocol.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ *             Tau Labs, http://taulabs.org, Copyright (C) 2015
+ *             dRonin, http://dronin.org Copyright (C) 2015-2016
+ * @brief      MSP framing and reply scheduling, independent of the UAVObjects
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "openpilot.h"
+#include "msp_protocol.h"
+
+#include <string.h>
+
+#define MSP_HEADER_LEN 5
+
+typedef enum {
+    MSP_IDLE,
+    MSP_HEADER_START,
+    MSP_HEADER_M,
+    MSP_HEADER_SIZE,
+    MSP_HEADER_CMD,
+    MSP_FILLBUF,
+    MSP_CHECKSUM,
+    MSP_DISCARD,
+    MSP_MAYBE_UAVTALK2,
+    MSP_MAYBE_UAVTALK3,
+    MSP_MAYBE_UAVTALK4,
+    MSP_MAYBE_UAVTALK_SLOW2,
+    MSP_MAYBE_UAVTALK_SLOW3,
+    MSP_MAYBE_UAVTALK_SLOW4,
+    MSP_MAYBE_UAVTALK_SLOW5,
+    MSP_MAYBE_UAVTALK_SLOW6
+} msp_state;
+
+struct msp_cache {
+    uint8_t *data; // NULL for MSP_NO_CACHE messages
+    uint32_t refreshed_ms;
+    int16_t  len;
+    bool     valid;
+};
+
+int32_t msp_protocol_init(struct msp_protocol *p, const struct msp_message *messages, uint8_t num_messages, msp_send_t send, void *context)
+{
+    uint16_t cache_len = 0;
+
+    for (uint8_t i = 0; i < num_messages; i++) {
+        PIOS_Assert(messages[i].max_len <= MSP_MAX_REPLY_LEN);
+        if (messages[i].encode && messages[i].period_ms != MSP_NO_CACHE) {
+            cache_len += messages[i].max_len;
+        }
+    }
+
+    // One block for the cache entries followed by the cached bodies
+    uint8_t *block = pios_malloc(num_messages * sizeof(struct msp_cache) + cache_len);
+    if (!block) {
+        return -1;
+    }
+
+    memset(p, 0, sizeof(*p));
+    p->messages     = messages;
+    p->num_messages = num_messages;
+    p->cache        = (struct msp_cache *)block;
+    p->send         = send;
+    p->context      = context;
+    p->state        = MSP_IDLE;
+
+    uint8_t *data   = block + num_messages * sizeof(struct msp_cache);
+    for (uint8_t i = 0; i < num_messages; i++) {
+        p->cache[i].valid = false;
+        if (messages[i].encode && messages[i].period_ms != MSP_NO_CACHE) {
+            p->cache[i].data = data;
+            data += messages[i].max_len;
+        } else {
+            p->cache[i].data = NULL;
+        }
+    }
+
+    return 0;
+}
+
+void msp_protocol_invalidate(struct msp_protocol *p)
+{
+    for (uint8_t i = 0; i < p->num_messages; i++) {
+        p->cache[i].valid = false;
+    }
+}
+
+static void msp_send(struct msp_protocol *p, uint8_t cmd, uint8_t *frame, uint8_t len)
+{
+    uint8_t cs = len ^ cmd;
+
+    frame[0] = '$';
+    frame[1] = 'M';
+    frame[2] = '>';
+    frame[3] = len;
+    frame[4] = cmd;
+
+    for (unsigned i = 0; i < len; i++) {
+        cs ^= frame[MSP_HEADER_LEN + i];
+    }
+    frame[MSP_HEADER_LEN + len] = cs;
+
+    p->send(p->context, frame, MSP_HEADER_LEN + len + 1);
+}
+
+static void msp_reply(struct msp_protocol *p, uint32_t now_ms)
+{
+    uint8_t frame[MSP_HEADER_LEN + MSP_MAX_REPLY_LEN + 1];
+    uint8_t i;
+
+    for (i = 0; i < p->num_messages && p->messages[i].cmd != p->cmd_id; i++) {
+        ;
+    }
+    if (i == p->num_messages) {
+        return; // not interesting
+    }
+
+    const struct msp_message *msg = &p->messages[i];
+    struct msp_cache *cache = &p->cache[i];
+
+    if (msg->handle) {
+        bool ack = msg->handle(p->context, p->cmd_data, p->cmd_size);
+        // whatever the command changed may show in the replies
+        msp_protocol_invalidate(p);
+        if (ack) {
+            msp_send(p, msg->cmd, frame, 0);
+        }
+        return;
+    }
+
+    int16_t len;
+    if (!cache->data) {
+        len = msg->encode(p->context, frame + MSP_HEADER_LEN);
+    } else {
+        if (!cache->valid || (now_ms - cache->refreshed_ms) >= msg->period_ms) {
+            cache->len = msg->encode(p->context, cache->data);
+            cache->refreshed_ms = now_ms;
+            cache->valid = true;
+        }
+        len = cache->len;
+        if (len > 0) {
+            memcpy(frame + MSP_HEADER_LEN, cache->data, len);
+        }
+    }
+
+    if (len >= 0) {
+        PIOS_Assert(len <= msg->max_len);
+        msp_send(p, msg->cmd, frame, len);
+    }
+}
+
+static msp_state msp_state_size(struct msp_protocol *p, uint8_t b)
+{
+    p->cmd_size = b;
+    p->checksum = b;
+    return MSP_HEADER_CMD;
+}
+
+static msp_state msp_state_cmd(struct msp_protocol *p, uint8_t b)
+{
+    p->cmd_i     = 0;
+    p->cmd_id    = b;
+    p->checksum ^= p->cmd_id;
+
+    if (p->cmd_size > sizeof(p->cmd_data)) {
+        // Too large a body.  Let's ignore it.
+        return MSP_DISCARD;
+    }
+
+    return p->cmd_size == 0 ? MSP_CHECKSUM : MSP_FILLBUF;
+}
+
+static msp_state msp_state_fill_buf(struct msp_protocol *p, uint8_t b)
+{
+    p->cmd_data[p->cmd_i++] = b;
+    p->checksum ^= b;
+    return p->cmd_i == p->cmd_size ? MSP_CHECKSUM : MSP_FILLBUF;
+}
+
+static msp_state msp_state_checksum(struct msp_protocol *p, uint8_t b, uint32_t now_ms)
+{
+    if ((p->checksum ^ b) == 0) {
+        p->confirmed = true;
+        msp_reply(p, now_ms);
+    }
+
+    return MSP_IDLE;
+}
+
+static msp_state msp_state_discard(struct msp_protocol *p, __attribute__((unused)) uint8_t b)
+{
+    return p->cmd_i++ == p->cmd_size ? MSP_IDLE : MSP_DISCARD;
+}
+
+/**
+ * Process one byte of an MSP query thing.
+ * @param[in] b received byte
+ * @return MSP_RESULT_CONTINUE if we should continue processing bytes
+ */
+static msp_result_t msp_receive_byte(struct msp_protocol *p, uint8_t b, uint32_t now_ms)
+{
+    switch (p->state) {
+    case MSP_IDLE:
+        switch (b) {
+        case 0xe0: // uavtalk matching first part of 0x3c @ 57600 baud
+            p->state = MSP_MAYBE_UAVTALK_SLOW2;
+            break;
+        case '<': // uavtalk matching with 0x3c 0x2x 0xxx 0x0x
+            p->state = MSP_MAYBE_UAVTALK2;
+            break;
+        case '$':
+            p->state = MSP_HEADER_START;
+            break;
+        default:
+            p->state = MSP_IDLE;
+        }
+        break;
+    case MSP_HEADER_START:
+        p->state = b == 'M' ? MSP_HEADER_M : MSP_IDLE;
+        break;
+    case MSP_HEADER_M:
+        p->state = b == '<' ? MSP_HEADER_SIZE : MSP_IDLE;
+        break;
+    case MSP_HEADER_SIZE:
+        p->state = msp_state_size(p, b);
+        break;
+    case MSP_HEADER_CMD:
+        p->state = msp_state_cmd(p, b);
+        break;
+    case MSP_FILLBUF:
+        p->state = msp_state_fill_buf(p, b);
+        break;
+    case MSP_CHECKSUM:
+        p->state = msp_state_checksum(p, b, now_ms);
+        break;
+    case MSP_DISCARD:
+        p->state = msp_state_discard(p, b);
+        break;
+    case MSP_MAYBE_UAVTALK2:
+        // e.g. 3c 20 1d 00
+        // second possible uavtalk byte
+        p->state = (b & 0xf0) == 0x20 ? MSP_MAYBE_UAVTALK3 : MSP_IDLE;
+        break;
+    case MSP_MAYBE_UAVTALK3:
+        // third possible uavtalk byte can be anything
+        p->state = MSP_MAYBE_UAVTALK4;
+        break;
+    case MSP_MAYBE_UAVTALK4:
+        p->state = MSP_IDLE;
+        // If this looks like the fourth possible uavtalk byte, we're done
+        if ((b & 0xf0) == 0) {
+            return MSP_RESULT_UAVTALK;
+        }
+        break;
+    case MSP_MAYBE_UAVTALK_SLOW2:
+        p->state = b == 0x18 ? MSP_MAYBE_UAVTALK_SLOW3 : MSP_IDLE;
+        break;
+    case MSP_MAYBE_UAVTALK_SLOW3:
+        p->state = b == 0x98 ? MSP_MAYBE_UAVTALK_SLOW4 : MSP_IDLE;
+        break;
+    case MSP_MAYBE_UAVTALK_SLOW4:
+        p->state = b == 0x7e ? MSP_MAYBE_UAVTALK_SLOW5 : MSP_IDLE;
+        break;
+    case MSP_MAYBE_UAVTALK_SLOW5:
+        p->state = b == 0x00 ? MSP_MAYBE_UAVTALK_SLOW6 : MSP_IDLE;
+        break;
+    case MSP_MAYBE_UAVTALK_SLOW6:
+        p->state = MSP_IDLE;
+        // If this looks like the sixth possible 57600 baud uavtalk byte, we're done
+        if (b == 0x60) {
+            return MSP_RESULT_UAVTALK_57600;
+        }
+        break;
+    }
+
+    return MSP_RESULT_CONTINUE;
+}
+
+msp_result_t msp_protocol_receive(struct msp_protocol *p, const uint8_t *buf, uint16_t len, uint32_t now_ms)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        msp_result_t result = msp_receive_byte(p, buf[i], now_ms);
+        if (result != MSP_RESULT_CONTINUE) {
+            return result;
+        }
+    }
+
+    return MSP_RESULT_CONTINUE;
+}
+
+/**
+ * @}
+ * @}
+ */
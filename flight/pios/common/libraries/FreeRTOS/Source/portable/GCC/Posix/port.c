@@ -88,6 +88,15 @@ more accurate high frequency ticks than a timer signal handler.
 All public functions in this port are protected by a safeguard mutex which
 assures priority access on all data objects
 
+In lockstep mode (vPortSetLockstep) the tick does not follow the wall clock.
+The idle task advances it through vPortLockstepIdle() from the idle hook, so
+the tick moves on as soon as all other tasks are blocked and the firmware runs
+as if the CPU was infinitely fast. An optional gate function is called before
+each tick and can hold it back, which lets a simulator step its physics and
+the firmware in turn. The supervisor only ticks when a task keeps the idle
+task from running for portLOCKSTEP_STALL_US, as it would be preempted on the
+target.
+
 This approach is tested and works both on Linux and BSD style Unix (MAC OS X)
 
 */
@@ -110,6 +119,9 @@ This approach is tested and works both on Linux and BSD style Unix (MAC OS X)
 /*-----------------------------------------------------------*/
 
 #define MAX_NUMBER_OF_TASKS 		( _POSIX_THREAD_THREADS_MAX )
+
+/* Wall time after which a task that does not block gets the tick in lockstep mode */
+#define portLOCKSTEP_STALL_US		( 100000 )
 /*-----------------------------------------------------------*/
 
 #define PORT_PRINT(...) fprintf(stderr,__VA_ARGS__)
@@ -158,6 +170,10 @@ static volatile portBASE_TYPE xInterruptsEnabled = pdFALSE;
 static volatile portBASE_TYPE xSchedulerNesting = 0;
 static volatile portBASE_TYPE xPendYield = pdFALSE;
 static volatile portLONG lIndexOfLastAddedTask = 0;
+static volatile portBASE_TYPE xLockstep = pdFALSE;
+static volatile portBASE_TYPE xLockstepProgress = pdFALSE;
+static volatile portBASE_TYPE xLockstepInGate = pdFALSE;
+static pdLOCKSTEP_GATE pxLockstepGate = NULL;
 /*-----------------------------------------------------------*/
 
 /*
@@ -303,6 +319,20 @@ portBASE_TYPE xPortStartScheduler( void )
 	
 	while ( pdTRUE != xSchedulerEnd )
 	{
+		if ( pdTRUE == xLockstep )
+		{
+			wait.tv_sec = 0;
+			wait.tv_nsec = 1000 * portLOCKSTEP_STALL_US;
+			nanosleep( &wait, NULL );
+
+			if ( pdTRUE != xLockstepProgress && pdTRUE != xLockstepInGate )
+			{
+				vPortSystemTickHandler();
+			}
+			xLockstepProgress = pdFALSE;
+			continue;
+		}
+
 		/* wait for the specified wait time */
 		wait.tv_sec = sleepTimeUS / 1000000;
 		wait.tv_nsec = 1000 * ( sleepTimeUS % 1000000 );
@@ -346,6 +376,43 @@ portBASE_TYPE xPortStartScheduler( void )
 }
 /*-----------------------------------------------------------*/
 
+/**
+ * Switch the tick to lockstep simulated time, must be called before the
+ * scheduler is started. pxGate may be NULL to run as fast as possible.
+ */
+void vPortSetLockstep( pdLOCKSTEP_GATE pxGate )
+{
+	pxLockstepGate = pxGate;
+	xLockstep = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Advances the lockstep tick, called from the idle hook. The idle task only
+ * runs when all other tasks are blocked. With the scheduler suspended the
+ * tick is pended and xTaskResumeAll() delivers it, switching to the tasks it
+ * woke up.
+ */
+void vPortLockstepIdle( void )
+{
+	if ( pdTRUE != xLockstep )
+	{
+		return;
+	}
+
+	vTaskSuspendAll();
+	if ( pxLockstepGate )
+	{
+		xLockstepInGate = pdTRUE;
+		pxLockstepGate( xTaskGetTickCount() + 1 );
+		xLockstepInGate = pdFALSE;
+	}
+	xTaskIncrementTick();
+	xLockstepProgress = pdTRUE;
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
 /**
  * quickly clean up all running threads, without asking them first
  */
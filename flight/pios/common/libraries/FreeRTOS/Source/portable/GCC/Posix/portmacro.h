@@ -158,6 +158,12 @@ extern void vPortForciblyEndThread( void *pxTaskToDelete );
 extern void vPortAddTaskHandle( void *pxTaskHandle );
 #define traceTASK_CREATE( pxNewTCB )			vPortAddTaskHandle( pxNewTCB )
 
+/* Lockstep simulated time, the idle hook must call vPortLockstepIdle().
+The gate is called with the next tick count before each tick and may block. */
+typedef void ( *pdLOCKSTEP_GATE )( TickType_t xNextTick );
+extern void vPortSetLockstep( pdLOCKSTEP_GATE pxGate );
+extern void vPortLockstepIdle( void );
+
 /* Posix Signal definitions that can be changed or read as appropriate. */
 #define SIG_SUSPEND					SIGUSR1
 
@@ -620,6 +620,150 @@ check_again:
     return bytes_from_fifo;
 }
 
+/**
+ * Get a reference to the bytes held in the receive buffer of a port without
+ * copying them out. The bytes stay in the buffer, owned by the port, until
+ * they are released with PIOS_COM_ReceiveBufferRelease().
+ * \param[in] com_id COM port
+ * \param[out] buf oldest received byte
+ * \param[in] timeout_ms time to wait for data
+ * \returns number of bytes that can be read at *buf
+ */
+uint16_t PIOS_COM_ReceiveBufferRef(uint32_t com_id, const uint8_t **buf, uint32_t timeout_ms)
+{
+    PIOS_Assert(buf);
+    uint16_t bytes_in_fifo;
+
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    if (!PIOS_COM_validate(com_dev)) {
+        /* Undefined COM port for this board (see pios_board.c) */
+        PIOS_Assert(0);
+    }
+    PIOS_Assert(com_dev->has_rx);
+
+check_again:
+    bytes_in_fifo = fifoBuf_getDataRef(&com_dev->rx, buf);
+
+    if (bytes_in_fifo == 0) {
+        /* Make sure the receiver is running while we wait */
+        if (com_dev->driver->rx_start) {
+            (com_dev->driver->rx_start)(com_dev->lower_id,
+                                        fifoBuf_getFree(&com_dev->rx));
+        }
+        if (timeout_ms > 0) {
+#if defined(PIOS_INCLUDE_FREERTOS)
+            if (xSemaphoreTake(com_dev->rx_sem, timeout_ms / portTICK_RATE_MS) == pdTRUE) {
+                /* Make sure we don't come back here again */
+                timeout_ms = 0;
+                goto check_again;
+            }
+#else
+            PIOS_DELAY_WaitmS(1);
+            timeout_ms--;
+            goto check_again;
+#endif
+        }
+    }
+
+    return bytes_in_fifo;
+}
+
+/**
+ * Give bytes obtained with PIOS_COM_ReceiveBufferRef() back to the port
+ * \param[in] com_id COM port
+ * \param[in] len number of bytes consumed
+ */
+void PIOS_COM_ReceiveBufferRelease(uint32_t com_id, uint16_t len)
+{
+    struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+    if (!PIOS_COM_validate(com_dev)) {
+        /* Undefined COM port for this board (see pios_board.c) */
+        PIOS_Assert(0);
+    }
+    PIOS_Assert(com_dev->has_rx);
+
+    fifoBuf_removeData(&com_dev->rx, len);
+
+    if (com_dev->driver->rx_start) {
+        /* Notify the lower layer that there is now room in the rx buffer */
+        (com_dev->driver->rx_start)(com_dev->lower_id,
+                                    fifoBuf_getFree(&com_dev->rx));
+    }
+}
+
+/**
+ * Move the bytes received on a port straight into the transmit buffer of
+ * another port. Only what the transmit buffer can take is moved, the rest
+ * stays in the receive buffer for the next call, so a slow destination
+ * throttles the source instead of losing data.
+ * \param[in] rx_com_id source COM port
+ * \param[in] tx_com_id destination COM port
+ * \param[in] timeout_ms time to wait for room in the transmit buffer
+ * \return -1 if a port is not available
+ * \return -3 another thread is already sending on the destination
+ * \return number of bytes moved on success
+ */
+int32_t PIOS_COM_ForwardBuffer(uint32_t rx_com_id, uint32_t tx_com_id, uint32_t timeout_ms)
+{
+    struct pios_com_dev *rx_dev = (struct pios_com_dev *)rx_com_id;
+    struct pios_com_dev *tx_dev = (struct pios_com_dev *)tx_com_id;
+
+    if (!PIOS_COM_validate(rx_dev) || !PIOS_COM_validate(tx_dev)) {
+        /* Undefined COM port for this board (see pios_board.c) */
+        return -1;
+    }
+    PIOS_Assert(rx_dev->has_rx);
+    PIOS_Assert(tx_dev->has_tx);
+
+    const uint8_t *buf;
+    uint16_t len = fifoBuf_getDataRef(&rx_dev->rx, &buf);
+    if (len == 0) {
+        return 0;
+    }
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    if (xSemaphoreTake(tx_dev->sendbuffer_sem, timeout_ms / portTICK_RATE_MS) != pdTRUE) {
+        return -3;
+    }
+#endif /* PIOS_INCLUDE_FREERTOS */
+
+    int32_t moved = 0;
+check_again:
+    if (tx_dev->driver->available && !tx_dev->driver->available(tx_dev->lower_id)) {
+        /* Device is down, let the send function drop the data */
+        moved = PIOS_COM_SendBufferNonBlockingInternal(tx_dev, buf, len);
+    } else {
+        uint16_t room = fifoBuf_getFree(&tx_dev->tx);
+        if (room > 0) {
+            moved = PIOS_COM_SendBufferNonBlockingInternal(tx_dev, buf, len < room ? len : room);
+        } else if (timeout_ms > 0) {
+#if defined(PIOS_INCLUDE_FREERTOS)
+            if (xSemaphoreTake(tx_dev->tx_sem, timeout_ms / portTICK_RATE_MS) == pdTRUE) {
+                /* Make sure we don't come back here again */
+                timeout_ms = 0;
+                goto check_again;
+            }
+#else
+            PIOS_DELAY_WaitmS(1);
+            timeout_ms--;
+            goto check_again;
+#endif
+        }
+    }
+
+#if defined(PIOS_INCLUDE_FREERTOS)
+    xSemaphoreGive(tx_dev->sendbuffer_sem);
+#endif /* PIOS_INCLUDE_FREERTOS */
+
+    if (moved > 0) {
+        PIOS_COM_ReceiveBufferRelease(rx_com_id, moved);
+    }
+
+    return moved;
+}
+
 /**
  * Query if a com port is available for use.  That can be
  * used to check a link is established even if the device
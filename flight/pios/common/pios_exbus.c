@@ -238,7 +238,7 @@ static int PIOS_EXBUS_UnrollChannels(struct pios_exbus_dev *exbus_dev)
             break;
 
         case EXBUS_STATE_DATA:
-            if (channel < n_channels) {
+            if (channel < n_channels && channel < PIOS_EXBUS_NUM_INPUTS) {
                 /* 1 lsb = 1/8 us */
                 state->channel_data[channel++] = (byte[1] << 8 | byte[0]) / 8;
             }
@@ -334,7 +334,7 @@ static uint16_t PIOS_EXBUS_RxInCallback(uint32_t context,
     PIOS_Assert(valid);
 
     /* process byte(s) and clear receive timer */
-    for (uint8_t i = 0; i < buf_len; i++) {
+    for (uint16_t i = 0; i < buf_len; i++) {
         PIOS_EXBUS_UpdateState(exbus_dev, buf[i]);
         exbus_dev->state.receive_timer = 0;
     }
@@ -125,6 +125,7 @@ struct pios_hott_state {
     uint8_t  tx_connected;
     uint8_t  byte_count;
     uint8_t  frame_length;
+    uint16_t crc;
     float    quality;
 };
 
@@ -198,17 +199,8 @@ static int PIOS_HOTT_UnrollChannels(struct pios_hott_dev *hott_dev)
     case HOTT_STATUS_FAILSAFE:
         /* check crc before processing */
         if (hott_dev->proto == PIOS_HOTT_PROTO_SUMD) {
-            /* SUMD has 16 bit CCITT CRC */
-            uint16_t crc = 0;
-            uint8_t *s   = &(state->received_data[0]);
-            int len = state->byte_count - 2;
-            for (int n = 0; n < len; n++) {
-                crc ^= (uint16_t)s[n] << 8;
-                for (int i = 0; i < 8; i++) {
-                    crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
-                }
-            }
-            if (crc ^ (((uint16_t)s[len] << 8) | s[len + 1])) {
+            /* SUMD has 16 bit CCITT CRC, the frame including it leaves 0 */
+            if (state->crc != 0) {
                 /* wrong crc checksum found */
                 goto stream_error;
             }
@@ -252,8 +244,8 @@ static int PIOS_HOTT_UnrollChannels(struct pios_hott_dev *hott_dev)
             s   += sizeof(uint16_t);
             /* save the channel value */
             if (i < PIOS_HOTT_NUM_INPUTS) {
-                /* floating version. channel limits from -100..+100% are mapped to 1000..2000 */
-                state->channel_data[i] = (uint16_t)(word / 6.4f - 375);
+                /* channel limits from -100..+100% are mapped to 1000..2000, word / 6.4 - 375 */
+                state->channel_data[i] = (uint16_t)(((word * 5) >> 5) - 375);
             }
         } else {
             /* this channel was not received */
@@ -269,6 +261,21 @@ stream_error:
     return -1;
 }
 
+/**
+ * CRC16-CCITT (polynomial 0x1021, MSB first) of one more byte. Updated as the
+ * bytes come in so that the end of a frame costs the same as any other byte.
+ */
+static uint16_t PIOS_HOTT_CRC_Update(uint16_t crc, uint8_t data)
+{
+    crc  = (crc >> 8) | (crc << 8);
+    crc ^= data;
+    crc ^= (crc & 0xff) >> 4;
+    crc ^= crc << 12;
+    crc ^= (crc & 0xff) << 5;
+
+    return crc;
+}
+
 /* Update decoder state processing input byte from the HoTT stream */
 static void PIOS_HOTT_UpdateState(struct pios_hott_dev *hott_dev, uint8_t byte)
 {
@@ -277,8 +284,14 @@ static void PIOS_HOTT_UpdateState(struct pios_hott_dev *hott_dev, uint8_t byte)
     if (state->frame_found) {
         /* receiving the data frame */
         if (state->byte_count < HOTT_MAX_FRAME_LENGTH) {
+            if (state->byte_count == 0) {
+                state->crc = 0;
+            }
             /* store next byte */
             state->received_data[state->byte_count++] = byte;
+            if (hott_dev->proto == PIOS_HOTT_PROTO_SUMD) {
+                state->crc = PIOS_HOTT_CRC_Update(state->crc, byte);
+            }
             if (state->byte_count == HOTT_HEADER_LENGTH) {
                 /* 3rd byte contains the number of channels. calculate frame size */
                 state->frame_length = HOTT_OVERHEAD_LENGTH + 2 * byte;
@@ -349,7 +362,7 @@ static uint16_t PIOS_HOTT_RxInCallback(uint32_t context,
     PIOS_Assert(valid);
 
     /* process byte(s) and clear receive timer */
-    for (uint8_t i = 0; i < buf_len; i++) {
+    for (uint16_t i = 0; i < buf_len; i++) {
         PIOS_HOTT_UpdateState(hott_dev, buf[i]);
         hott_dev->state.receive_timer = 0;
     }
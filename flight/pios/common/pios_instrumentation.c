@@ -30,6 +30,18 @@ pios_perf_counter_t *pios_instrumentation_perf_counters = NULL;
 int8_t pios_instrumentation_max_counters = -1;
 int8_t pios_instrumentation_last_used_counter = -1;
 
+/* open addressing hash index from counter id to counter, -1 marks a free slot */
+static int8_t *pios_instrumentation_index;
+static uint16_t pios_instrumentation_index_mask;
+
+static inline uint16_t hashId(uint32_t id)
+{
+    id ^= id >> 16;
+    id *= 0x45d9f3b;
+    id ^= id >> 16;
+    return id & pios_instrumentation_index_mask;
+}
+
 void PIOS_Instrumentation_Init(int8_t maxCounters)
 {
     PIOS_Assert(maxCounters >= 0);
@@ -37,39 +49,61 @@ void PIOS_Instrumentation_Init(int8_t maxCounters)
         pios_instrumentation_perf_counters = (pios_perf_counter_t *)pvPortMalloc(sizeof(pios_perf_counter_t) * maxCounters);
         PIOS_Assert(pios_instrumentation_perf_counters);
         memset(pios_instrumentation_perf_counters, 0, sizeof(pios_perf_counter_t) * maxCounters);
-        pios_instrumentation_max_counters  = maxCounters;
+        pios_instrumentation_max_counters = maxCounters;
+
+        // keep the index at most half full, so probe sequences stay short
+        uint16_t slots = 2;
+        while (slots < 2 * maxCounters) {
+            slots <<= 1;
+        }
+        pios_instrumentation_index = (int8_t *)pvPortMalloc(slots);
+        PIOS_Assert(pios_instrumentation_index);
+        memset(pios_instrumentation_index, -1, slots);
+        pios_instrumentation_index_mask = slots - 1;
     } else {
         pios_instrumentation_perf_counters = NULL;
         pios_instrumentation_max_counters  = -1;
+        pios_instrumentation_index = NULL;
     }
+    pios_instrumentation_last_used_counter = -1;
 }
 
 pios_counter_t PIOS_Instrumentation_CreateCounter(uint32_t id)
 {
-    PIOS_Assert(pios_instrumentation_perf_counters && (pios_instrumentation_max_counters > pios_instrumentation_last_used_counter));
+    PIOS_Assert(pios_instrumentation_perf_counters);
 
-    pios_counter_t counter_handle = PIOS_Instrumentation_SearchCounter(id);
-    if (!counter_handle) {
-        pios_perf_counter_t *newcounter = &pios_instrumentation_perf_counters[++pios_instrumentation_last_used_counter];
-        newcounter->id  = id;
-        newcounter->max = INT32_MIN + 1;
-        newcounter->min = INT32_MAX - 1;
-        counter_handle  = (pios_counter_t)newcounter;
+    uint16_t slot = hashId(id);
+    int8_t index;
+    while ((index = pios_instrumentation_index[slot]) >= 0) {
+        if (pios_instrumentation_perf_counters[index].id == id) {
+            return (pios_counter_t)&pios_instrumentation_perf_counters[index];
+        }
+        slot = (slot + 1) & pios_instrumentation_index_mask;
     }
-    return counter_handle;
+
+    PIOS_Assert(pios_instrumentation_max_counters > pios_instrumentation_last_used_counter + 1);
+    index = ++pios_instrumentation_last_used_counter;
+    pios_perf_counter_t *newcounter = &pios_instrumentation_perf_counters[index];
+    newcounter->id  = id;
+    newcounter->max = INT32_MIN + 1;
+    newcounter->min = INT32_MAX - 1;
+    pios_instrumentation_index[slot] = index;
+    return (pios_counter_t)newcounter;
 }
 
 pios_counter_t PIOS_Instrumentation_SearchCounter(uint32_t id)
 {
     PIOS_Assert(pios_instrumentation_perf_counters);
-    uint8_t i = 0;
-    while (i < pios_instrumentation_last_used_counter && pios_instrumentation_perf_counters[i].id != id) {
-        i++;
-    }
-    if (pios_instrumentation_perf_counters[i].id != id) {
-        return NULL;
+
+    uint16_t slot = hashId(id);
+    int8_t index;
+    while ((index = pios_instrumentation_index[slot]) >= 0) {
+        if (pios_instrumentation_perf_counters[index].id == id) {
+            return (pios_counter_t)&pios_instrumentation_perf_counters[index];
+        }
+        slot = (slot + 1) & pios_instrumentation_index_mask;
     }
-    return (pios_counter_t)&pios_instrumentation_perf_counters[i];
+    return NULL;
 }
 
 void PIOS_Instrumentation_ForEachCounter(InstrumentationCounterCallback callback, void *context)
@@ -80,3 +114,21 @@ void PIOS_Instrumentation_ForEachCounter(InstrumentationCounterCallback callback
         callback(counter, index, context);
     }
 }
+
+void PIOS_Instrumentation_ForEachSnapshot(InstrumentationCounterCallback callback, void *context)
+{
+    PIOS_Assert(pios_instrumentation_perf_counters);
+    for (int8_t index = 0; index < pios_instrumentation_last_used_counter + 1; index++) {
+        pios_perf_counter_t *counter = &pios_instrumentation_perf_counters[index];
+        pios_perf_counter_t snapshot;
+
+        vPortEnterCritical();
+        snapshot = *counter;
+        counter->total = 0;
+        counter->count = 0;
+        memset(counter->histogram, 0, sizeof(counter->histogram));
+        vPortExitCritical();
+
+        callback(&snapshot, index, context);
+    }
+}
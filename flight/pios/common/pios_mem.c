@@ -30,21 +30,135 @@
 #ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
 // relies on pios_general_malloc to perform the allocation (i.e. pios_msheap.c)
 extern void *pios_general_malloc(void *ptr, size_t size, bool fastheap);
+// the pool serves both heaps, so it lives in the one that suits every use
+#define PIOS_MEMPOOL_ARENA_MALLOC(size) pios_general_malloc(NULL, (size), false)
+#else
+#define PIOS_MEMPOOL_ARENA_MALLOC(size) pvPortMalloc(size)
+#endif
+
+#ifdef PIOS_INCLUDE_MEMPOOL
+#include <pios_mempool.h>
+
+#ifndef PIOS_MEMPOOL_CLASSES
+// Small long lived allocations: UAVObject instances, callbacks, queues
+#define PIOS_MEMPOOL_CLASSES { { 16, 32 }, { 32, 32 }, { 64, 16 }, { 128, 8 } }
+#endif
+
+static const struct pios_mempool_class mempool_classes[] = PIOS_MEMPOOL_CLASSES;
+static bool mempool_ready;
+
+/**
+ * Take the pool arena from the heap, once at startup before any task allocates.
+ * Until then, or if this fails, all allocations go to the heap.
+ */
+void pios_mem_init(void)
+{
+    if (mempool_ready) {
+        return;
+    }
+
+    void *arena = PIOS_MEMPOOL_ARENA_MALLOC(PIOS_MEMPOOL_ArenaSize(mempool_classes, NELEMENTS(mempool_classes)));
+    if (!arena) {
+        return;
+    }
+    if (PIOS_MEMPOOL_Init(mempool_classes, NELEMENTS(mempool_classes), arena) != 0) {
+        vPortFree(arena);
+        return;
+    }
+
+    mempool_ready = true;
+}
+
+static void *pios_mempool_malloc(size_t size)
+{
+    void *ptr = NULL;
+
+    vPortEnterCritical();
+    if (mempool_ready) {
+        ptr = PIOS_MEMPOOL_Alloc(size);
+    }
+    vPortExitCritical();
+
+    return ptr;
+}
+
+static bool pios_mempool_free(void *ptr)
+{
+    vPortEnterCritical();
+    bool freed = mempool_ready && PIOS_MEMPOOL_Free(ptr);
+    vPortExitCritical();
+
+    return freed;
+}
+
+#ifdef PIOS_INCLUDE_REALLOC
+/**
+ * Pool blocks do not grow, the data moves to whatever fits the new size.
+ * @return false if ptr does not belong to the pool
+ */
+static bool pios_mempool_realloc(void *ptr, size_t size, void **new_ptr)
+{
+    vPortEnterCritical();
+    size_t block_size = mempool_ready ? PIOS_MEMPOOL_BlockSize(ptr) : 0;
+    vPortExitCritical();
+
+    if (!block_size) {
+        return false;
+    }
+    *new_ptr = pios_malloc(size);
+    if (*new_ptr) {
+        memcpy(*new_ptr, ptr, size < block_size ? size : block_size);
+        pios_free(ptr);
+    }
+    return true;
+}
+#endif /* PIOS_INCLUDE_REALLOC */
+
+#else /* PIOS_INCLUDE_MEMPOOL */
+void pios_mem_init(void)
+{}
+
+static inline void *pios_mempool_malloc(__attribute__((unused)) size_t size)
+{
+    return NULL;
+}
+
+static inline bool pios_mempool_free(__attribute__((unused)) void *ptr)
+{
+    return false;
+}
+
+static inline bool pios_mempool_realloc(__attribute__((unused)) void *ptr, __attribute__((unused)) size_t size, __attribute__((unused)) void **new_ptr)
+{
+    return false;
+}
+#endif /* PIOS_INCLUDE_MEMPOOL */
+
+#ifdef PIOS_TARGET_PROVIDES_FAST_HEAP
 
 void *pios_fastheapmalloc(size_t size)
 {
-    return pios_general_malloc(NULL, size, true);
+    void *ptr = pios_mempool_malloc(size);
+
+    return ptr ? ptr : pios_general_malloc(NULL, size, true);
 }
 
 
 void *pios_malloc(size_t size)
 {
-    return pios_general_malloc(NULL, size, false);
+    void *ptr = pios_mempool_malloc(size);
+
+    return ptr ? ptr : pios_general_malloc(NULL, size, false);
 }
 
 void *pios_realloc(__attribute__((unused)) void *ptr, __attribute__((unused)) size_t size)
 {
 #ifdef PIOS_INCLUDE_REALLOC
+    void *new_ptr;
+
+    if (pios_mempool_realloc(ptr, size, &new_ptr)) {
+        return new_ptr;
+    }
     return pios_general_malloc(ptr, size, false);
 
 #else
@@ -59,25 +173,36 @@ void *pios_realloc(__attribute__((unused)) void *ptr, __attribute__((unused)) si
 
 void pios_free(void *p)
 {
-    vPortFree(p);
+    if (!pios_mempool_free(p)) {
+        vPortFree(p);
+    }
 }
 
 #else /* ifdef PIOS_TARGET_PROVIDES_FAST_HEAP */
 // demand to pvPortMalloc implementation
 void *pios_fastheapmalloc(size_t size)
 {
-    return pvPortMalloc(size);
+    void *ptr = pios_mempool_malloc(size);
+
+    return ptr ? ptr : pvPortMalloc(size);
 }
 
 
 void *pios_malloc(size_t size)
 {
-    return pvPortMalloc(size);
+    void *ptr = pios_mempool_malloc(size);
+
+    return ptr ? ptr : pvPortMalloc(size);
 }
 
 void *pios_realloc(__attribute__((unused)) void *ptr, __attribute__((unused)) size_t size)
 {
 #ifdef PIOS_INCLUDE_REALLOC
+    void *new_ptr;
+
+    if (pios_mempool_realloc(ptr, size, &new_ptr)) {
+        return new_ptr;
+    }
     return pvPortMalloc(size);
 
 #else
@@ -92,7 +217,9 @@ void *pios_realloc(__attribute__((unused)) void *ptr, __attribute__((unused)) si
 
 void pios_free(void *p)
 {
-    vPortFree(p);
+    if (!pios_mempool_free(p)) {
+        vPortFree(p);
+    }
 }
 
 #endif /* ifdef PIOS_TARGET_PROVIDES_FAST_HEAP */
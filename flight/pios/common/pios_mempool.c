@@ -0,0 +1,183 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_mempool.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup PiOS
+ * @{
+ * @addtogroup PiOS
+ * @{
+ * @brief Fixed size block pools behind pios_malloc
+ *
+ * Each class owns a contiguous part of the arena, split in equal blocks
+ * that are linked in a free list through their first word. Allocation pops
+ * the head of the list of the smallest class that fits, freeing pushes the
+ * block back, and the class of a block follows from its address. Both take
+ * the same time whatever the state of the pool, and the blocks are never
+ * split or merged, so the pool does not fragment. The caller is in charge
+ * of the locking.
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <pios.h>
+
+#ifdef PIOS_INCLUDE_MEMPOOL
+
+#include <pios_mempool.h>
+
+struct mempool_class {
+    uint8_t *start;
+    uint8_t *end;
+    void    *free_list;
+    struct pios_mempool_stats stats;
+};
+
+static struct mempool_class mempool[PIOS_MEMPOOL_MAX_CLASSES];
+static uint8_t mempool_classes;
+
+static uint16_t mempool_block_size(uint16_t size)
+{
+    return (size + PIOS_MEMPOOL_ALIGN - 1) & ~(PIOS_MEMPOOL_ALIGN - 1);
+}
+
+size_t PIOS_MEMPOOL_ArenaSize(const struct pios_mempool_class *classes, uint8_t num_classes)
+{
+    size_t size = 0;
+
+    for (uint8_t i = 0; i < num_classes; i++) {
+        size += (size_t)mempool_block_size(classes[i].block_size) * classes[i].blocks;
+    }
+    return size;
+}
+
+int32_t PIOS_MEMPOOL_Init(const struct pios_mempool_class *classes, uint8_t num_classes, void *arena)
+{
+    if (num_classes > PIOS_MEMPOOL_MAX_CLASSES || ((uintptr_t)arena & (PIOS_MEMPOOL_ALIGN - 1))) {
+        return -1;
+    }
+    for (uint8_t i = 0; i < num_classes; i++) {
+        if (!classes[i].block_size || !classes[i].blocks ||
+            (i > 0 && mempool_block_size(classes[i].block_size) <= mempool_block_size(classes[i - 1].block_size))) {
+            return -1;
+        }
+    }
+
+    uint8_t *block = (uint8_t *)arena;
+    for (uint8_t i = 0; i < num_classes; i++) {
+        struct mempool_class *c = &mempool[i];
+        uint16_t size = mempool_block_size(classes[i].block_size);
+
+        c->start     = block;
+        c->free_list = NULL;
+        // link the blocks so the lowest address is handed out first
+        for (uint16_t j = classes[i].blocks; j > 0; j--) {
+            void **b = (void **)(block + (size_t)(j - 1) * size);
+            *b = c->free_list;
+            c->free_list = b;
+        }
+        block += (size_t)size * classes[i].blocks;
+        c->end = block;
+
+        c->stats.block_size = size;
+        c->stats.blocks     = classes[i].blocks;
+        c->stats.used       = 0;
+        c->stats.max_used   = 0;
+        c->stats.failed     = 0;
+    }
+    mempool_classes = num_classes;
+
+    return 0;
+}
+
+void *PIOS_MEMPOOL_Alloc(size_t size)
+{
+    uint8_t i;
+
+    for (i = 0; i < mempool_classes && mempool[i].stats.block_size < size; i++) {
+        ;
+    }
+    if (i == mempool_classes) {
+        return NULL;
+    }
+
+    struct mempool_class *c = &mempool[i];
+    void **block = (void **)c->free_list;
+    if (!block) {
+        if (c->stats.failed < UINT16_MAX) {
+            c->stats.failed++;
+        }
+        return NULL;
+    }
+
+    c->free_list = *block;
+    if (++c->stats.used > c->stats.max_used) {
+        c->stats.max_used = c->stats.used;
+    }
+    return block;
+}
+
+static struct mempool_class *mempool_find(const void *ptr)
+{
+    const uint8_t *p = (const uint8_t *)ptr;
+
+    for (uint8_t i = 0; i < mempool_classes; i++) {
+        if (p >= mempool[i].start && p < mempool[i].end) {
+            // a pointer inside a block is a corrupted heap
+            PIOS_Assert((p - mempool[i].start) % mempool[i].stats.block_size == 0);
+            return &mempool[i];
+        }
+    }
+    return NULL;
+}
+
+bool PIOS_MEMPOOL_Free(void *ptr)
+{
+    struct mempool_class *c = mempool_find(ptr);
+
+    if (!c) {
+        return false;
+    }
+
+    PIOS_Assert(c->stats.used > 0);
+    *(void **)ptr = c->free_list;
+    c->free_list  = ptr;
+    c->stats.used--;
+    return true;
+}
+
+size_t PIOS_MEMPOOL_BlockSize(const void *ptr)
+{
+    struct mempool_class *c = mempool_find(ptr);
+
+    return c ? c->stats.block_size : 0;
+}
+
+uint8_t PIOS_MEMPOOL_GetStats(struct pios_mempool_stats *stats, uint8_t max_classes)
+{
+    uint8_t i;
+
+    for (i = 0; i < mempool_classes && i < max_classes; i++) {
+        stats[i] = mempool[i].stats;
+    }
+    return i;
+}
+
+#endif /* PIOS_INCLUDE_MEMPOOL */
+
+/**
+ * @}
+ * @}
+ */
@@ -57,6 +57,18 @@ const PIOS_SENSORS_Driver PIOS_MPU6000_Driver = {
     .get_scale = PIOS_MPU6000_driver_get_scale,
     .is_polled = false,
 };
+
+// used instead when the samples are read in bursts from the FIFO
+const PIOS_SENSORS_Driver PIOS_MPU6000_BatchDriver = {
+    .test       = PIOS_MPU6000_driver_Test,
+    .poll       = NULL,
+    .fetch      = NULL,
+    .reset      = PIOS_MPU6000_driver_Reset,
+    .get_queue  = PIOS_MPU6000_driver_get_queue,
+    .get_scale  = PIOS_MPU6000_driver_get_scale,
+    .is_polled  = false,
+    .is_batched = true,
+};
 //
 
 
@@ -74,36 +86,51 @@ struct mpu6000_dev {
 #define PIOS_MPU6000_SAMPLES_BYTES    14
 #define PIOS_MPU6000_SENSOR_FIRST_REG PIOS_MPU6000_ACCEL_X_OUT_MSB
 
+// register layout of one sample, which is also the layout of a FIFO frame
+typedef struct {
+    uint8_t Accel_X_h;
+    uint8_t Accel_X_l;
+    uint8_t Accel_Y_h;
+    uint8_t Accel_Y_l;
+    uint8_t Accel_Z_h;
+    uint8_t Accel_Z_l;
+    uint8_t Temperature_h;
+    uint8_t Temperature_l;
+    uint8_t Gyro_X_h;
+    uint8_t Gyro_X_l;
+    uint8_t Gyro_Y_h;
+    uint8_t Gyro_Y_l;
+    uint8_t Gyro_Z_h;
+    uint8_t Gyro_Z_l;
+} mpu6000_sample_t;
+
 typedef union {
     uint8_t buffer[1 + PIOS_MPU6000_SAMPLES_BYTES];
     struct {
         uint8_t dummy;
-        uint8_t Accel_X_h;
-        uint8_t Accel_X_l;
-        uint8_t Accel_Y_h;
-        uint8_t Accel_Y_l;
-        uint8_t Accel_Z_h;
-        uint8_t Accel_Z_l;
-        uint8_t Temperature_h;
-        uint8_t Temperature_l;
-        uint8_t Gyro_X_h;
-        uint8_t Gyro_X_l;
-        uint8_t Gyro_Y_h;
-        uint8_t Gyro_Y_l;
-        uint8_t Gyro_Z_h;
-        uint8_t Gyro_Z_l;
+        mpu6000_sample_t sample;
     } data;
 } mpu6000_data_t;
 
-#define GET_SENSOR_DATA(mpudataptr, sensor) (mpudataptr.data.sensor##_h << 8 | mpudataptr.data.sensor##_l)
+#define GET_SENSOR_DATA(sampleptr, sensor) ((sampleptr)->sensor##_h << 8 | (sampleptr)->sensor##_l)
+
+// FIFO contents in the burst mode
+#define PIOS_MPU6000_FIFO_BURST_STORE \
+    (PIOS_MPU6000_FIFO_TEMP_OUT | PIOS_MPU6000_FIFO_GYRO_X_OUT | PIOS_MPU6000_FIFO_GYRO_Y_OUT | \
+     PIOS_MPU6000_FIFO_GYRO_Z_OUT | PIOS_MPU6000_ACCEL_OUT)
+#define PIOS_MPU6000_FIFO_BURST_BYTES (PIOS_SENSORS_MAX_BATCH * PIOS_MPU6000_SAMPLES_BYTES)
 
 // ! Global structure for this device device
 static struct mpu6000_dev *dev;
 volatile bool mpu6000_configured = false;
 static mpu6000_data_t mpu6000_data;
 static PIOS_SENSORS_3Axis_SensorsWithTemp *queue_data = 0;
+static PIOS_SENSORS_3Axis_SensorsBatch *batch_data    = 0;
+static uint8_t *fifo_data = 0;
+static uint8_t fifo_pending;
 #define SENSOR_COUNT     2
 #define SENSOR_DATA_SIZE (sizeof(PIOS_SENSORS_3Axis_SensorsWithTemp) + sizeof(Vector3i16) * SENSOR_COUNT)
+#define BATCH_DATA_SIZE  (sizeof(PIOS_SENSORS_3Axis_SensorsBatch) + sizeof(Vector3i16) * SENSOR_COUNT * PIOS_SENSORS_MAX_BATCH)
 // ! Private functions
 static struct mpu6000_dev *PIOS_MPU6000_alloc(const struct pios_mpu6000_cfg *cfg);
 static int32_t PIOS_MPU6000_Validate(struct mpu6000_dev *dev);
@@ -113,12 +140,16 @@ static int32_t PIOS_MPU6000_GetReg(uint8_t address);
 static void PIOS_MPU6000_SetSpeed(const bool fast);
 static bool PIOS_MPU6000_HandleData();
 static bool PIOS_MPU6000_ReadSensor(bool *woken);
+static uint16_t PIOS_MPU6000_ReadFifo(bool *woken);
+static bool PIOS_MPU6000_HandleBatch(uint16_t samples);
+static int16_t PIOS_MPU6000_ConvertSample(const mpu6000_sample_t *sample, Vector3i16 *accel, Vector3i16 *gyro);
 
 static int32_t PIOS_MPU6000_Test(void);
 
 void PIOS_MPU6000_Register()
 {
-    PIOS_SENSORS_Register(&PIOS_MPU6000_Driver, PIOS_SENSORS_TYPE_3AXIS_GYRO_ACCEL, 0);
+    PIOS_SENSORS_Register((dev && dev->cfg->fifo_burst) ? &PIOS_MPU6000_BatchDriver : &PIOS_MPU6000_Driver,
+                          PIOS_SENSORS_TYPE_3AXIS_GYRO_ACCEL, 0);
 }
 /**
  * @brief Allocate a new device
@@ -132,6 +163,19 @@ static struct mpu6000_dev *PIOS_MPU6000_alloc(const struct pios_mpu6000_cfg *cfg
 
     mpu6000_dev->magic = PIOS_MPU6000_DEV_MAGIC;
 
+    if (cfg->fifo_burst) {
+        PIOS_Assert(cfg->fifo_burst <= PIOS_SENSORS_MAX_BATCH);
+        mpu6000_dev->queue = xQueueCreate(cfg->max_downsample / cfg->fifo_burst + 2, BATCH_DATA_SIZE);
+        PIOS_Assert(mpu6000_dev->queue);
+
+        batch_data = (PIOS_SENSORS_3Axis_SensorsBatch *)pios_malloc(BATCH_DATA_SIZE);
+        PIOS_Assert(batch_data);
+        batch_data->count = SENSOR_COUNT;
+        fifo_data = (uint8_t *)pios_malloc(1 + PIOS_MPU6000_FIFO_BURST_BYTES);
+        PIOS_Assert(fifo_data);
+        return mpu6000_dev;
+    }
+
     mpu6000_dev->queue = xQueueCreate(cfg->max_downsample + 1, SENSOR_DATA_SIZE);
     PIOS_Assert(mpu6000_dev->queue);
 
@@ -230,12 +274,13 @@ static void PIOS_MPU6000_Config(struct pios_mpu6000_cfg const *cfg)
     }
 
     // FIFO storage
-    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_FIFO_EN_REG, cfg->Fifo_store) != 0) {
+    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_FIFO_EN_REG, cfg->fifo_burst ? PIOS_MPU6000_FIFO_BURST_STORE : cfg->Fifo_store) != 0) {
         ;
     }
     PIOS_MPU6000_ConfigureRanges(cfg->gyro_range, cfg->accel_range, cfg->filter);
-    // Interrupt configuration
-    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_USER_CTRL_REG, cfg->User_ctl) != 0) {
+    // Interrupt configuration, the burst mode starts from an empty FIFO
+    while (PIOS_MPU6000_SetReg(PIOS_MPU6000_USER_CTRL_REG, cfg->User_ctl |
+                               (cfg->fifo_burst ? PIOS_MPU6000_USERCTL_FIFO_EN | PIOS_MPU6000_USERCTL_FIFO_RST : 0)) != 0) {
         ;
     }
 
@@ -546,6 +591,22 @@ bool PIOS_MPU6000_IRQHandler(void)
         return false;
     }
 
+    if (dev->cfg->fifo_burst) {
+        // The chip has no FIFO watermark interrupt, so the data ready
+        // interrupts are counted and the FIFO is read every fifo_burst samples
+        if (++fifo_pending < dev->cfg->fifo_burst) {
+            return false;
+        }
+        fifo_pending = 0;
+
+        uint16_t samples = PIOS_MPU6000_ReadFifo(&woken);
+        if (samples) {
+            bool woken2 = PIOS_MPU6000_HandleBatch(samples);
+            woken |= woken2;
+        }
+        return woken;
+    }
+
     bool read_ok = false;
     read_ok = PIOS_MPU6000_ReadSensor(&woken);
 
@@ -557,12 +618,12 @@ bool PIOS_MPU6000_IRQHandler(void)
     return woken;
 }
 
-static bool PIOS_MPU6000_HandleData()
+/**
+ * @brief Rotate one sample to the board frame
+ * @return temperature in degrees C * 100
+ */
+static int16_t PIOS_MPU6000_ConvertSample(const mpu6000_sample_t *sample, Vector3i16 *accel, Vector3i16 *gyro)
 {
-    if (!queue_data) {
-        return false;
-    }
-
     // Rotate the sensor to OP convention.  The datasheet defines X as towards the right
     // and Y as forward.  OP convention transposes this.  Also the Z is defined negatively
     // to our convention
@@ -570,42 +631,69 @@ static bool PIOS_MPU6000_HandleData()
     // Currently we only support rotations on top so switch X/Y accordingly
     switch (dev->cfg->orientation) {
     case PIOS_MPU6000_TOP_0DEG:
-        queue_data->sample[0].y = GET_SENSOR_DATA(mpu6000_data, Accel_X); // chip X
-        queue_data->sample[0].x = GET_SENSOR_DATA(mpu6000_data, Accel_Y); // chip Y
-        queue_data->sample[1].y = GET_SENSOR_DATA(mpu6000_data, Gyro_X); // chip X
-        queue_data->sample[1].x = GET_SENSOR_DATA(mpu6000_data, Gyro_Y); // chip Y
+        accel->y = GET_SENSOR_DATA(sample, Accel_X); // chip X
+        accel->x = GET_SENSOR_DATA(sample, Accel_Y); // chip Y
+        gyro->y  = GET_SENSOR_DATA(sample, Gyro_X); // chip X
+        gyro->x  = GET_SENSOR_DATA(sample, Gyro_Y); // chip Y
         break;
     case PIOS_MPU6000_TOP_90DEG:
         // -1 to bring it back to -32768 +32767 range
-        queue_data->sample[0].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Y)); // chip Y
-        queue_data->sample[0].x = GET_SENSOR_DATA(mpu6000_data, Accel_X); // chip X
-        queue_data->sample[1].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Y)); // chip Y
-        queue_data->sample[1].x = GET_SENSOR_DATA(mpu6000_data, Gyro_X); // chip X
+        accel->y = -1 - (GET_SENSOR_DATA(sample, Accel_Y)); // chip Y
+        accel->x = GET_SENSOR_DATA(sample, Accel_X); // chip X
+        gyro->y  = -1 - (GET_SENSOR_DATA(sample, Gyro_Y)); // chip Y
+        gyro->x  = GET_SENSOR_DATA(sample, Gyro_X); // chip X
         break;
     case PIOS_MPU6000_TOP_180DEG:
-        queue_data->sample[0].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_X)); // chip X
-        queue_data->sample[0].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Y)); // chip Y
-        queue_data->sample[1].y = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_X)); // chip X
-        queue_data->sample[1].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Y)); // chip Y
+        accel->y = -1 - (GET_SENSOR_DATA(sample, Accel_X)); // chip X
+        accel->x = -1 - (GET_SENSOR_DATA(sample, Accel_Y)); // chip Y
+        gyro->y  = -1 - (GET_SENSOR_DATA(sample, Gyro_X)); // chip X
+        gyro->x  = -1 - (GET_SENSOR_DATA(sample, Gyro_Y)); // chip Y
         break;
     case PIOS_MPU6000_TOP_270DEG:
-        queue_data->sample[0].y = GET_SENSOR_DATA(mpu6000_data, Accel_Y); // chip Y
-        queue_data->sample[0].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_X)); // chip X
-        queue_data->sample[1].y = GET_SENSOR_DATA(mpu6000_data, Gyro_Y); // chip Y
-        queue_data->sample[1].x = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_X)); // chip X
+        accel->y = GET_SENSOR_DATA(sample, Accel_Y); // chip Y
+        accel->x = -1 - (GET_SENSOR_DATA(sample, Accel_X)); // chip X
+        gyro->y  = GET_SENSOR_DATA(sample, Gyro_Y); // chip Y
+        gyro->x  = -1 - (GET_SENSOR_DATA(sample, Gyro_X)); // chip X
         break;
     }
-    queue_data->sample[0].z = -1 - (GET_SENSOR_DATA(mpu6000_data, Accel_Z));
-    queue_data->sample[1].z = -1 - (GET_SENSOR_DATA(mpu6000_data, Gyro_Z));
-    const int16_t temp = GET_SENSOR_DATA(mpu6000_data, Temperature);
+    accel->z = -1 - (GET_SENSOR_DATA(sample, Accel_Z));
+    gyro->z  = -1 - (GET_SENSOR_DATA(sample, Gyro_Z));
+    const int16_t temp = GET_SENSOR_DATA(sample, Temperature);
     // Temperature in degrees C = (TEMP_OUT Register Value as a signed quantity)/340 + 36.53
-    queue_data->temperature = 3653 + (temp * 100) / 340;
+    return 3653 + (temp * 100) / 340;
+}
+
+static bool PIOS_MPU6000_HandleData()
+{
+    if (!queue_data) {
+        return false;
+    }
+
+    queue_data->temperature = PIOS_MPU6000_ConvertSample(&mpu6000_data.data.sample, &queue_data->sample[0], &queue_data->sample[1]);
 
     BaseType_t higherPriorityTaskWoken;
     xQueueSendToBackFromISR(dev->queue, (void *)queue_data, &higherPriorityTaskWoken);
     return higherPriorityTaskWoken == pdTRUE;
 }
 
+static bool PIOS_MPU6000_HandleBatch(uint16_t samples)
+{
+    if (!batch_data) {
+        return false;
+    }
+
+    const mpu6000_sample_t *sample = (const mpu6000_sample_t *)&fifo_data[1];
+    for (uint16_t i = 0; i < samples; i++, sample++) {
+        batch_data->temperature = PIOS_MPU6000_ConvertSample(sample, &batch_data->sample[2 * i], &batch_data->sample[2 * i + 1]);
+    }
+    batch_data->samples   = samples;
+    batch_data->timestamp = PIOS_DELAY_GetRaw();
+
+    BaseType_t higherPriorityTaskWoken;
+    xQueueSendToBackFromISR(dev->queue, (void *)batch_data, &higherPriorityTaskWoken);
+    return higherPriorityTaskWoken == pdTRUE;
+}
+
 static bool PIOS_MPU6000_ReadSensor(bool *woken)
 {
     const uint8_t mpu6000_send_buf[1 + PIOS_MPU6000_SAMPLES_BYTES] = { PIOS_MPU6000_SENSOR_FIRST_REG | 0x80 };
@@ -621,6 +709,55 @@ static bool PIOS_MPU6000_ReadSensor(bool *woken)
     return true;
 }
 
+/**
+ * @brief Read the complete samples collected in the FIFO, up to PIOS_SENSORS_MAX_BATCH
+ * @return number of samples in fifo_data
+ */
+static uint16_t PIOS_MPU6000_ReadFifo(bool *woken)
+{
+    static const uint8_t fifo_send_buf[1 + PIOS_MPU6000_FIFO_BURST_BYTES] = { PIOS_MPU6000_FIFO_REG | 0x80 };
+    const uint8_t count_send_buf[3] = { PIOS_MPU6000_FIFO_CNT_MSB | 0x80 };
+    uint8_t count_buf[3];
+
+    if (PIOS_MPU6000_ClaimBusISR(woken, true) != 0) {
+        return 0;
+    }
+    if (PIOS_SPI_TransferBlock(dev->spi_id, &count_send_buf[0], &count_buf[0], sizeof(count_buf), NULL) < 0) {
+        PIOS_MPU6000_ReleaseBusISR(woken);
+        return 0;
+    }
+    PIOS_MPU6000_ReleaseBusISR(woken);
+
+    uint16_t fifo_bytes = count_buf[1] << 8 | count_buf[2];
+    if (fifo_bytes % PIOS_MPU6000_SAMPLES_BYTES || fifo_bytes > PIOS_MPU6000_FIFO_SIZE - PIOS_MPU6000_SAMPLES_BYTES) {
+        // Overflowed, the frames are no longer aligned: start over from an empty FIFO
+        if (PIOS_MPU6000_ClaimBusISR(woken, false) == 0) {
+            PIOS_SPI_TransferByte(dev->spi_id, 0x7f & PIOS_MPU6000_USER_CTRL_REG);
+            PIOS_SPI_TransferByte(dev->spi_id, dev->cfg->User_ctl | PIOS_MPU6000_USERCTL_FIFO_EN | PIOS_MPU6000_USERCTL_FIFO_RST);
+            PIOS_MPU6000_ReleaseBusISR(woken);
+        }
+        return 0;
+    }
+
+    uint16_t samples = fifo_bytes / PIOS_MPU6000_SAMPLES_BYTES;
+    if (samples > PIOS_SENSORS_MAX_BATCH) {
+        samples = PIOS_SENSORS_MAX_BATCH;
+    }
+    if (!samples) {
+        return 0;
+    }
+
+    if (PIOS_MPU6000_ClaimBusISR(woken, true) != 0) {
+        return 0;
+    }
+    if (PIOS_SPI_TransferBlock(dev->spi_id, &fifo_send_buf[0], &fifo_data[0], 1 + samples * PIOS_MPU6000_SAMPLES_BYTES, NULL) < 0) {
+        PIOS_MPU6000_ReleaseBusISR(woken);
+        return 0;
+    }
+    PIOS_MPU6000_ReleaseBusISR(woken);
+    return samples;
+}
+
 // Sensor driver implementation
 bool PIOS_MPU6000_driver_Test(__attribute__((unused)) uintptr_t context)
 {
@@ -84,46 +84,73 @@ struct mpu9250_dev {
 #error ERROR: PIOS_MPU9250_ACCEL not defined! THIS CONFIGURATION IS NOT SUPPORTED
 #endif
 
+// register layout of the accel/gyro sample, which is also the layout of a FIFO frame
+typedef struct {
+#ifdef PIOS_MPU9250_ACCEL
+    uint8_t Accel_X_h;
+    uint8_t Accel_X_l;
+    uint8_t Accel_Y_h;
+    uint8_t Accel_Y_l;
+    uint8_t Accel_Z_h;
+    uint8_t Accel_Z_l;
+#endif
+    uint8_t Temperature_h;
+    uint8_t Temperature_l;
+    uint8_t Gyro_X_h;
+    uint8_t Gyro_X_l;
+    uint8_t Gyro_Y_h;
+    uint8_t Gyro_Y_l;
+    uint8_t Gyro_Z_h;
+    uint8_t Gyro_Z_l;
+} __attribute__((__packed__)) mpu9250_sample_t;
+
+// layout of the mag registers copied by the I2C master
+typedef struct {
+    uint8_t st1;
+    uint8_t Mag_X_l;
+    uint8_t Mag_X_h;
+    uint8_t Mag_Y_l;
+    uint8_t Mag_Y_h;
+    uint8_t Mag_Z_l;
+    uint8_t Mag_Z_h;
+    uint8_t st2;
+} __attribute__((__packed__)) mpu9250_mag_sample_t;
+
 typedef union {
     uint8_t buffer[2 + PIOS_MPU9250_SAMPLES_BYTES];
     struct {
         uint8_t dummy;
-#ifdef PIOS_MPU9250_ACCEL
-        uint8_t Accel_X_h;
-        uint8_t Accel_X_l;
-        uint8_t Accel_Y_h;
-        uint8_t Accel_Y_l;
-        uint8_t Accel_Z_h;
-        uint8_t Accel_Z_l;
-#endif
-        uint8_t Temperature_h;
-        uint8_t Temperature_l;
-        uint8_t Gyro_X_h;
-        uint8_t Gyro_X_l;
-        uint8_t Gyro_Y_h;
-        uint8_t Gyro_Y_l;
-        uint8_t Gyro_Z_h;
-        uint8_t Gyro_Z_l;
+        mpu9250_sample_t     sample;
 #ifdef PIOS_MPU9250_MAG
-        uint8_t st1;
-        uint8_t Mag_X_l;
-        uint8_t Mag_X_h;
-        uint8_t Mag_Y_l;
-        uint8_t Mag_Y_h;
-        uint8_t Mag_Z_l;
-        uint8_t Mag_Z_h;
-        uint8_t st2;
+        mpu9250_mag_sample_t mag;
 #endif
-    } data;
+    } __attribute__((__packed__)) data;
 } __attribute__((__packed__)) mpu9250_data_t;
 
-#define GET_SENSOR_DATA(mpudataptr, sensor) (mpudataptr.data.sensor##_h << 8 | mpudataptr.data.sensor##_l)
+#define GET_SENSOR_DATA(sampleptr, sensor) ((sampleptr)->sensor##_h << 8 | (sampleptr)->sensor##_l)
+
+// FIFO contents in the burst mode
+#define PIOS_MPU9250_FRAME_BYTES         (PIOS_MPU9250_ACCEL_SAMPLES_BYTES + PIOS_MPU9250_TEMP_SAMPLES_BYTES + PIOS_MPU9250_GYRO_SAMPLES_BYTES)
+#define PIOS_MPU9250_FIFO_BURST_BYTES    (PIOS_SENSORS_MAX_BATCH * PIOS_MPU9250_FRAME_BYTES)
+#ifdef PIOS_MPU9250_ACCEL
+#define PIOS_MPU9250_FIFO_BURST_STORE \
+    (PIOS_MPU9250_FIFO_TEMP_OUT | PIOS_MPU9250_FIFO_GYRO_X_OUT | PIOS_MPU9250_FIFO_GYRO_Y_OUT | \
+     PIOS_MPU9250_FIFO_GYRO_Z_OUT | PIOS_MPU9250_ACCEL_OUT)
+#else
+#define PIOS_MPU9250_FIFO_BURST_STORE \
+    (PIOS_MPU9250_FIFO_TEMP_OUT | PIOS_MPU9250_FIFO_GYRO_X_OUT | PIOS_MPU9250_FIFO_GYRO_Y_OUT | \
+     PIOS_MPU9250_FIFO_GYRO_Z_OUT)
+#endif
 
 static PIOS_SENSORS_3Axis_SensorsWithTemp *queue_data = 0;
 static PIOS_SENSORS_3Axis_SensorsWithTemp *mag_data   = 0;
 static volatile bool mag_ready = false;
+static PIOS_SENSORS_3Axis_SensorsBatch *batch_data = 0;
+static uint8_t *fifo_data = 0;
+static uint8_t fifo_pending;
 #define SENSOR_COUNT         2
 #define SENSOR_DATA_SIZE     (sizeof(PIOS_SENSORS_3Axis_SensorsWithTemp) + sizeof(Vector3i16) * SENSOR_COUNT)
+#define BATCH_DATA_SIZE      (sizeof(PIOS_SENSORS_3Axis_SensorsBatch) + sizeof(Vector3i16) * SENSOR_COUNT * PIOS_SENSORS_MAX_BATCH)
 #define MAG_SENSOR_DATA_SIZE (sizeof(PIOS_SENSORS_3Axis_SensorsWithTemp) + sizeof(Vector3i16))
 // ! Global structure for this device device
 static struct mpu9250_dev *dev;
@@ -139,10 +166,15 @@ static int32_t PIOS_MPU9250_GetReg(uint8_t address);
 static void PIOS_MPU9250_SetSpeed(const bool fast);
 static bool PIOS_MPU9250_HandleData();
 static bool PIOS_MPU9250_ReadSensor(bool *woken);
+static uint16_t PIOS_MPU9250_ReadFifo(bool *woken);
+static bool PIOS_MPU9250_HandleBatch(uint16_t samples);
+static int16_t PIOS_MPU9250_ConvertSample(const mpu9250_sample_t *sample, Vector3i16 *accel, Vector3i16 *gyro);
 static int32_t PIOS_MPU9250_Test(void);
 #if defined(PIOS_MPU9250_MAG)
 static int32_t PIOS_MPU9250_Mag_Test(void);
 static int32_t PIOS_MPU9250_Mag_Init(void);
+static bool PIOS_MPU9250_ReadMagSample(bool *woken);
+static void PIOS_MPU9250_ConvertMag(const mpu9250_mag_sample_t *mag);
 #endif
 
 /* Driver Framework interfaces */
@@ -162,6 +194,18 @@ const PIOS_SENSORS_Driver PIOS_MPU9250_Main_Driver = {
     .is_polled = false,
 };
 
+// used instead when the samples are read in bursts from the FIFO
+const PIOS_SENSORS_Driver PIOS_MPU9250_Batch_Driver = {
+    .test       = PIOS_MPU9250_Main_driver_Test,
+    .poll       = NULL,
+    .fetch      = NULL,
+    .reset      = PIOS_MPU9250_Main_driver_Reset,
+    .get_queue  = PIOS_MPU9250_Main_driver_get_queue,
+    .get_scale  = PIOS_MPU9250_Main_driver_get_scale,
+    .is_polled  = false,
+    .is_batched = true,
+};
+
 // mag sensor interface
 bool PIOS_MPU9250_Mag_driver_Test(uintptr_t context);
 void PIOS_MPU9250_Mag_driver_Reset(uintptr_t context);
@@ -181,7 +225,8 @@ const PIOS_SENSORS_Driver PIOS_MPU9250_Mag_Driver = {
 
 void PIOS_MPU9250_MainRegister()
 {
-    PIOS_SENSORS_Register(&PIOS_MPU9250_Main_Driver, PIOS_SENSORS_TYPE_3AXIS_GYRO_ACCEL, 0);
+    PIOS_SENSORS_Register((dev && dev->cfg->fifo_burst) ? &PIOS_MPU9250_Batch_Driver : &PIOS_MPU9250_Main_Driver,
+                          PIOS_SENSORS_TYPE_3AXIS_GYRO_ACCEL, 0);
 }
 
 void PIOS_MPU9250_MagRegister()
@@ -200,13 +245,25 @@ static struct mpu9250_dev *PIOS_MPU9250_alloc(const struct pios_mpu9250_cfg *cfg
 
     mpu9250_dev->magic = PIOS_MPU9250_DEV_MAGIC;
 
-    mpu9250_dev->queue = xQueueCreate(cfg->max_downsample + 1, SENSOR_DATA_SIZE);
-    PIOS_Assert(mpu9250_dev->queue);
+    if (cfg->fifo_burst) {
+        PIOS_Assert(cfg->fifo_burst <= PIOS_SENSORS_MAX_BATCH);
+        mpu9250_dev->queue = xQueueCreate(cfg->max_downsample / cfg->fifo_burst + 2, BATCH_DATA_SIZE);
+        PIOS_Assert(mpu9250_dev->queue);
+
+        batch_data = (PIOS_SENSORS_3Axis_SensorsBatch *)pios_malloc(BATCH_DATA_SIZE);
+        PIOS_Assert(batch_data);
+        batch_data->count = SENSOR_COUNT;
+        fifo_data = (uint8_t *)pios_malloc(1 + PIOS_MPU9250_FIFO_BURST_BYTES);
+        PIOS_Assert(fifo_data);
+    } else {
+        mpu9250_dev->queue = xQueueCreate(cfg->max_downsample + 1, SENSOR_DATA_SIZE);
+        PIOS_Assert(mpu9250_dev->queue);
 
-    queue_data = (PIOS_SENSORS_3Axis_SensorsWithTemp *)pios_malloc(SENSOR_DATA_SIZE);
-    PIOS_Assert(queue_data);
+        queue_data = (PIOS_SENSORS_3Axis_SensorsWithTemp *)pios_malloc(SENSOR_DATA_SIZE);
+        PIOS_Assert(queue_data);
 
-    queue_data->count = SENSOR_COUNT;
+        queue_data->count = SENSOR_COUNT;
+    }
 
     mag_data = (PIOS_SENSORS_3Axis_SensorsWithTemp *)pios_malloc(MAG_SENSOR_DATA_SIZE);
     mag_data->count   = 1;
@@ -293,7 +350,9 @@ static void PIOS_MPU9250_Config(struct pios_mpu9250_cfg const *cfg)
         ;
     }
 
-    while (PIOS_MPU9250_SetReg(PIOS_MPU9250_USER_CTRL_REG, cfg->User_ctl) != 0) {
+    // the burst mode starts from an empty FIFO
+    while (PIOS_MPU9250_SetReg(PIOS_MPU9250_USER_CTRL_REG, cfg->User_ctl |
+                               (cfg->fifo_burst ? PIOS_MPU9250_USERCTL_FIFO_EN | PIOS_MPU9250_USERCTL_FIFO_RST : 0)) != 0) {
         ;
     }
 
@@ -305,7 +364,7 @@ static void PIOS_MPU9250_Config(struct pios_mpu9250_cfg const *cfg)
     power &= ~PIOS_MPU9250_PWRMGMT2_DISABLE_ACCEL;
 #endif
 
-    while (PIOS_MPU9250_SetReg(PIOS_MPU9250_FIFO_EN_REG, cfg->Fifo_store) != 0) {
+    while (PIOS_MPU9250_SetReg(PIOS_MPU9250_FIFO_EN_REG, cfg->fifo_burst ? PIOS_MPU9250_FIFO_BURST_STORE : cfg->Fifo_store) != 0) {
         ;
     }
     PIOS_MPU9250_SetReg(PIOS_MPU9250_PWR_MGMT2_REG, power);
@@ -805,6 +864,29 @@ static bool PIOS_MPU9250_ReadMag(bool *woken)
 
     return true;
 }
+
+/**
+ * @brief Read the mag registers copied by the I2C master, in the burst mode
+ * \return true if data has been read from mpu
+ * \return false on error
+ */
+static bool PIOS_MPU9250_ReadMagSample(bool *woken)
+{
+    const uint8_t mag_send_buf[1 + sizeof(mpu9250_mag_sample_t)] = { PIOS_MPU9250_EXT_SENS_DATA_00 | 0x80 };
+    uint8_t mag_buf[1 + sizeof(mpu9250_mag_sample_t)];
+
+    if (PIOS_MPU9250_ClaimBusISR(woken, true) != 0) {
+        return false;
+    }
+    if (PIOS_SPI_TransferBlock(dev->spi_id, &mag_send_buf[0], &mag_buf[0], sizeof(mag_buf), NULL) < 0) {
+        PIOS_MPU9250_ReleaseBusISR(woken);
+        return false;
+    }
+    PIOS_MPU9250_ReleaseBusISR(woken);
+
+    PIOS_MPU9250_ConvertMag((const mpu9250_mag_sample_t *)&mag_buf[1]);
+    return true;
+}
 #endif /* if defined(PIOS_MPU9250_MAG) */
 
 /**
@@ -821,6 +903,27 @@ bool PIOS_MPU9250_IRQHandler(void)
         return false;
     }
 
+    if (dev->cfg->fifo_burst) {
+        // The chip has no FIFO watermark interrupt, so the data ready
+        // interrupts are counted and the FIFO is read every fifo_burst samples
+        if (++fifo_pending < dev->cfg->fifo_burst) {
+            return false;
+        }
+        fifo_pending = 0;
+
+#if defined(PIOS_MPU9250_MAG)
+        // the mag sample requested on the previous burst
+        PIOS_MPU9250_ReadMagSample(&woken);
+        PIOS_MPU9250_ReadMag(&woken);
+#endif
+        uint16_t samples = PIOS_MPU9250_ReadFifo(&woken);
+        if (samples) {
+            bool woken2 = PIOS_MPU9250_HandleBatch(samples);
+            woken |= woken2;
+        }
+        return woken;
+    }
+
 #if defined(PIOS_MPU9250_MAG)
     PIOS_MPU9250_ReadMag(&woken);
 #endif
@@ -836,92 +939,103 @@ bool PIOS_MPU9250_IRQHandler(void)
     return woken;
 }
 
-static bool PIOS_MPU9250_HandleData()
+/**
+ * @brief Rotate one accel/gyro sample to the board frame
+ * @return temperature in degrees C * 100
+ */
+static int16_t PIOS_MPU9250_ConvertSample(const mpu9250_sample_t *sample, __attribute__((unused)) Vector3i16 *accel, Vector3i16 *gyro)
 {
     // Rotate the sensor to OP convention.  The datasheet defines X as towards the right
     // and Y as forward.  OP convention transposes this.  Also the Z is defined negatively
     // to our convention
-    if (!queue_data) {
-        return false;
-    }
-
-#ifdef PIOS_MPU9250_MAG
-    bool mag_valid = mpu9250_data.data.st1 & PIOS_MPU9250_MAG_DATA_RDY;
-#endif
 
     // Currently we only support rotations on top so switch X/Y accordingly
     switch (dev->cfg->orientation) {
     case PIOS_MPU9250_TOP_0DEG:
 #ifdef PIOS_MPU9250_ACCEL
-        queue_data->sample[0].y = GET_SENSOR_DATA(mpu9250_data, Accel_X); // chip X
-        queue_data->sample[0].x = GET_SENSOR_DATA(mpu9250_data, Accel_Y); // chip Y
-#endif
-        queue_data->sample[1].y = GET_SENSOR_DATA(mpu9250_data, Gyro_X); // chip X
-        queue_data->sample[1].x = GET_SENSOR_DATA(mpu9250_data, Gyro_Y); // chip Y
-#ifdef PIOS_MPU9250_MAG
-        if (mag_valid) {
-            mag_data->sample[0].y = GET_SENSOR_DATA(mpu9250_data, Mag_Y) * dev->mag_sens_adj[1]; // chip Y
-            mag_data->sample[0].x = GET_SENSOR_DATA(mpu9250_data, Mag_X) * dev->mag_sens_adj[0]; // chip X
-        }
+        accel->y = GET_SENSOR_DATA(sample, Accel_X); // chip X
+        accel->x = GET_SENSOR_DATA(sample, Accel_Y); // chip Y
 #endif
+        gyro->y  = GET_SENSOR_DATA(sample, Gyro_X); // chip X
+        gyro->x  = GET_SENSOR_DATA(sample, Gyro_Y); // chip Y
         break;
     case PIOS_MPU9250_TOP_90DEG:
         // -1 to bring it back to -32768 +32767 range
 #ifdef PIOS_MPU9250_ACCEL
-        queue_data->sample[0].y = -1 - (GET_SENSOR_DATA(mpu9250_data, Accel_Y)); // chip Y
-        queue_data->sample[0].x = GET_SENSOR_DATA(mpu9250_data, Accel_X); // chip X
-#endif
-        queue_data->sample[1].y = -1 - (GET_SENSOR_DATA(mpu9250_data, Gyro_Y)); // chip Y
-        queue_data->sample[1].x = GET_SENSOR_DATA(mpu9250_data, Gyro_X); // chip X
-#ifdef PIOS_MPU9250_MAG
-        if (mag_valid) {
-            mag_data->sample[0].y = GET_SENSOR_DATA(mpu9250_data, Mag_X) * dev->mag_sens_adj[0]; // chip X
-            mag_data->sample[0].x = -1 - (GET_SENSOR_DATA(mpu9250_data, Mag_Y)) * dev->mag_sens_adj[1]; // chip Y
-        }
-
+        accel->y = -1 - (GET_SENSOR_DATA(sample, Accel_Y)); // chip Y
+        accel->x = GET_SENSOR_DATA(sample, Accel_X); // chip X
 #endif
+        gyro->y  = -1 - (GET_SENSOR_DATA(sample, Gyro_Y)); // chip Y
+        gyro->x  = GET_SENSOR_DATA(sample, Gyro_X); // chip X
         break;
     case PIOS_MPU9250_TOP_180DEG:
 #ifdef PIOS_MPU9250_ACCEL
-        queue_data->sample[0].y = -1 - (GET_SENSOR_DATA(mpu9250_data, Accel_X)); // chip X
-        queue_data->sample[0].x = -1 - (GET_SENSOR_DATA(mpu9250_data, Accel_Y)); // chip Y
-#endif
-        queue_data->sample[1].y = -1 - (GET_SENSOR_DATA(mpu9250_data, Gyro_X)); // chip X
-        queue_data->sample[1].x = -1 - (GET_SENSOR_DATA(mpu9250_data, Gyro_Y)); // chip Y
-#ifdef PIOS_MPU9250_MAG
-        if (mag_valid) {
-            mag_data->sample[0].y = -1 - (GET_SENSOR_DATA(mpu9250_data, Mag_Y)) * dev->mag_sens_adj[1]; // chip Y
-            mag_data->sample[0].x = -1 - (GET_SENSOR_DATA(mpu9250_data, Mag_X)) * dev->mag_sens_adj[0]; // chip X
-        }
+        accel->y = -1 - (GET_SENSOR_DATA(sample, Accel_X)); // chip X
+        accel->x = -1 - (GET_SENSOR_DATA(sample, Accel_Y)); // chip Y
 #endif
+        gyro->y  = -1 - (GET_SENSOR_DATA(sample, Gyro_X)); // chip X
+        gyro->x  = -1 - (GET_SENSOR_DATA(sample, Gyro_Y)); // chip Y
         break;
     case PIOS_MPU9250_TOP_270DEG:
 #ifdef PIOS_MPU9250_ACCEL
-        queue_data->sample[0].y = GET_SENSOR_DATA(mpu9250_data, Accel_Y); // chip Y
-        queue_data->sample[0].x = -1 - (GET_SENSOR_DATA(mpu9250_data, Accel_X)); // chip X
-#endif
-        queue_data->sample[1].y = GET_SENSOR_DATA(mpu9250_data, Gyro_Y); // chip Y
-        queue_data->sample[1].x = -1 - (GET_SENSOR_DATA(mpu9250_data, Gyro_X)); // chip X
-#ifdef PIOS_MPU9250_MAG
-        if (mag_valid) {
-            mag_data->sample[0].y = -1 - (GET_SENSOR_DATA(mpu9250_data, Mag_X)) * dev->mag_sens_adj[0]; // chip X
-            mag_data->sample[0].x = GET_SENSOR_DATA(mpu9250_data, Mag_Y) * dev->mag_sens_adj[1]; // chip Y
-        }
+        accel->y = GET_SENSOR_DATA(sample, Accel_Y); // chip Y
+        accel->x = -1 - (GET_SENSOR_DATA(sample, Accel_X)); // chip X
 #endif
+        gyro->y  = GET_SENSOR_DATA(sample, Gyro_Y); // chip Y
+        gyro->x  = -1 - (GET_SENSOR_DATA(sample, Gyro_X)); // chip X
         break;
     }
 #ifdef PIOS_MPU9250_ACCEL
-    queue_data->sample[0].z = -1 - (GET_SENSOR_DATA(mpu9250_data, Accel_Z));
+    accel->z = -1 - (GET_SENSOR_DATA(sample, Accel_Z));
 #endif
-    queue_data->sample[1].z = -1 - (GET_SENSOR_DATA(mpu9250_data, Gyro_Z));
-    const int16_t temp = GET_SENSOR_DATA(mpu9250_data, Temperature);
-    queue_data->temperature = 2100 + ((float)(temp - PIOS_MPU9250_TEMP_OFFSET)) * (100.0f / PIOS_MPU9250_TEMP_SENSITIVITY);
-    mag_data->temperature   = queue_data->temperature;
+    gyro->z  = -1 - (GET_SENSOR_DATA(sample, Gyro_Z));
+    const int16_t temp = GET_SENSOR_DATA(sample, Temperature);
+    return 2100 + ((float)(temp - PIOS_MPU9250_TEMP_OFFSET)) * (100.0f / PIOS_MPU9250_TEMP_SENSITIVITY);
+}
+
 #ifdef PIOS_MPU9250_MAG
-    if (mag_valid) {
-        mag_data->sample[0].z = GET_SENSOR_DATA(mpu9250_data, Mag_Z) * dev->mag_sens_adj[2]; // chip Z
-        mag_ready = true;
+/**
+ * @brief Rotate the mag sample to the board frame when it holds new data
+ */
+static void PIOS_MPU9250_ConvertMag(const mpu9250_mag_sample_t *mag)
+{
+    if (!(mag->st1 & PIOS_MPU9250_MAG_DATA_RDY)) {
+        return;
+    }
+
+    switch (dev->cfg->orientation) {
+    case PIOS_MPU9250_TOP_0DEG:
+        mag_data->sample[0].y = GET_SENSOR_DATA(mag, Mag_Y) * dev->mag_sens_adj[1]; // chip Y
+        mag_data->sample[0].x = GET_SENSOR_DATA(mag, Mag_X) * dev->mag_sens_adj[0]; // chip X
+        break;
+    case PIOS_MPU9250_TOP_90DEG:
+        mag_data->sample[0].y = GET_SENSOR_DATA(mag, Mag_X) * dev->mag_sens_adj[0]; // chip X
+        mag_data->sample[0].x = -1 - (GET_SENSOR_DATA(mag, Mag_Y)) * dev->mag_sens_adj[1]; // chip Y
+        break;
+    case PIOS_MPU9250_TOP_180DEG:
+        mag_data->sample[0].y = -1 - (GET_SENSOR_DATA(mag, Mag_Y)) * dev->mag_sens_adj[1]; // chip Y
+        mag_data->sample[0].x = -1 - (GET_SENSOR_DATA(mag, Mag_X)) * dev->mag_sens_adj[0]; // chip X
+        break;
+    case PIOS_MPU9250_TOP_270DEG:
+        mag_data->sample[0].y = -1 - (GET_SENSOR_DATA(mag, Mag_X)) * dev->mag_sens_adj[0]; // chip X
+        mag_data->sample[0].x = GET_SENSOR_DATA(mag, Mag_Y) * dev->mag_sens_adj[1]; // chip Y
+        break;
     }
+    mag_data->sample[0].z = GET_SENSOR_DATA(mag, Mag_Z) * dev->mag_sens_adj[2]; // chip Z
+    mag_ready = true;
+}
+#endif /* PIOS_MPU9250_MAG */
+
+static bool PIOS_MPU9250_HandleData()
+{
+    if (!queue_data) {
+        return false;
+    }
+
+    queue_data->temperature = PIOS_MPU9250_ConvertSample(&mpu9250_data.data.sample, &queue_data->sample[0], &queue_data->sample[1]);
+    mag_data->temperature   = queue_data->temperature;
+#ifdef PIOS_MPU9250_MAG
+    PIOS_MPU9250_ConvertMag(&mpu9250_data.data.mag);
 #endif
 
     BaseType_t higherPriorityTaskWoken;
@@ -929,6 +1043,25 @@ static bool PIOS_MPU9250_HandleData()
     return higherPriorityTaskWoken == pdTRUE;
 }
 
+static bool PIOS_MPU9250_HandleBatch(uint16_t samples)
+{
+    if (!batch_data) {
+        return false;
+    }
+
+    const mpu9250_sample_t *sample = (const mpu9250_sample_t *)&fifo_data[1];
+    for (uint16_t i = 0; i < samples; i++, sample++) {
+        batch_data->temperature = PIOS_MPU9250_ConvertSample(sample, &batch_data->sample[2 * i], &batch_data->sample[2 * i + 1]);
+    }
+    batch_data->samples     = samples;
+    batch_data->timestamp   = PIOS_DELAY_GetRaw();
+    mag_data->temperature   = batch_data->temperature;
+
+    BaseType_t higherPriorityTaskWoken;
+    xQueueSendToBackFromISR(dev->queue, batch_data, &higherPriorityTaskWoken);
+    return higherPriorityTaskWoken == pdTRUE;
+}
+
 static bool PIOS_MPU9250_ReadSensor(bool *woken)
 {
     const uint8_t mpu9250_send_buf[1 + PIOS_MPU9250_SAMPLES_BYTES] = { PIOS_MPU9250_SENSOR_FIRST_REG | 0x80 };
@@ -944,6 +1077,55 @@ static bool PIOS_MPU9250_ReadSensor(bool *woken)
     return true;
 }
 
+/**
+ * @brief Read the complete samples collected in the FIFO, up to PIOS_SENSORS_MAX_BATCH
+ * @return number of samples in fifo_data
+ */
+static uint16_t PIOS_MPU9250_ReadFifo(bool *woken)
+{
+    static const uint8_t fifo_send_buf[1 + PIOS_MPU9250_FIFO_BURST_BYTES] = { PIOS_MPU9250_FIFO_REG | 0x80 };
+    const uint8_t count_send_buf[3] = { PIOS_MPU9250_FIFO_CNT_MSB | 0x80 };
+    uint8_t count_buf[3];
+
+    if (PIOS_MPU9250_ClaimBusISR(woken, true) != 0) {
+        return 0;
+    }
+    if (PIOS_SPI_TransferBlock(dev->spi_id, &count_send_buf[0], &count_buf[0], sizeof(count_buf), NULL) < 0) {
+        PIOS_MPU9250_ReleaseBusISR(woken);
+        return 0;
+    }
+    PIOS_MPU9250_ReleaseBusISR(woken);
+
+    uint16_t fifo_bytes = (count_buf[1] & 0x1f) << 8 | count_buf[2];
+    if (fifo_bytes % PIOS_MPU9250_FRAME_BYTES || fifo_bytes > PIOS_MPU9250_FIFO_SIZE - PIOS_MPU9250_FRAME_BYTES) {
+        // Overflowed, the frames are no longer aligned: start over from an empty FIFO
+        if (PIOS_MPU9250_ClaimBusISR(woken, false) == 0) {
+            PIOS_SPI_TransferByte(dev->spi_id, 0x7f & PIOS_MPU9250_USER_CTRL_REG);
+            PIOS_SPI_TransferByte(dev->spi_id, dev->cfg->User_ctl | PIOS_MPU9250_USERCTL_FIFO_EN | PIOS_MPU9250_USERCTL_FIFO_RST);
+            PIOS_MPU9250_ReleaseBusISR(woken);
+        }
+        return 0;
+    }
+
+    uint16_t samples = fifo_bytes / PIOS_MPU9250_FRAME_BYTES;
+    if (samples > PIOS_SENSORS_MAX_BATCH) {
+        samples = PIOS_SENSORS_MAX_BATCH;
+    }
+    if (!samples) {
+        return 0;
+    }
+
+    if (PIOS_MPU9250_ClaimBusISR(woken, true) != 0) {
+        return 0;
+    }
+    if (PIOS_SPI_TransferBlock(dev->spi_id, &fifo_send_buf[0], &fifo_data[0], 1 + samples * PIOS_MPU9250_FRAME_BYTES, NULL) < 0) {
+        PIOS_MPU9250_ReleaseBusISR(woken);
+        return 0;
+    }
+    PIOS_MPU9250_ReleaseBusISR(woken);
+    return samples;
+}
+
 // Sensor driver implementation
 bool PIOS_MPU9250_Main_driver_Test(__attribute__((unused)) uintptr_t context)
 {
@@ -35,7 +35,6 @@
 // Define to report number of frames since last dropped instead of weighted ave
 #undef SBUS_GOOD_FRAME_COUNT
 
-#include <uavobjectmanager.h>
 #include "pios_sbus_priv.h"
 
 /* Forward Declarations */
@@ -330,7 +329,7 @@ static uint16_t PIOS_SBus_RxInCallback(uint32_t context,
     struct pios_sbus_state *state = &(sbus_dev->state);
 
     /* process byte(s) and clear receive timer */
-    for (uint8_t i = 0; i < buf_len; i++) {
+    for (uint16_t i = 0; i < buf_len; i++) {
         PIOS_SBus_UpdateState(state, buf[i]);
         state->receive_timer = 0;
     }
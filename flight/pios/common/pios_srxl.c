@@ -74,6 +74,7 @@ struct pios_srxl_state {
     uint8_t  frame_found;
     uint8_t  byte_count;
     uint8_t  data_bytes;
+    uint16_t crc;
 };
 
 struct pios_srxl_dev {
@@ -216,27 +217,21 @@ static void PIOS_SRXL_UnrollChannels(struct pios_srxl_state *state)
     PERF_TIMED_SECTION_END(messageUnrollTimer);
 }
 
-static bool PIOS_SRXL_Validate_Checksum(struct pios_srxl_state *state)
+/**
+ * CRC16-CCITT (polynomial 0x1021, MSB first) of one more byte. Updated as the
+ * bytes come in so that the end of a frame costs the same as any other byte.
+ * All data including start byte and version byte is included in crc calculation,
+ * and so is the checksum itself, which leaves 0 for a valid frame.
+ */
+static uint16_t PIOS_SRXL_CRC_Update(uint16_t crc, uint8_t data)
 {
-    // Check the CRC16 checksum. The provided checksum is immediately after the channel data.
-    // All data including start byte and version byte is included in crc calculation.
-    uint8_t i    = 0;
-    uint16_t crc = 0;
-
-    for (i = 0; i < SRXL_HEADER_LENGTH + state->data_bytes; i++) {
-        crc = crc ^ (int16_t)state->received_data[i] << 8;
-        uint8_t j = 0;
-        for (j = 0; j < 8; j++) {
-            if (crc & 0x8000) {
-                crc = crc << 1 ^ 0x1021;
-            } else {
-                crc = crc << 1;
-            }
-        }
-    }
-    uint16_t checksum = (((uint16_t)(state->received_data[i] << 8) |
-                          (uint16_t)state->received_data[i + 1]));
-    return crc == checksum;
+    crc  = (crc >> 8) | (crc << 8);
+    crc ^= data;
+    crc ^= (crc & 0xff) >> 4;
+    crc ^= crc << 12;
+    crc ^= (crc & 0xff) << 5;
+
+    return crc;
 }
 
 /* Update decoder state processing input byte from the SRXL stream */
@@ -261,14 +256,16 @@ static void PIOS_SRXL_UpdateState(struct pios_srxl_state *state, uint8_t b)
                 PERF_INCREMENT_VALUE(frameAbortCount);
                 return;
             }
+            state->crc = 0;
         }
         /* store next byte */
         state->received_data[state->byte_count] = b;
         state->byte_count++;
+        state->crc = PIOS_SRXL_CRC_Update(state->crc, b);
         if (state->byte_count == (SRXL_HEADER_LENGTH + state->data_bytes + SRXL_CHECKSUM_LENGTH)) {
             PERF_INCREMENT_VALUE(completeMessageCount);
             // We have a complete message, lets decode it
-            if (PIOS_SRXL_Validate_Checksum(state)) {
+            if (state->crc == 0) {
                 /* data looking good */
                 PIOS_SRXL_UnrollChannels(state);
                 state->failsafe_timer = 0;
@@ -300,7 +297,7 @@ static uint16_t PIOS_SRXL_RxInCallback(uint32_t context,
     struct pios_srxl_state *state = &(srxl_dev->state);
 
     /* process byte(s) and clear receive timer */
-    for (uint8_t i = 0; i < buf_len; i++) {
+    for (uint16_t i = 0; i < buf_len; i++) {
         PIOS_SRXL_UpdateState(state, buf[i]);
         state->receive_timer = 0;
         PERF_INCREMENT_VALUE(receivedBytesCount);
@@ -105,6 +105,22 @@ bool PIOS_TASK_MONITOR_IsRunning(uint16_t task_id)
     return mTaskHandles && task_id <= mMaxTasks && mTaskHandles[task_id];
 }
 
+/**
+ * Find the task_id of a registered task handle
+ */
+int32_t PIOS_TASK_MONITOR_GetTaskId(xTaskHandle handle)
+{
+    if (!mTaskHandles || !handle) {
+        return -1;
+    }
+    for (uint16_t n = 0; n < mMaxTasks; ++n) {
+        if (mTaskHandles[n] == handle) {
+            return n;
+        }
+    }
+    return -1;
+}
+
 /**
  * Tell the caller the status of all tasks via a task-by-task callback
  */
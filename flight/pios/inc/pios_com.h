@@ -68,6 +68,9 @@ extern int32_t PIOS_COM_SendString(uint32_t com_id, const char *str);
 extern int32_t PIOS_COM_SendFormattedStringNonBlocking(uint32_t com_id, const char *format, ...);
 extern int32_t PIOS_COM_SendFormattedString(uint32_t com_id, const char *format, ...);
 extern uint16_t PIOS_COM_ReceiveBuffer(uint32_t com_id, uint8_t *buf, uint16_t buf_len, uint32_t timeout_ms);
+extern uint16_t PIOS_COM_ReceiveBufferRef(uint32_t com_id, const uint8_t **buf, uint32_t timeout_ms);
+extern void PIOS_COM_ReceiveBufferRelease(uint32_t com_id, uint16_t len);
+extern int32_t PIOS_COM_ForwardBuffer(uint32_t rx_com_id, uint32_t tx_com_id, uint32_t timeout_ms);
 extern bool PIOS_COM_Available(uint32_t com_id);
 
 #endif /* PIOS_COM_H */
@@ -29,12 +29,31 @@
 #include <pios_debug.h>
 #include <pios_delay.h>
 #include <FreeRTOS.h>
+#include <task.h>
+
+/* Number of log2 buckets of the counter histograms, bucket 0 holds values
+ * <= 0 and bucket n values in [2^(n-1), 2^n), the last one everything above */
+#define PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS 16
+
+typedef enum {
+    PIOS_PERF_COUNTER_VALUE     = 0,
+    PIOS_PERF_COUNTER_DURATION  = 1,
+    PIOS_PERF_COUNTER_PERIOD    = 2,
+    PIOS_PERF_COUNTER_INCREMENT = 3,
+} pios_perf_counter_type_t;
+
 typedef struct {
-    uint32_t id;
-    int32_t  max;
-    int32_t  min;
-    int32_t  value;
-    uint32_t lastUpdateTS;
+    uint32_t    id;
+    int32_t     max;
+    int32_t     min;
+    int32_t     value;
+    uint32_t    lastUpdateTS;
+    /* statistics since the last snapshot, @see PIOS_Instrumentation_ForEachSnapshot */
+    uint32_t    total;
+    uint16_t    count;
+    uint16_t    histogram[PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS];
+    uint8_t     type;
+    xTaskHandle task; // task that recorded the last sample
 } pios_perf_counter_t;
 
 typedef void *pios_counter_t;
@@ -42,6 +61,31 @@ typedef void *pios_counter_t;
 extern pios_perf_counter_t *pios_instrumentation_perf_counters;
 extern int8_t pios_instrumentation_last_used_counter;
 
+/**
+ * Add a sample to the statistics of a counter, must be called in a critical section
+ * @param counter the counter to update
+ * @param type the kind of sample
+ * @param sample the sample value
+ */
+static inline void PIOS_Instrumentation_recordSample(pios_perf_counter_t *counter, pios_perf_counter_type_t type, int32_t sample)
+{
+    uint32_t magnitude = sample > 0 ? (uint32_t)sample : 0;
+    uint8_t bucket     = magnitude ? 32 - __builtin_clz(magnitude) : 0;
+
+    if (bucket >= PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS) {
+        bucket = PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS - 1;
+    }
+    if (counter->histogram[bucket] < UINT16_MAX) {
+        counter->histogram[bucket]++;
+    }
+    if (counter->count < UINT16_MAX) {
+        counter->count++;
+    }
+    counter->total += magnitude;
+    counter->type   = type;
+    counter->task   = xTaskGetCurrentTaskHandle();
+}
+
 /**
  * Update a counter with a new value
  * @param counter_handle handle of the counter to update @see PIOS_Instrumentation_SearchCounter @see PIOS_Instrumentation_CreateCounter
@@ -53,6 +97,7 @@ static inline void PIOS_Instrumentation_updateCounter(pios_counter_t counter_han
     vPortEnterCritical();
     pios_perf_counter_t *counter = (pios_perf_counter_t *)counter_handle;
     counter->value = newValue;
+    PIOS_Instrumentation_recordSample(counter, PIOS_PERF_COUNTER_VALUE, newValue);
     counter->max--;
     if (counter->value > counter->max) {
         counter->max = counter->value;
@@ -90,6 +135,7 @@ static inline void PIOS_Instrumentation_TimeEnd(pios_counter_t counter_handle)
     pios_perf_counter_t *counter = (pios_perf_counter_t *)counter_handle;
 
     counter->value = PIOS_DELAY_DiffuS(counter->lastUpdateTS);
+    PIOS_Instrumentation_recordSample(counter, PIOS_PERF_COUNTER_DURATION, counter->value);
     counter->max--;
     if (counter->value > counter->max) {
         counter->max = counter->value;
@@ -114,6 +160,7 @@ static inline void PIOS_Instrumentation_TrackPeriod(pios_counter_t counter_handl
         vPortEnterCritical();
         uint32_t period = PIOS_DELAY_DiffuS(counter->lastUpdateTS);
         counter->value = (counter->value * 15 + period) / 16;
+        PIOS_Instrumentation_recordSample(counter, PIOS_PERF_COUNTER_PERIOD, period);
         counter->max--;
         if ((int32_t)period > counter->max) {
             counter->max = period;
@@ -138,6 +185,7 @@ static inline void PIOS_Instrumentation_incrementCounter(pios_counter_t counter_
     vPortEnterCritical();
     pios_perf_counter_t *counter = (pios_perf_counter_t *)counter_handle;
     counter->value += increment;
+    PIOS_Instrumentation_recordSample(counter, PIOS_PERF_COUNTER_INCREMENT, increment);
     counter->max--;
     if (counter->value > counter->max) {
         counter->max = counter->value;
@@ -179,4 +227,12 @@ typedef void (*InstrumentationCounterCallback)(const pios_perf_counter_t *counte
  */
 void PIOS_Instrumentation_ForEachCounter(InstrumentationCounterCallback callback, void *context);
 
+/**
+ * Execute the passed callback for a copy of each counter and restart the
+ * statistics (total, count and histogram) of the counter
+ * @param callback to be called for each counter snapshot
+ * @param context a context variable pointer that can be passed to the callback
+ */
+void PIOS_Instrumentation_ForEachSnapshot(InstrumentationCounterCallback callback, void *context);
+
 #endif /* PIOS_INSTRUMENTATION_H */
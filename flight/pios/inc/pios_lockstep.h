@@ -0,0 +1,52 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_lockstep.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Lockstep simulated time for the posix simulation.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_LOCKSTEP_H
+#define PIOS_LOCKSTEP_H
+
+/*
+ * Step protocol on the lockstep UDP port, one struct per datagram in host
+ * byte order. The simulator sends a step, the firmware runs until all tasks
+ * are blocked at untilUs and answers with a report. Everything the firmware
+ * sent over the other UDP ports up to then is in the simulator's socket
+ * buffers before the report arrives, and everything the simulator sent before
+ * the step is read by the firmware within the first tick of it.
+ */
+struct pios_lockstep_step {
+    uint64_t untilUs; // run until this simulated time
+};
+
+struct pios_lockstep_report {
+    uint64_t timeUs; // simulated time reached
+    uint64_t runNs; // host time spent running tasks since the last report
+};
+
+/* Public Functions */
+extern int32_t PIOS_LOCKSTEP_Init(uint16_t port);
+extern bool PIOS_LOCKSTEP_Enabled(void);
+extern uint32_t PIOS_LOCKSTEP_GetuS(void);
+extern void PIOS_LOCKSTEP_Busy(uint32_t uS);
+
+#endif /* PIOS_LOCKSTEP_H */
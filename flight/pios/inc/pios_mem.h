@@ -28,6 +28,8 @@
 #define PIOS_MEM_H
 #include <strings.h>
 
+void pios_mem_init(void);
+
 void *pios_fastheapmalloc(size_t size);
 
 void *pios_malloc(size_t size);
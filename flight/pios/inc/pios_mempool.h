@@ -0,0 +1,96 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_mempool.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup PiOS
+ * @{
+ * @addtogroup PiOS
+ * @{
+ * @brief Fixed size block pools behind pios_malloc
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef PIOS_MEMPOOL_H
+#define PIOS_MEMPOOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define PIOS_MEMPOOL_MAX_CLASSES 6
+// alignment of every block, as the heap guarantees
+#define PIOS_MEMPOOL_ALIGN       8
+
+/**
+ * One size class: a number of blocks of the same size. The classes are
+ * given by increasing block size.
+ */
+struct pios_mempool_class {
+    uint16_t block_size;
+    uint16_t blocks;
+};
+
+struct pios_mempool_stats {
+    uint16_t block_size;
+    uint16_t blocks;
+    uint16_t used;
+    uint16_t max_used; // high water mark since the pool was initialised
+    uint16_t failed; // requests that found the class exhausted
+};
+
+/**
+ * @brief Memory needed for the blocks of the given classes
+ */
+size_t PIOS_MEMPOOL_ArenaSize(const struct pios_mempool_class *classes, uint8_t num_classes);
+
+/**
+ * @brief Carve the arena into the blocks of each class
+ * @param[in] arena PIOS_MEMPOOL_ArenaSize() bytes, aligned to PIOS_MEMPOOL_ALIGN
+ * @return 0 on success, -1 for an invalid class table
+ */
+int32_t PIOS_MEMPOOL_Init(const struct pios_mempool_class *classes, uint8_t num_classes, void *arena);
+
+/**
+ * @brief Take a block from the smallest class that fits, in constant time
+ * @return the block, or NULL when the request is larger than every class
+ *         or its class is exhausted; the caller then falls back to the heap
+ */
+void *PIOS_MEMPOOL_Alloc(size_t size);
+
+/**
+ * @brief Return a block to its class, in constant time
+ * @return true if ptr was a pool block, false if it belongs to the heap
+ */
+bool PIOS_MEMPOOL_Free(void *ptr);
+
+/**
+ * @return size of the block ptr points to, 0 if it is not a pool block
+ */
+size_t PIOS_MEMPOOL_BlockSize(const void *ptr);
+
+/**
+ * @brief Copy the statistics of each class
+ * @return number of classes written to stats
+ */
+uint8_t PIOS_MEMPOOL_GetStats(struct pios_mempool_stats *stats, uint8_t max_classes);
+
+#endif /* PIOS_MEMPOOL_H */
+
+/**
+ * @}
+ * @}
+ */
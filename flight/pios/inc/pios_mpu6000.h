@@ -69,6 +69,7 @@
 #define PIOS_MPU6000_FIFO_GYRO_Y_OUT          0x20
 #define PIOS_MPU6000_FIFO_GYRO_Z_OUT          0x10
 #define PIOS_MPU6000_ACCEL_OUT                0x08
+#define PIOS_MPU6000_FIFO_SIZE                1024
 
 /* Interrupt Configuration */
 #define PIOS_MPU6000_INT_ACTL                 0x80
@@ -151,6 +152,7 @@ struct pios_mpu6000_cfg {
     SPIPrescalerTypeDef fast_prescaler;
     SPIPrescalerTypeDef std_prescaler;
     uint8_t max_downsample;
+    uint8_t fifo_burst; /* Samples collected in the FIFO and read in one transfer, 0 to read every sample (up to PIOS_SENSORS_MAX_BATCH) */
 };
 
 /* Public Functions */
@@ -86,6 +86,7 @@
 #define PIOS_MPU9250_FIFO_GYRO_Y_OUT          0x20
 #define PIOS_MPU9250_FIFO_GYRO_Z_OUT          0x10
 #define PIOS_MPU9250_ACCEL_OUT                0x08
+#define PIOS_MPU9250_FIFO_SIZE                512
 
 /* Interrupt Configuration */
 #define PIOS_MPU9250_INT_ACTL                 0x80
@@ -232,6 +233,7 @@ struct pios_mpu9250_cfg {
     SPIPrescalerTypeDef fast_prescaler;
     SPIPrescalerTypeDef std_prescaler;
     uint8_t max_downsample;
+    uint8_t fifo_burst; /* Samples collected in the FIFO and read in one transfer, 0 to read every sample (up to PIOS_SENSORS_MAX_BATCH) */
 };
 
 /* Public Functions */
@@ -51,6 +51,7 @@ typedef struct PIOS_SENSORS_Driver {
     PIOS_SENSORS_get_queue_function get_queue; // get the queue reference
     PIOS_SENSORS_get_scale_function get_scale; // return scales for the sensors
     bool is_polled;
+    bool is_batched; // the queue carries PIOS_SENSORS_3Axis_SensorsBatch items
 } PIOS_SENSORS_Driver;
 
 typedef enum PIOS_SENSORS_TYPE {
@@ -81,6 +82,21 @@ typedef struct PIOS_SENSORS_3Axis_SensorsWithTemp {
     Vector3i16 sample[];
 } PIOS_SENSORS_3Axis_SensorsWithTemp;
 
+/**
+ * A batch of 3d samples with temperature, read from a sensor FIFO in one transfer.
+ * sample[] holds count vectors for each sample, oldest sample first.
+ */
+typedef struct PIOS_SENSORS_3Axis_SensorsBatch {
+    uint16_t   count; // number of sensor instances
+    uint16_t   samples; // number of samples of each instance
+    uint32_t   timestamp; // PIOS_DELAY_GetRaw() when the transfer completed
+    int16_t    temperature;  // Degrees Celsius * 100, of the latest sample
+    Vector3i16 sample[];
+} PIOS_SENSORS_3Axis_SensorsBatch;
+
+// Largest number of samples in a batch
+#define PIOS_SENSORS_MAX_BATCH 16
+
 typedef struct PIOS_SENSORS_1Axis_SensorsWithTemp {
     float temperature; // Degrees Celsius
     float sample; // sample
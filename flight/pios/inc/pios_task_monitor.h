@@ -74,6 +74,14 @@ extern int32_t PIOS_TASK_MONITOR_UnregisterTask(uint16_t task_id);
  */
 extern bool PIOS_TASK_MONITOR_IsRunning(uint16_t task_id);
 
+/**
+ * Looks up the task monitor id of a task.
+ *
+ * @param handle The FreeRTOS xTaskHandle of the task.
+ * @return the task_id the task was registered with, -1 if it is not monitored.
+ */
+extern int32_t PIOS_TASK_MONITOR_GetTaskId(xTaskHandle handle);
+
 /**
  * Information about a running task that has been registered
  * via a call to PIOS_TASK_MONITOR_Add().
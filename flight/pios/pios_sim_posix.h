@@ -73,6 +73,9 @@
 /* PIOS Hardware Includes (posix) */
 #include <pios_sys.h>
 #include <pios_delay.h>
+#ifdef PIOS_INCLUDE_LOCKSTEP
+#include <pios_lockstep.h>
+#endif
 #include <pios_led.h>
 /* FIXME: simposix needs its own custom include directory into
  * which a custom pios_led.h can be put that includes the following
@@ -0,0 +1,166 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_lockstep.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Lockstep simulated time for the posix simulation
+ *                 - Drives the FreeRTOS tick and PIOS_DELAY from a virtual clock
+ *                 - Optionally waits for a simulator to grant each step over UDP
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   PIOS_LOCKSTEP Lockstep Functions
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/* Project Includes */
+#include "pios.h"
+
+#if defined(PIOS_INCLUDE_LOCKSTEP)
+
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+static bool enabled;
+static int lockstepSocket = -1;
+static struct sockaddr_in simulator;
+static bool simulatorKnown;
+static uint64_t grantedUs;
+static uint64_t runNs;
+static uint64_t lastTickNs;
+
+/* busy waits of the running task within the current tick */
+static TickType_t busyTick;
+static uint32_t busyUs;
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * Called by the FreeRTOS port from the idle task before each tick, once all
+ * other tasks are blocked. Blocks until the simulator has granted the tick.
+ */
+static void lockstepGate(TickType_t nextTick)
+{
+    uint64_t now    = nowNs();
+    uint64_t nextUs = (uint64_t)nextTick * portTICK_RATE_MICROSECONDS;
+
+    if (lastTickNs) {
+        runNs += now - lastTickNs;
+    }
+
+    while (lockstepSocket >= 0 && nextUs > grantedUs) {
+        if (simulatorKnown) {
+            struct pios_lockstep_report report = {
+                .timeUs = nextUs - portTICK_RATE_MICROSECONDS,
+                .runNs  = runNs,
+            };
+            sendto(lockstepSocket, &report, sizeof(report), 0, (struct sockaddr *)&simulator, sizeof(simulator));
+            runNs = 0;
+        }
+
+        struct pios_lockstep_step step;
+        socklen_t length = sizeof(simulator);
+        if (recvfrom(lockstepSocket, &step, sizeof(step), 0, (struct sockaddr *)&simulator, &length) == sizeof(step)) {
+            simulatorKnown = true;
+            grantedUs = step.untilUs;
+        }
+    }
+
+    lastTickNs = nowNs();
+}
+
+/**
+ * Switches the simulation to lockstep time, before the scheduler is started.
+ * \param[in] port UDP port the simulator sends its steps to, 0 to run as fast as possible
+ * \return < 0 if the port could not be opened
+ */
+int32_t PIOS_LOCKSTEP_Init(uint16_t port)
+{
+    if (port) {
+        struct sockaddr_in server;
+
+        lockstepSocket = socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        memset(&server, 0, sizeof(server));
+        server.sin_family = AF_INET;
+        server.sin_addr.s_addr = inet_addr("0.0.0.0");
+        server.sin_port   = htons(port);
+        if (lockstepSocket < 0 || bind(lockstepSocket, (struct sockaddr *)&server, sizeof(server)) < 0) {
+            printf("lockstep - port %u could not be opened\n", port);
+            return -1;
+        }
+        printf("lockstep - waiting for the simulator on port %u\n", port);
+    } else {
+        printf("lockstep - running as fast as possible\n");
+    }
+
+    enabled = true;
+    vPortSetLockstep(lockstepGate);
+
+    return 0;
+}
+
+/**
+ * \return true if the simulation runs on lockstep time
+ */
+bool PIOS_LOCKSTEP_Enabled(void)
+{
+    return enabled;
+}
+
+/**
+ * @brief Query the simulated time
+ * @return A microsecond value
+ */
+uint32_t PIOS_LOCKSTEP_GetuS(void)
+{
+    TickType_t tick = xTaskGetTickCount();
+
+    return tick * portTICK_RATE_MICROSECONDS + (busyTick == tick ? busyUs : 0);
+}
+
+/**
+ * Accounts for a busy wait of the running task. The simulated time moves on
+ * within the current tick only, the next tick waits for all tasks to block.
+ * \param[in] uS the time waited
+ */
+void PIOS_LOCKSTEP_Busy(uint32_t uS)
+{
+    TickType_t tick = xTaskGetTickCount();
+
+    if (busyTick != tick) {
+        busyTick = tick;
+        busyUs   = 0;
+    }
+    busyUs += uS;
+    if (busyUs >= portTICK_RATE_MICROSECONDS) {
+        busyUs = portTICK_RATE_MICROSECONDS - 1;
+    }
+}
+
+#endif /* if defined(PIOS_INCLUDE_LOCKSTEP) */
+
+/**
+ * @}
+ */
@@ -87,11 +87,18 @@ void *PIOS_UDP_RxThread(void *udp_dev_n)
          * receive
          */
         int received;
+        int flags = 0;
+#if defined(PIOS_INCLUDE_LOCKSTEP)
+        // a task blocked in recvfrom() never lets lockstep time advance, poll once per tick instead
+        if (PIOS_LOCKSTEP_Enabled()) {
+            flags = MSG_DONTWAIT;
+        }
+#endif
         udp_dev->clientLength = sizeof(udp_dev->client);
         if ((received = recvfrom(udp_dev->socket,
                                  &udp_dev->rx_buffer,
                                  PIOS_UDP_RX_BUFFER_SIZE,
-                                 0,
+                                 flags,
                                  (struct sockaddr *)&udp_dev->client,
                                  (socklen_t *)&udp_dev->clientLength)) >= 0) {
             /* copy received data to buffer if possible */
@@ -107,6 +114,10 @@ void *PIOS_UDP_RxThread(void *udp_dev_n)
                 vPortYieldFromISR();
             }
 #endif /* PIOS_INCLUDE_FREERTOS */
+        } else if (flags) {
+#if defined(PIOS_INCLUDE_LOCKSTEP)
+            vTaskDelay(1);
+#endif
         }
     }
 }
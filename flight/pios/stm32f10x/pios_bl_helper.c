@@ -43,6 +43,12 @@ uint8_t *PIOS_BL_HELPER_FLASH_If_Read(uint32_t SectorAddress)
 
 #if defined(PIOS_INCLUDE_BL_HELPER_WRITE_SUPPORT)
 
+#ifdef STM32F10X_HD
+#define BL_FLASH_PAGE_SIZE 2048
+#elif defined(STM32F10X_MD)
+#define BL_FLASH_PAGE_SIZE 1024
+#endif
+
 static bool erase_flash(uint32_t startAddress, uint32_t endAddress);
 
 uint8_t PIOS_BL_HELPER_FLASH_Ini()
@@ -73,6 +79,29 @@ uint8_t PIOS_BL_HELPER_FLASH_Erase_Bootloader()
     return (success) ? 1 : 0;
 }
 
+/**
+ * Return the erase unit (page) holding address
+ */
+uint8_t PIOS_BL_HELPER_FLASH_Get_Page(uint32_t address, uint32_t *page_start, uint32_t *page_size)
+{
+    *page_start = address & ~(BL_FLASH_PAGE_SIZE - 1);
+    *page_size  = BL_FLASH_PAGE_SIZE;
+    return 1;
+}
+
+/**
+ * Erase the single page holding address
+ */
+uint8_t PIOS_BL_HELPER_FLASH_Erase_Page(uint32_t address)
+{
+    for (int retry = 0; retry < MAX_DEL_RETRYS; ++retry) {
+        if (FLASH_ErasePage(address & ~(BL_FLASH_PAGE_SIZE - 1)) == FLASH_COMPLETE) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 static bool erase_flash(uint32_t startAddress, uint32_t endAddress)
 {
     uint32_t pageAddress = startAddress;
@@ -88,11 +117,7 @@ static bool erase_flash(uint32_t startAddress, uint32_t endAddress)
             }
         }
 
-#ifdef STM32F10X_HD
-        pageAddress += 2048;
-#elif defined(STM32F10X_MD)
-        pageAddress += 1024;
-#endif
+        pageAddress += BL_FLASH_PAGE_SIZE;
     }
     return !fail;
 }
@@ -103,9 +128,14 @@ uint32_t PIOS_BL_HELPER_CRC_Memory_Calc()
 {
     const struct pios_board_info *bdinfo = &pios_board_info_blob;
 
+    return PIOS_BL_HELPER_CRC_Calc(bdinfo->fw_base, bdinfo->fw_size);
+}
+
+uint32_t PIOS_BL_HELPER_CRC_Calc(uint32_t address, uint32_t size)
+{
     PIOS_BL_HELPER_CRC_Ini();
     CRC_ResetDR();
-    CRC_CalcBlockCRC((uint32_t *)bdinfo->fw_base, (bdinfo->fw_size) >> 2);
+    CRC_CalcBlockCRC((uint32_t *)address, size >> 2);
     return CRC_GetCRC();
 }
 
@@ -182,10 +182,11 @@ static void PIOS_DSM_ResetState(struct pios_dsm_dev *dsm_dev)
 
 /**
  * Check and unroll complete frame data.
+ * \param[in] detect the resolution may be switched, at most once per frame
  * \output 0 frame data accepted
  * \output -1 frame error found
  */
-static int PIOS_DSM_UnrollChannels(struct pios_dsm_dev *dsm_dev)
+static int PIOS_DSM_UnrollChannels(struct pios_dsm_dev *dsm_dev, bool detect)
 {
     struct pios_dsm_state *state = &(dsm_dev->state);
     /* Fix resolution for detection. */
@@ -236,20 +237,20 @@ static int PIOS_DSM_UnrollChannels(struct pios_dsm_dev *dsm_dev)
             if (channel_log & (1 << channel_num)) {
                 /* Found duplicate. This should happen when in 11 bit */
                 /* mode and the data is 10 bits */
-                if (resolution == 10) {
+                if (resolution == 10 || !detect) {
                     return -1;
                 }
                 resolution = 10;
-                return PIOS_DSM_UnrollChannels(dsm_dev);
+                return PIOS_DSM_UnrollChannels(dsm_dev, false);
             }
 
             if ((channel_log & 0xFF) == 0x55) {
                 /* This pattern indicates 10 bit pattern */
-                if (resolution == 11) {
+                if (resolution == 11 || !detect) {
                     return -1;
                 }
                 resolution = 11;
-                return PIOS_DSM_UnrollChannels(dsm_dev);
+                return PIOS_DSM_UnrollChannels(dsm_dev, false);
             }
 
             state->channel_data[channel_num] = (word & mask);
@@ -278,7 +279,7 @@ static void PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
             state->received_data[state->byte_count++] = byte;
             if (state->byte_count == DSM_FRAME_LENGTH) {
                 /* full frame received - process and wait for new one */
-                if (!PIOS_DSM_UnrollChannels(dsm_dev)) {
+                if (!PIOS_DSM_UnrollChannels(dsm_dev, true)) {
                     /* data looking good */
                     state->failsafe_timer = 0;
                 }
@@ -344,7 +345,7 @@ static uint16_t PIOS_DSM_RxInCallback(uint32_t context,
     PIOS_Assert(valid);
 
     /* process byte(s) and clear receive timer */
-    for (uint8_t i = 0; i < buf_len; i++) {
+    for (uint16_t i = 0; i < buf_len; i++) {
         PIOS_DSM_UpdateState(dsm_dev, buf[i]);
         dsm_dev->state.receive_timer = 0;
     }
@@ -70,10 +70,22 @@ typedef enum {
     Download_Req, // 9
     Download, // 10
     Status_Request, // 11
-    Status_Rep
-// 12
+    Status_Rep, // 12
+    Req_PageCRCs, // 13
+    Rep_PageCRCs, // 14
+    Delta_Start, // 15
+    Erase_Page
+// 16
 } DFUCommands;
 
+/**************************************************/
+/* SSP link                                       */
+/**************************************************/
+#define MAX_PACKET_DATA_LEN 255
+#define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
+// packets in flight, the serial rx buffer and the DFU fifo each hold a full window
+#define SSP_WINDOW_SIZE     2
+
 typedef enum {
     High_Density, Medium_Density
 } DeviceType;
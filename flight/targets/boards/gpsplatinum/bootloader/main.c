@@ -43,9 +43,7 @@ int32_t platform_senddata(const uint8_t *msg, uint16_t msg_len);
 /* Private typedef -----------------------------------------------------------*/
 typedef void (*pFunction)(void);
 /* Private define ------------------------------------------------------------*/
-#define MAX_PACKET_DATA_LEN 255
-#define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
-#define UART_BUFFER_SIZE    256
+#define UART_BUFFER_SIZE    (SSP_WINDOW_SIZE * MAX_PACKET_BUF_SIZE)
 #define BL_WAIT_TIME        6 * 1000 * 1000
 #define DFU_BUFFER_SIZE     63
 
@@ -96,6 +94,9 @@ static const PortConfig_t ssp_portConfig = {
     .pfSerialRead  = SSP_SerialRead,
     .pfSerialWrite = SSP_SerialWrite,
     .pfGetTime     = PIOS_DELAY_GetuS,
+    // pipelined uploads, in order only: no window buffers. Limited by the 4 KiB of SRAM,
+    // ssp_buffer and the COM rx buffer are sized for SSP_WINDOW_SIZE full packets
+    .windowSize    = SSP_WINDOW_SIZE,
 };
 
 static Port_t ssp_port;
@@ -226,6 +227,10 @@ void processRX()
     do {
         ssp_ReceiveProcess(&ssp_port);
         status = ssp_SendProcess(&ssp_port);
+        if (status == SSP_TX_TIMEOUT && ssp_Window(&ssp_port)) {
+            // the window was dropped, both ends have to count from zero again
+            ssp_Synchronise(&ssp_port);
+        }
     } while ((status != SSP_TX_IDLE) && (status != SSP_TX_ACKED));
 
     if (fifoBuf_getUsed(&ssp_buffer) >= DFU_BUFFER_SIZE) {
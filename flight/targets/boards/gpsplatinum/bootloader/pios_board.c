@@ -36,8 +36,10 @@
  */
 #include "../board_hw_defs.c"
 #include <pios_com_msg.h>
+#include <common.h>
 uint32_t PIOS_COM_TELEM_USB;
-#define PIOS_COM_MAIN_RX_BUF_LEN 256
+// a whole SSP window may arrive while a flash page is written
+#define PIOS_COM_MAIN_RX_BUF_LEN (SSP_WINDOW_SIZE * MAX_PACKET_BUF_SIZE)
 #define PIOS_COM_MAIN_TX_BUF_LEN 256
 uint8_t rx_buffer[PIOS_COM_MAIN_RX_BUF_LEN];
 uint8_t tx_buffer[PIOS_COM_MAIN_TX_BUF_LEN];
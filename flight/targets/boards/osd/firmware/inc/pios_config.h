@@ -55,6 +55,7 @@
 #define PIOS_INCLUDE_INITCALL
 #define PIOS_INCLUDE_SYS
 #define PIOS_INCLUDE_TASK_MONITOR
+#define PIOS_CRC_SLICE_BY_4
 
 /* PIOS hardware peripherals */
 #define PIOS_INCLUDE_IRQ
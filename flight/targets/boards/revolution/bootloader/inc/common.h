@@ -70,8 +70,12 @@ typedef enum {
     Download_Req, // 9
     Download, // 10
     Status_Request, // 11
-    Status_Rep
-// 12
+    Status_Rep, // 12
+    Req_PageCRCs, // 13
+    Rep_PageCRCs, // 14
+    Delta_Start, // 15
+    Erase_Page
+// 16
 } DFUCommands;
 
 typedef enum {
@@ -56,9 +56,15 @@
 #define PIOS_INCLUDE_INITCALL
 #define PIOS_INCLUDE_SYS
 #define PIOS_INCLUDE_TASK_MONITOR
+#define PIOS_CRC_SLICE_BY_4
 
 #define PIOS_INCLUDE_INSTRUMENTATION
 #define PIOS_INSTRUMENTATION_MAX_COUNTERS 10
+/* Small block pool, opt-in and not yet verified in flight. Size the */
+/* classes with PIOS_MEMPOOL_CLASSES from the MemPoolStats MaxUsed of */
+/* a real configuration before enabling it. */
+/* #define PIOS_INCLUDE_MEMPOOL */
+/* #define PIOS_MEMPOOL_CLASSES { { 16, 32 }, { 32, 32 }, { 64, 16 }, { 128, 8 } } */
 
 /* PIOS hardware peripherals */
 #define PIOS_INCLUDE_IRQ
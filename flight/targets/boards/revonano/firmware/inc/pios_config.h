@@ -56,6 +56,7 @@
 #define PIOS_INCLUDE_INITCALL
 #define PIOS_INCLUDE_SYS
 #define PIOS_INCLUDE_TASK_MONITOR
+#define PIOS_CRC_SLICE_BY_4
 
 #define PIOS_INCLUDE_INSTRUMENTATION
 #define PIOS_INSTRUMENTATION_MAX_COUNTERS 40
@@ -42,6 +42,7 @@
 /* Enable/Disable PiOS Modules */
 // #define PIOS_INCLUDE_ADC
 #define PIOS_INCLUDE_DELAY
+#define PIOS_INCLUDE_LOCKSTEP
 // #define PIOS_INCLUDE_I2C
 #define PIOS_INCLUDE_IRQ
 #define PIOS_INCLUDE_LED
@@ -52,6 +53,7 @@
 #define PIOS_INCLUDE_SPI
 #define PIOS_INCLUDE_SYS
 #define PIOS_INCLUDE_TASK_MONITOR
+#define PIOS_CRC_SLICE_BY_4
 #define PIOS_INCLUDE_USART
 // #define PIOS_INCLUDE_USB
 #define PIOS_INCLUDE_USB_HID
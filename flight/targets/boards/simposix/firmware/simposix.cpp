@@ -39,6 +39,10 @@ extern "C" {
 #include <systemmod.h>
 }
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
 /**
  * OpenPilot Main function:
  *
@@ -47,9 +51,26 @@ extern "C" {
  * Start FreeRTOS Scheduler (vTaskStartScheduler)<BR>
  * If something goes wrong, blink LED1 and LED2 every 100ms
  *
+ * -l port runs on lockstep simulated time, stepped by a simulator on the
+ * given UDP port (0: no simulator, as fast as possible), see pios_lockstep.h
  */
-int main()
+int main(int argc, char *argv[])
 {
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:")) != -1) {
+        switch (opt) {
+        case 'l':
+            if (PIOS_LOCKSTEP_Init(atoi(optarg)) < 0) {
+                return 1;
+            }
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-l lockstep port]\n", argv[0]);
+            return 1;
+        }
+    }
+
     /* Brings up System using CMSIS functions, enables the LEDs. */
     PIOS_SYS_Init();
 
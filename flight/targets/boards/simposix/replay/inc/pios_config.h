@@ -0,0 +1,52 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotSystem OpenPilot System
+ * @{
+ * @addtogroup OpenPilotCore OpenPilot Core
+ * @{
+ *
+ * @file       pios_config.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      PiOS configuration header for the state estimation replay.
+ *             Only what the state estimation, the UAVObject manager and
+ *             UAVTalk need, everything else is left out of the host build.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_CONFIG_H
+#define PIOS_CONFIG_H
+
+/* Enable/Disable PiOS Modules */
+#define PIOS_INCLUDE_FREERTOS /* replay_system.c, single threaded */
+#define PIOS_INCLUDE_CALLBACKSCHEDULER /* replay_system.c, runs on the log time */
+#define PIOS_INCLUDE_DELAY    /* replay_system.c, runs on the log time */
+#define PIOS_INCLUDE_INITCALL
+#define PIOS_CRC_SLICE_BY_4
+
+/* Task/Thread Options */
+#define PIOS_SENSOR_RATE      500.0f
+
+#define REVOLUTION
+#define SIMPOSIX
+
+#endif /* PIOS_CONFIG_H */
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,59 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotSystem OpenPilot System
+ * @{
+ * @addtogroup StateReplay State estimation replay
+ * @{
+ *
+ * @file       replay.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Clock and scheduler of the state estimation replay.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+
+/*
+ * The replay runs single threaded. PIOS_DELAY, the FreeRTOS tick and the
+ * callback scheduler all run on the time of the log, which only moves
+ * forward in REPLAY_Advance().
+ */
+
+/* Current log time in microseconds */
+uint64_t REPLAY_GetTime(void);
+
+/* Number of callbacks run so far, the current one included */
+uint32_t REPLAY_GetRun(void);
+
+/*
+ * Move the log time forward to time, first running the callbacks that were
+ * dispatched at the current time, then every callback scheduled up to time
+ * in order, each at its own time.
+ */
+void REPLAY_Advance(uint64_t time);
+
+#endif /* REPLAY_H */
+
+/**
+ * @}
+ * @}
+ */
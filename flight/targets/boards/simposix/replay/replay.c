@@ -0,0 +1,368 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotSystem OpenPilot System
+ * @{
+ * @addtogroup StateReplay State estimation replay
+ * @brief Runs the StateEstimation filter chains on a recorded flight
+ * @{
+ *
+ * @file       replay.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Feeds a log to the StateEstimation module and writes the
+ *             estimated states and the run time of each filter stage.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * Usage: sim_replay [-a algorithm] [-d] [-o prefix] logfile.opl
+ *
+ * The log is a GCS .opl file, either recorded by the GCS logging plugin or
+ * exported from the onboard DebugLog by the flight log gadget (-d, its
+ * timestamps are the FlightTime of the entries in microseconds).
+ * Every object in the log is unpacked as UAVTalk would on the vehicle, so
+ * the settings in the log (RevoSettings, HomeLocation, EKFConfiguration, ...)
+ * are used unless -a overrides the FusionAlgorithm. The states written by
+ * the estimator itself are skipped.
+ *
+ * Output, time in microseconds of the log:
+ * prefix_attitude.csv  time, q1..q4, roll, pitch, yaw
+ * prefix_position.csv  time, north, east, down
+ * prefix_velocity.csv  time, north, east, down
+ * prefix_stages.csv    time, run, stage, filter, result, ns
+ * and a summary of the stage times on stderr.
+ */
+
+#include <openpilot.h>
+#include <time.h>
+#include <uavobjectsinit.h>
+
+#include "replay.h"
+#include "stateestimation.h"
+
+#include <attitudestate.h>
+#include <positionstate.h>
+#include <velocitystate.h>
+#include <gyrostate.h>
+#include <accelstate.h>
+#include <magstate.h>
+#include <airspeedstate.h>
+#include <ekfstatevariance.h>
+#include <revosettings.h>
+#include <systemalarms.h>
+
+#define MAX_PACKET_SIZE 1024
+#define MAX_FILTERS     16
+
+static const struct {
+    const char *name;
+    RevoSettingsFusionAlgorithmOptions algorithm;
+} algorithms[] = {
+    { "cf",          REVOSETTINGS_FUSIONALGORITHM_BASICCOMPLEMENTARY         },
+    { "cfm",         REVOSETTINGS_FUSIONALGORITHM_COMPLEMENTARYMAG           },
+    { "cfmgps",      REVOSETTINGS_FUSIONALGORITHM_COMPLEMENTARYMAGGPSOUTDOOR },
+    { "ins13indoor", REVOSETTINGS_FUSIONALGORITHM_INS13INDOOR                },
+    { "ins13",       REVOSETTINGS_FUSIONALGORITHM_GPSNAVIGATIONINS13         },
+};
+
+// objects written by the estimator, the logged values would overwrite the replayed ones
+static const uint32_t estimatorOutputs[] = {
+    ATTITUDESTATE_OBJID,
+    POSITIONSTATE_OBJID,
+    VELOCITYSTATE_OBJID,
+    GYROSTATE_OBJID,
+    ACCELSTATE_OBJID,
+    MAGSTATE_OBJID,
+    AIRSPEEDSTATE_OBJID,
+    EKFSTATEVARIANCE_OBJID,
+    SYSTEMALARMS_OBJID,
+};
+
+static struct {
+    const stateFilter *filter;
+    uint32_t count;
+    uint64_t totalNs;
+    uint64_t maxNs;
+} stageStats[MAX_FILTERS];
+
+static FILE *attitudeFile;
+static FILE *positionFile;
+static FILE *velocityFile;
+static FILE *stagesFile;
+static int16_t algorithmOverride = -1;
+static uint32_t stageRun;
+static uint8_t stage;
+
+static int32_t discardOutput(__attribute__((unused)) uint8_t *data, int32_t length)
+{
+    return length;
+}
+
+static uint64_t nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * Stage hook, times each filter of the chain
+ */
+static filterResult timeStage(stateFilter *filter, stateEstimation *state)
+{
+    uint64_t start = nowNs();
+    filterResult result = filter->filter(filter, state);
+    uint64_t ns = nowNs() - start;
+
+    if (stageRun != REPLAY_GetRun()) {
+        stageRun = REPLAY_GetRun();
+        stage    = 0;
+    }
+    fprintf(stagesFile, "%llu,%u,%u,%s,%d,%llu\n", (unsigned long long)REPLAY_GetTime(), stageRun, stage++,
+            StateEstimationFilterName(filter), result, (unsigned long long)ns);
+
+    for (uint8_t i = 0; i < MAX_FILTERS; i++) {
+        if (!stageStats[i].filter) {
+            stageStats[i].filter = filter;
+        }
+        if (stageStats[i].filter == filter) {
+            stageStats[i].count++;
+            stageStats[i].totalNs += ns;
+            if (ns > stageStats[i].maxNs) {
+                stageStats[i].maxNs = ns;
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+static void attitudeUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    AttitudeStateData s;
+
+    AttitudeStateGet(&s);
+    fprintf(attitudeFile, "%llu,%.7g,%.7g,%.7g,%.7g,%.7g,%.7g,%.7g\n", (unsigned long long)REPLAY_GetTime(),
+            (double)s.q1, (double)s.q2, (double)s.q3, (double)s.q4, (double)s.Roll, (double)s.Pitch, (double)s.Yaw);
+}
+
+static void positionUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    PositionStateData s;
+
+    PositionStateGet(&s);
+    fprintf(positionFile, "%llu,%.7g,%.7g,%.7g\n", (unsigned long long)REPLAY_GetTime(),
+            (double)s.North, (double)s.East, (double)s.Down);
+}
+
+static void velocityUpdatedCb(__attribute__((unused)) UAVObjEvent *ev)
+{
+    VelocityStateData s;
+
+    VelocityStateGet(&s);
+    fprintf(velocityFile, "%llu,%.7g,%.7g,%.7g\n", (unsigned long long)REPLAY_GetTime(),
+            (double)s.North, (double)s.East, (double)s.Down);
+}
+
+static FILE *openOutput(const char *prefix, const char *name, const char *header)
+{
+    char fileName[256];
+
+    snprintf(fileName, sizeof(fileName), "%s_%s.csv", prefix, name);
+    FILE *file = fopen(fileName, "w");
+    if (!file) {
+        perror(fileName);
+        exit(1);
+    }
+    fprintf(file, "%s\n", header);
+    return file;
+}
+
+static bool isEstimatorOutput(uint32_t objId)
+{
+    for (uint8_t i = 0; i < NELEMENTS(estimatorOutputs); i++) {
+        // the metadata of an object has the next ID
+        if ((objId & ~1u) == estimatorOutputs[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Unpack the objects of one log record into the object manager
+ * \return number of objects applied
+ */
+static uint32_t replayRecord(UAVTalkConnection connection, uint8_t *data, int64_t size)
+{
+    uint32_t applied = 0;
+
+    while (size > 0) {
+        uint8_t length   = size > 255 ? 255 : size;
+        uint8_t position = 0;
+
+        while (position < length) {
+            if (UAVTalkProcessInputStreamQuiet(connection, data, length, &position) != UAVTALK_STATE_COMPLETE) {
+                continue;
+            }
+            uint32_t objId = UAVTalkGetPacketObjId(connection);
+            if (isEstimatorOutput(objId)) {
+                continue;
+            }
+            if (UAVTalkReceiveObject(connection) == 0) {
+                applied++;
+                if (objId == REVOSETTINGS_OBJID && algorithmOverride >= 0) {
+                    uint8_t algorithm = algorithmOverride;
+                    RevoSettingsFusionAlgorithmSet(&algorithm);
+                }
+            }
+        }
+        data += length;
+        size -= length;
+    }
+    return applied;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: sim_replay [-a algorithm] [-d] [-o prefix] logfile.opl\n");
+    fprintf(stderr, "  -a  fusion algorithm:");
+    for (uint8_t i = 0; i < NELEMENTS(algorithms); i++) {
+        fprintf(stderr, " %s", algorithms[i].name);
+    }
+    fprintf(stderr, "\n      (default: the RevoSettings of the log)\n");
+    fprintf(stderr, "  -d  log exported from the onboard DebugLog, timestamps in microseconds\n");
+    fprintf(stderr, "  -o  prefix of the output files (default: replay)\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *prefix = "replay";
+    uint64_t timeScale = 1000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:do:")) != -1) {
+        switch (opt) {
+        case 'a':
+            for (uint8_t i = 0; i < NELEMENTS(algorithms); i++) {
+                if (!strcmp(optarg, algorithms[i].name)) {
+                    algorithmOverride = algorithms[i].algorithm;
+                }
+            }
+            if (algorithmOverride < 0) {
+                usage();
+            }
+            break;
+        case 'd':
+            timeScale = 1;
+            break;
+        case 'o':
+            prefix = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc - 1) {
+        usage();
+    }
+
+    FILE *log = fopen(argv[optind], "rb");
+    if (!log) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    attitudeFile = openOutput(prefix, "attitude", "time,q1,q2,q3,q4,roll,pitch,yaw");
+    positionFile = openOutput(prefix, "position", "time,north,east,down");
+    velocityFile = openOutput(prefix, "velocity", "time,north,east,down");
+    stagesFile   = openOutput(prefix, "stages", "time,run,stage,filter,result,ns");
+
+    UAVObjInitialize();
+    UAVObjectsInitializeAll();
+    AlarmsInitialize();
+
+    StateEstimationInitialize();
+    StateEstimationSetStageHook(&timeStage);
+    if (algorithmOverride >= 0) {
+        uint8_t algorithm = algorithmOverride;
+        RevoSettingsFusionAlgorithmSet(&algorithm);
+    }
+    StateEstimationStart();
+
+    AttitudeStateConnectCallback(&attitudeUpdatedCb);
+    PositionStateConnectCallback(&positionUpdatedCb);
+    VelocityStateConnectCallback(&velocityUpdatedCb);
+
+    UAVTalkConnection connection = UAVTalkInitialize(&discardOutput);
+    uint8_t *packet   = pios_malloc(MAX_PACKET_SIZE);
+    uint32_t records  = 0;
+    uint32_t objects  = 0;
+    uint64_t firstTime = 0;
+    uint64_t start    = nowNs();
+
+    for (;;) {
+        uint32_t timeStamp;
+        int64_t size;
+
+        if (fread(&timeStamp, sizeof(timeStamp), 1, log) != 1 || fread(&size, sizeof(size), 1, log) != 1) {
+            break;
+        }
+        if (size < 1 || size > MAX_PACKET_SIZE || fread(packet, size, 1, log) != 1) {
+            fprintf(stderr, "corrupt record %u at offset %ld\n", records, ftell(log));
+            break;
+        }
+        uint64_t time = timeScale * timeStamp;
+        if (!records) {
+            firstTime = time;
+        }
+        // run the estimator on everything logged before, then apply the record
+        REPLAY_Advance(time);
+        objects += replayRecord(connection, packet, size);
+        records++;
+    }
+    REPLAY_Advance(REPLAY_GetTime());
+
+    double wallSeconds = (nowNs() - start) * 1e-9;
+    double logSeconds  = (REPLAY_GetTime() - firstTime) * 1e-6;
+
+    fprintf(stderr, "%u records, %u objects, %.1f s of log replayed in %.2f s\n", records, objects, logSeconds, wallSeconds);
+    fprintf(stderr, "%-12s %10s %10s %10s\n", "filter", "runs", "mean us", "max us");
+    for (uint8_t i = 0; i < MAX_FILTERS && stageStats[i].filter; i++) {
+        fprintf(stderr, "%-12s %10u %10.2f %10.2f\n", StateEstimationFilterName(stageStats[i].filter), stageStats[i].count,
+                stageStats[i].totalNs * 1e-3 / stageStats[i].count, stageStats[i].maxNs * 1e-3);
+    }
+    if (!stageStats[0].filter) {
+        // same as the attitude error alarm on the vehicle, e.g. the ins needs a HomeLocation with Be set
+        fprintf(stderr, "no filter ran, the filter chain did not initialize with the settings of this log\n");
+    }
+
+    fclose(log);
+    fclose(attitudeFile);
+    fclose(positionFile);
+    fclose(velocityFile);
+    fclose(stagesFile);
+    return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
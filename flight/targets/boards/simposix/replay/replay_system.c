@@ -0,0 +1,284 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotSystem OpenPilot System
+ * @{
+ * @addtogroup StateReplay State estimation replay
+ * @{
+ *
+ * @file       replay_system.c
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Single threaded FreeRTOS, PIOS_DELAY, callback scheduler and
+ *             event dispatcher, all running on the time of the replayed log.
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <openpilot.h>
+#include "replay.h"
+
+#define MAX_CALLBACKS 16
+#define NOT_SCHEDULED UINT64_MAX
+
+struct DelayedCallbackInfoStruct {
+    DelayedCallback cb;
+    bool     dispatched;
+    uint64_t scheduledTime;
+};
+
+static uint64_t replayTime;
+static uint32_t replayRun;
+static struct DelayedCallbackInfoStruct callbacks[MAX_CALLBACKS];
+static uint8_t numCallbacks;
+static uint8_t dummyHandle;
+
+uint64_t REPLAY_GetTime(void)
+{
+    return replayTime;
+}
+
+uint32_t REPLAY_GetRun(void)
+{
+    return replayRun;
+}
+
+static bool runDispatched(void)
+{
+    bool ran = false;
+
+    for (uint8_t i = 0; i < numCallbacks; i++) {
+        if (callbacks[i].dispatched) {
+            callbacks[i].dispatched = false;
+            replayRun++;
+            callbacks[i].cb();
+            ran = true;
+        }
+    }
+    return ran;
+}
+
+void REPLAY_Advance(uint64_t time)
+{
+    // a callback that keeps dispatching itself is run once per call only
+    runDispatched();
+
+    for (;;) {
+        struct DelayedCallbackInfoStruct *next = NULL;
+        for (uint8_t i = 0; i < numCallbacks; i++) {
+            if (callbacks[i].scheduledTime <= time && (!next || callbacks[i].scheduledTime < next->scheduledTime)) {
+                next = &callbacks[i];
+            }
+        }
+        if (!next) {
+            break;
+        }
+        if (next->scheduledTime > replayTime) {
+            replayTime = next->scheduledTime;
+        }
+        next->scheduledTime = NOT_SCHEDULED;
+        next->dispatched    = true;
+        runDispatched();
+    }
+
+    if (time > replayTime) {
+        replayTime = time;
+    }
+}
+
+/*
+ * PIOS_DELAY
+ */
+int32_t PIOS_DELAY_Init(void)
+{
+    return 0;
+}
+
+int32_t PIOS_DELAY_WaituS(__attribute__((unused)) uint32_t uS)
+{
+    return 0;
+}
+
+int32_t PIOS_DELAY_WaitmS(__attribute__((unused)) uint32_t mS)
+{
+    return 0;
+}
+
+uint32_t PIOS_DELAY_GetuS()
+{
+    return (uint32_t)replayTime;
+}
+
+uint32_t PIOS_DELAY_GetuSSince(uint32_t t)
+{
+    return PIOS_DELAY_GetuS() - t;
+}
+
+uint32_t PIOS_DELAY_GetRaw()
+{
+    return PIOS_DELAY_GetuS();
+}
+
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
+{
+    return PIOS_DELAY_GetuS() - raw;
+}
+
+/*
+ * PIOS_CALLBACKSCHEDULER, callbacks run in creation order
+ */
+DelayedCallbackInfo *PIOS_CALLBACKSCHEDULER_Create(
+    DelayedCallback cb,
+    __attribute__((unused)) DelayedCallbackPriority priority,
+    __attribute__((unused)) DelayedCallbackPriorityTask priorityTask,
+    __attribute__((unused)) int16_t callbackID,
+    __attribute__((unused)) uint32_t stacksize)
+{
+    if (numCallbacks >= MAX_CALLBACKS) {
+        return NULL;
+    }
+    DelayedCallbackInfo *info = &callbacks[numCallbacks++];
+    info->cb = cb;
+    info->dispatched    = false;
+    info->scheduledTime = NOT_SCHEDULED;
+    return info;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_Schedule(DelayedCallbackInfo *cbinfo, int32_t milliseconds, DelayedCallbackUpdateMode updatemode)
+{
+    uint64_t time = replayTime + 1000 * (uint64_t)milliseconds;
+    int32_t result;
+
+    if (cbinfo->scheduledTime == NOT_SCHEDULED) {
+        result = 1;
+    } else if ((updatemode & CALLBACK_UPDATEMODE_SOONER && time < cbinfo->scheduledTime) ||
+               (updatemode & CALLBACK_UPDATEMODE_LATER && time > cbinfo->scheduledTime)) {
+        result = 2;
+    } else {
+        return 0;
+    }
+    cbinfo->scheduledTime = time;
+    return result;
+}
+
+int32_t PIOS_CALLBACKSCHEDULER_Dispatch(DelayedCallbackInfo *cbinfo)
+{
+    cbinfo->dispatched = true;
+    return 1;
+}
+
+/*
+ * Event dispatcher, object callbacks run right away
+ */
+int32_t EventDispatcherInitialize()
+{
+    return 0;
+}
+
+void EventGetStats(EventStats *statsOut)
+{
+    memset(statsOut, 0, sizeof(EventStats));
+}
+
+void EventClearStats() {}
+
+int32_t EventCallbackDispatch(UAVObjEvent *ev, UAVObjEventCallback cb)
+{
+    cb(ev);
+    return 0;
+}
+
+int32_t EventPeriodicCallbackCreate(__attribute__((unused)) UAVObjEvent *ev, __attribute__((unused)) UAVObjEventCallback cb, __attribute__((unused)) uint16_t periodMs)
+{
+    return 0;
+}
+
+int32_t EventPeriodicCallbackUpdate(__attribute__((unused)) UAVObjEvent *ev, __attribute__((unused)) UAVObjEventCallback cb, __attribute__((unused)) uint16_t periodMs)
+{
+    return 0;
+}
+
+int32_t EventPeriodicQueueCreate(__attribute__((unused)) UAVObjEvent *ev, __attribute__((unused)) xQueueHandle queue, __attribute__((unused)) uint16_t periodMs)
+{
+    return 0;
+}
+
+int32_t EventPeriodicQueueUpdate(__attribute__((unused)) UAVObjEvent *ev, __attribute__((unused)) xQueueHandle queue, __attribute__((unused)) uint16_t periodMs)
+{
+    return 0;
+}
+
+/*
+ * FreeRTOS, nothing ever blocks in a single thread
+ */
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(replayTime / (1000 * portTICK_RATE_MS));
+}
+
+void *pvPortMalloc(size_t xSize)
+{
+    return malloc(xSize);
+}
+
+void vPortFree(void *pv)
+{
+    free(pv);
+}
+
+QueueHandle_t xQueueGenericCreate(__attribute__((unused)) const UBaseType_t uxQueueLength, __attribute__((unused)) const UBaseType_t uxItemSize, __attribute__((unused)) const uint8_t ucQueueType)
+{
+    return (QueueHandle_t)&dummyHandle;
+}
+
+QueueHandle_t xQueueCreateMutex(__attribute__((unused)) const uint8_t ucQueueType)
+{
+    return (QueueHandle_t)&dummyHandle;
+}
+
+BaseType_t xQueueTakeMutexRecursive(__attribute__((unused)) QueueHandle_t xMutex, __attribute__((unused)) TickType_t xTicksToWait)
+{
+    return pdTRUE;
+}
+
+BaseType_t xQueueGiveMutexRecursive(__attribute__((unused)) QueueHandle_t pxMutex)
+{
+    return pdTRUE;
+}
+
+BaseType_t xQueueGenericSend(__attribute__((unused)) QueueHandle_t xQueue, __attribute__((unused)) const void *const pvItemToQueue, __attribute__((unused)) TickType_t xTicksToWait, __attribute__((unused)) const BaseType_t xCopyPosition)
+{
+    return pdTRUE;
+}
+
+BaseType_t xQueueGenericReceive(__attribute__((unused)) QueueHandle_t xQueue, __attribute__((unused)) void *const pvBuffer, __attribute__((unused)) TickType_t xTicksToWait, __attribute__((unused)) const BaseType_t xJustPeek)
+{
+    return pdFALSE;
+}
+
+/*
+ * PIOS_DEBUG
+ */
+void PIOS_DEBUG_Panic(const char *msg)
+{
+    fprintf(stderr, "panic: %s\n", msg);
+    exit(1);
+}
+
+/**
+ * @}
+ * @}
+ */
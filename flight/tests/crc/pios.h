@@ -0,0 +1,9 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* Just enough to build pios_crc.c on the host */
+#include <stdint.h>
+
+#include "pios_crc.h"
+
+#endif /* PIOS_H */
@@ -0,0 +1,208 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <string.h> /* memcpy */
+#include <time.h> /* clock_gettime */
+
+#include <vector>
+
+extern "C" {
+#include "pios.h"
+}
+
+/* Bit at a time reference implementations of the three polynomials */
+static uint8_t ref_crc8(uint8_t crc, const uint8_t *data, int32_t length)
+{
+    for (int32_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t ref_crc16(uint16_t crc, const uint8_t *data, int32_t length)
+{
+    for (int32_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0x8408) : (uint16_t)(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static uint32_t ref_crc32(uint32_t crc, const uint8_t *data, int32_t length)
+{
+    for (int32_t i = 0; i < length; i++) {
+        crc ^= (uint32_t)data[i] << 24;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* What the STM32 CRC unit computes for each word written to CRC->DR */
+static uint32_t ref_stm32(uint32_t crc, const uint32_t *words, int32_t count)
+{
+    for (int32_t i = 0; i < count; i++) {
+        crc ^= words[i];
+        for (int bit = 0; bit < 32; bit++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static double now_s()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+class CrcTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        srand(1);
+        // a few spare bytes so that every alignment can be tested
+        buffer.resize(4096 + 8);
+        for (size_t i = 0; i < buffer.size(); i++) {
+            buffer[i] = (uint8_t)rand();
+        }
+    }
+
+    std::vector<uint8_t> buffer;
+};
+
+TEST_F(CrcTest, KnownValues) {
+    const uint8_t check[] = "123456789";
+
+    EXPECT_EQ(0xf4, PIOS_CRC_updateCRC(0, check, 9));
+    // X.25 without the final complement
+    EXPECT_EQ(0x906e, PIOS_CRC16_updateCRC(0xffff, check, 9) ^ 0xffff);
+    // CRC-32/MPEG-2
+    EXPECT_EQ(0x0376e6e7u, PIOS_CRC32_updateCRC(0xffffffff, check, 9));
+}
+
+TEST_F(CrcTest, MatchesReferenceForAllLengthsAndAlignments) {
+    for (int offset = 0; offset < 4; offset++) {
+        for (int32_t length = 0; length < 64; length++) {
+            const uint8_t *p = &buffer[offset];
+            EXPECT_EQ(ref_crc8(0x5a, p, length), PIOS_CRC_updateCRC(0x5a, p, length)) << offset << " " << length;
+            EXPECT_EQ(ref_crc16(0xffff, p, length), PIOS_CRC16_updateCRC(0xffff, p, length)) << offset << " " << length;
+            EXPECT_EQ(ref_crc32(0xffffffff, p, length), PIOS_CRC32_updateCRC(0xffffffff, p, length)) << offset << " " << length;
+        }
+    }
+
+    EXPECT_EQ(ref_crc8(0, &buffer[1], 4096), PIOS_CRC_updateCRC(0, &buffer[1], 4096));
+    EXPECT_EQ(ref_crc16(0, &buffer[1], 4096), PIOS_CRC16_updateCRC(0, &buffer[1], 4096));
+    EXPECT_EQ(ref_crc32(0, &buffer[1], 4096), PIOS_CRC32_updateCRC(0, &buffer[1], 4096));
+}
+
+TEST_F(CrcTest, BufferMatchesByteUpdates) {
+    // uavtalk mixes both while it receives a frame
+    uint8_t crc8    = 0;
+    uint16_t crc16  = 0;
+    uint32_t crc32  = 0;
+
+    for (int32_t i = 0; i < 1000; i++) {
+        crc8  = PIOS_CRC_updateByte(crc8, buffer[i]);
+        crc16 = PIOS_CRC16_updateByte(crc16, buffer[i]);
+        crc32 = PIOS_CRC32_updateByte(crc32, buffer[i]);
+    }
+    EXPECT_EQ(crc8, PIOS_CRC_updateCRC(0, &buffer[0], 1000));
+    EXPECT_EQ(crc16, PIOS_CRC16_updateCRC(0, &buffer[0], 1000));
+    EXPECT_EQ(crc32, PIOS_CRC32_updateCRC(0, &buffer[0], 1000));
+}
+
+TEST_F(CrcTest, IncrementalUpdates) {
+    // split the buffer in random chunks, like the object list does with its read buffer
+    for (int run = 0; run < 100; run++) {
+        uint8_t crc8   = 0;
+        uint16_t crc16 = 0;
+        uint32_t crc32 = 0xffffffff;
+        int32_t done   = 0;
+
+        while (done < 4096) {
+            int32_t chunk = rand() % 67;
+            if (chunk > 4096 - done) {
+                chunk = 4096 - done;
+            }
+            crc8  = PIOS_CRC_updateCRC(crc8, &buffer[done], chunk);
+            crc16 = PIOS_CRC16_updateCRC(crc16, &buffer[done], chunk);
+            crc32 = PIOS_CRC32_updateCRC(crc32, &buffer[done], chunk);
+            done += chunk;
+        }
+        EXPECT_EQ(ref_crc8(0, &buffer[0], 4096), crc8);
+        EXPECT_EQ(ref_crc16(0, &buffer[0], 4096), crc16);
+        EXPECT_EQ(ref_crc32(0xffffffff, &buffer[0], 4096), crc32);
+    }
+}
+
+TEST_F(CrcTest, WordsMatchTheHardwareUnit) {
+    std::vector<uint32_t> words(1024);
+    memcpy(&words[0], &buffer[0], 4096);
+
+    EXPECT_EQ(ref_stm32(0xffffffff, &words[0], 1024), PIOS_CRC32_updateWords(0xffffffff, &words[0], 1024));
+    EXPECT_EQ(ref_stm32(0xffffffff, &words[0], 1), PIOS_CRC32_updateWords(0xffffffff, &words[0], 1));
+    EXPECT_EQ(0xffffffffu, PIOS_CRC32_updateWords(0xffffffff, &words[0], 0));
+
+    // the unit takes the most significant byte of each word first
+    uint32_t crc = 0xffffffff;
+    for (int i = 0; i < 1024; i++) {
+        const uint8_t msbFirst[4] = {
+            (uint8_t)(words[i] >> 24), (uint8_t)(words[i] >> 16), (uint8_t)(words[i] >> 8), (uint8_t)words[i]
+        };
+        crc = PIOS_CRC32_updateCRC(crc, msbFirst, 4);
+    }
+    EXPECT_EQ(crc, PIOS_CRC32_updateWords(0xffffffff, &words[0], 1024));
+}
+
+TEST_F(CrcTest, Throughput) {
+    const int rounds = 2000;
+    double start;
+    double bytewise;
+    double sliced;
+    volatile uint32_t sink = 0;
+
+    start = now_s();
+    for (int n = 0; n < rounds; n++) {
+        uint8_t crc = 0;
+        for (int32_t i = 0; i < 4096; i++) {
+            crc = PIOS_CRC_updateByte(crc, buffer[i]);
+        }
+        sink = sink + crc;
+    }
+    bytewise = rounds * 4096 / (now_s() - start) / 1e6;
+
+    start = now_s();
+    for (int n = 0; n < rounds; n++) {
+        sink = sink + PIOS_CRC_updateCRC(0, &buffer[0], 4096);
+    }
+    sliced = rounds * 4096 / (now_s() - start) / 1e6;
+    printf("crc8:  byte at a time %7.1f MB/s, slice by 4 %7.1f MB/s\n", bytewise, sliced);
+
+    start = now_s();
+    for (int n = 0; n < rounds; n++) {
+        uint32_t crc = 0xffffffff;
+        for (int32_t i = 0; i < 4096; i++) {
+            crc = PIOS_CRC32_updateByte(crc, buffer[i]);
+        }
+        sink = sink + crc;
+    }
+    bytewise = rounds * 4096 / (now_s() - start) / 1e6;
+
+    start = now_s();
+    for (int n = 0; n < rounds; n++) {
+        sink = sink + PIOS_CRC32_updateCRC(0xffffffff, &buffer[0], 4096);
+    }
+    sliced = rounds * 4096 / (now_s() - start) / 1e6;
+    printf("crc32: byte at a time %7.1f MB/s, slice by 4 %7.1f MB/s\n", bytewise, sliced);
+    (void)sink;
+}
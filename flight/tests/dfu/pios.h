@@ -0,0 +1,27 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* Just enough of the bootloader environment to build op_dfu.c on the host */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define BOARD_READABLE true
+#define BOARD_WRITABLE true
+
+typedef enum {
+    FLASH_BUSY = 1,
+    FLASH_ERROR_PG,
+    FLASH_ERROR_WRP,
+    FLASH_COMPLETE,
+    FLASH_TIMEOUT
+} FLASH_Status;
+
+FLASH_Status FLASH_ProgramWord(uint32_t Address, uint32_t Data);
+void FLASH_Lock(void);
+
+void PIOS_IAP_WriteBootCount(uint16_t);
+void PIOS_IAP_WriteBootCmd(uint8_t b, uint32_t val);
+int32_t PIOS_SYS_Reset(void);
+
+#endif /* PIOS_H */
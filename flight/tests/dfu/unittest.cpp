@@ -0,0 +1,549 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memset */
+
+#include <set>
+#include <vector>
+
+extern "C" {
+#include "pios.h"
+#include "op_dfu.h"
+#include "pios_bl_helper.h"
+#include "pios_board_info.h"
+}
+
+#define FW_BASE     0x08010000
+#define BANK_SIZE   0x00070000
+#define DESC_SIZE   0x00000064
+#define PACKET_SIZE (14 * 4)
+
+extern "C" {
+const struct pios_board_info pios_board_info_blob = {
+    PIOS_BOARD_INFO_BLOB_MAGIC, // magic
+    0x04, // board_type
+    0x02, // board_rev
+    0x83, // bl_rev
+    0, // hw_type
+    FW_BASE, // fw_base
+    BANK_SIZE - DESC_SIZE, // fw_size
+    FW_BASE + BANK_SIZE - DESC_SIZE, // desc_base
+    DESC_SIZE, // desc_size
+    0, // ee_base
+    0, // ee_size
+};
+
+DFUStates DeviceState;
+uint8_t JumpToApp;
+}
+
+/*
+ * In memory flash for the firmware bank. Like the real thing a word can only
+ * clear bits, everything else needs an erase of the whole page.
+ */
+static struct {
+    std::vector<uint32_t> pageSizes;
+    std::vector<uint8_t> mem;
+    std::vector<int> erases; // per page
+    std::vector<int> programmed; // words per page
+} flash;
+
+static uint8_t reply[64];
+
+static void flash_geometry(uint32_t pageSize, uint32_t firstPageSize = 0)
+{
+    flash.pageSizes.clear();
+    for (uint32_t size = 0; size < BANK_SIZE;) {
+        uint32_t page = (size == 0 && firstPageSize) ? firstPageSize : pageSize;
+        flash.pageSizes.push_back(page);
+        size += page;
+    }
+    flash.mem.assign(BANK_SIZE, 0xFF);
+    flash.erases.assign(flash.pageSizes.size(), 0);
+    flash.programmed.assign(flash.pageSizes.size(), 0);
+}
+
+static int page_of(uint32_t address, uint32_t *start = NULL, uint32_t *size = NULL)
+{
+    uint32_t pageStart = FW_BASE;
+
+    for (size_t n = 0; n < flash.pageSizes.size(); n++) {
+        if (address >= pageStart && address < pageStart + flash.pageSizes[n]) {
+            if (start) {
+                *start = pageStart;
+                *size  = flash.pageSizes[n];
+            }
+            return n;
+        }
+        pageStart += flash.pageSizes[n];
+    }
+    return -1;
+}
+
+static void erase_page(int page)
+{
+    uint32_t start = 0;
+
+    for (int n = 0; n < page; n++) {
+        start += flash.pageSizes[n];
+    }
+    memset(&flash.mem[start], 0xFF, flash.pageSizes[page]);
+    flash.erases[page]++;
+}
+
+// the STM32 CRC unit, same nibble table implementation as the GCS
+static uint32_t crc32_stm32(uint32_t crc, const uint8_t *data, uint32_t words)
+{
+    static const uint32_t table[16] = {
+        0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
+        0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
+    };
+
+    while (words--) {
+        crc ^= data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+        data += 4;
+        for (int n = 0; n < 8; n++) {
+            crc = (crc << 4) ^ table[crc >> 28];
+        }
+    }
+    return crc;
+}
+
+extern "C" {
+FLASH_Status FLASH_ProgramWord(uint32_t Address, uint32_t Data)
+{
+    int page = page_of(Address);
+
+    if (page < 0 || (Address & 3)) {
+        return FLASH_ERROR_PG;
+    }
+    uint32_t word;
+    memcpy(&word, &flash.mem[Address - FW_BASE], 4);
+    word &= Data;
+    memcpy(&flash.mem[Address - FW_BASE], &word, 4);
+    flash.programmed[page]++;
+    return (word == Data) ? FLASH_COMPLETE : FLASH_ERROR_PG;
+}
+
+void FLASH_Lock(void) {}
+void PIOS_IAP_WriteBootCount(uint16_t) {}
+void PIOS_IAP_WriteBootCmd(uint8_t, uint32_t) {}
+int32_t PIOS_SYS_Reset(void)
+{
+    return 0;
+}
+
+uint8_t *PIOS_BL_HELPER_FLASH_If_Read(uint32_t SectorAddress)
+{
+    static uint8_t outside[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+    if (page_of(SectorAddress) < 0) {
+        ADD_FAILURE() << "read outside of the bank at " << std::hex << SectorAddress;
+        return outside;
+    }
+    return &flash.mem[SectorAddress - FW_BASE];
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Ini()
+{
+    return 1;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Start()
+{
+    for (size_t n = 0; n < flash.pageSizes.size(); n++) {
+        erase_page(n);
+    }
+    return 1;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Get_Page(uint32_t address, uint32_t *page_start, uint32_t *page_size)
+{
+    return page_of(address, page_start, page_size) >= 0;
+}
+
+uint8_t PIOS_BL_HELPER_FLASH_Erase_Page(uint32_t address)
+{
+    int page = page_of(address);
+
+    if (page < 0) {
+        return 0;
+    }
+    erase_page(page);
+    return 1;
+}
+
+uint32_t PIOS_BL_HELPER_CRC_Calc(uint32_t address, uint32_t size)
+{
+    return crc32_stm32(0xFFFFFFFF, &flash.mem[address - FW_BASE], size >> 2);
+}
+
+uint32_t PIOS_BL_HELPER_CRC_Memory_Calc()
+{
+    return PIOS_BL_HELPER_CRC_Calc(pios_board_info_blob.fw_base, pios_board_info_blob.fw_size);
+}
+
+int32_t platform_senddata(const uint8_t *msg, uint16_t msg_len)
+{
+    // the host sees the report id in front of the command
+    reply[0] = 0x01;
+    memcpy(reply + 1, msg, msg_len);
+    return 0;
+}
+}
+
+/*
+ * The host side of the protocol, packets are built the same way the GCS
+ * DFUObject does it.
+ */
+class DfuTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        flash_geometry(1024);
+        DeviceState = BLidle;
+        sent = 0;
+    }
+
+    void command(uint8_t cmd, uint32_t count, const uint8_t *data = NULL, int size = 0)
+    {
+        uint8_t buf[64];
+
+        memset(buf, 0, sizeof(buf));
+        buf[0] = 0x02; // reportID
+        buf[1] = cmd;
+        buf[2] = count >> 24;
+        buf[3] = count >> 16;
+        buf[4] = count >> 8;
+        buf[5] = count;
+        if (data) {
+            memcpy(&buf[6], data, size);
+        }
+        memset(reply, 0, sizeof(reply));
+        processComand(buf + 1);
+        sent++;
+    }
+
+    static uint32_t unpack(const uint8_t *buf)
+    {
+        return ((uint32_t)buf[0] << 24) | (buf[1] << 16) | (buf[2] << 8) | buf[3];
+    }
+
+    uint8_t status()
+    {
+        command(Status_Request, 0);
+        EXPECT_EQ(Status_Rep, reply[1]);
+        return reply[6];
+    }
+
+    void enterDFU()
+    {
+        uint8_t device = 0;
+
+        command(Req_Capabilities, 0);
+        ASSERT_EQ(1, reply[7]);
+        device = 1;
+        command(Req_Capabilities, 0, &device, 1);
+        sizeOfCode = unpack(&reply[2]);
+        caps = reply[DFU_CAPS];
+        device     = 0;
+        command(EnterDFU, 0, &device, 1);
+        ASSERT_EQ(DFUidle, status());
+    }
+
+    // pad to whole words and to the bank size for the CRC, as UploadFirmwareT does
+    std::vector<uint8_t> padded(const std::vector<uint8_t> & image)
+    {
+        std::vector<uint8_t> fw(image);
+
+        fw.resize(sizeOfCode, 0xFF);
+        return fw;
+    }
+
+    void start(uint8_t cmd, uint8_t type, uint32_t bytes, uint32_t crc)
+    {
+        uint32_t packets = (bytes + PACKET_SIZE - 1) / PACKET_SIZE;
+        uint8_t data[6];
+
+        data[0] = type;
+        data[1] = (bytes % PACKET_SIZE) ? (bytes % PACKET_SIZE) / 4 : 14;
+        data[2] = crc >> 24;
+        data[3] = crc >> 16;
+        data[4] = crc >> 8;
+        data[5] = crc;
+        command(cmd | 0x20, packets, data, sizeof(data));
+    }
+
+    void packet(const std::vector<uint8_t> & image, uint32_t n)
+    {
+        uint8_t data[PACKET_SIZE];
+
+        memset(data, 0, sizeof(data));
+        for (uint32_t x = 0; x < PACKET_SIZE && n * PACKET_SIZE + x < image.size(); x += 4) {
+            // CopyWords: the words go big endian on the wire
+            for (int b = 0; b < 4; b++) {
+                data[x + b] = image[n * PACKET_SIZE + x + 3 - b];
+            }
+        }
+        command(Upload, n, data, sizeof(data));
+    }
+
+    uint8_t fullUpload(const std::vector<uint8_t> & image)
+    {
+        uint32_t packets = (image.size() + PACKET_SIZE - 1) / PACKET_SIZE;
+
+        start(Upload, FW, image.size(), crc32_stm32(0xFFFFFFFF, &padded(image)[0], sizeOfCode / 4));
+        EXPECT_EQ(uploading, status());
+        for (uint32_t n = 0; n < packets; n++) {
+            packet(image, n);
+        }
+        command(Op_END, 0);
+        return status();
+    }
+
+    uint8_t uploadDescription(const std::vector<uint8_t> & desc)
+    {
+        start(Upload, Descript, desc.size(), 0);
+        EXPECT_EQ(uploading, status());
+        for (uint32_t n = 0; n < (desc.size() + PACKET_SIZE - 1) / PACKET_SIZE; n++) {
+            packet(desc, n);
+        }
+        command(Op_END, 0);
+        return status();
+    }
+
+    struct Page {
+        uint32_t offset;
+        uint32_t size;
+        uint32_t crc;
+    };
+
+    std::vector<Page> pageCRCs()
+    {
+        std::vector<Page> pages;
+        uint32_t total = 1;
+
+        while (pages.size() < total) {
+            command(Req_PageCRCs, pages.size());
+            EXPECT_EQ(Rep_PageCRCs, reply[1]);
+            total = (reply[6] << 8) | reply[7];
+            if (reply[8] == 0) {
+                break;
+            }
+            for (int n = 0; n < reply[8]; n++) {
+                Page page = { unpack(&reply[9 + 12 * n]), unpack(&reply[13 + 12 * n]), unpack(&reply[17 + 12 * n]) };
+                pages.push_back(page);
+            }
+        }
+        return pages;
+    }
+
+    // the GCS delta upload: erase and program only the pages that differ
+    uint8_t deltaUpload(const std::vector<uint8_t> & image, uint32_t crcError = 0)
+    {
+        std::vector<uint8_t> fw = padded(image);
+        std::vector<Page> pages = pageCRCs();
+        std::vector<Page> dirty;
+
+        for (size_t n = 0; n < pages.size(); n++) {
+            // the page holding the description is always rewritten
+            if (pages[n].offset + pages[n].size > sizeOfCode
+                || pages[n].crc != crc32_stm32(0xFFFFFFFF, &fw[pages[n].offset], pages[n].size / 4)) {
+                dirty.push_back(pages[n]);
+            }
+        }
+
+        start(Delta_Start, FW, image.size(), crc32_stm32(0xFFFFFFFF, &fw[0], sizeOfCode / 4) ^ crcError);
+        if (status() != uploading) {
+            return reply[6];
+        }
+        for (size_t n = 0; n < dirty.size(); n++) {
+            command(Erase_Page, dirty[n].offset);
+        }
+        for (uint32_t n = 0; n < (image.size() + PACKET_SIZE - 1) / PACKET_SIZE; n++) {
+            for (size_t p = 0; p < dirty.size(); p++) {
+                if (n * PACKET_SIZE < dirty[p].offset + dirty[p].size && (n + 1) * PACKET_SIZE > dirty[p].offset) {
+                    packet(image, n);
+                    break;
+                }
+            }
+        }
+        command(Op_END, 0);
+        return status();
+    }
+
+    std::vector<uint8_t> firmware(uint32_t size, int seed)
+    {
+        std::vector<uint8_t> image(size);
+
+        for (uint32_t n = 0; n < size; n++) {
+            image[n] = (uint8_t)(n * 7 + (n >> 8) * 13 + seed);
+        }
+        return image;
+    }
+
+    void checkFlash(const std::vector<uint8_t> & image)
+    {
+        std::vector<uint8_t> fw = padded(image);
+
+        ASSERT_TRUE(std::equal(fw.begin(), fw.end(), flash.mem.begin()));
+    }
+
+    void resetCounters()
+    {
+        flash.erases.assign(flash.pageSizes.size(), 0);
+        flash.programmed.assign(flash.pageSizes.size(), 0);
+        sent = 0;
+    }
+
+    std::set<int> erasedPages()
+    {
+        std::set<int> pages;
+
+        for (size_t n = 0; n < flash.erases.size(); n++) {
+            if (flash.erases[n]) {
+                pages.insert(n);
+            }
+        }
+        return pages;
+    }
+
+    uint32_t sizeOfCode;
+    uint8_t caps;
+    int sent;
+};
+
+TEST_F(DfuTest, ReportsDeltaCapability) {
+    enterDFU();
+    EXPECT_EQ((uint32_t)(BANK_SIZE - DESC_SIZE), sizeOfCode);
+    EXPECT_EQ(DFU_CAP_DELTA_UPLOAD, caps & DFU_CAP_DELTA_UPLOAD);
+}
+
+TEST_F(DfuTest, PageCRCsCoverTheBank) {
+    enterDFU();
+    std::vector<uint8_t> image = firmware(100000, 1);
+    ASSERT_EQ(Last_operation_Success, fullUpload(image));
+
+    std::vector<Page> pages = pageCRCs();
+    ASSERT_EQ((size_t)(BANK_SIZE / 1024), pages.size());
+
+    std::vector<uint8_t> fw = padded(image);
+    uint32_t offset = 0;
+    for (size_t n = 0; n < pages.size(); n++) {
+        EXPECT_EQ(offset, pages[n].offset);
+        EXPECT_EQ(1024u, pages[n].size);
+        uint32_t size = (offset + 1024 > sizeOfCode) ? sizeOfCode - offset : 1024;
+        EXPECT_EQ(crc32_stm32(0xFFFFFFFF, &fw[offset], size / 4), pages[n].crc) << "page " << n;
+        offset += pages[n].size;
+    }
+    EXPECT_EQ((uint32_t)BANK_SIZE, offset);
+}
+
+TEST_F(DfuTest, DeltaUploadOnlyTouchesChangedPages) {
+    enterDFU();
+    std::vector<uint8_t> image = firmware(200000, 1);
+    std::vector<uint8_t> desc(DESC_SIZE, 'd');
+    ASSERT_EQ(Last_operation_Success, fullUpload(image));
+    ASSERT_EQ(Last_operation_Success, uploadDescription(desc));
+    int fullPackets = sent;
+
+    // a small patch, a few bytes in two places
+    image[5000]++;
+    image[150001] ^= 0x55;
+    image[150002] ^= 0x55;
+
+    resetCounters();
+    ASSERT_EQ(Last_operation_Success, deltaUpload(image));
+    int deltaPackets = sent;
+    checkFlash(image);
+
+    std::set<int> expected;
+    expected.insert(5000 / 1024);
+    expected.insert(150001 / 1024);
+    expected.insert(flash.pageSizes.size() - 1); // description
+    EXPECT_EQ(expected, erasedPages());
+    for (size_t n = 0; n < flash.programmed.size(); n++) {
+        if (!expected.count(n)) {
+            EXPECT_EQ(0, flash.programmed[n]) << "page " << n;
+        }
+    }
+
+    ASSERT_EQ(Last_operation_Success, uploadDescription(desc));
+    EXPECT_TRUE(std::equal(desc.begin(), desc.end(), flash.mem.begin() + sizeOfCode));
+
+    printf("full upload %d packets, delta upload %d packets\n", fullPackets, deltaPackets);
+    EXPECT_LT(deltaPackets * 10, fullPackets);
+}
+
+TEST_F(DfuTest, DeltaUploadOfShorterImageClearsTheTail) {
+    enterDFU();
+    std::vector<uint8_t> image = firmware(200000, 1);
+    ASSERT_EQ(Last_operation_Success, fullUpload(image));
+
+    image.resize(120000);
+    image[100] = 0;
+    resetCounters();
+    ASSERT_EQ(Last_operation_Success, deltaUpload(image));
+    checkFlash(image);
+    EXPECT_EQ(0, flash.erases[50]);
+    EXPECT_EQ(1, flash.erases[0]);
+    EXPECT_EQ(1, flash.erases[150]);
+}
+
+TEST_F(DfuTest, DeltaUploadOnSectors) {
+    // f4 style, a 64k sector followed by 128k ones
+    flash_geometry(128 * 1024, 64 * 1024);
+    enterDFU();
+    std::vector<uint8_t> image = firmware(300000, 1);
+    ASSERT_EQ(Last_operation_Success, fullUpload(image));
+
+    image[70000]++;
+    resetCounters();
+    ASSERT_EQ(Last_operation_Success, deltaUpload(image));
+    checkFlash(image);
+
+    std::set<int> expected;
+    expected.insert(1);
+    expected.insert(3);
+    EXPECT_EQ(expected, erasedPages());
+    EXPECT_EQ(0, flash.programmed[0]);
+    EXPECT_EQ(0, flash.programmed[2]);
+}
+
+TEST_F(DfuTest, DeltaUploadChecksTheImageCRC) {
+    enterDFU();
+    std::vector<uint8_t> image = firmware(100000, 1);
+    ASSERT_EQ(Last_operation_Success, fullUpload(image));
+
+    image[30000]++;
+    EXPECT_EQ(CRC_Fail, deltaUpload(image, 1));
+    // and the bootloader is ready for the next try
+    command(Abort_Operation, 0);
+    EXPECT_EQ(Last_operation_Success, deltaUpload(image));
+    checkFlash(image);
+}
+
+TEST_F(DfuTest, DeltaUploadOfIdenticalImage) {
+    enterDFU();
+    std::vector<uint8_t> image = firmware(100000, 1);
+    ASSERT_EQ(Last_operation_Success, fullUpload(image));
+
+    resetCounters();
+    ASSERT_EQ(Last_operation_Success, deltaUpload(image));
+    checkFlash(image);
+    // only the description page
+    EXPECT_EQ(1u, erasedPages().size());
+}
+
+TEST_F(DfuTest, FullUploadStillInOrder) {
+    enterDFU();
+    std::vector<uint8_t> image = firmware(10000, 1);
+    ASSERT_EQ(Last_operation_Success, deltaUpload(image));
+
+    // a plain upload must not accept the gaps of a delta one
+    start(Upload, FW, image.size(), 0);
+    ASSERT_EQ(uploading, status());
+    packet(image, 0);
+    packet(image, 2);
+    EXPECT_EQ(wrong_packet_received, status());
+}
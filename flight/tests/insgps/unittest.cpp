@@ -0,0 +1,381 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <string.h> /* memcpy */
+#include <math.h> /* sin, cos */
+#include <time.h> /* clock_gettime */
+
+#include <vector>
+
+extern "C" {
+#include "insgps.h"
+#include "insgps_update.h"
+}
+
+#define NUMV 10
+
+// the sensor sparsity of LinearizeH(), shared by the 13 and 16 state filters
+static const int8_t HrowMin[NUMV] = { 0, 1, 2, 3, 4, 5, 6, 6, 6, 2 };
+static const int8_t HrowMax[NUMV] = { 0, 1, 2, 3, 4, 5, 9, 9, 9, 2 };
+
+static double now_s()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * SerialUpdate() of insgps13state.c before the block aware update, for any
+ * number of states. It forms the full H*P row and updates all of P.
+ */
+static void referenceSerialUpdate(int n, float *H, float *R, float *Z, float *Y, float *P, float *X, uint16_t SensorsUsed)
+{
+    float HP[INSGPS_MAX_STATES], HPHR, Error;
+    int i, j, k, m;
+    float Km[INSGPS_MAX_STATES];
+
+    for (m = 0; m < NUMV; m++) {
+        if (SensorsUsed & (0x01 << m)) {
+            for (j = 0; j < n; j++) {
+                HP[j] = 0;
+            }
+            for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
+                for (j = 0; j < n; j++) {
+                    HP[j] += H[m * n + k] * P[k * n + j];
+                }
+            }
+            HPHR = R[m];
+            for (k = HrowMin[m]; k <= HrowMax[m]; k++) {
+                HPHR += HP[k] * H[m * n + k];
+            }
+            float invHPHR = 1.0f / HPHR;
+            for (k = 0; k < n; k++) {
+                Km[k] = HP[k] * invHPHR;
+            }
+            for (i = 0; i < n; i++) {
+                for (j = i; j < n; j++) {
+                    P[i * n + j] = P[j * n + i] = P[i * n + j] - Km[i] * HP[j];
+                }
+            }
+            Error = Z[m] - Y[m];
+            for (i = 0; i < n; i++) {
+                X[i] = X[i] + Km[i] * Error;
+            }
+        }
+    }
+}
+
+static void serialUpdate(int n, float *H, float *R, float *Z, float *Y, float *P, float *X, uint16_t SensorsUsed)
+{
+    for (int m = 0; m < NUMV; m++) {
+        if (SensorsUsed & (0x01 << m)) {
+            INSSerialUpdateRow(n, P, X, &H[m * n], HrowMin[m], HrowMax[m], R[m], Z[m] - Y[m]);
+        }
+    }
+    INSMirrorUpper(n, P);
+}
+
+static float uniform()
+{
+    return (float)rand() / RAND_MAX - 0.5f;
+}
+
+static const int numStates[] = { 13, 16 };
+
+class SerialUpdateTest : public testing::Test {
+protected:
+    void init(int states)
+    {
+        n = states;
+        srand(n);
+        H.assign(NUMV * n, 0.0f);
+        for (int m = 0; m < NUMV; m++) {
+            for (int k = HrowMin[m]; k <= HrowMax[m]; k++) {
+                H[m * n + k] = (m < 6) ? 1.0f : (m == 9) ? -1.0f : 2.0f * uniform();
+            }
+            R[m] = 0.001f + 0.01f * (uniform() + 0.5f);
+            Z[m] = uniform();
+            Y[m] = uniform();
+        }
+        X.resize(n);
+        for (int i = 0; i < n; i++) {
+            X[i] = uniform();
+        }
+        randomCovariance(n);
+    }
+
+    // P = A * A' + I / 10, symmetric positive definite
+    void randomCovariance(int blockEnd)
+    {
+        std::vector<double> A(n * n);
+
+        for (int i = 0; i < n * n; i++) {
+            A[i] = uniform();
+        }
+        P.assign(n * n, 0.0f);
+        for (int i = 0; i < n; i++) {
+            for (int j = i; j < n; j++) {
+                if ((i < blockEnd) != (j < blockEnd)) {
+                    continue; // no correlation between the blocks
+                }
+                double s = (i == j) ? 0.1 : 0.0;
+                for (int k = 0; k < n; k++) {
+                    s += A[i * n + k] * A[j * n + k];
+                }
+                P[i * n + j] = P[j * n + i] = (float)s;
+            }
+        }
+    }
+
+    void expectSameUpdate(uint16_t sensors)
+    {
+        std::vector<float> P1(P), P2(P), X1(X), X2(X);
+
+        referenceSerialUpdate(n, &H[0], R, Z, Y, &P1[0], &X1[0], sensors);
+        serialUpdate(n, &H[0], R, Z, Y, &P2[0], &X2[0], sensors);
+        for (int i = 0; i < n; i++) {
+            EXPECT_FLOAT_EQ(X1[i], X2[i]) << "X[" << i << "]";
+            for (int j = 0; j < n; j++) {
+                EXPECT_FLOAT_EQ(P1[i * n + j], P2[i * n + j]) << "P[" << i << "][" << j << "]";
+            }
+        }
+    }
+
+    void throughput()
+    {
+        const int rounds = 20000;
+        std::vector<float> P1(P), X1(X);
+        double start;
+        double reference;
+        double update;
+
+        start = now_s();
+        for (int r = 0; r < rounds; r++) {
+            memcpy(&P1[0], &P[0], n * n * sizeof(float));
+            referenceSerialUpdate(n, &H[0], R, Z, Y, &P1[0], &X1[0], FULL_SENSORS);
+        }
+        reference = (now_s() - start) / rounds * 1e6;
+
+        start = now_s();
+        for (int r = 0; r < rounds; r++) {
+            memcpy(&P1[0], &P[0], n * n * sizeof(float));
+            serialUpdate(n, &H[0], R, Z, Y, &P1[0], &X1[0], FULL_SENSORS);
+        }
+        update = (now_s() - start) / rounds * 1e6;
+
+        printf("%d states, all sensors: dense %.2f us, block aware %.2f us\n", n, reference, update);
+    }
+
+    int n;
+    std::vector<float> H, P, X;
+    float R[NUMV], Z[NUMV], Y[NUMV];
+};
+
+TEST_F(SerialUpdateTest, MatchesDenseUpdate) {
+    const uint16_t sets[] = { FULL_SENSORS, MAG_SENSORS | BARO_SENSOR, POS_SENSORS, HORIZ_SENSORS | VERT_SENSORS, BARO_SENSOR };
+
+    for (int states = 0; states < 2; states++) {
+        init(numStates[states]);
+        for (size_t s = 0; s < sizeof(sets) / sizeof(sets[0]); s++) {
+            SCOPED_TRACE(testing::Message() << n << " states, sensors " << sets[s]);
+            expectSameUpdate(sets[s]);
+        }
+    }
+}
+
+TEST_F(SerialUpdateTest, MatchesDenseUpdateAfterPosVelReset) {
+    for (int states = 0; states < 2; states++) {
+        init(numStates[states]);
+        SCOPED_TRACE(testing::Message() << n << " states");
+        // INSPosVelReset() clears the correlation of position and velocity with the rest
+        randomCovariance(6);
+        expectSameUpdate(FULL_SENSORS);
+        expectSameUpdate(POS_SENSORS | HORIZ_SENSORS | VERT_SENSORS);
+    }
+}
+
+TEST_F(SerialUpdateTest, Throughput) {
+    for (int states = 0; states < 2; states++) {
+        init(numStates[states]);
+        throughput();
+    }
+}
+/*
+ * Simulated flight: a slow climbing turn with a rocking attitude, sampled
+ * like the sensors of a Revolution. The state estimation feeds the filter
+ * the same way, so the run covers every correction the module makes.
+ */
+#define SIM_DT       0.002f
+#define SIM_STEPS    10000
+#define SIM_MAG_RATE 10 // steps between mag and baro samples
+#define SIM_GPS_RATE 100 // steps between GPS samples
+
+struct FilterResult {
+    float pos[3];
+    float vel[3];
+    float q[4];
+    float gyro_bias[3];
+    float var[13];
+};
+
+static void rotate(const double q[4], const double in[3], double out[3], bool toBody)
+{
+    // Rbe from the quaternion, transposed when going to the earth frame
+    double R[3][3];
+
+    R[0][0] = q[0] * q[0] + q[1] * q[1] - q[2] * q[2] - q[3] * q[3];
+    R[0][1] = 2 * (q[1] * q[2] + q[0] * q[3]);
+    R[0][2] = 2 * (q[1] * q[3] - q[0] * q[2]);
+    R[1][0] = 2 * (q[1] * q[2] - q[0] * q[3]);
+    R[1][1] = q[0] * q[0] - q[1] * q[1] + q[2] * q[2] - q[3] * q[3];
+    R[1][2] = 2 * (q[2] * q[3] + q[0] * q[1]);
+    R[2][0] = 2 * (q[1] * q[3] + q[0] * q[2]);
+    R[2][1] = 2 * (q[2] * q[3] - q[0] * q[1]);
+    R[2][2] = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+    for (int i = 0; i < 3; i++) {
+        out[i] = 0;
+        for (int j = 0; j < 3; j++) {
+            out[i] += (toBody ? R[i][j] : R[j][i]) * in[j];
+        }
+    }
+}
+
+static void runFlight(FilterResult *result)
+{
+    const double Be[3]    = { 0.35, 0.05, 0.94 };
+    const double gyroBias[3] = { 0.01, -0.02, 0.005 };
+    double q[4] = { 1, 0, 0, 0 };
+    double pos[3] = { 0, 0, 0 };
+    double vel[3] = { 0, 0, 0 };
+    float zeros[3] = { 0, 0, 0 };
+    float qInit[4] = { 1, 0, 0, 0 };
+    float BeInit[3] = { (float)Be[0], (float)Be[1], (float)Be[2] };
+    float magVar[3] = { 0.005f, 0.005f, 0.005f };
+    float accelVar[3] = { 0.01f, 0.01f, 0.01f };
+    float gyroVar[3] = { 1e-5f, 1e-5f, 1e-5f };
+    float gyroBiasVar[3] = { 1e-7f, 1e-7f, 1e-7f };
+    float posVar[3] = { 1.0f, 1.0f, 1.0f };
+    float velVar[3] = { 0.1f, 0.1f, 0.1f };
+    float PDiag[13] = { 25, 25, 25, 5, 5, 5, 1e-5f, 1e-5f, 1e-5f, 1e-5f, 1e-6f, 1e-6f, 1e-6f };
+
+    srand(42);
+    INSGPSInit();
+    INSSetMagNorth(BeInit);
+    INSSetMagVar(magVar);
+    INSSetAccelVar(accelVar);
+    INSSetGyroVar(gyroVar);
+    INSSetGyroBiasVar(gyroBiasVar);
+    INSSetBaroVar(0.25f);
+    INSSetPosVelVar(posVar, velVar);
+    INSSetState(zeros, zeros, qInit, zeros, zeros);
+    INSResetP(PDiag);
+
+    for (int step = 1; step <= SIM_STEPS; step++) {
+        double t = step * SIM_DT;
+        // body rates and NED acceleration of the manoeuvre
+        double rates[3] = { 0.3 * cos(t), 0.2 * sin(0.7 * t), 0.15 };
+        double accelNED[3] = { 0.5 * cos(0.15 * t), 0.5 * sin(0.15 * t), -0.2 * sin(0.3 * t) };
+
+        double dq[4] = {
+            0.5 * (-q[1] * rates[0] - q[2] * rates[1] - q[3] * rates[2]),
+            0.5 * (q[0] * rates[0] - q[3] * rates[1] + q[2] * rates[2]),
+            0.5 * (q[3] * rates[0] + q[0] * rates[1] - q[1] * rates[2]),
+            0.5 * (-q[2] * rates[0] + q[1] * rates[1] + q[0] * rates[2])
+        };
+        double norm = 0;
+        for (int i = 0; i < 4; i++) {
+            q[i] += dq[i] * SIM_DT;
+            norm += q[i] * q[i];
+        }
+        for (int i = 0; i < 4; i++) {
+            q[i] /= sqrt(norm);
+        }
+        for (int i = 0; i < 3; i++) {
+            pos[i] += vel[i] * SIM_DT;
+            vel[i] += accelNED[i] * SIM_DT;
+        }
+
+        // specific force in the body frame
+        double forceNED[3] = { accelNED[0], accelNED[1], accelNED[2] - 9.81 };
+        double forceBody[3];
+        rotate(q, forceNED, forceBody, true);
+
+        float gyro[3], accel[3];
+        for (int i = 0; i < 3; i++) {
+            gyro[i]  = (float)(rates[i] + gyroBias[i]) + 0.01f * uniform();
+            accel[i] = (float)forceBody[i] + 0.2f * uniform();
+        }
+        INSStatePrediction(gyro, accel, SIM_DT);
+        INSCovariancePrediction(SIM_DT);
+
+        uint16_t sensors = 0;
+        float mag[3] = { 0, 0, 0 }, gpsPos[3] = { 0, 0, 0 }, gpsVel[3] = { 0, 0, 0 }, baro = 0;
+        if (step % SIM_MAG_RATE == 0) {
+            double magBody[3];
+            rotate(q, Be, magBody, true);
+            for (int i = 0; i < 3; i++) {
+                mag[i] = (float)magBody[i] + 0.02f * uniform();
+            }
+            baro     = (float)-pos[2] + 0.5f * uniform();
+            sensors |= MAG_SENSORS | BARO_SENSOR;
+        }
+        if (step % SIM_GPS_RATE == 0) {
+            for (int i = 0; i < 3; i++) {
+                gpsPos[i] = (float)pos[i] + 1.0f * uniform();
+                gpsVel[i] = (float)vel[i] + 0.1f * uniform();
+            }
+            sensors |= POS_SENSORS | HORIZ_SENSORS | VERT_SENSORS;
+        }
+        if (sensors) {
+            INSCorrection(mag, gpsPos, gpsVel, baro, sensors);
+        }
+    }
+
+    memcpy(result->pos, Nav.Pos, sizeof(result->pos));
+    memcpy(result->vel, Nav.Vel, sizeof(result->vel));
+    memcpy(result->q, Nav.q, sizeof(result->q));
+    memcpy(result->gyro_bias, Nav.gyro_bias, sizeof(result->gyro_bias));
+    INSGetP(result->var);
+}
+
+/* Taken from the dense serial update, before the block aware update */
+static const FilterResult golden = {
+    { 44.1163483f, 63.764389f, -13.9626408f },
+    { 0.358004898f, 6.81722736f, -0.0208661407f },
+    { 0.13103199f, 0.150364906f, 0.118164271f, 0.972758114f },
+    { 0.00967613235f, -0.0193855409f, 0.00436445698f },
+    { 0.0559573732f, 0.0567855909f, 0.00236879522f, 0.00521211466f, 0.00541668432f, 0.000206939949f, 2.21644514e-05f,
+      1.46791922e-06f, 6.53625762e-07f, 5.87598606e-07f, 3.6309654e-08f, 4.34886438e-08f, 3.58645707e-07f }
+};
+
+static void expectNear(const float *expected, const float *actual, int n, const char *name)
+{
+    for (int i = 0; i < n; i++) {
+        EXPECT_NEAR(expected[i], actual[i], 1e-5f * fabsf(expected[i]) + 1e-6f) << name << "[" << i << "]";
+    }
+}
+
+TEST(InsGpsTest, SimulatedFlightMatchesGolden) {
+    FilterResult result;
+
+    runFlight(&result);
+    expectNear(golden.pos, result.pos, 3, "pos");
+    expectNear(golden.vel, result.vel, 3, "vel");
+    expectNear(golden.q, result.q, 4, "q");
+    expectNear(golden.gyro_bias, result.gyro_bias, 3, "gyro_bias");
+    // the variances are tiny, compare them relative only
+    for (int i = 0; i < 13; i++) {
+        EXPECT_NEAR(golden.var[i], result.var[i], 1e-5f * golden.var[i]) << "var[" << i << "]";
+    }
+}
+
+TEST(InsGpsTest, SimulatedFlightThroughput) {
+    FilterResult result;
+    double start = now_s();
+
+    runFlight(&result);
+    printf("%d steps of %.0f s of flight in %.1f ms\n", SIM_STEPS, SIM_STEPS * SIM_DT, (now_s() - start) * 1e3);
+}
@@ -0,0 +1,13 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+/* Single threaded host stand-ins for the kernel functions used by pios_instrumentation */
+#include <stdlib.h>
+
+typedef void *xTaskHandle;
+
+#define pvPortMalloc(size) malloc(size)
+#define vPortEnterCritical()
+#define vPortExitCritical()
+
+#endif /* FREERTOS_H */
@@ -0,0 +1,9 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* Just enough to build pios_instrumentation.c on the host */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#endif /* PIOS_H */
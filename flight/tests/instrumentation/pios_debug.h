@@ -0,0 +1,8 @@
+#ifndef PIOS_DEBUG_H
+#define PIOS_DEBUG_H
+
+#include <assert.h>
+
+#define PIOS_Assert(test) assert(test)
+
+#endif /* PIOS_DEBUG_H */
@@ -0,0 +1,6 @@
+#ifndef TASK_H
+#define TASK_H
+
+xTaskHandle xTaskGetCurrentTaskHandle(void);
+
+#endif /* TASK_H */
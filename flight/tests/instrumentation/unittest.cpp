@@ -0,0 +1,225 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <time.h> /* clock_gettime */
+
+extern "C" {
+#include "pios_instrumentation.h"
+
+/* fake clock and scheduler, the raw clock counts microseconds */
+static uint32_t fakeRaw;
+static xTaskHandle fakeTask;
+
+uint32_t PIOS_DELAY_GetRaw()
+{
+    return fakeRaw;
+}
+
+uint32_t PIOS_DELAY_DiffuS(uint32_t raw)
+{
+    return fakeRaw - raw;
+}
+
+xTaskHandle xTaskGetCurrentTaskHandle(void)
+{
+    return fakeTask;
+}
+}
+
+#define MAX_COUNTERS 100
+
+static double now_s()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void countCallback(const pios_perf_counter_t *counter, const int8_t index, void *context)
+{
+    pios_perf_counter_t *copies = (pios_perf_counter_t *)context;
+
+    copies[index] = *counter;
+}
+
+class InstrumentationTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        fakeRaw  = 1;
+        fakeTask = NULL;
+        PIOS_Instrumentation_Init(MAX_COUNTERS);
+    }
+
+    // ids as modules use them, module in the upper half word
+    uint32_t counterId(int i)
+    {
+        return ((0x5300 + i / 8) << 16) | (i % 8 + 1);
+    }
+};
+
+TEST_F(InstrumentationTest, CreateAndSearch) {
+    pios_counter_t handles[MAX_COUNTERS];
+
+    for (int i = 0; i < MAX_COUNTERS; i++) {
+        handles[i] = PIOS_Instrumentation_CreateCounter(counterId(i));
+        ASSERT_TRUE(handles[i] != NULL);
+    }
+    for (int i = 0; i < MAX_COUNTERS; i++) {
+        EXPECT_EQ(handles[i], PIOS_Instrumentation_SearchCounter(counterId(i)));
+        EXPECT_EQ(counterId(i), ((pios_perf_counter_t *)handles[i])->id);
+    }
+    EXPECT_TRUE(PIOS_Instrumentation_SearchCounter(0x12345678) == NULL);
+    EXPECT_TRUE(PIOS_Instrumentation_SearchCounter(0) == NULL);
+}
+
+TEST_F(InstrumentationTest, CreateExisting) {
+    pios_counter_t first = PIOS_Instrumentation_CreateCounter(0xA7710001);
+
+    PIOS_Instrumentation_CreateCounter(0xA7710002);
+    EXPECT_EQ(first, PIOS_Instrumentation_CreateCounter(0xA7710001));
+    EXPECT_EQ(1, pios_instrumentation_last_used_counter);
+}
+
+TEST_F(InstrumentationTest, ForEachKeepsCreationOrder) {
+    pios_perf_counter_t copies[MAX_COUNTERS];
+
+    for (int i = 0; i < 10; i++) {
+        PIOS_Instrumentation_CreateCounter(counterId(9 - i));
+    }
+    PIOS_Instrumentation_ForEachCounter(countCallback, copies);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(counterId(9 - i), copies[i].id);
+    }
+}
+
+TEST_F(InstrumentationTest, HistogramBuckets) {
+    pios_counter_t counter = PIOS_Instrumentation_CreateCounter(1);
+    pios_perf_counter_t *c = (pios_perf_counter_t *)counter;
+    const int32_t values[]  = { -5, 0, 1, 2, 3, 4, 1000, 100000 };
+    const int buckets[]     = { 0, 0, 1, 2, 2, 3, 10, 15 };
+
+    for (unsigned i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        PIOS_Instrumentation_updateCounter(counter, values[i]);
+    }
+    uint16_t expected[PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS] = { 0 };
+    for (unsigned i = 0; i < sizeof(buckets) / sizeof(buckets[0]); i++) {
+        expected[buckets[i]]++;
+    }
+    for (int i = 0; i < PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS; i++) {
+        EXPECT_EQ(expected[i], c->histogram[i]) << "bucket " << i;
+    }
+    EXPECT_EQ(8, c->count);
+    EXPECT_EQ(101010u, c->total);
+    EXPECT_EQ(PIOS_PERF_COUNTER_VALUE, c->type);
+    EXPECT_EQ(100000, c->max);
+}
+
+TEST_F(InstrumentationTest, TimedSection) {
+    pios_counter_t counter = PIOS_Instrumentation_CreateCounter(2);
+    pios_perf_counter_t *c = (pios_perf_counter_t *)counter;
+    int task;
+
+    fakeTask = &task;
+    for (int i = 0; i < 4; i++) {
+        PIOS_Instrumentation_TimeStart(counter);
+        fakeRaw += 150;
+        PIOS_Instrumentation_TimeEnd(counter);
+        fakeRaw += 1000;
+    }
+    EXPECT_EQ(150, c->value);
+    EXPECT_EQ(4, c->count);
+    EXPECT_EQ(600u, c->total);
+    EXPECT_EQ(4, c->histogram[8]);
+    EXPECT_EQ(PIOS_PERF_COUNTER_DURATION, c->type);
+    EXPECT_EQ((xTaskHandle)&task, c->task);
+}
+
+TEST_F(InstrumentationTest, TrackPeriod) {
+    pios_counter_t counter = PIOS_Instrumentation_CreateCounter(3);
+    pios_perf_counter_t *c = (pios_perf_counter_t *)counter;
+
+    // the first call only starts the measurement
+    for (int i = 0; i < 11; i++) {
+        PIOS_Instrumentation_TrackPeriod(counter);
+        fakeRaw += 2000;
+    }
+    EXPECT_EQ(10, c->count);
+    EXPECT_EQ(20000u, c->total);
+    EXPECT_EQ(10, c->histogram[11]);
+    EXPECT_EQ(PIOS_PERF_COUNTER_PERIOD, c->type);
+}
+
+TEST_F(InstrumentationTest, SnapshotRestartsStatistics) {
+    pios_counter_t counter = PIOS_Instrumentation_CreateCounter(4);
+    pios_perf_counter_t *c = (pios_perf_counter_t *)counter;
+    pios_perf_counter_t snapshots[MAX_COUNTERS];
+
+    PIOS_Instrumentation_updateCounter(counter, 7);
+    PIOS_Instrumentation_updateCounter(counter, 9);
+    PIOS_Instrumentation_ForEachSnapshot(countCallback, snapshots);
+
+    EXPECT_EQ(2, snapshots[0].count);
+    EXPECT_EQ(16u, snapshots[0].total);
+    EXPECT_EQ(1, snapshots[0].histogram[3]);
+    EXPECT_EQ(1, snapshots[0].histogram[4]);
+
+    // the statistics restart, the running values are kept
+    EXPECT_EQ(0, c->count);
+    EXPECT_EQ(0u, c->total);
+    for (int i = 0; i < PIOS_INSTRUMENTATION_HISTOGRAM_BUCKETS; i++) {
+        EXPECT_EQ(0, c->histogram[i]);
+    }
+    EXPECT_EQ(9, c->value);
+    EXPECT_EQ(9, c->max);
+}
+
+TEST_F(InstrumentationTest, HistogramSaturates) {
+    pios_counter_t counter = PIOS_Instrumentation_CreateCounter(5);
+    pios_perf_counter_t *c = (pios_perf_counter_t *)counter;
+
+    for (int i = 0; i < 70000; i++) {
+        PIOS_Instrumentation_updateCounter(counter, 1);
+    }
+    EXPECT_EQ(UINT16_MAX, c->histogram[1]);
+    EXPECT_EQ(UINT16_MAX, c->count);
+    EXPECT_EQ(70000u, c->total);
+}
+
+TEST_F(InstrumentationTest, Benchmark) {
+    const int rounds = 200000;
+    volatile uintptr_t sink = 0;
+
+    for (int i = 0; i < MAX_COUNTERS; i++) {
+        PIOS_Instrumentation_CreateCounter(counterId(i));
+    }
+
+    // the linear search the registry used before
+    double t0 = now_s();
+    for (int r = 0; r < rounds; r++) {
+        uint32_t id = counterId(r % MAX_COUNTERS);
+        int8_t i    = 0;
+        while (i < pios_instrumentation_last_used_counter && pios_instrumentation_perf_counters[i].id != id) {
+            i++;
+        }
+        sink += (uintptr_t)&pios_instrumentation_perf_counters[i];
+    }
+    double t1 = now_s();
+    for (int r = 0; r < rounds; r++) {
+        sink += (uintptr_t)PIOS_Instrumentation_SearchCounter(counterId(r % MAX_COUNTERS));
+    }
+    double t2 = now_s();
+
+    pios_counter_t counter = PIOS_Instrumentation_SearchCounter(counterId(0));
+    for (int r = 0; r < rounds; r++) {
+        PIOS_Instrumentation_TimeStart(counter);
+        fakeRaw += r & 1023;
+        PIOS_Instrumentation_TimeEnd(counter);
+    }
+    double t3 = now_s();
+
+    printf("search of %d counters: linear %.1f ns, hashed %.1f ns, timed section %.1f ns\n",
+           MAX_COUNTERS, (t1 - t0) * 1e9 / rounds, (t2 - t1) * 1e9 / rounds, (t3 - t2) * 1e9 / rounds);
+    (void)sink;
+}
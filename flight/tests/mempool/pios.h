@@ -0,0 +1,14 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* Just enough to build pios_mempool.c on the host */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#define PIOS_INCLUDE_MEMPOOL
+
+#define PIOS_Assert(test) assert(test)
+
+#endif /* PIOS_H */
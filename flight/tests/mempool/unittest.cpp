@@ -0,0 +1,167 @@
+#include "gtest/gtest.h"
+
+#include <stdlib.h> /* rand */
+#include <string.h> /* memset */
+#include <vector>
+
+extern "C" {
+#include "pios_mempool.h"
+}
+
+static const struct pios_mempool_class classes[] = {
+    { 16, 4 }, { 30, 2 }, { 64, 3 },
+};
+#define NUM_CLASSES (sizeof(classes) / sizeof(classes[0]))
+
+class MemPoolTest : public testing::Test {
+protected:
+    std::vector<uint64_t> arena;
+
+    virtual void SetUp()
+    {
+        arena.resize(PIOS_MEMPOOL_ArenaSize(classes, NUM_CLASSES) / sizeof(uint64_t));
+        ASSERT_EQ(0, PIOS_MEMPOOL_Init(classes, NUM_CLASSES, &arena[0]));
+    }
+
+    struct pios_mempool_stats stats(uint8_t c)
+    {
+        struct pios_mempool_stats s[PIOS_MEMPOOL_MAX_CLASSES];
+
+        EXPECT_EQ(NUM_CLASSES, PIOS_MEMPOOL_GetStats(s, PIOS_MEMPOOL_MAX_CLASSES));
+        return s[c];
+    }
+};
+
+TEST_F(MemPoolTest, ArenaSizeRoundsBlocksToTheAlignment) {
+    EXPECT_EQ(4u * 16 + 2u * 32 + 3u * 64, PIOS_MEMPOOL_ArenaSize(classes, NUM_CLASSES));
+    EXPECT_EQ(32, stats(1).block_size);
+    EXPECT_EQ(2, stats(1).blocks);
+}
+
+TEST_F(MemPoolTest, RejectsInvalidClassTables) {
+    const struct pios_mempool_class unsorted[] = { { 64, 1 }, { 16, 1 } };
+    const struct pios_mempool_class same_size[] = { { 10, 1 }, { 16, 1 } };
+    const struct pios_mempool_class empty[] = { { 16, 0 } };
+    const struct pios_mempool_class too_many[PIOS_MEMPOOL_MAX_CLASSES + 1] = {};
+
+    EXPECT_EQ(-1, PIOS_MEMPOOL_Init(unsorted, 2, &arena[0]));
+    EXPECT_EQ(-1, PIOS_MEMPOOL_Init(same_size, 2, &arena[0]));
+    EXPECT_EQ(-1, PIOS_MEMPOOL_Init(empty, 1, &arena[0]));
+    EXPECT_EQ(-1, PIOS_MEMPOOL_Init(too_many, PIOS_MEMPOOL_MAX_CLASSES + 1, &arena[0]));
+    EXPECT_EQ(-1, PIOS_MEMPOOL_Init(classes, NUM_CLASSES, (uint8_t *)&arena[0] + 4));
+}
+
+TEST_F(MemPoolTest, TakesTheSmallestClassThatFits) {
+    void *p;
+
+    p = PIOS_MEMPOOL_Alloc(1);
+    EXPECT_EQ(16u, PIOS_MEMPOOL_BlockSize(p));
+    p = PIOS_MEMPOOL_Alloc(16);
+    EXPECT_EQ(16u, PIOS_MEMPOOL_BlockSize(p));
+    p = PIOS_MEMPOOL_Alloc(17);
+    EXPECT_EQ(32u, PIOS_MEMPOOL_BlockSize(p));
+    p = PIOS_MEMPOOL_Alloc(64);
+    EXPECT_EQ(64u, PIOS_MEMPOOL_BlockSize(p));
+    EXPECT_EQ(NULL, PIOS_MEMPOOL_Alloc(65));
+}
+
+TEST_F(MemPoolTest, BlocksAreAlignedAndDisjoint) {
+    std::vector<uint8_t *> blocks;
+
+    for (uint8_t c = 0; c < NUM_CLASSES; c++) {
+        for (uint16_t i = 0; i < classes[c].blocks; i++) {
+            uint8_t *p = (uint8_t *)PIOS_MEMPOOL_Alloc(classes[c].block_size);
+            ASSERT_TRUE(p != NULL);
+            EXPECT_EQ(0u, (uintptr_t)p % PIOS_MEMPOOL_ALIGN);
+            memset(p, blocks.size(), classes[c].block_size);
+            blocks.push_back(p);
+        }
+    }
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        size_t size = PIOS_MEMPOOL_BlockSize(blocks[i]);
+        for (size_t j = 0; j < size && j < classes[0].block_size; j++) {
+            ASSERT_EQ(i, blocks[i][j]);
+        }
+    }
+}
+
+TEST_F(MemPoolTest, ExhaustedClassFailsWithoutSpilling) {
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(PIOS_MEMPOOL_Alloc(8) != NULL);
+    }
+    EXPECT_EQ(NULL, PIOS_MEMPOOL_Alloc(8));
+    EXPECT_EQ(NULL, PIOS_MEMPOOL_Alloc(16));
+
+    EXPECT_EQ(4, stats(0).used);
+    EXPECT_EQ(2, stats(0).failed);
+    EXPECT_EQ(0, stats(1).used);
+}
+
+TEST_F(MemPoolTest, FreedBlockIsReused) {
+    void *a = PIOS_MEMPOOL_Alloc(40);
+    void *b = PIOS_MEMPOOL_Alloc(40);
+
+    EXPECT_EQ(2, stats(2).used);
+    EXPECT_TRUE(PIOS_MEMPOOL_Free(a));
+    EXPECT_EQ(1, stats(2).used);
+    EXPECT_EQ(2, stats(2).max_used);
+
+    EXPECT_EQ(a, PIOS_MEMPOOL_Alloc(40));
+    EXPECT_TRUE(PIOS_MEMPOOL_Free(b));
+    EXPECT_TRUE(PIOS_MEMPOOL_Free(a));
+    EXPECT_EQ(0, stats(2).used);
+    EXPECT_EQ(2, stats(2).max_used);
+}
+
+TEST_F(MemPoolTest, ForeignPointersAreLeftToTheHeap) {
+    uint64_t heap_block[4];
+
+    EXPECT_FALSE(PIOS_MEMPOOL_Free(heap_block));
+    EXPECT_FALSE(PIOS_MEMPOOL_Free(NULL));
+    EXPECT_EQ(0u, PIOS_MEMPOOL_BlockSize(heap_block));
+    EXPECT_EQ(0u, PIOS_MEMPOOL_BlockSize(&arena[0] + arena.size()));
+}
+
+TEST_F(MemPoolTest, StatsAreLimitedToTheCallerArray) {
+    struct pios_mempool_stats s[2];
+
+    EXPECT_EQ(2, PIOS_MEMPOOL_GetStats(s, 2));
+    EXPECT_EQ(16, s[0].block_size);
+    EXPECT_EQ(32, s[1].block_size);
+}
+
+TEST_F(MemPoolTest, RandomChurnKeepsTheCounts) {
+    std::vector<void *> live;
+    uint16_t expected_max[NUM_CLASSES] = {};
+
+    srand(42);
+    for (int n = 0; n < 10000; n++) {
+        if (!live.empty() && rand() % 2) {
+            size_t i = rand() % live.size();
+            ASSERT_TRUE(PIOS_MEMPOOL_Free(live[i]));
+            live.erase(live.begin() + i);
+        } else {
+            void *p = PIOS_MEMPOOL_Alloc(1 + rand() % 64);
+            if (p) {
+                live.push_back(p);
+            }
+        }
+
+        uint16_t used[NUM_CLASSES] = {};
+        for (size_t i = 0; i < live.size(); i++) {
+            for (uint8_t c = 0; c < NUM_CLASSES; c++) {
+                if (PIOS_MEMPOOL_BlockSize(live[i]) == stats(c).block_size) {
+                    used[c]++;
+                }
+            }
+        }
+        for (uint8_t c = 0; c < NUM_CLASSES; c++) {
+            if (used[c] > expected_max[c]) {
+                expected_max[c] = used[c];
+            }
+            ASSERT_EQ(used[c], stats(c).used);
+            ASSERT_EQ(expected_max[c], stats(c).max_used);
+        }
+    }
+}
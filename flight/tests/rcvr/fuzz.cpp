@@ -0,0 +1,97 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+extern "C" {
+#include "pios_rcvr_ut.h"
+#include "pios_sbus_priv.h"
+#include "pios_srxl_priv.h"
+#include "pios_exbus_priv.h"
+#include "pios_hott_priv.h"
+#include "pios_dsm_priv.h"
+}
+
+/*
+ * libFuzzer entry point, the unit test runs it on random input as well.
+ *
+ * The first byte picks the decoder. The rest is a list of chunks, each one
+ * a control byte followed by up to 31 received bytes: the top 3 bits are the
+ * RTC ticks before the chunk, so the fuzzer gets to place the frame gaps,
+ * the low 5 bits the number of bytes, delivered in a single callback.
+ */
+static GPIO_TypeDef gpio;
+static void gpio_clk(__attribute__((unused)) uint32_t periph, __attribute__((unused)) FunctionalState state) {}
+
+static const struct pios_sbus_cfg sbus_cfg = {
+    { &gpio, { 1, GPIO_PuPd_NOPULL }, 0 }, gpio_clk, 0, Bit_SET, Bit_RESET,
+};
+static const struct pios_dsm_cfg dsm_cfg = {
+    { &gpio, { 1, GPIO_PuPd_NOPULL }, 0 },
+};
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    const struct pios_rcvr_driver *driver;
+    uint32_t id = 0;
+    int32_t ret;
+
+    if (size < 1) {
+        return 0;
+    }
+
+    PIOS_RCVR_UT_Reset();
+    switch (data[0] % 6) {
+    case 0:
+        driver = &pios_sbus_rcvr_driver;
+        ret    = PIOS_SBus_Init(&id, &sbus_cfg, &pios_rcvr_ut_com_driver, 0);
+        break;
+    case 1:
+        driver = &pios_srxl_rcvr_driver;
+        ret    = PIOS_SRXL_Init(&id, &pios_rcvr_ut_com_driver, 0);
+        break;
+    case 2:
+        driver = &pios_exbus_rcvr_driver;
+        ret    = PIOS_EXBUS_Init(&id, &pios_rcvr_ut_com_driver, 0);
+        break;
+    case 3:
+        driver = &pios_hott_rcvr_driver;
+        ret    = PIOS_HOTT_Init(&id, &pios_rcvr_ut_com_driver, 0, PIOS_HOTT_PROTO_SUMD);
+        break;
+    case 4:
+        driver = &pios_hott_rcvr_driver;
+        ret    = PIOS_HOTT_Init(&id, &pios_rcvr_ut_com_driver, 0, PIOS_HOTT_PROTO_SUMH);
+        break;
+    default:
+        driver = &pios_dsm_rcvr_driver;
+        ret    = PIOS_DSM_Init(&id, &dsm_cfg, &pios_rcvr_ut_com_driver, 0, 0);
+        break;
+    }
+    assert(ret == 0);
+
+    size_t i = 1;
+    while (i < size) {
+        uint8_t ticks = data[i] >> 5;
+        uint8_t len   = data[i] & 0x1f;
+        i++;
+        if (len > size - i) {
+            len = size - i;
+        }
+
+        PIOS_RCVR_UT_Tick(ticks);
+        if (len) {
+            PIOS_RCVR_UT_ReceiveBlock(&data[i], len);
+        }
+        i += len;
+    }
+
+    /* one past the last channel is answered as well */
+    for (uint8_t channel = 0; channel <= 32; channel++) {
+        int32_t value = driver->read(id, channel);
+        assert(value >= PIOS_RCVR_NODRIVER && value <= UINT16_MAX);
+    }
+    if (driver->get_quality) {
+        assert(driver->get_quality(id) <= 100);
+    }
+
+    return 0;
+}
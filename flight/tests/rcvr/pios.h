@@ -0,0 +1,38 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* Just enough to build the receiver protocol decoders on the host */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+#define PIOS_INCLUDE_RTC
+#define PIOS_INCLUDE_SBUS
+#define PIOS_INCLUDE_SRXL
+#define PIOS_INCLUDE_EXBUS
+#define PIOS_INCLUDE_HOTT
+#define PIOS_INCLUDE_DSM
+/* every instance comes from pios_malloc, so the tests can start afresh */
+#define PIOS_INCLUDE_FREERTOS
+
+/* as on the boards that have the receivers */
+#define PIOS_SBUS_NUM_INPUTS  (16 + 2)
+#define PIOS_SRXL_NUM_INPUTS  16
+#define PIOS_EXBUS_NUM_INPUTS 16
+#define PIOS_HOTT_NUM_INPUTS  32
+#define PIOS_DSM_NUM_INPUTS   12
+
+#define PIOS_Assert(test)       assert(test)
+#define PIOS_DEBUG_Assert(test) assert(test)
+
+typedef void *xSemaphoreHandle;
+
+#include "pios_com.h"
+#include "pios_rcvr.h"
+#include "pios_rtc.h"
+#include "pios_delay.h"
+
+void *pios_malloc(size_t size);
+
+#endif /* PIOS_H */
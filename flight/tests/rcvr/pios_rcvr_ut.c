@@ -0,0 +1,132 @@
+#include <string.h> /* memset */
+#include "pios.h"
+#include "pios_stm32.h"
+#include "pios_rcvr_ut.h"
+
+/*
+ * The decoders keep their instance in a uint32_t handle, like the rest of
+ * PiOS. The test is linked without PIE so that this heap lies below 4GB.
+ */
+static uint64_t heap[256];
+static size_t heap_used;
+
+static pios_com_callback rx_in_cb;
+static uint32_t rx_in_context;
+static void (*tick_cb)(uint32_t id);
+static uint32_t tick_id;
+static uint32_t baud;
+static uint16_t bind_pulses;
+static uint32_t now_us;
+
+void *pios_malloc(size_t size)
+{
+    size_t words = (size + sizeof(heap[0]) - 1) / sizeof(heap[0]);
+
+    if (heap_used + words > sizeof(heap) / sizeof(heap[0])) {
+        return NULL;
+    }
+
+    void *p = &heap[heap_used];
+    heap_used += words;
+    assert((uintptr_t)p == (uint32_t)(uintptr_t)p);
+    return p;
+}
+
+void PIOS_RCVR_UT_Reset(void)
+{
+    /* not zero, the decoders must not rely on it */
+    memset(heap, 0xa5, sizeof(heap));
+    heap_used     = 0;
+    rx_in_cb      = NULL;
+    rx_in_context = 0;
+    tick_cb       = NULL;
+    tick_id       = 0;
+    baud          = 0;
+    bind_pulses   = 0;
+    now_us        = 0;
+}
+
+void PIOS_RCVR_UT_Receive(const uint8_t *buf, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; i++) {
+        PIOS_RCVR_UT_ReceiveBlock(&buf[i], 1);
+    }
+}
+
+void PIOS_RCVR_UT_ReceiveBlock(const uint8_t *buf, uint16_t len)
+{
+    bool need_yield = true;
+    uint16_t headroom;
+
+    assert(rx_in_cb);
+    uint16_t consumed = (rx_in_cb)(rx_in_context, (uint8_t *)buf, len, &headroom, &need_yield);
+    assert(consumed == len);
+    assert(!need_yield);
+}
+
+void PIOS_RCVR_UT_Tick(uint16_t ticks)
+{
+    assert(tick_cb);
+    while (ticks--) {
+        (tick_cb)(tick_id);
+    }
+}
+
+uint32_t PIOS_RCVR_UT_Baud(void)
+{
+    return baud;
+}
+
+uint16_t PIOS_RCVR_UT_BindPulses(void)
+{
+    return bind_pulses;
+}
+
+static void PIOS_RCVR_UT_BindRxCb(__attribute__((unused)) uint32_t id, pios_com_callback rx_in, uint32_t context)
+{
+    rx_in_cb = rx_in;
+    rx_in_context = context;
+}
+
+static void PIOS_RCVR_UT_SetBaud(__attribute__((unused)) uint32_t id, uint32_t rate)
+{
+    baud = rate;
+}
+
+const struct pios_com_driver pios_rcvr_ut_com_driver = {
+    .set_baud   = PIOS_RCVR_UT_SetBaud,
+    .bind_rx_cb = PIOS_RCVR_UT_BindRxCb,
+};
+
+bool PIOS_RTC_RegisterTickCallback(void (*fn)(uint32_t id), uint32_t data)
+{
+    tick_cb = fn;
+    tick_id = data;
+    return true;
+}
+
+/* time only moves when somebody waits for it */
+uint32_t PIOS_DELAY_GetuS()
+{
+    return now_us += 1000;
+}
+
+int32_t PIOS_DELAY_WaituS(uint32_t uS)
+{
+    now_us += uS;
+    return 0;
+}
+
+void GPIO_Init(__attribute__((unused)) GPIO_TypeDef *gpio, __attribute__((unused)) const GPIO_InitTypeDef *init)
+{}
+
+void GPIO_SetBits(__attribute__((unused)) GPIO_TypeDef *gpio, __attribute__((unused)) uint16_t pin)
+{}
+
+void GPIO_ResetBits(__attribute__((unused)) GPIO_TypeDef *gpio, __attribute__((unused)) uint16_t pin)
+{
+    bind_pulses++;
+}
+
+void GPIO_WriteBit(__attribute__((unused)) GPIO_TypeDef *gpio, __attribute__((unused)) uint16_t pin, __attribute__((unused)) BitAction value)
+{}
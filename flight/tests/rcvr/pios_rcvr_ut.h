@@ -0,0 +1,27 @@
+#ifndef PIOS_RCVR_UT_H
+#define PIOS_RCVR_UT_H
+
+#include <stdint.h>
+
+/* USART stand-in, whatever decoder binds to it gets the bytes below */
+extern const struct pios_com_driver pios_rcvr_ut_com_driver;
+
+/* Forget the decoder of the previous test, its memory is handed out again */
+void PIOS_RCVR_UT_Reset(void);
+
+/* Received bytes, one callback per byte as the USART interrupt does */
+void PIOS_RCVR_UT_Receive(const uint8_t *buf, uint16_t len);
+
+/* Received bytes, all in a single callback */
+void PIOS_RCVR_UT_ReceiveBlock(const uint8_t *buf, uint16_t len);
+
+/* RTC ticks of 1.6ms, running the supervisor of the decoder */
+void PIOS_RCVR_UT_Tick(uint16_t ticks);
+
+/* Last baud rate the decoder asked for, 0 if none */
+uint32_t PIOS_RCVR_UT_Baud(void);
+
+/* Pulses driven on the bind line */
+uint16_t PIOS_RCVR_UT_BindPulses(void);
+
+#endif /* PIOS_RCVR_UT_H */
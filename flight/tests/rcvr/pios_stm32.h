@@ -0,0 +1,29 @@
+#ifndef PIOS_STM32_H
+#define PIOS_STM32_H
+
+/* The GPIO the S.Bus inverter and the DSM bind use, recorded by pios_rcvr_ut.c */
+typedef enum { DISABLE = 0, ENABLE = !DISABLE } FunctionalState;
+typedef enum { Bit_RESET = 0, Bit_SET } BitAction;
+typedef enum { GPIO_PuPd_NOPULL, GPIO_PuPd_UP, GPIO_PuPd_DOWN } GPIOPuPd_TypeDef;
+
+typedef struct {
+    uint32_t GPIO_Pin;
+    GPIOPuPd_TypeDef GPIO_PuPd;
+} GPIO_InitTypeDef;
+
+typedef struct {
+    uint32_t ODR;
+} GPIO_TypeDef;
+
+struct stm32_gpio {
+    GPIO_TypeDef     *gpio;
+    GPIO_InitTypeDef init;
+    uint8_t pin_source;
+};
+
+void GPIO_Init(GPIO_TypeDef *gpio, const GPIO_InitTypeDef *init);
+void GPIO_SetBits(GPIO_TypeDef *gpio, uint16_t pin);
+void GPIO_ResetBits(GPIO_TypeDef *gpio, uint16_t pin);
+void GPIO_WriteBit(GPIO_TypeDef *gpio, uint16_t pin, BitAction value);
+
+#endif /* PIOS_STM32_H */
@@ -0,0 +1,6 @@
+#ifndef PIOS_USART_PRIV_H
+#define PIOS_USART_PRIV_H
+
+/* the receivers only need the com driver, see pios_rcvr_ut.c */
+
+#endif /* PIOS_USART_PRIV_H */
@@ -0,0 +1,654 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <time.h> /* clock_gettime */
+#include <vector>
+
+extern "C" {
+#include "pios_rcvr_ut.h"
+#include "pios_sbus_priv.h"
+#include "pios_srxl_priv.h"
+#include "pios_exbus_priv.h"
+#include "pios_hott_priv.h"
+#include "pios_dsm_priv.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+}
+
+#define TIMEOUT ((uint16_t)PIOS_RCVR_TIMEOUT)
+#define INVALID ((uint16_t)PIOS_RCVR_INVALID)
+
+typedef std::vector<uint8_t> frame_t;
+
+/* Bit at a time reference implementations of the checksums */
+static uint16_t crc16_ccitt(const frame_t &f)
+{
+    uint16_t crc = 0;
+
+    for (size_t n = 0; n < f.size(); n++) {
+        crc ^= (uint16_t)f[n] << 8;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t crc16_ccitt_reflected(const frame_t &f)
+{
+    uint16_t crc = 0;
+
+    for (size_t n = 0; n < f.size(); n++) {
+        crc ^= f[n];
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static void put16(frame_t &f, uint16_t v)
+{
+    f.push_back(v >> 8);
+    f.push_back(v & 0xff);
+}
+
+static frame_t sbus_frame(const uint16_t *channels, uint8_t flags, uint8_t eof = 0x00)
+{
+    frame_t f(SBUS_FRAME_LENGTH, 0);
+
+    f[0] = SBUS_SOF_BYTE;
+    for (int bit = 0; bit < 16 * 11; bit++) {
+        if (channels[bit / 11] & (1 << (bit % 11))) {
+            f[1 + bit / 8] |= 1 << (bit % 8);
+        }
+    }
+    f[23] = flags;
+    f[24] = eof;
+    return f;
+}
+
+static frame_t srxl_frame(uint8_t header, const uint16_t *values)
+{
+    frame_t f(1, header);
+    int n = (header == SRXL_V1_HEADER) ? 12 : 16;
+
+    for (int i = 0; i < n; i++) {
+        put16(f, values[i]);
+    }
+    put16(f, crc16_ccitt(f));
+    return f;
+}
+
+static frame_t exbus_frame(const uint16_t *us, uint8_t n, uint8_t sublen)
+{
+    frame_t f;
+
+    f.push_back(0x3e);
+    f.push_back(0x01);
+    f.push_back(8 + 2 * n);
+    f.push_back(0x42); // packet id
+    f.push_back(0x31); // channel data
+    f.push_back(sublen);
+    for (int i = 0; i < n; i++) {
+        f.push_back((us[i] * 8) & 0xff);
+        f.push_back((us[i] * 8) >> 8);
+    }
+    uint16_t crc = crc16_ccitt_reflected(f);
+    f.push_back(crc & 0xff);
+    f.push_back(crc >> 8);
+    return f;
+}
+
+static frame_t sumd_frame(uint8_t status, const uint16_t *words, uint8_t n)
+{
+    frame_t f;
+
+    f.push_back(0xa8);
+    f.push_back(status);
+    f.push_back(n);
+    for (int i = 0; i < n; i++) {
+        put16(f, words[i]);
+    }
+    put16(f, crc16_ccitt(f));
+    return f;
+}
+
+static frame_t sumh_frame(const uint16_t *words, uint8_t n)
+{
+    frame_t f;
+    uint8_t sum = 0;
+
+    f.push_back(0xa8);
+    f.push_back(0x00);
+    f.push_back(n);
+    for (int i = 0; i < n; i++) {
+        put16(f, words[i]);
+    }
+    f.push_back(0x00); // no telemetry request
+    for (size_t i = 0; i < f.size(); i++) {
+        sum += f[i];
+    }
+    f.push_back(sum);
+    return f;
+}
+
+// 7 channels 0..6 of 10 or 11 bits, empty slots as ff ff
+static frame_t dsm_frame(const uint16_t *values, uint8_t n, uint8_t resolution)
+{
+    frame_t f;
+
+    f.push_back(0x00); // fades
+    f.push_back(resolution == 11 ? 0x12 : 0x01);
+    for (int i = 0; i < DSM_CHANNELS_PER_FRAME; i++) {
+        put16(f, i < n ? (i << resolution) | values[i] : 0xffff);
+    }
+    return f;
+}
+
+static GPIO_TypeDef gpio;
+static void gpio_clk(__attribute__((unused)) uint32_t periph, __attribute__((unused)) FunctionalState state) {}
+
+static const struct pios_sbus_cfg sbus_cfg = {
+    { &gpio, { 1, GPIO_PuPd_NOPULL }, 0 }, gpio_clk, 0, Bit_SET, Bit_RESET,
+};
+static const struct pios_dsm_cfg dsm_cfg = {
+    { &gpio, { 1, GPIO_PuPd_NOPULL }, 0 },
+};
+
+static double now_s()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+class RcvrTest : public testing::Test {
+protected:
+    const struct pios_rcvr_driver *driver;
+    uint32_t id;
+    // ticks without a byte before the decoder looks for a new frame
+    uint8_t gap_ticks;
+
+    virtual void SetUp()
+    {
+        PIOS_RCVR_UT_Reset();
+        gap_ticks = 5;
+    }
+
+    void frame(const frame_t &f)
+    {
+        PIOS_RCVR_UT_Tick(gap_ticks);
+        PIOS_RCVR_UT_Receive(&f[0], f.size());
+    }
+
+    uint16_t read(uint8_t channel)
+    {
+        return driver->read(id, channel);
+    }
+
+    uint8_t quality()
+    {
+        return driver->get_quality(id);
+    }
+};
+
+class SBusTest : public RcvrTest {
+protected:
+    uint16_t ch[16];
+
+    virtual void SetUp()
+    {
+        RcvrTest::SetUp();
+        gap_ticks = 3;
+        driver    = &pios_sbus_rcvr_driver;
+        ASSERT_EQ(0, PIOS_SBus_Init(&id, &sbus_cfg, &pios_rcvr_ut_com_driver, 0));
+        for (int i = 0; i < 16; i++) {
+            ch[i] = 172 + i * 101;
+        }
+    }
+
+    void expect_channels()
+    {
+        for (int i = 0; i < 16; i++) {
+            EXPECT_EQ(ch[i], read(i)) << "channel " << i;
+        }
+    }
+};
+
+TEST_F(SBusTest, StartsInFailsafe) {
+    for (int i = 0; i < PIOS_SBUS_NUM_INPUTS; i++) {
+        EXPECT_EQ(TIMEOUT, read(i));
+    }
+    EXPECT_EQ(INVALID, read(PIOS_SBUS_NUM_INPUTS));
+}
+
+TEST_F(SBusTest, DecodesChannelsAndDiscretes) {
+    frame(sbus_frame(ch, SBUS_FLAG_DC2));
+    expect_channels();
+    EXPECT_EQ(SBUS_VALUE_MIN, read(16));
+    EXPECT_EQ(SBUS_VALUE_MAX, read(17));
+}
+
+TEST_F(SBusTest, AcceptsRotatingEndOfFrame) {
+    const uint8_t eof[] = { 0x04, 0x14, 0x24, 0x34 };
+
+    for (int i = 0; i < 4; i++) {
+        ch[0] = 1000 + i;
+        frame(sbus_frame(ch, 0, eof[i]));
+        EXPECT_EQ(ch[0], read(0));
+    }
+}
+
+TEST_F(SBusTest, DropsCorruptFrames) {
+    frame(sbus_frame(ch, 0));
+    uint16_t previous = ch[3];
+    ch[3] = 42;
+
+    frame_t f = sbus_frame(ch, 0, 0x01);
+    frame(f);
+    f = sbus_frame(ch, 0);
+    f[0] = 0x0e;
+    frame(f);
+    EXPECT_EQ(previous, read(3));
+
+    // nothing is taken without a gap to find the start of the frame
+    f = sbus_frame(ch, 0);
+    PIOS_RCVR_UT_Receive(&f[0], f.size());
+    EXPECT_EQ(previous, read(3));
+}
+
+TEST_F(SBusTest, LostAndFailsafeFrames) {
+    for (int i = 0; i < 20; i++) {
+        frame(sbus_frame(ch, 0));
+    }
+    uint8_t good = quality();
+
+    ch[0] = 500;
+    frame(sbus_frame(ch, SBUS_FLAG_FL));
+    EXPECT_NE(500, read(0));
+    EXPECT_LT(quality(), good);
+
+    frame(sbus_frame(ch, SBUS_FLAG_FS));
+    EXPECT_EQ(TIMEOUT, read(0));
+}
+
+TEST_F(SBusTest, FailsafeWithoutFrames) {
+    frame(sbus_frame(ch, 0));
+    PIOS_RCVR_UT_Tick(64);
+    expect_channels();
+    PIOS_RCVR_UT_Tick(1);
+    EXPECT_EQ(TIMEOUT, read(0));
+}
+
+class SRXLTest : public RcvrTest {
+protected:
+    uint16_t values[16];
+
+    virtual void SetUp()
+    {
+        RcvrTest::SetUp();
+        driver = &pios_srxl_rcvr_driver;
+        ASSERT_EQ(0, PIOS_SRXL_Init(&id, &pios_rcvr_ut_com_driver, 0));
+        for (int i = 0; i < 16; i++) {
+            values[i] = i * 0x111;
+        }
+    }
+};
+
+TEST_F(SRXLTest, DecodesBothVersions) {
+    frame(srxl_frame(SRXL_V1_HEADER, values));
+    for (int i = 0; i < 12; i++) {
+        EXPECT_EQ(800 + ((values[i] * 1400) >> 12), read(i)) << "channel " << i;
+    }
+    EXPECT_EQ(TIMEOUT, read(12));
+
+    values[15] = 0x800;
+    frame(srxl_frame(SRXL_V2_HEADER, values));
+    EXPECT_EQ(1500, read(15));
+    EXPECT_EQ(INVALID, read(16));
+}
+
+TEST_F(SRXLTest, DropsBadChecksumAndHeader) {
+    frame_t good = srxl_frame(SRXL_V2_HEADER, values);
+    frame(good);
+    uint16_t previous = read(1);
+    values[1] = 0xfff;
+
+    for (size_t i = 1; i < SRXL_FRAME_LENGTH; i++) {
+        frame_t f = srxl_frame(SRXL_V2_HEADER, values);
+        f[i] ^= 0x10;
+        frame(f);
+        ASSERT_EQ(previous, read(1)) << "corrupt byte " << i;
+        // keeps the failsafe away
+        frame(good);
+    }
+    frame_t f = srxl_frame(SRXL_V2_HEADER, values);
+    f[0] = 0xa3;
+    frame(f);
+    EXPECT_EQ(previous, read(1));
+
+    frame(srxl_frame(SRXL_V2_HEADER, values));
+    EXPECT_EQ(2199, read(1));
+}
+
+TEST_F(SRXLTest, FailsafeWithoutFrames) {
+    frame(srxl_frame(SRXL_V2_HEADER, values));
+    PIOS_RCVR_UT_Tick(64);
+    EXPECT_NE(TIMEOUT, read(0));
+    PIOS_RCVR_UT_Tick(1);
+    EXPECT_EQ(TIMEOUT, read(0));
+}
+
+class EXBusTest : public RcvrTest {
+protected:
+    uint16_t us[20];
+
+    virtual void SetUp()
+    {
+        RcvrTest::SetUp();
+        driver = &pios_exbus_rcvr_driver;
+        ASSERT_EQ(0, PIOS_EXBUS_Init(&id, &pios_rcvr_ut_com_driver, 0));
+        for (int i = 0; i < 20; i++) {
+            us[i] = 1000 + i * 50;
+        }
+    }
+};
+
+TEST_F(EXBusTest, DecodesChannels) {
+    frame(exbus_frame(us, 16, 32));
+    for (int i = 0; i < 16; i++) {
+        EXPECT_EQ(us[i], read(i)) << "channel " << i;
+    }
+    EXPECT_EQ(INVALID, read(16));
+    EXPECT_GT(quality(), 0);
+}
+
+TEST_F(EXBusTest, DropsBadChecksum) {
+    frame(exbus_frame(us, 16, 32));
+    us[0] = 2000;
+    frame_t f = exbus_frame(us, 16, 32);
+    f[7] ^= 0x01;
+    frame(f);
+    EXPECT_EQ(1000, read(0));
+}
+
+TEST_F(EXBusTest, OversizedChannelCountIsBounded) {
+    // a valid frame that claims more channels than the decoder has
+    frame(exbus_frame(us, 20, 64));
+    for (int i = 0; i < 16; i++) {
+        EXPECT_EQ(us[i], read(i)) << "channel " << i;
+    }
+    EXPECT_EQ(INVALID, read(16));
+
+    frame(exbus_frame(us, 16, 32));
+    EXPECT_EQ(us[15], read(15));
+}
+
+TEST_F(EXBusTest, SwitchesBaudRateWithoutFrames) {
+    EXPECT_EQ(0u, PIOS_RCVR_UT_Baud());
+    PIOS_RCVR_UT_Tick(64 * 65);
+    EXPECT_EQ(250000u, PIOS_RCVR_UT_Baud());
+    PIOS_RCVR_UT_Tick(64 * 65);
+    EXPECT_EQ(125000u, PIOS_RCVR_UT_Baud());
+}
+
+class HoTTTest : public RcvrTest {
+protected:
+    uint16_t words[32];
+
+    void init(enum pios_hott_proto proto)
+    {
+        driver = &pios_hott_rcvr_driver;
+        ASSERT_EQ(0, PIOS_HOTT_Init(&id, &pios_rcvr_ut_com_driver, 0, proto));
+        for (int i = 0; i < 32; i++) {
+            words[i] = 0x2260 + i * 0x100;
+        }
+    }
+};
+
+TEST_F(HoTTTest, DecodesSUMD) {
+    init(PIOS_HOTT_PROTO_SUMD);
+    words[0] = 0x1c20;
+    words[1] = 0x2260;
+    words[2] = 0x2ee0;
+    words[3] = 0x3b60;
+    words[4] = 0x41a0;
+    frame(sumd_frame(0x01, words, 8));
+
+    EXPECT_EQ(750, read(0));
+    EXPECT_EQ(1000, read(1));
+    EXPECT_EQ(1500, read(2));
+    EXPECT_EQ(2000, read(3));
+    EXPECT_EQ(2250, read(4));
+    EXPECT_EQ(INVALID, read(8));
+    EXPECT_EQ(INVALID, read(31));
+}
+
+TEST_F(HoTTTest, ScalesEveryWordLikeTheFloatVersion) {
+    init(PIOS_HOTT_PROTO_SUMD);
+    for (uint32_t w = 2400; w <= 0xffff; w += 0xf00 / 7) {
+        words[0] = w;
+        frame(sumd_frame(0x01, words, 1));
+        ASSERT_EQ((uint16_t)(w / 6.4f - 375), read(0)) << "word " << w;
+    }
+}
+
+TEST_F(HoTTTest, DropsBadSUMDChecksum) {
+    init(PIOS_HOTT_PROTO_SUMD);
+    frame(sumd_frame(0x01, words, 32));
+    uint16_t previous = read(31);
+
+    words[31] = 0x2ee0;
+    frame_t f = sumd_frame(0x01, words, 32);
+    f.back() ^= 0x80;
+    frame(f);
+    EXPECT_EQ(previous, read(31));
+
+    // SUMH is not taken for SUMD
+    frame(sumh_frame(words, 32));
+    EXPECT_EQ(previous, read(31));
+}
+
+TEST_F(HoTTTest, DecodesSUMH) {
+    init(PIOS_HOTT_PROTO_SUMH);
+    words[0] = 0x2ee0;
+    frame(sumh_frame(words, 6));
+    EXPECT_EQ(1500, read(0));
+
+    words[0] = 0x2260;
+    frame_t f = sumh_frame(words, 6);
+    f.back()++;
+    frame(f);
+    EXPECT_EQ(1500, read(0));
+}
+
+TEST_F(HoTTTest, FailsafeNeedsAConnection) {
+    init(PIOS_HOTT_PROTO_SUMD);
+    frame(sumd_frame(0x81, words, 8));
+    EXPECT_EQ(TIMEOUT, read(0));
+
+    frame(sumd_frame(0x01, words, 8));
+    EXPECT_EQ(1000, read(0));
+
+    // once connected the failsafe values of the receiver are used
+    words[0] = 0x2ee0;
+    frame(sumd_frame(0x81, words, 8));
+    EXPECT_EQ(1500, read(0));
+}
+
+class DSMTest : public RcvrTest {
+protected:
+    uint16_t values[7];
+
+    virtual void SetUp()
+    {
+        RcvrTest::SetUp();
+        driver = &pios_dsm_rcvr_driver;
+        for (int i = 0; i < 7; i++) {
+            values[i] = 100 + i * 111;
+        }
+    }
+};
+
+TEST_F(DSMTest, DetectsResolution) {
+    ASSERT_EQ(0, PIOS_DSM_Init(&id, &dsm_cfg, &pios_rcvr_ut_com_driver, 0, 0));
+    EXPECT_EQ(0, PIOS_RCVR_UT_BindPulses());
+
+    values[6] = 2047;
+    frame(dsm_frame(values, 7, 11));
+    for (int i = 0; i < 7; i++) {
+        EXPECT_EQ(values[i], read(i)) << "channel " << i;
+    }
+    EXPECT_EQ(TIMEOUT, read(7));
+
+    values[6] = 1023;
+    frame(dsm_frame(values, 7, 10));
+    for (int i = 0; i < 7; i++) {
+        EXPECT_EQ(values[i], read(i)) << "channel " << i;
+    }
+
+    values[6] = 2000;
+    frame(dsm_frame(values, 7, 11));
+    EXPECT_EQ(2000, read(6));
+}
+
+TEST_F(DSMTest, DropsSecondFrameFlagInsideAFrame) {
+    ASSERT_EQ(0, PIOS_DSM_Init(&id, &dsm_cfg, &pios_rcvr_ut_com_driver, 0, 0));
+    frame(dsm_frame(values, 7, 11));
+
+    frame_t f = dsm_frame(values, 7, 11);
+    f[4] |= 0x80;
+    PIOS_RCVR_UT_Tick(60);
+    frame(f);
+    // the rest of the frame from the flagged channel on is dropped
+    for (int i = 1; i < 7; i++) {
+        EXPECT_EQ(TIMEOUT, read(i)) << "channel " << i;
+    }
+}
+
+TEST_F(DSMTest, ConflictingResolutionIsDropped) {
+    ASSERT_EQ(0, PIOS_DSM_Init(&id, &dsm_cfg, &pios_rcvr_ut_com_driver, 0, 0));
+
+    // a duplicate channel at 11 bits, the 10 bit pattern at 10 bits
+    const uint16_t words[] = { 0x0000, 0x0800, 0x1000, 0x1800, 0x2000, 0x0400, 0xffff };
+    frame_t f(2, 0);
+    for (int i = 0; i < 7; i++) {
+        put16(f, words[i]);
+    }
+    frame(f);
+    PIOS_RCVR_UT_Tick(60);
+    frame(f);
+    EXPECT_EQ(TIMEOUT, read(5));
+
+    frame(dsm_frame(values, 7, 11));
+    EXPECT_EQ(values[5], read(5));
+}
+
+TEST_F(DSMTest, BindPulses) {
+    ASSERT_EQ(0, PIOS_DSM_Init(&id, &dsm_cfg, &pios_rcvr_ut_com_driver, 0, 9));
+    EXPECT_EQ(9, PIOS_RCVR_UT_BindPulses());
+
+    PIOS_RCVR_UT_Reset();
+    ASSERT_EQ(0, PIOS_DSM_Init(&id, &dsm_cfg, &pios_rcvr_ut_com_driver, 0, 42));
+    EXPECT_EQ(10, PIOS_RCVR_UT_BindPulses());
+}
+
+TEST(RcvrFuzzTest, RandomInput) {
+    std::vector<uint8_t> data;
+
+    srand(1);
+    for (int n = 0; n < 20000; n++) {
+        data.resize(1 + rand() % 512);
+        for (size_t i = 0; i < data.size(); i++) {
+            data[i] = rand();
+        }
+        LLVMFuzzerTestOneInput(&data[0], data.size());
+    }
+}
+
+/*
+ * Valid frames as the receivers send them, with a frame gap before each,
+ * byte by byte as the USART interrupt delivers them. There is no recording
+ * of real receivers here, so the frames are synthesized with moving sticks.
+ */
+TEST_F(RcvrTest, Benchmark) {
+    const int frames = 2000;
+    const char *names[] = { "sbus", "srxl", "exbus", "sumd", "sumh", "dsm" };
+
+    for (int proto = 0; proto < 6; proto++) {
+        std::vector<frame_t> stream;
+        uint16_t ch[32];
+
+        for (int n = 0; n < frames; n++) {
+            for (int i = 0; i < 32; i++) {
+                ch[i] = (n * 7 + i * 13) % 1000;
+            }
+            switch (proto) {
+            case 0:
+                stream.push_back(sbus_frame(ch, 0));
+                break;
+            case 1:
+                stream.push_back(srxl_frame(SRXL_V2_HEADER, ch));
+                break;
+            case 2:
+                stream.push_back(exbus_frame(ch, 16, 32));
+                break;
+            case 3:
+                stream.push_back(sumd_frame(0x01, ch, 16));
+                break;
+            case 4:
+                stream.push_back(sumh_frame(ch, 16));
+                break;
+            default:
+                stream.push_back(dsm_frame(ch, 7, 11));
+                break;
+            }
+        }
+
+        PIOS_RCVR_UT_Reset();
+        switch (proto) {
+        case 0:
+            PIOS_SBus_Init(&id, &sbus_cfg, &pios_rcvr_ut_com_driver, 0);
+            break;
+        case 1:
+            PIOS_SRXL_Init(&id, &pios_rcvr_ut_com_driver, 0);
+            break;
+        case 2:
+            PIOS_EXBUS_Init(&id, &pios_rcvr_ut_com_driver, 0);
+            break;
+        case 3:
+            PIOS_HOTT_Init(&id, &pios_rcvr_ut_com_driver, 0, PIOS_HOTT_PROTO_SUMD);
+            break;
+        case 4:
+            PIOS_HOTT_Init(&id, &pios_rcvr_ut_com_driver, 0, PIOS_HOTT_PROTO_SUMH);
+            break;
+        default:
+            PIOS_DSM_Init(&id, &dsm_cfg, &pios_rcvr_ut_com_driver, 0, 0);
+            break;
+        }
+
+        // the last byte of a frame does the decoding, it is timed on its own
+        double bytes_s = 0;
+        double last_s  = 0;
+        size_t bytes   = 0;
+        for (int n = 0; n < frames; n++) {
+            const frame_t &f = stream[n];
+            double start;
+
+            PIOS_RCVR_UT_Tick(5);
+            start    = now_s();
+            PIOS_RCVR_UT_Receive(&f[0], f.size() - 1);
+            bytes_s += now_s() - start;
+            start    = now_s();
+            PIOS_RCVR_UT_Receive(&f[f.size() - 1], 1);
+            last_s  += now_s() - start;
+            bytes   += f.size() - 1;
+        }
+
+        printf("%-5s: %6.1f ns per byte, %6.1f ns for the last byte of a frame\n",
+               names[proto], bytes_s / bytes * 1e9, last_s / frames * 1e9);
+    }
+}
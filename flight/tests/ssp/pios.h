@@ -0,0 +1,8 @@
+#ifndef PIOS_H
+#define PIOS_H
+
+/* ssp.c only needs the standard headers on the host */
+#include <stdint.h>
+#include <stdbool.h>
+
+#endif /* PIOS_H */
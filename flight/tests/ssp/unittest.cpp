@@ -0,0 +1,392 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <string.h> /* memset */
+#include <fcntl.h> /* fcntl */
+#include <unistd.h> /* read, write, usleep */
+#include <termios.h> /* cfmakeraw */
+#include <pty.h> /* openpty */
+#include <time.h> /* clock_gettime */
+
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "ssp.h"
+}
+
+#define MAX_PACKET_DATA_LEN 255
+#define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
+#define WINDOW_SIZE         8
+#define DFU_PACKET_SIZE     62 /* payload of a serial DFU packet */
+#define USB_LATENCY_US      4000 /* one way delay of a USB serial adapter */
+
+static uint64_t now_us()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t get_time_us(void)
+{
+    return (uint32_t)now_us();
+}
+
+/*
+ * One end of the link. A pty does not care about the baud rate, so the bytes
+ * written by ssp are held back until they would have left a real UART (plus a
+ * fixed adapter latency) before they are written to the pty.
+ */
+struct Endpoint {
+    int fd;
+    uint32_t byteTime;
+    uint64_t lineFree;
+    std::deque<std::pair<uint64_t, uint8_t> > wire;
+
+    // frame to corrupt, counted from the synchronise packet (1)
+    std::vector<int> corruptFrames;
+    int frames;
+    bool corruptPending;
+
+    std::vector<std::vector<uint8_t> > received;
+    std::atomic<int> receivedCount;
+
+    uint8_t rxBuf[MAX_PACKET_BUF_SIZE];
+    uint8_t txBuf[MAX_PACKET_BUF_SIZE];
+    uint8_t txWindowBuf[SSP_MAX_WINDOW * (MAX_PACKET_DATA_LEN + 2)];
+    uint8_t rxWindowBuf[SSP_MAX_WINDOW * (MAX_PACKET_DATA_LEN + 2)];
+    Port_t port;
+};
+
+static Endpoint *endpoints[2];
+
+static void wire_write(Endpoint *ep, uint8_t c)
+{
+    uint64_t now = now_us();
+
+    if (c == 225) { // SYNC, only ever written raw at the start of a frame
+        ep->frames++;
+        for (size_t n = 0; n < ep->corruptFrames.size(); n++) {
+            ep->corruptPending |= (ep->corruptFrames[n] == ep->frames);
+        }
+    } else if (ep->corruptPending && c != 224 && c != 1 && (c ^ 0x10) != 224 && (c ^ 0x10) != 225) {
+        c ^= 0x10;
+        ep->corruptPending = false;
+    }
+
+    ep->lineFree = (ep->lineFree > now ? ep->lineFree : now) + ep->byteTime;
+    ep->wire.push_back(std::make_pair(ep->lineFree + USB_LATENCY_US, c));
+}
+
+static void wire_pump(Endpoint *ep)
+{
+    uint64_t now = now_us();
+
+    while (!ep->wire.empty() && ep->wire.front().first <= now) {
+        if (write(ep->fd, &ep->wire.front().second, 1) != 1) {
+            break; // pty full, try again later
+        }
+        ep->wire.pop_front();
+    }
+}
+
+static int16_t wire_read(Endpoint *ep)
+{
+    uint8_t c;
+
+    // ssp polls for input all the time, good place to move our own output along
+    wire_pump(ep);
+    if (read(ep->fd, &c, 1) == 1) {
+        return c;
+    }
+    return -1;
+}
+
+static void received(Endpoint *ep, uint8_t *buf, uint16_t length)
+{
+    ep->received.push_back(std::vector<uint8_t>(buf, buf + length));
+    ep->receivedCount++;
+}
+
+static void write_a(uint8_t c)
+{
+    wire_write(endpoints[0], c);
+}
+static void write_b(uint8_t c)
+{
+    wire_write(endpoints[1], c);
+}
+static int16_t read_a(void)
+{
+    return wire_read(endpoints[0]);
+}
+static int16_t read_b(void)
+{
+    return wire_read(endpoints[1]);
+}
+static void callback_a(uint8_t *buf, uint16_t length)
+{
+    received(endpoints[0], buf, length);
+}
+static void callback_b(uint8_t *buf, uint16_t length)
+{
+    received(endpoints[1], buf, length);
+}
+
+static void process(Endpoint *ep)
+{
+    while (ssp_ReceiveProcess(&ep->port) == SSP_RX_COMPLETE) {}
+    ssp_SendProcess(&ep->port);
+}
+
+static std::vector<uint8_t> payload(int n, int size)
+{
+    std::vector<uint8_t> data(size);
+
+    for (int i = 0; i < size; i++) {
+        // include plenty of bytes that need escaping
+        data[i] = (uint8_t)(n * 31 + i * 7 + ((i & 3) ? 0 : 224));
+    }
+    return data;
+}
+
+class SspTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        int fds[2];
+
+        ASSERT_EQ(0, openpty(&fds[0], &fds[1], NULL, NULL, NULL));
+        for (int n = 0; n < 2; n++) {
+            struct termios tio;
+            tcgetattr(fds[n], &tio);
+            cfmakeraw(&tio);
+            tcsetattr(fds[n], TCSANOW, &tio);
+            fcntl(fds[n], F_SETFL, fcntl(fds[n], F_GETFL) | O_NONBLOCK);
+
+            endpoints[n] = new Endpoint();
+            endpoints[n]->fd = fds[n];
+            endpoints[n]->frames = 0;
+            endpoints[n]->corruptPending = false;
+            endpoints[n]->receivedCount  = 0;
+            endpoints[n]->lineFree = 0;
+        }
+        a = endpoints[0];
+        b = endpoints[1];
+        stop = false;
+    }
+
+    virtual void TearDown()
+    {
+        stopB();
+        for (int n = 0; n < 2; n++) {
+            close(endpoints[n]->fd);
+            delete endpoints[n];
+            endpoints[n] = NULL;
+        }
+    }
+
+    void init(Endpoint *ep, int baud, uint8_t windowSize, bool rxWindow,
+              void (*callback)(uint8_t *, uint16_t), int16_t (*serialRead)(void), void (*serialWrite)(uint8_t))
+    {
+        PortConfig_t config;
+
+        memset(&config, 0, sizeof(config));
+        config.rxBuf         = ep->rxBuf;
+        config.rxBufSize     = MAX_PACKET_DATA_LEN;
+        config.txBuf         = ep->txBuf;
+        config.txBufSize     = MAX_PACKET_DATA_LEN;
+        config.max_retry     = 10;
+        config.timeoutLen    = 500000;
+        config.pfCallBack    = callback;
+        config.pfSerialRead  = serialRead;
+        config.pfSerialWrite = serialWrite;
+        config.pfGetTime     = get_time_us;
+        config.windowSize    = windowSize;
+        config.txWindowBuf   = ep->txWindowBuf;
+        config.rxWindowBuf   = rxWindow ? ep->rxWindowBuf : NULL;
+        ssp_Init(&ep->port, &config);
+        ep->byteTime = 10 * 1000000 / baud; // 8N1
+    }
+
+    void setup(int baud, uint8_t windowA, uint8_t windowB, bool rxWindowB)
+    {
+        init(a, baud, windowA, false, callback_a, read_a, write_a);
+        init(b, baud, windowB, rxWindowB, callback_b, read_b, write_b);
+        startB();
+    }
+
+    void startB()
+    {
+        // the far end runs on its own, like the bootloader would
+        stop    = false;
+        threadB = std::thread([this]() {
+            while (!stop) {
+                process(b);
+                usleep(50);
+            }
+        });
+    }
+
+    void stopB()
+    {
+        stop = true;
+        if (threadB.joinable()) {
+            threadB.join();
+        }
+    }
+
+    // sends 'count' packets from a to b, returns payload bytes per second
+    double transfer(int count, int size)
+    {
+        int sent = 0;
+        uint64_t start = now_us();
+
+        while (b->receivedCount < count || ssp_TxWindowFree(&a->port) == 0) {
+            process(a);
+            if (sent < count && ssp_TxWindowFree(&a->port) > 0) {
+                std::vector<uint8_t> data = payload(sent, size);
+                EXPECT_EQ(SSP_TX_WAITING, ssp_SendData(&a->port, &data[0], size));
+                sent++;
+            }
+            if (now_us() - start > 60000000) {
+                ADD_FAILURE() << "transfer timed out, " << b->receivedCount << " of " << count << " received";
+                break;
+            }
+            usleep(50);
+        }
+        return (double)count * size * 1000000 / (now_us() - start);
+    }
+
+    void checkReceived(int count, int size)
+    {
+        ASSERT_EQ((size_t)count, b->received.size());
+        for (int n = 0; n < count; n++) {
+            EXPECT_EQ(payload(n, size), b->received[n]) << "packet " << n;
+        }
+    }
+
+    Endpoint *a;
+    Endpoint *b;
+    std::thread threadB;
+    std::atomic<bool> stop;
+};
+
+TEST_F(SspTest, NegotiatesSmallestWindow) {
+    setup(115200, WINDOW_SIZE, 4, false);
+    ASSERT_TRUE(ssp_Synchronise(&a->port));
+    stopB();
+
+    EXPECT_EQ(4, a->port.window);
+    EXPECT_EQ(4, b->port.window);
+}
+
+TEST_F(SspTest, FallsBackToStopAndWait) {
+    // a peer without a window answers the synch request with a plain ACK
+    setup(115200, WINDOW_SIZE, 0, false);
+    ASSERT_TRUE(ssp_Synchronise(&a->port));
+    EXPECT_EQ(0, a->port.window);
+
+    transfer(20, DFU_PACKET_SIZE);
+    stopB();
+    EXPECT_EQ(0, b->port.window);
+    checkReceived(20, DFU_PACKET_SIZE);
+}
+
+TEST_F(SspTest, OldInitiatorStaysStopAndWait) {
+    setup(115200, 0, WINDOW_SIZE, true);
+    ASSERT_TRUE(ssp_Synchronise(&a->port));
+
+    transfer(20, DFU_PACKET_SIZE);
+    stopB();
+    EXPECT_EQ(0, a->port.window);
+    EXPECT_EQ(0, b->port.window);
+    checkReceived(20, DFU_PACKET_SIZE);
+}
+
+TEST_F(SspTest, InOrderReceiverWithoutWindowBuffer) {
+    a->corruptFrames.push_back(6);
+    setup(115200, WINDOW_SIZE, WINDOW_SIZE, false);
+    ASSERT_TRUE(ssp_Synchronise(&a->port));
+
+    transfer(40, DFU_PACKET_SIZE);
+    stopB();
+    checkReceived(40, DFU_PACKET_SIZE);
+}
+
+TEST_F(SspTest, SelectiveAckResendsOnlyLostPackets) {
+    // frame 1 is the synch request, frames 4 and 15 are data packets 3 and 14
+    a->corruptFrames.push_back(4);
+    a->corruptFrames.push_back(15);
+    setup(115200, WINDOW_SIZE, WINDOW_SIZE, true);
+    ASSERT_TRUE(ssp_Synchronise(&a->port));
+    ASSERT_EQ(WINDOW_SIZE, a->port.window);
+
+    transfer(40, DFU_PACKET_SIZE);
+    stopB();
+    checkReceived(40, DFU_PACKET_SIZE);
+
+    // synch + 40 packets + one resend per lost packet, nothing went back N
+    EXPECT_EQ(1 + 40 + 2, a->frames);
+}
+
+TEST_F(SspTest, ResynchronisesAfterWindowTimeout) {
+    setup(115200, WINDOW_SIZE, WINDOW_SIZE, true);
+    ASSERT_TRUE(ssp_Synchronise(&a->port));
+
+    // the far end goes quiet and the window is lost on the way
+    stopB();
+    a->port.maxRetryCount = 1;
+    a->port.timeoutLen    = 50000;
+    for (int n = 0; n < 3; n++) {
+        std::vector<uint8_t> data = payload(100 + n, DFU_PACKET_SIZE);
+        EXPECT_EQ(SSP_TX_WAITING, ssp_SendData(&a->port, &data[0], DFU_PACKET_SIZE));
+    }
+    int16_t status;
+    do {
+        (void)ssp_ReceiveProcess(&a->port);
+        status = ssp_SendProcess(&a->port);
+        usleep(50);
+    } while (status == SSP_TX_WAITING);
+    ASSERT_EQ(SSP_TX_TIMEOUT, status);
+    wire_pump(a);
+    tcflush(b->fd, TCIFLUSH);
+
+    // the sequence numbers only match again after a new synchronise
+    a->port.maxRetryCount = 10;
+    a->port.timeoutLen    = 500000;
+    startB();
+    ASSERT_TRUE(ssp_Synchronise(&a->port));
+    EXPECT_EQ(WINDOW_SIZE, a->port.window);
+
+    transfer(20, DFU_PACKET_SIZE);
+    stopB();
+    checkReceived(20, DFU_PACKET_SIZE);
+}
+
+TEST_F(SspTest, WindowedThroughput) {
+    const int baudrates[] = { 57600, 115200 };
+    const int count = 100;
+
+    for (size_t n = 0; n < sizeof(baudrates) / sizeof(baudrates[0]); n++) {
+        double rate[2];
+
+        for (int windowed = 0; windowed < 2; windowed++) {
+            TearDown();
+            SetUp();
+            setup(baudrates[n], windowed ? WINDOW_SIZE : 0, WINDOW_SIZE, true);
+            ASSERT_TRUE(ssp_Synchronise(&a->port));
+            rate[windowed] = transfer(count, DFU_PACKET_SIZE);
+            stopB();
+            checkReceived(count, DFU_PACKET_SIZE);
+        }
+
+        printf("%6d baud: stop and wait %6.0f B/s, window %d %6.0f B/s (%.0f%% of line rate)\n",
+               baudrates[n], rate[0], WINDOW_SIZE, rate[1], 100.0 * rate[1] * 10 / baudrates[n]);
+        EXPECT_GT(rate[1], rate[0] * 1.1);
+    }
+}
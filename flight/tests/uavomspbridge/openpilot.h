@@ -0,0 +1,14 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define PIOS_Assert(x) \
+    if (!(x)) { abort(); \
+    }
+
+#define pios_malloc(size) (malloc(size))
+#define pios_free(p)      (free(p))
+
+#endif /* OPENPILOT_H */
@@ -0,0 +1,276 @@
+#include "gtest/gtest.h"
+
+#include <string.h> /* memcpy */
+#include <vector>
+
+extern "C" {
+#include "msp_protocol.h"
+}
+
+#define MSP_RC       105
+#define MSP_RAW_GPS  106
+#define MSP_ATTITUDE 108
+#define MSP_ANALOG   110
+#define MSP_PIDNAMES 117
+#define MSP_SET_PID  202
+
+// MWOSD poll cycle as captured on the MSP port: RC, RAW_GPS, ATTITUDE, ANALOG
+static const uint8_t mwosd_capture[] = {
+    0x24, 0x4d, 0x3c, 0x00, 0x69, 0x69,
+    0x24, 0x4d, 0x3c, 0x00, 0x6a, 0x6a,
+    0x24, 0x4d, 0x3c, 0x00, 0x6c, 0x6c,
+    0x24, 0x4d, 0x3c, 0x00, 0x6e, 0x6e,
+};
+
+typedef std::vector<uint8_t> frame_t;
+
+static std::vector<frame_t> sent;
+static int encodes[256];
+static bool gps_present;
+static frame_t handled;
+
+static void send(__attribute__((unused)) void *context, const uint8_t *frame, uint16_t len)
+{
+    sent.push_back(frame_t(frame, frame + len));
+}
+
+// every body is the command id followed by the number of encodes so far
+static int16_t encode(uint8_t cmd, uint8_t *buf)
+{
+    buf[0] = cmd;
+    buf[1] = ++encodes[cmd];
+    return 2;
+}
+
+static int16_t encode_rc(__attribute__((unused)) void *context, uint8_t *buf)
+{
+    return encode(MSP_RC, buf);
+}
+
+static int16_t encode_raw_gps(__attribute__((unused)) void *context, uint8_t *buf)
+{
+    if (!gps_present) {
+        encodes[MSP_RAW_GPS]++;
+        return -1;
+    }
+    return encode(MSP_RAW_GPS, buf);
+}
+
+static int16_t encode_attitude(__attribute__((unused)) void *context, uint8_t *buf)
+{
+    return encode(MSP_ATTITUDE, buf);
+}
+
+static int16_t encode_analog(__attribute__((unused)) void *context, uint8_t *buf)
+{
+    return encode(MSP_ANALOG, buf);
+}
+
+static int16_t encode_pidnames(__attribute__((unused)) void *context, uint8_t *buf)
+{
+    memcpy(buf, "ROLL;", 5);
+    encodes[MSP_PIDNAMES]++;
+    return 5;
+}
+
+static bool set_pid(__attribute__((unused)) void *context, const uint8_t *data, uint8_t len)
+{
+    handled = frame_t(data, data + len);
+    return true;
+}
+
+static const struct msp_message messages[] = {
+    { MSP_RC,       2, 50,           encode_rc,       NULL    },
+    { MSP_RAW_GPS,  2, 200,          encode_raw_gps,  NULL    },
+    { MSP_ATTITUDE, 2, 20,           encode_attitude, NULL    },
+    { MSP_ANALOG,   2, 100,          encode_analog,   NULL    },
+    { MSP_PIDNAMES, 5, MSP_NO_CACHE, encode_pidnames, NULL    },
+    { MSP_SET_PID,  0, MSP_NO_CACHE, NULL,            set_pid },
+};
+
+class MSPProtocolTest : public testing::Test {
+protected:
+    struct msp_protocol p;
+
+    virtual void SetUp()
+    {
+        sent.clear();
+        handled.clear();
+        memset(encodes, 0, sizeof(encodes));
+        gps_present = true;
+        ASSERT_EQ(0, msp_protocol_init(&p, messages, sizeof(messages) / sizeof(messages[0]), send, NULL));
+    }
+
+    virtual void TearDown()
+    {
+        free(p.cache);
+    }
+
+    static frame_t request(uint8_t cmd, const frame_t &body = frame_t())
+    {
+        frame_t f;
+        uint8_t cs = body.size() ^ cmd;
+
+        f.push_back('$');
+        f.push_back('M');
+        f.push_back('<');
+        f.push_back(body.size());
+        f.push_back(cmd);
+        for (size_t i = 0; i < body.size(); i++) {
+            f.push_back(body[i]);
+            cs ^= body[i];
+        }
+        f.push_back(cs);
+        return f;
+    }
+
+    msp_result_t receive(const frame_t &f, uint32_t now_ms)
+    {
+        return msp_protocol_receive(&p, &f[0], f.size(), now_ms);
+    }
+
+    // checks the framing of a reply and returns its body
+    static frame_t body(const frame_t &f, uint8_t cmd)
+    {
+        EXPECT_GE(f.size(), 6u);
+        EXPECT_EQ('$', f[0]);
+        EXPECT_EQ('M', f[1]);
+        EXPECT_EQ('>', f[2]);
+        EXPECT_EQ(f.size() - 6, f[3]);
+        EXPECT_EQ(cmd, f[4]);
+        uint8_t cs = 0;
+        for (size_t i = 3; i < f.size(); i++) {
+            cs ^= f[i];
+        }
+        EXPECT_EQ(0, cs);
+        return frame_t(f.begin() + 5, f.end() - 1);
+    }
+};
+
+TEST_F(MSPProtocolTest, RepliesToRecordedPollCycle) {
+    EXPECT_EQ(MSP_RESULT_CONTINUE, msp_protocol_receive(&p, mwosd_capture, sizeof(mwosd_capture), 0));
+
+    const uint8_t cmds[] = { MSP_RC, MSP_RAW_GPS, MSP_ATTITUDE, MSP_ANALOG };
+    ASSERT_EQ(4u, sent.size());
+    for (int i = 0; i < 4; i++) {
+        frame_t b = body(sent[i], cmds[i]);
+        ASSERT_EQ(2u, b.size());
+        EXPECT_EQ(cmds[i], b[0]);
+        EXPECT_EQ(1, b[1]);
+    }
+}
+
+TEST_F(MSPProtocolTest, RecordedPollCycleByteByByte) {
+    for (size_t i = 0; i < sizeof(mwosd_capture); i++) {
+        EXPECT_EQ(MSP_RESULT_CONTINUE, msp_protocol_receive(&p, &mwosd_capture[i], 1, 0));
+    }
+    EXPECT_EQ(4u, sent.size());
+}
+
+TEST_F(MSPProtocolTest, CachedReplyRefreshesAtItsPeriod) {
+    receive(request(MSP_ATTITUDE), 0);
+    receive(request(MSP_ATTITUDE), 10);
+    receive(request(MSP_ATTITUDE), 19);
+    EXPECT_EQ(1, encodes[MSP_ATTITUDE]);
+    receive(request(MSP_ATTITUDE), 20);
+    EXPECT_EQ(2, encodes[MSP_ATTITUDE]);
+
+    ASSERT_EQ(4u, sent.size());
+    EXPECT_EQ(1, body(sent[2], MSP_ATTITUDE)[1]);
+    EXPECT_EQ(2, body(sent[3], MSP_ATTITUDE)[1]);
+}
+
+TEST_F(MSPProtocolTest, CacheSurvivesClockWrap) {
+    receive(request(MSP_ATTITUDE), UINT32_MAX - 5);
+    receive(request(MSP_ATTITUDE), 5);
+    EXPECT_EQ(1, encodes[MSP_ATTITUDE]);
+    receive(request(MSP_ATTITUDE), 14);
+    EXPECT_EQ(2, encodes[MSP_ATTITUDE]);
+}
+
+TEST_F(MSPProtocolTest, UncachedReplyEncodesEveryRequest) {
+    for (int i = 0; i < 3; i++) {
+        receive(request(MSP_PIDNAMES), 0);
+    }
+    EXPECT_EQ(3, encodes[MSP_PIDNAMES]);
+    ASSERT_EQ(3u, sent.size());
+    frame_t b = body(sent[2], MSP_PIDNAMES);
+    EXPECT_EQ(frame_t((const uint8_t *)"ROLL;", (const uint8_t *)"ROLL;" + 5), b);
+}
+
+TEST_F(MSPProtocolTest, MissingDataIsNotAnswered) {
+    gps_present = false;
+    receive(request(MSP_RAW_GPS), 0);
+    receive(request(MSP_RAW_GPS), 100);
+    EXPECT_EQ(0u, sent.size());
+    // the empty result is cached like any other
+    EXPECT_EQ(1, encodes[MSP_RAW_GPS]);
+}
+
+TEST_F(MSPProtocolTest, UnknownAndCorruptRequestsAreIgnored) {
+    frame_t bad = request(MSP_ATTITUDE);
+
+    bad.back() ^= 0x55;
+    receive(bad, 0);
+    receive(request(42), 0);
+    EXPECT_EQ(0u, sent.size());
+
+    receive(request(MSP_ATTITUDE), 0);
+    EXPECT_EQ(1u, sent.size());
+}
+
+TEST_F(MSPProtocolTest, OversizedBodyIsDiscarded) {
+    receive(request(MSP_SET_PID, frame_t(MSP_CMD_BUF_LEN + 1, 7)), 0);
+    EXPECT_EQ(0u, handled.size());
+    EXPECT_EQ(0u, sent.size());
+
+    receive(request(MSP_RC), 0);
+    EXPECT_EQ(1u, sent.size());
+}
+
+TEST_F(MSPProtocolTest, CommandIsHandledAndAcknowledged) {
+    frame_t pids;
+
+    for (int i = 0; i < MSP_CMD_BUF_LEN; i++) {
+        pids.push_back(i);
+    }
+    receive(request(MSP_ATTITUDE), 0);
+    receive(request(MSP_SET_PID, pids), 1);
+    EXPECT_EQ(pids, handled);
+    ASSERT_EQ(2u, sent.size());
+    EXPECT_EQ(0u, body(sent[1], MSP_SET_PID).size());
+
+    // the command dropped the cached replies
+    receive(request(MSP_ATTITUDE), 2);
+    EXPECT_EQ(2, encodes[MSP_ATTITUDE]);
+}
+
+TEST_F(MSPProtocolTest, DetectsUAVTalk) {
+    const uint8_t uavtalk[] = { 0x3c, 0x20, 0x1d, 0x00, 0x3c, 0x20 };
+
+    EXPECT_EQ(MSP_RESULT_UAVTALK, msp_protocol_receive(&p, uavtalk, sizeof(uavtalk), 0));
+}
+
+TEST_F(MSPProtocolTest, DetectsSlowUAVTalk) {
+    const uint8_t uavtalk[] = { 0xe0, 0x18, 0x98, 0x7e, 0x00, 0x60 };
+
+    EXPECT_EQ(MSP_RESULT_UAVTALK_57600, msp_protocol_receive(&p, uavtalk, sizeof(uavtalk), 0));
+}
+
+TEST_F(MSPProtocolTest, ConfirmedByValidRequest) {
+    frame_t bad = request(MSP_ATTITUDE);
+
+    bad.back() ^= 0xff;
+    EXPECT_FALSE(p.confirmed);
+    receive(bad, 0);
+    EXPECT_FALSE(p.confirmed);
+    receive(request(MSP_ATTITUDE), 0);
+    EXPECT_TRUE(p.confirmed);
+}
+
+TEST_F(MSPProtocolTest, MSPIsNotTakenForUAVTalk) {
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(MSP_RESULT_CONTINUE, msp_protocol_receive(&p, mwosd_capture, sizeof(mwosd_capture), i * 10));
+    }
+    EXPECT_EQ(400u, sent.size());
+}
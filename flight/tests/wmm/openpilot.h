@@ -0,0 +1,12 @@
+#ifndef OPENPILOT_H
+#define OPENPILOT_H
+
+/* Just enough to build WorldMagModel.c on the host */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define pios_malloc(size) malloc(size)
+#define vPortFree(ptr)    free(ptr)
+
+#endif /* OPENPILOT_H */
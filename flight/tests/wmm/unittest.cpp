@@ -0,0 +1,183 @@
+#include "gtest/gtest.h"
+
+#include <stdio.h> /* printf */
+#include <stdlib.h> /* rand */
+#include <math.h> /* sqrtf */
+#include <time.h> /* clock_gettime */
+
+extern "C" {
+#include "openpilot.h"
+#include "WorldMagModel.h"
+}
+
+static double now_s()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static float norm(const float v[3])
+{
+    return sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
+
+static float distance(const float a[3], const float b[3])
+{
+    const float d[3] = { a[0] - b[0], a[1] - b[1], a[2] - b[2] };
+
+    return norm(d);
+}
+
+class WmmTest : public testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        srand(1);
+    }
+
+    float randf(float min, float max)
+    {
+        return min + (max - min) * rand() / (float)RAND_MAX;
+    }
+};
+
+TEST_F(WmmTest, KnownValues) {
+    // WMM2015 test values (nT, scaled by 1e-2 as in HomeLocation.Be)
+    float B[3];
+
+    ASSERT_EQ(0, WMM_GetMagVector(80.0f, 0.0f, 0.0f, 1, 1, 2015, B));
+    EXPECT_NEAR(66.271f, B[0], 0.05f);
+    EXPECT_NEAR(-4.459f, B[1], 0.05f);
+    EXPECT_NEAR(544.323f, B[2], 0.05f);
+
+    ASSERT_EQ(0, WMM_GetMagVector(0.0f, 120.0f, 0.0f, 1, 1, 2015, B));
+    EXPECT_NEAR(395.182f, B[0], 0.05f);
+    EXPECT_NEAR(3.929f, B[1], 0.05f);
+    EXPECT_NEAR(-112.292f, B[2], 0.5f);
+
+    ASSERT_EQ(0, WMM_GetMagVector(-80.0f, -120.0f, 0.0f, 1, 1, 2015, B));
+    EXPECT_NEAR(57.973f, B[0], 0.05f);
+    EXPECT_NEAR(157.611f, B[1], 0.05f);
+    EXPECT_NEAR(-529.191f, B[2], 0.05f);
+}
+
+TEST_F(WmmTest, DateTableMatchesPerCoefficientModel) {
+    // outputs of the model before the date adjusted coefficient table
+    const struct {
+        float    lat, lon, alt;
+        uint16_t month, day, year;
+        float    B[3];
+    } golden[] = {
+        { 80.0f,  0.0f,    100000.0f, 7, 2,  2017, { 62.9050865f, -3.48557115f, 522.927185f }  },
+        { 0.0f,   120.0f,  100000.0f, 7, 2,  2017, { 375.855042f, 2.09604263f,  -105.643188f } },
+        { -80.0f, -120.0f, 100000.0f, 7, 2,  2017, { 56.8350372f, 148.088409f,  -501.631317f } },
+        { 47.4f,  8.5f,    450.0f,    6, 15, 2016, { 214.757599f, 8.06209373f,  428.118774f }  },
+        { -33.9f, 151.2f,  50.0f,     3, 1,  2018, { 241.307297f, 53.8901024f,  -514.390991f } },
+    };
+
+    for (unsigned i = 0; i < sizeof(golden) / sizeof(golden[0]); i++) {
+        float B[3];
+        ASSERT_EQ(0, WMM_GetMagVector(golden[i].lat, golden[i].lon, golden[i].alt, golden[i].month, golden[i].day, golden[i].year, B));
+        for (int k = 0; k < 3; k++) {
+            EXPECT_NEAR(golden[i].B[k], B[k], 1e-3f) << i << " " << k;
+        }
+    }
+}
+
+TEST_F(WmmTest, InvalidArguments) {
+    float B[3];
+
+    EXPECT_EQ(-1, WMM_GetMagVectorCached(-91.0f, 0.0f, 0.0f, 1, 1, 2017, B));
+    EXPECT_EQ(-2, WMM_GetMagVectorCached(91.0f, 0.0f, 0.0f, 1, 1, 2017, B));
+    EXPECT_EQ(-3, WMM_GetMagVectorCached(0.0f, -181.0f, 0.0f, 1, 1, 2017, B));
+    EXPECT_EQ(-4, WMM_GetMagVectorCached(0.0f, 181.0f, 0.0f, 1, 1, 2017, B));
+    EXPECT_EQ(-8, WMM_GetMagVectorCached(0.0f, 0.0f, 0.0f, 2, 30, 2017, B));
+    EXPECT_EQ(-8, WMM_GetMagVector(0.0f, 0.0f, 0.0f, 13, 1, 2017, B));
+}
+
+TEST_F(WmmTest, CachedErrorIsBounded) {
+    float worst = 0.0f;
+
+    for (int i = 0; i < 20000; i++) {
+        float lat = randf(-90.0f, 90.0f);
+        float lon = randf(-180.0f, 180.0f);
+        float alt = randf(-500.0f, 5000.0f);
+        float B[3], C[3];
+
+        ASSERT_EQ(0, WMM_GetMagVector(lat, lon, alt, 6, 1, 2017, B));
+        ASSERT_EQ(0, WMM_GetMagVectorCached(lat, lon, alt, 6, 1, 2017, C));
+        float error = distance(B, C) / norm(B);
+        EXPECT_LT(error, 1e-3f) << lat << " " << lon << " " << alt;
+        if (error > worst) {
+            worst = error;
+        }
+    }
+    printf("cached: worst relative error %g\n", worst);
+}
+
+TEST_F(WmmTest, CachedAroundAPosition) {
+    // a vehicle wandering around, altitude changing within a tile's band
+    float worst = 0.0f;
+
+    for (int i = 0; i < 5000; i++) {
+        float lat = 47.3f + randf(-0.5f, 0.5f);
+        float lon = 8.6f + randf(-0.5f, 0.5f);
+        float alt = 500.0f + randf(0.0f, 400.0f);
+        float B[3], C[3];
+
+        ASSERT_EQ(0, WMM_GetMagVector(lat, lon, alt, 6, 1, 2017, B));
+        ASSERT_EQ(0, WMM_GetMagVectorCached(lat, lon, alt, 6, 1, 2017, C));
+        float error = distance(B, C) / norm(B);
+        if (error > worst) {
+            worst = error;
+        }
+    }
+    EXPECT_LT(worst, 1e-3f);
+}
+
+TEST_F(WmmTest, CachedAcrossTheDateLine) {
+    float B[3], C[3];
+    const float lons[] = { -180.0f, -179.5f, 179.5f, 180.0f };
+
+    for (unsigned i = 0; i < sizeof(lons) / sizeof(lons[0]); i++) {
+        ASSERT_EQ(0, WMM_GetMagVector(-17.0f, lons[i], 0.0f, 6, 1, 2017, B));
+        ASSERT_EQ(0, WMM_GetMagVectorCached(-17.0f, lons[i], 0.0f, 6, 1, 2017, C));
+        EXPECT_LT(distance(B, C) / norm(B), 1e-3f) << lons[i];
+    }
+}
+
+TEST_F(WmmTest, CachedFollowsTheDate) {
+    float B[3], C[3];
+
+    ASSERT_EQ(0, WMM_GetMagVectorCached(10.2f, 20.3f, 0.0f, 1, 1, 2015, C));
+    ASSERT_EQ(0, WMM_GetMagVectorCached(10.2f, 20.3f, 0.0f, 1, 1, 2019, C));
+    ASSERT_EQ(0, WMM_GetMagVector(10.2f, 20.3f, 0.0f, 1, 1, 2019, B));
+    EXPECT_LT(distance(B, C) / norm(B), 1e-3f);
+}
+
+TEST_F(WmmTest, Benchmark) {
+    const int rounds = 20000;
+    volatile float sink = 0.0f;
+    float B[3];
+    double start;
+
+    start = now_s();
+    for (int i = 0; i < rounds; i++) {
+        WMM_GetMagVector(47.0f + 0.001f * (i % 100), 8.5f, 450.0f, 6, 1, 2017, B);
+        sink = sink + B[0];
+    }
+    double full = (now_s() - start) / rounds * 1e6;
+
+    start = now_s();
+    for (int i = 0; i < rounds; i++) {
+        WMM_GetMagVectorCached(47.0f + 0.001f * (i % 100), 8.5f, 450.0f, 6, 1, 2017, B);
+        sink = sink + B[0];
+    }
+    double cached = (now_s() - start) / rounds * 1e6;
+
+    printf("full model %7.3f us/call, cached %7.3f us/call\n", full, cached);
+    EXPECT_LT(cached, full);
+    (void)sink;
+}
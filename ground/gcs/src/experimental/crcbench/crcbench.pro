@@ -0,0 +1,15 @@
+# CRC benchmark, checks the GCS and flight CRC code against each other
+TARGET   = crcbench
+TEMPLATE = app
+CONFIG  += console
+CONFIG  -= app_bundle
+QT      -= gui
+
+FLIGHT = ../../../../../flight
+# crc.cpp is built in, the host stub pios.h of the flight unit test is enough for pios_crc.c
+DEFINES += QTCREATOR_UTILS_STATIC_LIB PIOS_CRC_SLICE_BY_4
+INCLUDEPATH += ../../libs $$FLIGHT/pios/inc $$FLIGHT/tests/crc
+
+SOURCES += main.cpp \
+    ../../libs/utils/crc.cpp \
+    $$FLIGHT/pios/common/pios_crc.c
@@ -0,0 +1,166 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Checks and measures the GCS and flight CRC implementations
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * Usage: crcbench [image size in KiB]
+ *
+ * Every implementation runs over the same random image: the CRC8 of UAVTalk,
+ * UAVObject and the flash object list, the CRC32 of the eeprom emulation and
+ * the word CRC32 of the STM32 CRC unit used for the firmware image. The
+ * results of the GCS and flight code must agree with the old byte and
+ * nibble at a time code, then the throughput of each is printed.
+ */
+
+#include "utils/crc.h"
+
+extern "C" {
+#include "pios.h"
+}
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+using namespace Utils;
+
+static QTextStream out(stdout);
+
+/* The firmware image CRC of the uploader before the slice tables */
+static quint32 nibbleCRC32(quint32 crc, quint32 size, const quint8 *data)
+{
+    static const quint32 table[16] = {
+        0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
+        0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
+    };
+    QVector<quint32> words(size);
+
+    for (quint32 x = 0; x < size; x++) {
+        words[x] = data[x * 4] | (data[x * 4 + 1] << 8) | (data[x * 4 + 2] << 16) | ((quint32)data[x * 4 + 3] << 24);
+    }
+    for (quint32 x = 0; x < size; x++) {
+        crc ^= words[x];
+        for (int n = 0; n < 8; n++) {
+            crc = (crc << 4) ^ table[crc >> 28];
+        }
+    }
+    return crc;
+}
+
+static quint8 byteCRC8(quint8 crc, const quint8 *data, qint32 length)
+{
+    while (length--) {
+        crc = Crc::updateCRC(crc, *data++);
+    }
+    return crc;
+}
+
+static double rate(const QElapsedTimer & timer, int bytes, int rounds)
+{
+    return (double)bytes * rounds / qMax<qint64>(timer.nsecsElapsed(), 1) * 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int size = 1024 * (app.arguments().size() > 1 ? app.arguments().at(1).toInt() : 1024);
+
+    if (size <= 0) {
+        out << "Usage: crcbench [image size in KiB]" << endl;
+        return 1;
+    }
+
+    QByteArray image(size, 0);
+    qsrand(1);
+    for (int n = 0; n < size; n++) {
+        image[n] = (char)qrand();
+    }
+    const quint8 *data = (const quint8 *)image.constData();
+    const int words    = size / 4;
+
+    // Equivalence, over every length and alignment of a UAVTalk sized frame and the whole image
+    int failed = 0;
+    for (int offset = 0; offset < 8; offset++) {
+        for (int length = 0; length <= 256 + 12; length++) {
+            const quint8 *p = data + offset;
+            quint8 crc8     = byteCRC8(0, p, length);
+            quint32 crc32   = PIOS_CRC32_updateCRC(0xFFFFFFFF, p, length);
+            failed += Crc::updateCRC(0, p, length) != crc8;
+            failed += PIOS_CRC_updateCRC(0, p, length) != crc8;
+            failed += Crc::updateCRC32(0xFFFFFFFF, p, length) != crc32;
+            failed += Crc::updateCRC32Words(0xFFFFFFFF, p, length / 4) != nibbleCRC32(0xFFFFFFFF, length / 4, p);
+        }
+    }
+    quint32 imageCRC = nibbleCRC32(0xFFFFFFFF, words, data);
+    failed += Crc::updateCRC32Words(0xFFFFFFFF, data, words) != imageCRC;
+    failed += PIOS_CRC32_updateWords(0xFFFFFFFF, (const uint32_t *)data, words) != imageCRC;
+    failed += Crc::updateCRC(0, data, size) != byteCRC8(0, data, size);
+    failed += Crc::updateCRC32(0xFFFFFFFF, data, size) != PIOS_CRC32_updateCRC(0xFFFFFFFF, data, size);
+    if (failed) {
+        out << failed << " mismatches, not measuring" << endl;
+        return 1;
+    }
+    out << "All implementations agree, image crc 0x" << hex << imageCRC << dec << endl;
+
+    const int rounds = qMax(1, (64 * 1024 * 1024) / size);
+    volatile quint32 sink = 0;
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int n = 0; n < rounds; n++) {
+        sink = sink + byteCRC8(0, data, size);
+    }
+    out << "crc8   byte at a time        " << rate(timer, size, rounds) << " MB/s" << endl;
+    timer.start();
+    for (int n = 0; n < rounds; n++) {
+        sink = sink + Crc::updateCRC(0, data, size);
+    }
+    out << "crc8   gcs slice by 8        " << rate(timer, size, rounds) << " MB/s" << endl;
+    timer.start();
+    for (int n = 0; n < rounds; n++) {
+        sink = sink + PIOS_CRC_updateCRC(0, data, size);
+    }
+    out << "crc8   flight slice by 4     " << rate(timer, size, rounds) << " MB/s" << endl;
+
+    timer.start();
+    for (int n = 0; n < rounds; n++) {
+        sink = sink + nibbleCRC32(0xFFFFFFFF, words, data);
+    }
+    out << "stm32  nibble, word copy     " << rate(timer, size, rounds) << " MB/s" << endl;
+    timer.start();
+    for (int n = 0; n < rounds; n++) {
+        sink = sink + Crc::updateCRC32Words(0xFFFFFFFF, data, words);
+    }
+    out << "stm32  gcs slice by 8        " << rate(timer, size, rounds) << " MB/s" << endl;
+    timer.start();
+    for (int n = 0; n < rounds; n++) {
+        sink = sink + PIOS_CRC32_updateWords(0xFFFFFFFF, (const uint32_t *)data, words);
+    }
+    out << "stm32  flight slice by 4     " << rate(timer, size, rounds) << " MB/s" << endl;
+
+    return 0;
+}
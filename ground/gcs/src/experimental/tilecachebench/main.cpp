@@ -0,0 +1,123 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Measures the tile cache write throughput
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * Usage: tilecachebench <tile directory> <cache directory>
+ *
+ * The tile directory is a local tile source laid out as <zoom>/<x>/<y>.<ext>,
+ * as produced by most tile downloaders. Every tile found is written once
+ * with the legacy one tile per connection path and once through the
+ * batched TileCacheQueue writer, each into a fresh database.
+ */
+
+#include "cache.h"
+#include "tilecachequeue.h"
+
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+using namespace core;
+
+static QTextStream out(stdout);
+
+static QList<CacheItemQueue> loadTiles(const QString &path)
+{
+    QList<CacheItemQueue> tiles;
+    QDirIterator it(path, QStringList() << "*.png" << "*.jpg" << "*.jpeg", QDir::Files, QDirIterator::Subdirectories);
+
+    while (it.hasNext()) {
+        QFileInfo info(it.next());
+        bool okZoom, okX, okY;
+        int y    = info.completeBaseName().toInt(&okY);
+        int x    = info.dir().dirName().toInt(&okX);
+        QDir zoomDir(info.dir());
+        zoomDir.cdUp();
+        int zoom = zoomDir.dirName().toInt(&okZoom);
+        if (!okZoom || !okX || !okY) {
+            continue;
+        }
+        QFile file(info.filePath());
+        if (file.open(QIODevice::ReadOnly)) {
+            tiles << CacheItemQueue(MapType::GoogleMap, Point(x, y), file.readAll(), zoom);
+        }
+    }
+    return tiles;
+}
+
+static void resetCache(const QString &path)
+{
+    QFile::remove(path + "Data.qmdb");
+    QFile::remove(path + "Data.qmdb-wal");
+    QFile::remove(path + "Data.qmdb-shm");
+    Cache::Instance()->setCacheLocation(path);
+}
+
+static void report(const char *name, int count, qint64 ms)
+{
+    out << name << ": " << count << " tiles in " << ms << " ms, "
+        << (ms ? count * 1000.0 / ms : 0.0) << " tiles/s" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc != 3) {
+        out << "usage: tilecachebench <tile directory> <cache directory>" << endl;
+        return 1;
+    }
+    QString cachePath = QDir(QString::fromLocal8Bit(argv[2])).absolutePath() + QDir::separator();
+    QList<CacheItemQueue> tiles = loadTiles(QString::fromLocal8Bit(argv[1]));
+    if (tiles.isEmpty()) {
+        out << "no tiles found" << endl;
+        return 1;
+    }
+
+    QElapsedTimer timer;
+
+    resetCache(cachePath);
+    timer.start();
+    for (int n = 0; n < tiles.count(); ++n) {
+        CacheItemQueue &tile = tiles[n];
+        Cache::Instance()->ImageCache.PutImageToCache(tile.GetImg(), tile.GetMapType(), tile.GetPosition(), tile.GetZoom());
+    }
+    report("single", tiles.count(), timer.elapsed());
+
+    resetCache(cachePath);
+    {
+        TileCacheQueue queue;
+        timer.restart();
+        for (int n = 0; n < tiles.count(); ++n) {
+            queue.EnqueueCacheTask(new CacheItemQueue(tiles.at(n)));
+        }
+        queue.Flush();
+        report("batched", tiles.count(), timer.elapsed());
+    }
+
+    return 0;
+}
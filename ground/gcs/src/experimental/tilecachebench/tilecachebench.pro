@@ -0,0 +1,13 @@
+# Tile cache writer benchmark, build the opmapcontrol core library first
+TARGET   = tilecachebench
+TEMPLATE = app
+CONFIG  += console
+CONFIG  -= app_bundle
+QT      += network sql
+QT      -= gui
+
+OPMAP_CORE = ../../libs/opmapcontrol/src
+INCLUDEPATH += $$OPMAP_CORE/core ../../libs
+LIBS += -L$$OPMAP_CORE/build -lcore
+
+SOURCES += main.cpp
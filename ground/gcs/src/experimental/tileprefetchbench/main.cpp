@@ -0,0 +1,165 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Measures how many tiles the prefetcher loads before they are shown
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * Usage: tileprefetchbench <tile directory> [--generate]
+ *
+ * Flies a simulated fixed-wing east at 30 m/s for 5 minutes over a local
+ * directory-backed tile source (<zoom>/<x>/<y>.png) and counts the tiles
+ * already in the memory cache when they enter the view, with and without
+ * the prefetcher. --generate fills the directory with blank tiles first.
+ */
+
+#include "opmaps.h"
+#include "tileprefetcher.h"
+#include "projections/mercatorprojection.h"
+
+#include <QCoreApplication>
+#include <QBuffer>
+#include <QDir>
+#include <QImage>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <qmath.h>
+
+using namespace core;
+using namespace internals;
+
+static QTextStream out(stdout);
+
+static const int ZOOM          = 17;
+static const int DURATION_S    = 300;
+static const double SPEED_MPS  = 30.0;
+static const int TICK_MS       = 20; // wall clock time of one simulated second
+static const Size VIEW_TILES(3, 2);
+static const PointLatLng START(46.5, 6.5);
+
+static PointLatLng positionAt(int t)
+{
+    return PointLatLng(START.Lat(), START.Lng() + SPEED_MPS * t / (111319.49 * qCos(qDegreesToRadians(START.Lat()))));
+}
+
+static void generateTiles(const QString &path, PureProjection *projection)
+{
+    QImage image(256, 256, QImage::Format_RGB32);
+    QByteArray png;
+    QBuffer buffer(&png);
+
+    image.fill(Qt::gray);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+
+    int count = 0;
+    for (int zoom = ZOOM - 1; zoom <= ZOOM + 1; ++zoom) {
+        Point from = projection->FromPixelToTileXY(projection->FromLatLngToPixel(positionAt(0), zoom));
+        Point to   = projection->FromPixelToTileXY(projection->FromLatLngToPixel(positionAt(DURATION_S + 120), zoom));
+        for (int x = from.X() - VIEW_TILES.Width() - 1; x <= to.X() + VIEW_TILES.Width() + 1; ++x) {
+            for (int y = from.Y() - VIEW_TILES.Height() - 1; y <= from.Y() + VIEW_TILES.Height() + 1; ++y) {
+                QDir dir(QString("%1/%2/%3").arg(path).arg(zoom).arg(x));
+                dir.mkpath(".");
+                QFile file(dir.filePath(QString("%1.png").arg(y)));
+                if (file.open(QIODevice::WriteOnly)) {
+                    file.write(png);
+                    ++count;
+                }
+            }
+        }
+    }
+    out << "generated " << count << " tiles" << endl;
+}
+
+static void run(const char *name, PureProjection *projection, TilePrefetcher *prefetcher)
+{
+    OPMaps *maps = OPMaps::Instance();
+    QSet<Point> seen;
+    int shown    = 0;
+    int ready    = 0;
+
+    maps->kiberCacheLock.lockForWrite();
+    maps->TilesInMemory.cachequeue.clear();
+    maps->TilesInMemory.list.clear();
+    maps->TilesInMemory.memoryCacheSize = 0;
+    maps->kiberCacheLock.unlock();
+    for (int t = 0; t < DURATION_S; ++t) {
+        PointLatLng position = positionAt(t);
+        if (prefetcher) {
+            prefetcher->SetTrack(position, 0, SPEED_MPS);
+            prefetcher->Rebuild(projection, ZOOM, 19, MapType::GoogleMap, VIEW_TILES);
+        }
+        QThread::msleep(TICK_MS);
+
+        Point center = projection->FromPixelToTileXY(projection->FromLatLngToPixel(position, ZOOM));
+        for (int i = -VIEW_TILES.Width(); i <= VIEW_TILES.Width(); ++i) {
+            for (int j = -VIEW_TILES.Height(); j <= VIEW_TILES.Height(); ++j) {
+                Point p(center.X() + i, center.Y() + j);
+                if (seen.contains(p)) {
+                    continue;
+                }
+                seen.insert(p);
+                ++shown;
+                if (!maps->GetTileFromMemoryCache(RawTile(MapType::GoogleMap, p, ZOOM)).isEmpty()) {
+                    ++ready;
+                } else {
+                    maps->GetImageFrom(MapType::GoogleMap, p, ZOOM);
+                }
+            }
+        }
+    }
+    out << name << ": " << ready << "/" << shown << " tiles ready when shown ("
+        << (shown ? 100 * ready / shown : 0) << "%)";
+    if (prefetcher) {
+        out << ", " << prefetcher->Fetched() << " tiles prefetched";
+    }
+    out << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2) {
+        out << "usage: tileprefetchbench <tile directory> [--generate]" << endl;
+        return 1;
+    }
+    QString path = QDir(QString::fromLocal8Bit(argv[1])).absolutePath();
+    MercatorProjection projection;
+
+    if (argc > 2 && QString(argv[2]) == "--generate") {
+        generateTiles(path, &projection);
+    }
+
+    OPMaps::Instance()->setLocalTileDirectory(path);
+    OPMaps::Instance()->setAccessMode(AccessMode::ServerOnly);
+    OPMaps::Instance()->setUseMemoryCache(true);
+
+    run("viewport only", &projection, 0);
+    {
+        TilePrefetcher prefetcher;
+        prefetcher.SetEnabled(true);
+        run("prefetch", &projection, &prefetcher);
+    }
+    return 0;
+}
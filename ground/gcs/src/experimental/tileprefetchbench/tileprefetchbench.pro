@@ -0,0 +1,12 @@
+# Tile prefetch simulation, build the opmapcontrol core and internals libraries first
+TARGET   = tileprefetchbench
+TEMPLATE = app
+CONFIG  += console
+CONFIG  -= app_bundle
+QT      += network sql
+
+OPMAP = ../../libs/opmapcontrol/src
+INCLUDEPATH += $$OPMAP/core $$OPMAP/internals ../../libs
+LIBS += -L$$OPMAP/build -linternals -lcore
+
+SOURCES += main.cpp
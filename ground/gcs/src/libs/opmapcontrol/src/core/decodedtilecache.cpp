@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ *
+ * @file       decodedtilecache.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "decodedtilecache.h"
+#include "pureimage.h"
+
+namespace core {
+// Cost unit is the KiB, default capacity holds ~256 decoded 256x256 tiles
+DecodedTileCache::DecodedTileCache() : cache(64 * 1024), hits(0), misses(0)
+{}
+
+/**
+ * Returns the decoded image of the compressed tile \a data.
+ * The entry is only reused if it was decoded from the very same buffer,
+ * a tile that was reloaded in the meantime is decoded again.
+ */
+QPixmap DecodedTileCache::GetPixmap(const RawTile &tile, const QByteArray &data)
+{
+    QMutexLocker locker(&lock);
+    Entry *entry = cache.object(tile);
+
+    if (entry && entry->data.constData() == data.constData() && entry->data.size() == data.size()) {
+        ++hits;
+        return entry->pixmap;
+    }
+    ++misses;
+
+    entry = new Entry;
+    entry->data   = data;
+    entry->pixmap = PureImageProxy::FromStream(data);
+    QPixmap pixmap = entry->pixmap;
+    int cost = (pixmap.width() * pixmap.height() * pixmap.depth() / 8 + data.size()) / 1024;
+#ifdef DEBUG_MEMORY_CACHE
+    qDebug() << "Decoded tile " << const_cast<RawTile &>(tile).ToString() << " cost=" << cost << "KiB total=" << cache.totalCost();
+#endif
+    // QCache takes ownership and evicts the least recently used entries
+    cache.insert(tile, entry, qMax(cost, 1));
+    return pixmap;
+}
+
+void DecodedTileCache::setCapacity(const int &megabytes)
+{
+    QMutexLocker locker(&lock);
+
+    cache.setMaxCost(megabytes * 1024);
+}
+
+int DecodedTileCache::Capacity()
+{
+    QMutexLocker locker(&lock);
+
+    return cache.maxCost() / 1024;
+}
+
+void DecodedTileCache::Clear()
+{
+    QMutexLocker locker(&lock);
+
+    cache.clear();
+}
+
+int DecodedTileCache::Hits()
+{
+    QMutexLocker locker(&lock);
+
+    return hits;
+}
+
+int DecodedTileCache::Misses()
+{
+    QMutexLocker locker(&lock);
+
+    return misses;
+}
+}
@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ *
+ * @file       decodedtilecache.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef DECODEDTILECACHE_H
+#define DECODEDTILECACHE_H
+
+#include "rawtile.h"
+#include <QCache>
+#include <QMutex>
+#include <QPixmap>
+#include <QByteArray>
+#include "debugheader.h"
+namespace core {
+/**
+ * LRU cache of decoded tile images, sitting next to the compressed
+ * tiles kept by KiberTileCache. Pixmaps must only be used from the GUI
+ * thread, so this cache is only ever queried while painting.
+ */
+class DecodedTileCache {
+public:
+    DecodedTileCache();
+
+    QPixmap GetPixmap(const RawTile &tile, const QByteArray &data);
+    void setCapacity(const int &megabytes);
+    int Capacity();
+    void Clear();
+    int Hits();
+    int Misses();
+private:
+    struct Entry {
+        QByteArray data;
+        QPixmap    pixmap;
+    };
+    QCache<RawTile, Entry> cache;
+    QMutex lock;
+    int hits;
+    int misses;
+};
+}
+#endif // DECODEDTILECACHE_H
@@ -36,9 +36,14 @@ struct diagnostics {
     int     tilesFromMem;
     int     tilesFromNet;
     int     tilesFromDB;
+    int     tilesFromDirectory;
+    int     decodedTileHits;
+    int     decodedTileMisses;
+    int     prefetchedTiles;
+    int     prefetchPending;
     QString toString()
     {
-        return QString("Network errors:%1\nEmpty Tiles:%2\nTimeOuts:%3\nRunningThreads:%4\nTilesFromMem:%5\nTilesFromNet:%6\nTilesFromDB:%7").arg(networkerrors).arg(emptytiles).arg(timeouts).arg(runningThreads).arg(tilesFromMem).arg(tilesFromNet).arg(tilesFromDB);
+        return QString("Network errors:%1\nEmpty Tiles:%2\nTimeOuts:%3\nRunningThreads:%4\nTilesFromMem:%5\nTilesFromNet:%6\nTilesFromDB:%7\nTilesFromDirectory:%8\nDecodedTileHits:%9\nDecodedTileMisses:%10\nPrefetchedTiles:%11\nPrefetchPending:%12").arg(networkerrors).arg(emptytiles).arg(timeouts).arg(runningThreads).arg(tilesFromMem).arg(tilesFromNet).arg(tilesFromDB).arg(tilesFromDirectory).arg(decodedTileHits).arg(decodedTileMisses).arg(prefetchedTiles).arg(prefetchPending);
 
         ;
     }
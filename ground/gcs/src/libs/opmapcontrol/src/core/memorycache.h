@@ -32,6 +32,7 @@
 #include <QReadWriteLock>
 #include <QQueue>
 #include "kibertilecache.h"
+#include "decodedtilecache.h"
 #include <QDebug>
 #include "debugheader.h"
 namespace core {
@@ -40,6 +41,7 @@ public:
     MemoryCache();
 
     KiberTileCache TilesInMemory;
+    DecodedTileCache DecodedTiles;
     QByteArray GetTileFromMemoryCache(const RawTile &tile);
     void AddTileToMemoryCache(const RawTile &tile, const QByteArray &pic);
     QReadWriteLock kiberCacheLock;
@@ -25,6 +25,8 @@
  * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 #include "opmaps.h"
+#include <QFile>
+#include <QStringList>
 
 
 namespace core {
@@ -47,7 +49,7 @@ OPMaps::OPMaps() : RetryLoadTile(2), useMemoryCache(true)
 
 OPMaps::~OPMaps()
 {
-    TileDBcacheQueue.wait();
+    TileDBcacheQueue.Stop();
 }
 
 
@@ -98,6 +100,23 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
                 return ret;
             }
         }
+        if (accessmode != AccessMode::CacheOnly && !localTileDirectory.isEmpty()) {
+            ret = GetImageFromDirectory(type, pos, zoom);
+            errorvars.lock();
+            if (ret.isEmpty()) {
+                ++diag.emptytiles;
+            } else {
+                ++diag.tilesFromDirectory;
+            }
+            errorvars.unlock();
+            if (!ret.isEmpty() && useMemoryCache) {
+                AddTileToMemoryCache(RawTile(type, pos, zoom), ret);
+            }
+            if (!ret.isEmpty() && accessmode != AccessMode::ServerOnly) {
+                TileDBcacheQueue.EnqueueCacheTask(new CacheItemQueue(type, pos, ret, zoom));
+            }
+            return ret;
+        }
         if (accessmode != AccessMode::CacheOnly) {
             QNetworkReply *reply;
             QNetworkRequest qheader;
@@ -242,6 +261,24 @@ QByteArray OPMaps::GetImageFrom(const MapType::Types &type, const Point &pos, co
     return ret;
 }
 
+QByteArray OPMaps::GetImageFromDirectory(const MapType::Types &type, const core::Point &pos, const int &zoom)
+{
+    QString tile = QString("%1/%2/%3").arg(zoom).arg(pos.X()).arg(pos.Y());
+    QStringList candidates;
+
+    candidates << localTileDirectory + "/" + MapType::StrByType(type) + "/" + tile
+               << localTileDirectory + "/" + tile;
+    foreach(QString base, candidates) {
+        foreach(QString extension, QStringList() << ".png" << ".jpg") {
+            QFile file(base + extension);
+            if (file.open(QIODevice::ReadOnly)) {
+                return file.readAll();
+            }
+        }
+    }
+    return QByteArray();
+}
+
 bool OPMaps::ExportToGMDB(const QString &file)
 {
     return Cache::Instance()->ImageCache.ExportMapDataToDB(Cache::Instance()->ImageCache.GtileCache() + QDir::separator() + "Data.qmdb", file);
@@ -258,6 +295,8 @@ diagnostics OPMaps::GetDiagnostics()
     errorvars.lock();
     i = diag;
     errorvars.unlock();
+    i.decodedTileHits   = DecodedTiles.Hits();
+    i.decodedTileMisses = DecodedTiles.Misses();
     return i;
 }
 }
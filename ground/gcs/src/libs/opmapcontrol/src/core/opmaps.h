@@ -81,6 +81,19 @@ public: ~OPMaps();
     {
         accessmode = mode;
     }
+    /**
+     * Serves the tiles from a local directory instead of the tile servers,
+     * laid out as <dir>/[<map type>/]<zoom>/<x>/<y>.png|jpg.
+     * An empty path restores the network access.
+     */
+    void setLocalTileDirectory(const QString & path)
+    {
+        localTileDirectory = path;
+    }
+    QString LocalTileDirectory() const
+    {
+        return localTileDirectory;
+    }
     int RetryLoadTile;
     diagnostics GetDiagnostics();
 
@@ -88,6 +101,8 @@ private:
     bool useMemoryCache;
     LanguageType::Types Language;
     AccessMode::Types accessmode;
+    QString localTileDirectory;
+    QByteArray GetImageFromDirectory(const MapType::Types &type, const core::Point &pos, const int &zoom);
     // PureImageCache ImageCacheLocal;//TODO Criar acesso Get Set
     TileCacheQueue TileDBcacheQueue;
     OPMaps();
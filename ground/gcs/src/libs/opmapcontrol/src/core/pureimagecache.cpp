@@ -27,6 +27,8 @@
 #include "pureimagecache.h"
 #include <QDateTime>
 #include <QSettings>
+#include <QStringList>
+#include <QThread>
 // #define DEBUG_PUREIMAGECACHE
 namespace core {
 qlonglong PureImageCache::ConnCounter = 0;
@@ -201,6 +203,138 @@ bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Type
     lock.unlock();
     return true;
 }
+
+/**
+ * Writes a batch of tiles in a single transaction using multi-row inserts.
+ *
+ * The connection used is kept open per calling thread and runs in WAL
+ * mode so that the readers are not blocked while the tiles are written.
+ * The ids are allocated upfront inside the write transaction to link the
+ * Tiles and TilesData rows without relying on last_insert_rowid().
+ */
+bool PureImageCache::PutImagesToCache(const QList<CacheItemQueue *> &tiles)
+{
+    if (gtilecache.isEmpty() | gtilecache.isNull()) {
+        return false;
+    }
+    lock.lockForRead();
+    QSqlDatabase cn;
+    if (!OpenWriter(cn)) {
+        lock.unlock();
+        return false;
+    }
+
+    bool ok = true;
+    QSqlQuery query(cn);
+    // IMMEDIATE so that no other writer can insert ids behind our back
+    if (!query.exec("BEGIN IMMEDIATE")) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "PutImagesToCache: " << query.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        lock.unlock();
+        return false;
+    }
+    qlonglong id = 0;
+    if (query.exec("SELECT IFNULL(MAX(id), 0) FROM Tiles") && query.next()) {
+        id = query.value(0).toLongLong();
+        query.finish();
+    } else {
+        ok = false;
+    }
+
+    QString date = QDateTime::currentDateTime().toString();
+    for (int start = 0; ok && start < tiles.count(); start += MAX_ROWS_PER_INSERT) {
+        int rows = qMin(MAX_ROWS_PER_INSERT, tiles.count() - start);
+        QStringList tileRows;
+        QStringList dataRows;
+        for (int n = 0; n < rows; ++n) {
+            tileRows << "(?, ?, ?, ?, ?, ?)";
+            dataRows << "(?, ?)";
+        }
+
+        QSqlQuery tileQuery(cn);
+        QSqlQuery dataQuery(cn);
+        tileQuery.prepare("INSERT INTO Tiles(id, X, Y, Zoom, Type, Date) VALUES " + tileRows.join(","));
+        dataQuery.prepare("INSERT INTO TilesData(id, Tile) VALUES " + dataRows.join(","));
+        for (int n = start; n < start + rows; ++n) {
+            CacheItemQueue *tile = tiles.at(n);
+            ++id;
+            tileQuery.addBindValue(id);
+            tileQuery.addBindValue(tile->GetPosition().X());
+            tileQuery.addBindValue(tile->GetPosition().Y());
+            tileQuery.addBindValue(tile->GetZoom());
+            tileQuery.addBindValue((int)tile->GetMapType());
+            tileQuery.addBindValue(date);
+            dataQuery.addBindValue(id);
+            dataQuery.addBindValue(tile->GetImg());
+        }
+        // Tiles first, the TilesData trigger checks the id exists
+        ok = tileQuery.exec() && dataQuery.exec();
+#ifdef DEBUG_PUREIMAGECACHE
+        if (!ok) {
+            qDebug() << "PutImagesToCache: " << tileQuery.lastError().driverText() << dataQuery.lastError().driverText();
+        }
+#endif // DEBUG_PUREIMAGECACHE
+    }
+
+    if (ok) {
+        ok = query.exec("COMMIT");
+    }
+    if (!ok) {
+        query.exec("ROLLBACK");
+    }
+    lock.unlock();
+    return ok;
+}
+
+/**
+ * Closes the writer connection of the calling thread.
+ */
+void PureImageCache::CloseWriter()
+{
+    QString name = QString("TileCacheWriter%1").arg((quintptr)QThread::currentThreadId());
+
+    if (QSqlDatabase::contains(name)) {
+        {
+            QSqlDatabase cn = QSqlDatabase::database(name, false);
+            cn.close();
+        }
+        QSqlDatabase::removeDatabase(name);
+    }
+}
+
+/**
+ * Returns the writer connection of the calling thread, opening it if needed.
+ * It is reopened if the cache location changed since it was opened.
+ */
+bool PureImageCache::OpenWriter(QSqlDatabase &cn)
+{
+    QString name = QString("TileCacheWriter%1").arg((quintptr)QThread::currentThreadId());
+    QString db   = gtilecache + "Data.qmdb";
+
+    if (QSqlDatabase::contains(name)) {
+        cn = QSqlDatabase::database(name, false);
+        if (cn.databaseName() == db && cn.isOpen()) {
+            return true;
+        }
+        cn.close();
+    } else {
+        cn = QSqlDatabase::addDatabase("QSQLITE", name);
+    }
+    cn.setDatabaseName(db);
+    cn.setConnectOptions("QSQLITE_BUSY_TIMEOUT=2000");
+    if (!cn.open()) {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug() << "OpenWriter: " << cn.lastError().driverText();
+#endif // DEBUG_PUREIMAGECACHE
+        return false;
+    }
+    QSqlQuery query(cn);
+    // WAL is persistent in the database file, readers benefit from it as well
+    query.exec("PRAGMA journal_mode=WAL");
+    query.exec("PRAGMA synchronous=NORMAL");
+    return true;
+}
 QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
 {
     lock.lockForRead();
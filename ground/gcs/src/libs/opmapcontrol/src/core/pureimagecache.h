@@ -39,6 +39,7 @@
 #include "point.h"
 #include <QVariant>
 #include "pureimage.h"
+#include "cacheitemqueue.h"
 #include <QList>
 #include <QMutex>
 #include <QReadWriteLock>
@@ -48,6 +49,8 @@ public:
     PureImageCache();
     static bool CreateEmptyDB(const QString &file);
     bool PutImageToCache(const QByteArray &tile, const MapType::Types &type, const core::Point &pos, const int &zoom);
+    bool PutImagesToCache(const QList<CacheItemQueue *> &tiles);
+    void CloseWriter();
     QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
     QString GtileCache();
     void setGtileCache(const QString &value);
@@ -58,6 +61,9 @@ private:
     QMutex Mcounter;
     QReadWriteLock lock;
     static qlonglong ConnCounter;
+    // SQLite default limit of 999 host parameters per statement
+    static const int MAX_ROWS_PER_INSERT = 128;
+    bool OpenWriter(QSqlDatabase &cn);
 };
 }
 #endif // PUREIMAGECACHE_H
@@ -30,85 +30,103 @@
 // #define DEBUG_TILECACHEQUEUE
 
 namespace core {
-TileCacheQueue::TileCacheQueue()
+TileCacheQueue::TileCacheQueue() :
+    inflight(0), stopping(false)
 {}
 TileCacheQueue::~TileCacheQueue()
 {
-    // QThread::wait(10000);
+    Stop();
 }
 
 void TileCacheQueue::EnqueueCacheTask(CacheItemQueue *task)
 {
 #ifdef DEBUG_TILECACHEQUEUE
-    qDebug() << "DB Do I EnqueueCacheTask" << task->GetPosition().X() << "," << task->GetPosition().Y();
+    qDebug() << "EnqueueCacheTask" << task->GetPosition().X() << "," << task->GetPosition().Y();
 #endif // DEBUG_TILECACHEQUEUE
-    if (!tileCacheQueue.contains(task)) {
-#ifdef DEBUG_TILECACHEQUEUE
-        qDebug() << "EnqueueCacheTask" << task->GetPosition().X() << "," << task->GetPosition().Y();
-#endif // DEBUG_TILECACHEQUEUE
-        mutex.lock();
-        tileCacheQueue.enqueue(task);
-        mutex.unlock();
-        if (this->isRunning()) {
-#ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Wake Thread";
-#endif // DEBUG_TILECACHEQUEUE
-            // this->start(QThread::NormalPriority);
-            // waitmutex.lock();
-            waitc.wakeAll();
-            // waitmutex.unlock();
-        } else {
+    QMutexLocker locker(&mutex);
+
+    if (stopping) {
+        delete task;
+        return;
+    }
+    tileCacheQueue.enqueue(task);
+    if (!this->isRunning()) {
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Start Thread";
+        qDebug() << "Start Thread";
 #endif // DEBUG_TILECACHEQUEUE
-            this->start(QThread::NormalPriority);
-        }
+        this->start(QThread::LowPriority);
+    }
+    waitc.wakeAll();
+}
+
+/**
+ * Blocks until every tile enqueued so far has been written to the database.
+ */
+void TileCacheQueue::Flush()
+{
+    QMutexLocker locker(&mutex);
+
+    while (this->isRunning() && (tileCacheQueue.count() > 0 || inflight > 0)) {
+        drained.wait(&mutex, 100);
     }
 }
+
+/**
+ * Writes the pending tiles and stops the writer thread.
+ */
+void TileCacheQueue::Stop()
+{
+    mutex.lock();
+    stopping = true;
+    waitc.wakeAll();
+    mutex.unlock();
+    wait();
+}
+
+/**
+ * The writer stays alive for the lifetime of the queue, the tiles pending
+ * when it wakes up are written in a single transaction.
+ */
 void TileCacheQueue::run()
 {
 #ifdef DEBUG_TILECACHEQUEUE
     qDebug() << "Cache Engine Start";
 #endif // DEBUG_TILECACHEQUEUE
+    QList<CacheItemQueue *> batch;
+
+    mutex.lock();
     while (true) {
-        CacheItemQueue *task;
-#ifdef DEBUG_TILECACHEQUEUE
-        qDebug() << "Cache";
-#endif // DEBUG_TILECACHEQUEUE
-        if (tileCacheQueue.count() > 0) {
-            mutex.lock();
-            task = tileCacheQueue.dequeue();
-            mutex.unlock();
-#ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Cache engine Put:" << task->GetPosition().X() << "," << task->GetPosition().Y();
-#endif // DEBUG_TILECACHEQUEUE
-            Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(), task->GetMapType(), task->GetPosition(), task->GetZoom());
-            usleep(44);
-            delete task;
-        } else {
-#ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Cache engine BEGIN WAIT";
-#endif // DEBUG_TILECACHEQUEUE
-            waitmutex.lock();
-            int tout = 4000;
-            if (!waitc.wait(&waitmutex, tout)) {
-                waitmutex.unlock();
-#ifdef DEBUG_TILECACHEQUEUE
-                qDebug() << "Cache Engine TimeOut";
-#endif // DEBUG_TILECACHEQUEUE
-                mutex.lock();
-                if (tileCacheQueue.count() == 0) {
-                    mutex.unlock();
-                    break;
-                }
-                mutex.unlock();
+        if (tileCacheQueue.isEmpty()) {
+            drained.wakeAll();
+            if (stopping) {
+                break;
             }
+            waitc.wait(&mutex);
+            continue;
+        }
+        while (!tileCacheQueue.isEmpty() && batch.count() < MAX_BATCH) {
+            batch.append(tileCacheQueue.dequeue());
+        }
+        inflight = batch.count();
+        mutex.unlock();
+
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug() << "Cache Engine DID NOT TimeOut";
+        qDebug() << "Cache engine Put:" << batch.count() << "tiles";
 #endif // DEBUG_TILECACHEQUEUE
-            waitmutex.unlock();
+        if (!Cache::Instance()->ImageCache.PutImagesToCache(batch)) {
+            // e.g. database not created yet, fall back to the single tile path
+            foreach(CacheItemQueue * task, batch) {
+                Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(), task->GetMapType(), task->GetPosition(), task->GetZoom());
+            }
         }
+        qDeleteAll(batch);
+        batch.clear();
+
+        mutex.lock();
+        inflight = 0;
     }
+    mutex.unlock();
+    Cache::Instance()->ImageCache.CloseWriter();
 #ifdef DEBUG_TILECACHEQUEUE
     qDebug() << "Cache Engine Stopped";
 #endif // DEBUG_TILECACHEQUEUE
@@ -45,14 +45,20 @@ public:
     TileCacheQueue();
     ~TileCacheQueue();
     void EnqueueCacheTask(CacheItemQueue *task);
+    void Flush();
+    void Stop();
 
 protected:
     QQueue<CacheItemQueue *> tileCacheQueue;
 private:
+    // Tiles written per transaction
+    static const int MAX_BATCH = 256;
     void run();
     QMutex mutex;
-    QMutex waitmutex;
     QWaitCondition waitc;
+    QWaitCondition drained;
+    int inflight;
+    bool stopping;
 };
 }
 #endif // TILECACHEQUEUE_H
@@ -48,6 +48,7 @@ Core::Core() : MouseWheelZooming(false), currentPosition(0, 0), currentPositionP
 }
 Core::~Core()
 {
+    Prefetcher.Cancel();
     ProcessLoadTaskCallback.waitForDone();
 }
 
@@ -71,6 +72,7 @@ void Core::run()
     {
         if (tileLoadQueue.count() > 0) {
             task = tileLoadQueue.dequeue();
+            tileLoadSet.remove(task);
             {
                 last = (tileLoadQueue.count() == 0);
 #ifdef DEBUG_CORE
@@ -123,6 +125,7 @@ void Core::run()
                                     Moverlays.lock();
                                     {
                                         t->Overlays.append(img);
+                                        t->OverlayTypes.append(tl);
 #ifdef DEBUG_CORE
                                         qDebug() << "Core::run append img:" << img.length() << " to tile:" << t->GetPos().ToString() << " now has " << t->Overlays.count() << " overlays" << " ID=" << debug;
 #endif // DEBUG_CORE
@@ -203,6 +206,8 @@ diagnostics Core::GetDiagnostics()
     diag = OPMaps::Instance()->GetDiagnostics();
     diag.runningThreads = runningThreads;
     MrunningThreads.unlock();
+    diag.prefetchedTiles = Prefetcher.Fetched();
+    diag.prefetchPending = Prefetcher.Pending();
     return diag;
 }
 
@@ -216,6 +221,7 @@ void Core::SetZoom(const int &value)
         if (started) {
             MtileLoadQueue.lock();
             tileLoadQueue.clear();
+            tileLoadSet.clear();
             MtileLoadQueue.unlock();
             MtileToload.lock();
             tilesToload = 0;
@@ -227,6 +233,7 @@ void Core::SetZoom(const int &value)
             emit OnMapDrag();
             emit OnMapZoomChanged();
             emit OnNeedInvalidation();
+            UpdatePrefetch();
         }
     }
 }
@@ -294,6 +301,7 @@ void Core::SetMapType(const MapType::Types &value)
             ReloadMap();
             GoToCurrentPosition();
             emit OnMapTypeChanged(value);
+            UpdatePrefetch();
         }
     }
 }
@@ -418,6 +426,7 @@ void Core::ReloadMap()
         MtileLoadQueue.lock();
         {
             tileLoadQueue.clear();
+            tileLoadSet.clear();
         }
         MtileLoadQueue.unlock();
         MtileToload.lock();
@@ -514,6 +523,7 @@ void Core::CancelAsyncTasks()
         MtileLoadQueue.lock();
         {
             tileLoadQueue.clear();
+            tileLoadSet.clear();
             // tilesToload=0;
         }
         MtileLoadQueue.unlock();
@@ -541,11 +551,12 @@ void Core::UpdateBounds()
             {
                 MtileLoadQueue.lock();
                 {
-                    if (!tileLoadQueue.contains(task)) {
+                    if (!tileLoadSet.contains(task)) {
                         MtileToload.lock();
                         ++tilesToload;
                         MtileToload.unlock();
                         tileLoadQueue.enqueue(task);
+                        tileLoadSet.insert(task);
 #ifdef DEBUG_CORE
                         qDebug() << "Core::UpdateBounds new Task" << task.Pos.ToString();
 #endif // DEBUG_CORE
@@ -559,6 +570,26 @@ void Core::UpdateBounds()
     MtileDrawingList.unlock();
     UpdateGroundResolution();
 }
+void Core::SetPrefetchTrack(PointLatLng const & position, double const & velocityNorth, double const & velocityEast)
+{
+    Prefetcher.SetTrack(position, velocityNorth, velocityEast);
+    // The prediction does not change much between two telemetry updates
+    if (!prefetchTimer.isValid() || prefetchTimer.elapsed() > 1000) {
+        UpdatePrefetch();
+    }
+}
+void Core::SetPrefetchPath(QList<PointLatLng> const & path)
+{
+    Prefetcher.SetPath(path);
+    UpdatePrefetch();
+}
+void Core::UpdatePrefetch()
+{
+    if (started && Prefetcher.IsEnabled()) {
+        prefetchTimer.restart();
+        Prefetcher.Rebuild(Projection(), Zoom(), MaxZoom(), GetMapType(), sizeOfMapArea);
+    }
+}
 void Core::FindTilesAround(QList<Point> &list)
 {
     list.clear();;
@@ -40,6 +40,9 @@
 #include "tilematrix.h"
 #include <QQueue>
 #include "loadtask.h"
+#include "tileprefetcher.h"
+#include <QSet>
+#include <QElapsedTimer>
 #include "copyrightstrings.h"
 #include "rectlatlng.h"
 #include "../internals/projections/lks94projection.h"
@@ -296,6 +299,14 @@ public:
 
     TileMatrix Matrix;
 
+    TilePrefetcher Prefetcher;
+
+    void SetPrefetchTrack(PointLatLng const & position, double const & velocityNorth, double const & velocityEast);
+
+    void SetPrefetchPath(QList<PointLatLng> const & path);
+
+    void UpdatePrefetch();
+
     bool isStarted()
     {
         return started;
@@ -342,6 +353,8 @@ private:
     Rectangle CurrentRegion;
 
     QQueue<LoadTask> tileLoadQueue;
+    QSet<LoadTask> tileLoadSet;
+    QElapsedTimer prefetchTimer;
 
     int zoom;
 
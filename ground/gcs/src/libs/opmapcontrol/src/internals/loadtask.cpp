@@ -32,4 +32,8 @@ bool operator==(LoadTask const & lhs, LoadTask const & rhs)
 {
     return (lhs.Pos == rhs.Pos) && (lhs.Zoom == rhs.Zoom);
 }
+uint qHash(LoadTask const & task)
+{
+    return ((uint)task.Pos.X() * 73856093u) ^ ((uint)task.Pos.Y() * 19349663u) ^ ((uint)task.Zoom * 83492791u);
+}
 }
@@ -30,6 +30,7 @@
 #include "QList"
 #include <QImage>
 #include "../core/point.h"
+#include "../core/maptype.h"
 #include <QMutex>
 #include <QDebug>
 #include "debugheader.h"
@@ -67,6 +68,7 @@ public:
         return !(zoom == 0);
     }
     QList<QByteArray> Overlays;
+    QList<MapType::Types> OverlayTypes; // map type of each of Overlays
 protected:
 
     QMutex mutex;
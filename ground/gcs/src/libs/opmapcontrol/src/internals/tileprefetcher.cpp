@@ -0,0 +1,273 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tileprefetcher.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Loads the tiles the map is about to show into the caches
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "tileprefetcher.h"
+#include "../core/opmaps.h"
+
+#include <QThread>
+#include <qmath.h>
+
+// #define DEBUG_TILEPREFETCHER
+
+namespace internals {
+const double TilePrefetcher::ADJACENT_ZOOM_DELAY_S = 10.0;
+const double TilePrefetcher::MIN_PATH_SPEED_MPS    = 15.0;
+
+// Meters per degree of latitude, good enough to extrapolate a few km
+#define METERS_PER_DEGREE 111319.49
+
+TilePrefetcher::TilePrefetcher() : mapType(MapType::GoogleMap), position(0, 0), velocityNorth(0), velocityEast(0),
+    enabled(false), horizon(60), fetched(0)
+{
+    this->setAutoDelete(false);
+    // Leave the bandwidth to the tiles being displayed
+    pool.setMaxThreadCount(2);
+}
+TilePrefetcher::~TilePrefetcher()
+{
+    Cancel();
+    pool.waitForDone();
+}
+
+void TilePrefetcher::SetTrack(PointLatLng const & position, double const & velocityNorth, double const & velocityEast)
+{
+    QMutexLocker locker(&lock);
+
+    this->position      = position;
+    this->velocityNorth = velocityNorth;
+    this->velocityEast  = velocityEast;
+}
+void TilePrefetcher::SetPath(QList<PointLatLng> const & path)
+{
+    QMutexLocker locker(&lock);
+
+    this->path = path;
+}
+/**
+ * Prefetching is off by default, it fetches tiles online that the user
+ * may never look at.
+ */
+void TilePrefetcher::SetEnabled(bool const & value)
+{
+    {
+        QMutexLocker locker(&lock);
+
+        enabled = value;
+    }
+    if (!value) {
+        Cancel();
+    }
+}
+bool TilePrefetcher::IsEnabled() const
+{
+    QMutexLocker locker(&lock);
+
+    return enabled;
+}
+void TilePrefetcher::SetHorizon(int const & seconds)
+{
+    QMutexLocker locker(&lock);
+
+    horizon = qMax(1, seconds);
+}
+int TilePrefetcher::Horizon() const
+{
+    QMutexLocker locker(&lock);
+
+    return horizon;
+}
+
+/**
+ * Replaces the pending tiles with the ones predicted from the current
+ * track and path, then makes sure enough loaders are running.
+ * The tiles already fetched are remembered and not queued again.
+ */
+void TilePrefetcher::Rebuild(PureProjection *projection, int const & zoom, int const & maxZoom, MapType::Types const & type, Size const & viewTiles)
+{
+    QMutexLocker locker(&lock);
+
+    if (!enabled) {
+        return;
+    }
+
+    foreach(LoadTask task, pending) {
+        known.remove(task);
+    }
+    pending.clear();
+    if (type != mapType || known.count() > MAX_KNOWN) {
+        known.clear();
+        mapType = type;
+    }
+
+    double speed = qSqrt(velocityNorth * velocityNorth + velocityEast * velocityEast);
+    if (speed > 1.0) {
+        PointLatLng ahead(position.Lat() + velocityNorth * horizon / METERS_PER_DEGREE,
+                          position.Lng() + velocityEast * horizon / (METERS_PER_DEGREE * qCos(qDegreesToRadians(position.Lat()))));
+        QueueSegment(projection, position, ahead, 0, speed, horizon, zoom, maxZoom, viewTiles);
+    }
+
+    // The path is followed from its first waypoint, a few horizons ahead at most
+    double pathSpeed = qMax(speed, MIN_PATH_SPEED_MPS);
+    double time      = 0;
+    PointLatLng last = position;
+    foreach(PointLatLng wp, path) {
+        double distance = PureProjection::DistanceBetweenLatLng(last, wp) * 1000.0;
+        QueueSegment(projection, last, wp, time, pathSpeed, 4 * horizon, zoom, maxZoom, viewTiles);
+        time += distance / pathSpeed;
+        last  = wp;
+        if (time > 4 * horizon) {
+            break;
+        }
+    }
+
+    // Drop the least urgent tiles
+    while (pending.count() > MAX_PENDING) {
+        QMultiMap<double, LoadTask>::iterator it = pending.end() - 1;
+        known.remove(it.value());
+        pending.erase(it);
+    }
+
+#ifdef DEBUG_TILEPREFETCHER
+    qDebug() << "TilePrefetcher::Rebuild" << pending.count() << "tiles pending";
+#endif // DEBUG_TILEPREFETCHER
+    for (int n = pending.count(); n > 0 && pool.tryStart(this); --n) {}
+}
+
+void TilePrefetcher::Cancel()
+{
+    QMutexLocker locker(&lock);
+
+    foreach(LoadTask task, pending) {
+        known.remove(task);
+    }
+    pending.clear();
+}
+
+int TilePrefetcher::Pending()
+{
+    QMutexLocker locker(&lock);
+
+    return pending.count();
+}
+int TilePrefetcher::Fetched()
+{
+    QMutexLocker locker(&lock);
+
+    return fetched;
+}
+
+/**
+ * Samples a segment every half tile, the tiles around each sample are
+ * queued with the time at which the UAV is expected there.
+ */
+void TilePrefetcher::QueueSegment(PureProjection *projection, PointLatLng const & from, PointLatLng const & to, double const & startTime, double const & speed,
+                                  double const & maxTime, int const & zoom, int const & maxZoom, Size const & viewTiles)
+{
+    double distance  = PureProjection::DistanceBetweenLatLng(from, to) * 1000.0;
+    double tileSize  = projection->GetGroundResolution(zoom, from.Lat()) * projection->TileSize().Width();
+    int steps = qMax(1, (int)qCeil(distance / (tileSize / 2)));
+
+    for (int n = 0; n <= steps; ++n) {
+        double f    = (double)n / steps;
+        double time = startTime + f * distance / speed;
+        if (time > maxTime) {
+            break;
+        }
+        PointLatLng p(from.Lat() + f * (to.Lat() - from.Lat()), from.Lng() + f * (to.Lng() - from.Lng()));
+        QueueAround(projection, p, time, zoom, maxZoom, viewTiles);
+    }
+}
+
+void TilePrefetcher::QueueAround(PureProjection *projection, PointLatLng const & point, double const & time, int const & zoom, int const & maxZoom, Size const & viewTiles)
+{
+    core::Point center = projection->FromPixelToTileXY(projection->FromLatLngToPixel(point, zoom));
+
+    for (int i = -viewTiles.Width(); i <= viewTiles.Width(); ++i) {
+        for (int j = -viewTiles.Height(); j <= viewTiles.Height(); ++j) {
+            core::Point p(center.X() + i, center.Y() + j);
+            // the tiles farther away become visible a bit later
+            QueueTile(projection, p, zoom, time + (qAbs(i) + qAbs(j)) * 0.01);
+        }
+    }
+    // Adjacent zoom levels, only the tile under the UAV and its neighbours
+    for (int z = zoom - 1; z <= zoom + 1; z += 2) {
+        if (z < 0 || z > maxZoom) {
+            continue;
+        }
+        center = projection->FromPixelToTileXY(projection->FromLatLngToPixel(point, z));
+        for (int i = -1; i <= 1; ++i) {
+            for (int j = -1; j <= 1; ++j) {
+                QueueTile(projection, core::Point(center.X() + i, center.Y() + j), z, time + ADJACENT_ZOOM_DELAY_S);
+            }
+        }
+    }
+}
+
+void TilePrefetcher::QueueTile(PureProjection *projection, core::Point const & pos, int const & zoom, double const & time)
+{
+    Size min = projection->GetTileMatrixMinXY(zoom);
+    Size max = projection->GetTileMatrixMaxXY(zoom);
+
+    if (pos.X() < min.Width() || pos.Y() < min.Height() || pos.X() > max.Width() || pos.Y() > max.Height()) {
+        return;
+    }
+    LoadTask task(pos, zoom);
+    if (!known.contains(task)) {
+        known.insert(task);
+        pending.insert(time, task);
+    }
+}
+
+void TilePrefetcher::run()
+{
+    QThread::currentThread()->setPriority(QThread::LowPriority);
+    while (true) {
+        LoadTask task;
+        MapType::Types type;
+        lock.lock();
+        if (pending.isEmpty()) {
+            lock.unlock();
+            break;
+        }
+        task = pending.begin().value();
+        pending.erase(pending.begin());
+        type = mapType;
+        lock.unlock();
+
+#ifdef DEBUG_TILEPREFETCHER
+        qDebug() << "TilePrefetcher::run" << task.ToString();
+#endif // DEBUG_TILEPREFETCHER
+        // GetImageFrom stores the tile in the memory and database caches
+        foreach(MapType::Types layer, OPMaps::Instance()->GetAllLayersOfType(type)) {
+            OPMaps::Instance()->GetImageFrom(layer, task.Pos, task.Zoom);
+        }
+
+        lock.lock();
+        ++fetched;
+        lock.unlock();
+    }
+}
+}
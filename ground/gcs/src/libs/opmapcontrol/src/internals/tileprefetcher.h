@@ -0,0 +1,96 @@
+/**
+ ******************************************************************************
+ *
+ * @file       tileprefetcher.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Loads the tiles the map is about to show into the caches
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   OPMapWidget
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef TILEPREFETCHER_H
+#define TILEPREFETCHER_H
+
+#include "loadtask.h"
+#include "pointlatlng.h"
+#include "pureprojection.h"
+#include "../core/maptype.h"
+#include "../core/size.h"
+
+#include <QMultiMap>
+#include <QSet>
+#include <QList>
+#include <QMutex>
+#include <QThreadPool>
+
+namespace internals {
+/**
+ * Warms the memory and database caches with the tiles along the projected
+ * UAV track and the planned waypoint path, at the current and adjacent zoom
+ * levels. Tiles are fetched in order of the predicted time before they
+ * become visible, each tile is only queued once.
+ */
+class TilePrefetcher : public QRunnable {
+public:
+    TilePrefetcher();
+    ~TilePrefetcher();
+    void run();
+
+    void SetTrack(PointLatLng const & position, double const & velocityNorth, double const & velocityEast);
+    void SetPath(QList<PointLatLng> const & path);
+
+    void SetEnabled(bool const & value);
+    bool IsEnabled() const;
+    void SetHorizon(int const & seconds);
+    int Horizon() const;
+
+    void Rebuild(PureProjection *projection, int const & zoom, int const & maxZoom, MapType::Types const & type, Size const & viewTiles);
+    void Cancel();
+
+    int Pending();
+    int Fetched();
+
+private:
+    // Tiles at the adjacent zoom levels are only needed if the user zooms
+    static const double ADJACENT_ZOOM_DELAY_S;
+    // Assumed speed to follow the path when the UAV is not moving
+    static const double MIN_PATH_SPEED_MPS;
+    static const int MAX_PENDING = 1024;
+    static const int MAX_KNOWN   = 16384;
+
+    void QueueAround(PureProjection *projection, PointLatLng const & point, double const & time, int const & zoom, int const & maxZoom, Size const & viewTiles);
+    void QueueTile(PureProjection *projection, core::Point const & pos, int const & zoom, double const & time);
+    void QueueSegment(PureProjection *projection, PointLatLng const & from, PointLatLng const & to, double const & startTime, double const & speed,
+                      double const & maxTime, int const & zoom, int const & maxZoom, Size const & viewTiles);
+
+    mutable QMutex lock;
+    QThreadPool pool;
+    QMultiMap<double, LoadTask> pending;
+    QSet<LoadTask> known;
+    MapType::Types mapType;
+    PointLatLng position;
+    double velocityNorth;
+    double velocityEast;
+    QList<PointLatLng> path;
+    bool enabled;
+    int horizon;
+    int fetched;
+};
+}
+#endif // TILEPREFETCHER_H
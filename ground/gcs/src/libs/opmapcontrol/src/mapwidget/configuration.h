@@ -152,6 +152,17 @@ public:
         core::OPMaps::Instance()->TilesInMemory.setMemoryCacheCapacity(value);
     }
 
+    /**
+     * @brief  Sets the size of the memory for decoded tile images
+     *
+     * @param  value size in Mb to use for decoded tiles
+     * @return
+     */
+    void SetDecodedTileMemorySize(int const & value)
+    {
+        core::OPMaps::Instance()->DecodedTiles.setCapacity(value);
+    }
+
     /**
      * @brief Sets the location for the SQLite Database used for caching and the geocoding cache files
      *
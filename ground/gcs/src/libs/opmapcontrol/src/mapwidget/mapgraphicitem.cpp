@@ -317,13 +317,16 @@ void MapGraphicItem::DrawMap2D(QPainter *painter)
                         // render tile
                         // lock(t.Overlays)
                         if (t != 0) {
-                            foreach(QByteArray img, t->Overlays) {
+                            for (int layer = 0; layer < t->Overlays.count(); ++layer) {
+                                QByteArray img = t->Overlays.at(layer);
                                 if (img.count() != 0) {
                                     if (!found) {
                                         found = true;
                                     }
                                     {
-                                        painter->drawPixmap(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(), PureImageProxy::FromStream(img));
+                                        // decoding is expensive, reuse the image from the previous frames
+                                        RawTile key(t->OverlayTypes.value(layer, core->GetMapType()), t->GetPos(), t->GetZoom());
+                                        painter->drawPixmap(core->tileRect.X(), core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(), OPMaps::Instance()->DecodedTiles.GetPixmap(key, img));
                                     }
                                 }
                             }
@@ -57,11 +57,49 @@ OPMapWidget::OPMapWidget(QWidget *parent, Configuration *config) : QGraphicsView
     connect(map->core, SIGNAL(OnTilesStillToLoad(int)), this, SIGNAL(OnTilesStillToLoad(int)));
     connect(map, SIGNAL(wpdoubleclicked(WayPointItem *)), this, SIGNAL(OnWayPointDoubleClicked(WayPointItem *)));
     connect(&mscene, SIGNAL(selectionChanged()), this, SLOT(OnSelectionChanged()));
+    connect(this, SIGNAL(WPCreated(int, WayPointItem *)), this, SLOT(prefetchPathChanged()));
+    connect(this, SIGNAL(WPInserted(int, WayPointItem *)), this, SLOT(prefetchPathChanged()));
+    connect(this, SIGNAL(WPDeleted(int, WayPointItem *)), this, SLOT(prefetchPathChanged()));
+    connect(this, SIGNAL(WPNumberChanged(int, int, WayPointItem *)), this, SLOT(prefetchPathChanged()));
+    connect(this, SIGNAL(WPValuesChanged(WayPointItem *)), this, SLOT(prefetchPathChanged()));
     SetShowDiagnostics(showDiag);
     this->setMouseTracking(followmouse);
     SetShowCompass(true);
     QPixmapCache::setCacheLimit(64 * 1024);
 }
+void OPMapWidget::SetTilePrefetch(bool const & value)
+{
+    core->Prefetcher.SetEnabled(value);
+    if (value) {
+        updatePrefetchPath();
+    }
+}
+void OPMapWidget::UpdatePrefetchTrack(internals::PointLatLng const & position, double const & velocityNorth, double const & velocityEast)
+{
+    if (core->Prefetcher.IsEnabled()) {
+        core->SetPrefetchTrack(position, velocityNorth, velocityEast);
+    }
+}
+void OPMapWidget::prefetchPathChanged()
+{
+    // Deferred, the waypoints are still being edited or deleted when the signals fire
+    QTimer::singleShot(0, this, SLOT(updatePrefetchPath()));
+}
+void OPMapWidget::updatePrefetchPath()
+{
+    if (!core->Prefetcher.IsEnabled()) {
+        return;
+    }
+    QMap<int, internals::PointLatLng> waypoints;
+    foreach(QGraphicsItem * i, map->childItems()) {
+        WayPointItem *w = qgraphicsitem_cast<WayPointItem *>(i);
+
+        if (w) {
+            waypoints.insert(w->Number(), w->Coord());
+        }
+    }
+    core->SetPrefetchPath(waypoints.values());
+}
 void OPMapWidget::SetShowDiagnostics(bool const & value)
 {
     showDiag = value;
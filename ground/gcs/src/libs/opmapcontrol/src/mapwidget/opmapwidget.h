@@ -511,6 +511,17 @@ public:
         return showhome;
     }
     void SetShowDiagnostics(bool const & value);
+    /**
+     * @brief Loads the tiles along the UAV track and the waypoint path ahead of time
+     *
+     * @param value true to enable the prefetch, it is off by default
+     */
+    void SetTilePrefetch(bool const & value);
+    bool TilePrefetch() const
+    {
+        return core->Prefetcher.IsEnabled();
+    }
+    void UpdatePrefetchTrack(internals::PointLatLng const & position, double const & velocityNorth, double const & velocityEast);
     void SetUavPic(QString UAVPic);
     WayPointLine *WPLineCreate(WayPointItem *from, WayPointItem *to, QColor color, bool dashed = false, int width = -1);
     WayPointLine *WPLineCreate(HomeItem *from, WayPointItem *to, QColor color, bool dashed = false, int width = -1);
@@ -543,6 +554,8 @@ private:
     qreal overlayOpacity;
 private slots:
     void diagRefresh();
+    void prefetchPathChanged();
+    void updatePrefetchPath();
     // WayPointItem* item;//apagar
 protected:
     void resizeEvent(QResizeEvent *event);
@@ -35,6 +35,7 @@ UAVItem::UAVItem(MapGraphicItem *map, OPMapWidget *parent, QString uavPic) : map
     trailtime(5), traildistance(50), autosetreached(true), autosetdistance(100), showUAVInfo(false)
 {
     pic.load(uavPic);
+    vNED[0] = vNED[1] = vNED[2] = 0;
     this->setFlag(QGraphicsItem::ItemIsMovable, false);
     this->setFlag(QGraphicsItem::ItemIsSelectable, false);
     localposition = map->FromLatLngToLocal(mapwidget->CurrentPosition());
@@ -277,6 +278,7 @@ void UAVItem::SetUAVPos(const internals::PointLatLng &position, const int &altit
         coord = position;
         this->altitude = altitude;
         RefreshPos();
+        mapwidget->UpdatePrefetchTrack(coord, vNED[0], vNED[1]);
         if (mapfollowtype == UAVMapFollowType::CenterAndRotateMap || mapfollowtype == UAVMapFollowType::CenterMap) {
             mapwidget->SetCurrentPosition(coord);
         }
@@ -28,6 +28,8 @@
 
 #include "crc.h"
 
+#include <QtEndian>
+
 using namespace Utils;
 
 /*
@@ -65,10 +67,76 @@ quint8 Crc::updateCRC(quint8 crc, const quint8 data)
     return crc_table[crc ^ data];
 }
 
+namespace {
+/*
+ * Slice by 8 tables, [n][x] is the crc of byte x followed by n zero bytes.
+ * Eight bytes are folded in per step with independent lookups.
+ */
+struct SliceTables {
+    quint8  crc8[8][256];
+    quint32 crc32[8][256];
+
+    SliceTables()
+    {
+        for (int x = 0; x < 256; x++) {
+            quint32 crc = (quint32)x << 24;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+            }
+            crc8[0][x]  = crc_table[x];
+            crc32[0][x] = crc;
+        }
+        for (int n = 1; n < 8; n++) {
+            for (int x = 0; x < 256; x++) {
+                crc8[n][x]  = crc_table[crc8[n - 1][x]];
+                crc32[n][x] = (crc32[n - 1][x] << 8) ^ crc32[0][crc32[n - 1][x] >> 24];
+            }
+        }
+    }
+};
+
+const SliceTables tables;
+
+inline quint32 fold32(quint32 x, int n)
+{
+    return tables.crc32[n + 3][x >> 24] ^ tables.crc32[n + 2][(x >> 16) & 0xff]
+           ^ tables.crc32[n + 1][(x >> 8) & 0xff] ^ tables.crc32[n][x & 0xff];
+}
+}
+
 quint8 Crc::updateCRC(quint8 crc, const quint8 *data, qint32 length)
 {
+    for (; length >= 8; length -= 8, data += 8) {
+        crc = tables.crc8[7][crc ^ data[0]] ^ tables.crc8[6][data[1]] ^ tables.crc8[5][data[2]] ^ tables.crc8[4][data[3]]
+              ^ tables.crc8[3][data[4]] ^ tables.crc8[2][data[5]] ^ tables.crc8[1][data[6]] ^ crc_table[data[7]];
+    }
     while (length--) {
         crc = crc_table[crc ^ *data++];
     }
     return crc;
 }
+
+quint32 Crc::updateCRC32(quint32 crc, const quint8 *data, qint32 length)
+{
+    for (; length >= 8; length -= 8, data += 8) {
+        crc ^= ((quint32)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+        crc  = fold32(crc, 4) ^ fold32(((quint32)data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7], 0);
+    }
+    while (length--) {
+        crc = (crc << 8) ^ tables.crc32[0][(crc >> 24) ^ *data++];
+    }
+    return crc;
+}
+
+quint32 Crc::updateCRC32Words(quint32 crc, const quint8 *data, qint32 words)
+{
+    // The unit takes the most significant byte of each word first
+    for (; words >= 2; words -= 2, data += 8) {
+        crc ^= qFromLittleEndian<quint32>(data);
+        crc  = fold32(crc, 4) ^ fold32(qFromLittleEndian<quint32>(data + 4), 0);
+    }
+    if (words) {
+        crc = fold32(crc ^ qFromLittleEndian<quint32>(data), 0);
+    }
+    return crc;
+}
@@ -150,6 +150,7 @@ const double CoeffFile[91][6] = {
 namespace Utils {
 WorldMagModel::WorldMagModel()
 {
+    coeff_valid = false;
     Initialize();
 }
 
@@ -201,6 +202,7 @@ int WorldMagModel::GetMagVector(double LLA[3], int Month, int Day, int Year, dou
     if (DateToYear(Month, Day, Year) < 0) {
         return -5; // error
     }
+    UpdateMainFieldCoeffs();
     // Compute the geoMagnetic field elements and their time change
     if (Geomag(&CoordSpherical, &CoordGeodetic, &GeoMagneticElements) < 0) {
         return -6; // error
@@ -924,61 +926,48 @@ void WorldMagModel::SecVarSummationSpecial(WMMtype_SphericalHarmonicVariables *S
     }
 }
 
-// brief Comput the MainFieldCoeffH accounting for the date
-double WorldMagModel::get_main_field_coeff_g(int index)
+// brief Move the main field coefficients to decimal_date, if not done yet for that date
+void WorldMagModel::UpdateMainFieldCoeffs()
 {
-    if (index >= WMM_NUMTERMS) {
-        return 0;
+    if (coeff_valid && coeff_date == decimal_date) {
+        return;
     }
 
-    double coeff = CoeffFile[index][2];
-
     int a = MagneticModel.nMaxSecVar;
     int b = (a * (a + 1) / 2 + a);
-    for (int n = 1; n <= MagneticModel.nMax; n++) {
-        for (int m = 0; m <= n; m++) {
-            int sum_index = (n * (n + 1) / 2 + m);
 
-            /* Hacky for now, will solve for which conditions need summing analytically */
-            if (sum_index != index) {
-                continue;
-            }
-
-            if (index <= b) {
-                coeff += (decimal_date - MagneticModel.epoch) * get_secular_var_coeff_g(sum_index);
-            }
+    for (int index = 0; index < WMM_NUMTERMS; index++) {
+        MainFieldCoeffG[index] = CoeffFile[index][2];
+        MainFieldCoeffH[index] = CoeffFile[index][3];
+        // index 0 is not a term of the model (n starts at 1)
+        if (index >= 1 && index <= b) {
+            MainFieldCoeffG[index] += (decimal_date - MagneticModel.epoch) * get_secular_var_coeff_g(index);
+            MainFieldCoeffH[index] += (decimal_date - MagneticModel.epoch) * get_secular_var_coeff_h(index);
         }
     }
 
-    return coeff;
+    coeff_date  = decimal_date;
+    coeff_valid = true;
 }
 
-double WorldMagModel::get_main_field_coeff_h(int index)
+// brief Get the MainFieldCoeffG accounting for the date
+double WorldMagModel::get_main_field_coeff_g(int index)
 {
     if (index >= WMM_NUMTERMS) {
         return 0;
     }
 
-    double coeff = CoeffFile[index][3];
-
-    int a = MagneticModel.nMaxSecVar;
-    int b = (a * (a + 1) / 2 + a);
-    for (int n = 1; n <= MagneticModel.nMax; n++) {
-        for (int m = 0; m <= n; m++) {
-            int sum_index = (n * (n + 1) / 2 + m);
-
-            /* Hacky for now, will solve for which conditions need summing analytically */
-            if (sum_index != index) {
-                continue;
-            }
+    return MainFieldCoeffG[index];
+}
 
-            if (index <= b) {
-                coeff += (decimal_date - MagneticModel.epoch) * get_secular_var_coeff_h(sum_index);
-            }
-        }
+// brief Get the MainFieldCoeffH accounting for the date
+double WorldMagModel::get_main_field_coeff_h(int index)
+{
+    if (index >= WMM_NUMTERMS) {
+        return 0;
     }
 
-    return coeff;
+    return MainFieldCoeffH[index];
 }
 
 double WorldMagModel::get_secular_var_coeff_g(int index)
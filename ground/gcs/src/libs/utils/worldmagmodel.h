@@ -132,7 +132,14 @@ private:
 
     double decimal_date;
 
+    // main field coefficients moved to decimal_date, rebuilt only when the date changes
+    double MainFieldCoeffG[WMM_NUMTERMS];
+    double MainFieldCoeffH[WMM_NUMTERMS];
+    double coeff_date;
+    bool coeff_valid;
+
     void Initialize();
+    void UpdateMainFieldCoeffs();
     int Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_GeoMagneticElements *GeoMagneticElements);
     void ComputeSphericalHarmonicVariables(WMMtype_CoordSpherical *CoordSpherical, int nMax, WMMtype_SphericalHarmonicVariables *SphVariables);
     int AssociatedLegendreFunction(WMMtype_CoordSpherical *CoordSpherical, int nMax, WMMtype_LegendreFunction *LegendreFunction);
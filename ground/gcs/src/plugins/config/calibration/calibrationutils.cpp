@@ -105,6 +105,108 @@ void CalibrationUtils::ComputePoly(VectorXf *samplesX, Eigen::VectorXf *polynomi
     }
 }
 
+PolynomialAccumulator::PolynomialAccumulator(int maxDegree) :
+    m_maxDegree(maxDegree)
+{
+    clear();
+}
+
+void PolynomialAccumulator::clear()
+{
+    m_count = 0;
+    m_minX  = 0.0f;
+    m_maxX  = 0.0f;
+    m_yRef  = 0.0;
+    m_xtx.setZero(m_maxDegree + 1, m_maxDegree + 1);
+    m_xty.setZero(m_maxDegree + 1);
+    m_yty   = 0.0;
+}
+
+void PolynomialAccumulator::addSample(float x, float y)
+{
+    if (m_count == 0) {
+        m_yRef = y;
+        m_minX = x;
+        m_maxX = x;
+    }
+    m_minX = qMin(m_minX, x);
+    m_maxX = qMax(m_maxX, x);
+    m_count++;
+
+    // row of the Vandermonde matrix for this sample
+    VectorXd row(m_maxDegree + 1);
+    row[0] = 1.0;
+    for (int i = 1; i < m_maxDegree + 1; i++) {
+        row[i] = row[i - 1] * x;
+    }
+    double dy = (double)y - m_yRef;
+
+    m_xtx.selfadjointView<Eigen::Upper>().rankUpdate(row);
+    m_xty += row * dy;
+    m_yty += dy * dy;
+}
+
+bool PolynomialAccumulator::solve(int degree, Eigen::Ref<Eigen::VectorXf> result, const double maxRelativeError, double yOffset) const
+{
+    Q_ASSERT(degree <= m_maxDegree);
+    if (m_count <= degree) {
+        return false;
+    }
+    MatrixXd xtx = m_xtx.topLeftCorner(degree + 1, degree + 1).selfadjointView<Eigen::Upper>();
+    // move y back from the first sample to yOffset
+    VectorXd xty = m_xty.head(degree + 1) + (m_yRef - yOffset) * xtx.col(0);
+    VectorXd tmpx = xtx.fullPivHouseholderQr().solve(xty);
+    result = tmpx.cast<float>();
+    double relativeError = (xtx * tmpx - xty).norm() / xty.norm();
+    return relativeError < maxRelativeError;
+}
+
+float PolynomialAccumulator::sigma() const
+{
+    if (m_count == 0) {
+        return 0.0f;
+    }
+    double mean = m_xty[0] / m_count;
+    return (float)sqrt(qMax(0.0, m_yty / m_count - mean * mean));
+}
+
+void PolynomialAccumulator::residualSums(const Eigen::VectorXf & polynomial, double yOffset, double *sum, double *sumSquares) const
+{
+    Q_ASSERT(polynomial.rows() <= m_maxDegree + 1);
+    VectorXd p   = VectorXd::Zero(m_maxDegree + 1);
+    p.head(polynomial.rows()) = polynomial.cast<double>();
+    MatrixXd xtx = m_xtx.selfadjointView<Eigen::Upper>();
+
+    // sums of (y - yOffset), expanded from the sums relative to the first sample
+    double d     = m_yRef - yOffset;
+    VectorXd xty = m_xty + d * xtx.col(0);
+    double yty   = m_yty + 2.0 * d * m_xty[0] + m_count * d * d;
+
+    *sum = xty[0] - p.dot(xtx.col(0));
+    *sumSquares = yty - 2.0 * p.dot(xty) + p.dot(xtx * p);
+}
+
+float PolynomialAccumulator::residualSigma(const Eigen::VectorXf & polynomial, double yOffset) const
+{
+    if (m_count == 0) {
+        return 0.0f;
+    }
+    double sum, sumSquares;
+    residualSums(polynomial, yOffset, &sum, &sumSquares);
+    double mean = sum / m_count;
+    return (float)sqrt(qMax(0.0, sumSquares / m_count - mean * mean));
+}
+
+float PolynomialAccumulator::residualMean(const Eigen::VectorXf & polynomial, double yOffset) const
+{
+    if (m_count == 0) {
+        return 0.0f;
+    }
+    double sum, sumSquares;
+    residualSums(polynomial, yOffset, &sum, &sumSquares);
+    return (float)(sum / m_count);
+}
+
 /* C++ Implementation of Yury Petrov's ellipsoid fit algorithm
  * Following is the origial code and its license from which this implementation is derived
  *
@@ -61,5 +61,72 @@ private:
 
     static int LinearEquationsSolve(int nDim, double *pfMatr, double *pfVect, double *pfSolution);
 };
+
+/**
+ * Streaming form of CalibrationUtils::PolynomialCalibration.
+ * Each sample is folded into the normal equations (XtX, Xty, yty) as it
+ * arrives, so memory does not grow with the acquisition length and a fit of
+ * any degree up to maxDegree, along with its statistics, can be computed at
+ * any time in O(maxDegree^3).
+ * y is accumulated relative to the first sample to limit cancellation in
+ * the variance terms. All sums are kept in double.
+ */
+class PolynomialAccumulator {
+public:
+    explicit PolynomialAccumulator(int maxDegree = 3);
+
+    void clear();
+    void addSample(float x, float y);
+
+    int count() const
+    {
+        return m_count;
+    }
+    float minX() const
+    {
+        return m_count ? m_minX : 0.0f;
+    }
+    float maxX() const
+    {
+        return m_count ? m_maxX : 0.0f;
+    }
+
+    /**
+     * @brief solve least squares fit of (y - yOffset) over x, same acceptance test as PolynomialCalibration
+     * @param degree degree of the polynomial, not greater than maxDegree
+     * @param result polynomial coefficients (x0, x1, ...)
+     * @param maxRelativeError maximum relative error of the normal equations solution
+     * @param yOffset value subtracted from all y samples
+     * @return true if the solution is accurate enough
+     */
+    bool solve(int degree, Eigen::Ref<Eigen::VectorXf> result, const double maxRelativeError, double yOffset = 0.0) const;
+
+    /**
+     * @brief sigma standard deviation of the y samples, as ComputeSigma
+     */
+    float sigma() const;
+
+    /**
+     * @brief residualSigma standard deviation of (y - yOffset - polynomial(x))
+     */
+    float residualSigma(const Eigen::VectorXf & polynomial, double yOffset = 0.0) const;
+
+    /**
+     * @brief residualMean mean of (y - yOffset - polynomial(x))
+     */
+    float residualMean(const Eigen::VectorXf & polynomial, double yOffset = 0.0) const;
+
+private:
+    int m_maxDegree;
+    int m_count;
+    float m_minX;
+    float m_maxX;
+    double m_yRef;
+    Eigen::MatrixXd m_xtx;
+    Eigen::VectorXd m_xty;
+    double m_yty;
+
+    void residualSums(const Eigen::VectorXf & polynomial, double yOffset, double *sum, double *sumSquares) const;
+};
 }
 #endif // CALIBRATIONUTILS_H
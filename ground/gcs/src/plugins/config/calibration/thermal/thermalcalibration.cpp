@@ -55,88 +55,100 @@ bool ThermalCalibration::BarometerCalibration(Eigen::VectorXf pressure, Eigen::V
     int index20deg = searchReferenceValue(20.0f, temperature);
 
     qDebug() << "Ref zero is " << index20deg << " T: " << temperature[index20deg] << " P:" << pressure[index20deg];
-    float refZero  = pressure[index20deg];
-    pressure.array() -= refZero;
-    qDebug() << "Rebiased zero is " << pressure[index20deg];
 
-    Eigen::VectorXf solution(BARO_PRESSURE_POLY_DEGREE + 1);
-    if (!CalibrationUtils::PolynomialCalibration(&temperature, &pressure, BARO_PRESSURE_POLY_DEGREE, solution, BARO_PRESSURE_MAX_REL_ERROR)) {
-        return false;
-    }
-    copyToArray(result, solution, BARO_PRESSURE_POLY_DEGREE + 1);
-    ComputeStats(&temperature, &pressure, &solution, inputSigma, calibratedSigma);
-    return (*calibratedSigma) < (*inputSigma);
+    PolynomialAccumulator samples(BARO_PRESSURE_POLY_DEGREE);
+    accumulate(&samples, temperature, pressure);
+    return BarometerCalibration(samples, pressure[index20deg], result, inputSigma, calibratedSigma);
 }
 
 bool ThermalCalibration::AccelerometerCalibration(Eigen::VectorXf samplesX, Eigen::VectorXf samplesY, Eigen::VectorXf samplesZ, Eigen::VectorXf temperature, float *result, float *inputSigma, float *calibratedSigma)
 {
-    Eigen::VectorXf solution(ACCEL_X_POLY_DEGREE + 1);
+    PolynomialAccumulator samples[3] = {
+        PolynomialAccumulator(ACCEL_X_POLY_DEGREE),
+        PolynomialAccumulator(ACCEL_Y_POLY_DEGREE),
+        PolynomialAccumulator(ACCEL_Z_POLY_DEGREE)
+    };
+
+    accumulate(&samples[0], temperature, samplesX);
+    accumulate(&samples[1], temperature, samplesY);
+    accumulate(&samples[2], temperature, samplesZ);
+    return AccelerometerCalibration(samples, result, inputSigma, calibratedSigma);
+}
 
-    if (!CalibrationUtils::PolynomialCalibration(&temperature, &samplesX, ACCEL_X_POLY_DEGREE, solution, ACCEL_X_MAX_REL_ERROR)) {
-        return false;
-    }
-    result[0]   = solution[1];
+bool ThermalCalibration::GyroscopeCalibration(Eigen::VectorXf samplesX, Eigen::VectorXf samplesY, Eigen::VectorXf samplesZ, Eigen::VectorXf temperature, float *resultPoly, float *resultBias, float *inputSigma, float *calibratedSigma)
+{
+    PolynomialAccumulator samples[3] = {
+        PolynomialAccumulator(GYRO_X_POLY_DEGREE),
+        PolynomialAccumulator(GYRO_Y_POLY_DEGREE),
+        PolynomialAccumulator(GYRO_Z_POLY_DEGREE)
+    };
+
+    accumulate(&samples[0], temperature, samplesX);
+    accumulate(&samples[1], temperature, samplesY);
+    accumulate(&samples[2], temperature, samplesZ);
+    return GyroscopeCalibration(samples, resultPoly, resultBias, inputSigma, calibratedSigma);
+}
 
-    solution[0] = 0;
-    ComputeStats(&temperature, &samplesX, &solution, &inputSigma[0], &calibratedSigma[0]);
+bool ThermalCalibration::BarometerCalibration(const PolynomialAccumulator & pressure, float refZero, float *result, float *inputSigma, float *calibratedSigma)
+{
+    Eigen::VectorXf solution(BARO_PRESSURE_POLY_DEGREE + 1);
 
-    solution.resize(ACCEL_Y_POLY_DEGREE + 1);
-    if (!CalibrationUtils::PolynomialCalibration(&temperature, &samplesY, ACCEL_Y_POLY_DEGREE, solution, ACCEL_Y_MAX_REL_ERROR)) {
+    if (!pressure.solve(BARO_PRESSURE_POLY_DEGREE, solution, BARO_PRESSURE_MAX_REL_ERROR, refZero)) {
         return false;
     }
-    result[1]   = solution[1];
+    copyToArray(result, solution, BARO_PRESSURE_POLY_DEGREE + 1);
+    *inputSigma = pressure.sigma();
+    *calibratedSigma = pressure.residualSigma(solution, refZero);
+    return (*calibratedSigma) < (*inputSigma);
+}
+
+bool ThermalCalibration::AccelerometerCalibration(const PolynomialAccumulator *samples, float *result, float *inputSigma, float *calibratedSigma)
+{
+    const int degree[3] = { ACCEL_X_POLY_DEGREE, ACCEL_Y_POLY_DEGREE, ACCEL_Z_POLY_DEGREE };
+    const double maxRelativeError[3] = { ACCEL_X_MAX_REL_ERROR, ACCEL_Y_MAX_REL_ERROR, ACCEL_Z_MAX_REL_ERROR };
 
-    solution[0] = 0;
-    ComputeStats(&temperature, &samplesY, &solution, &inputSigma[1], &calibratedSigma[1]);
+    for (int axis = 0; axis < 3; axis++) {
+        Eigen::VectorXf solution(degree[axis] + 1);
+        if (!samples[axis].solve(degree[axis], solution, maxRelativeError[axis])) {
+            return false;
+        }
+        result[axis]    = solution[1];
 
-    solution.resize(ACCEL_Z_POLY_DEGREE + 1);
-    if (!CalibrationUtils::PolynomialCalibration(&temperature, &samplesZ, ACCEL_Z_POLY_DEGREE, solution, ACCEL_Z_MAX_REL_ERROR)) {
-        return false;
+        solution[0]     = 0;
+        inputSigma[axis] = samples[axis].sigma();
+        calibratedSigma[axis] = samples[axis].residualSigma(solution);
     }
-    result[2]   = solution[1];
-
-    solution[0] = 0;
-    ComputeStats(&temperature, &samplesZ, &solution, &inputSigma[2], &calibratedSigma[2]);
     return (inputSigma[0] > calibratedSigma[0]) && (inputSigma[1] > calibratedSigma[1]) && (inputSigma[2] > calibratedSigma[2]);
 }
 
-
-bool ThermalCalibration::GyroscopeCalibration(Eigen::VectorXf samplesX, Eigen::VectorXf samplesY, Eigen::VectorXf samplesZ, Eigen::VectorXf temperature, float *resultPoly, float *resultBias, float *inputSigma, float *calibratedSigma)
+bool ThermalCalibration::GyroscopeCalibration(const PolynomialAccumulator *samples, float *resultPoly, float *resultBias, float *inputSigma, float *calibratedSigma)
 {
-    Eigen::VectorXf solution(GYRO_X_POLY_DEGREE + 1);
+    const int degree[3] = { GYRO_X_POLY_DEGREE, GYRO_Y_POLY_DEGREE, GYRO_Z_POLY_DEGREE };
+    const double maxRelativeError[3] = { GYRO_X_MAX_REL_ERROR, GYRO_Y_MAX_REL_ERROR, GYRO_Z_MAX_REL_ERROR };
 
-    if (!CalibrationUtils::PolynomialCalibration(&temperature, &samplesX, GYRO_X_POLY_DEGREE, solution, GYRO_X_MAX_REL_ERROR)) {
-        return false;
-    }
+    for (int axis = 0; axis < 3; axis++) {
+        Eigen::VectorXf solution(degree[axis] + 1);
+        if (!samples[axis].solve(degree[axis], solution, maxRelativeError[axis])) {
+            return false;
+        }
+        resultPoly[axis * 2]     = solution[1];
+        resultPoly[axis * 2 + 1] = solution[2];
 
-    resultPoly[0] = solution[1];
-    resultPoly[1] = solution[2];
-    solution[0]   = 0;
-    ComputeStats(&temperature, &samplesX, &solution, &inputSigma[0], &calibratedSigma[0]);
-    ComputeBias(&temperature, &samplesX, &solution, &resultBias[0]);
-    solution.resize(GYRO_Y_POLY_DEGREE + 1);
-    if (!CalibrationUtils::PolynomialCalibration(&temperature, &samplesY, GYRO_Y_POLY_DEGREE, solution, GYRO_Y_MAX_REL_ERROR)) {
-        return false;
-    }
-    resultPoly[2] = solution[1];
-    resultPoly[3] = solution[2];
-    solution[0]   = 0;
-    ComputeStats(&temperature, &samplesY, &solution, &inputSigma[1], &calibratedSigma[1]);
-    ComputeBias(&temperature, &samplesY, &solution, &resultBias[1]);
-
-    solution.resize(GYRO_Z_POLY_DEGREE + 1);
-    if (!CalibrationUtils::PolynomialCalibration(&temperature, &samplesZ, GYRO_Z_POLY_DEGREE, solution, GYRO_Z_MAX_REL_ERROR)) {
-        return false;
+        solution[0] = 0;
+        inputSigma[axis]      = samples[axis].sigma();
+        calibratedSigma[axis] = samples[axis].residualSigma(solution);
+        resultBias[axis]      = samples[axis].residualMean(solution);
     }
-    resultPoly[4] = solution[1];
-    resultPoly[5] = solution[2];
-    solution[0]   = 0;
-    ComputeStats(&temperature, &samplesZ, &solution, &inputSigma[2], &calibratedSigma[2]);
-    ComputeBias(&temperature, &samplesZ, &solution, &resultBias[2]);
-
     return (inputSigma[0] > calibratedSigma[0]) && (inputSigma[1] > calibratedSigma[1]) && (inputSigma[2] > calibratedSigma[2]);
 }
 
+void ThermalCalibration::accumulate(PolynomialAccumulator *accumulator, const Eigen::VectorXf & x, const Eigen::VectorXf & y)
+{
+    for (int i = 0; i < x.size(); i++) {
+        accumulator->addSample(x[i], y[i]);
+    }
+}
+
 void ThermalCalibration::copyToArray(float *result, Eigen::VectorXf solution, int elements)
 {
     for (int i = 0; i < elements; i++) {
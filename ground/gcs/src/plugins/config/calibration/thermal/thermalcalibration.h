@@ -106,8 +106,28 @@ public:
      */
     static bool GyroscopeCalibration(Eigen::VectorXf samplesX, Eigen::VectorXf samplesY, Eigen::VectorXf samplesZ, Eigen::VectorXf temperature, float *resultPoly, float *resultBias, float *inputSigma, float *calibratedSigma);
 
+    /**
+     * @brief BarometerCalibration as above, from pressure over temperature samples accumulated while acquiring
+     * @param pressure accumulated pressure samples, degree >= 3
+     * @param refZero pressure read at the reference temperature, the "zero bias" point
+     */
+    static bool BarometerCalibration(const PolynomialAccumulator & pressure, float refZero, float *result, float *inputSigma, float *calibratedSigma);
+
+    /**
+     * @brief AccelerometerCalibration as above, from accumulated samples
+     * @param samples a PolynomialAccumulator[3] of x,y,z over temperature, degree >= 1
+     */
+    static bool AccelerometerCalibration(const PolynomialAccumulator *samples, float *result, float *inputSigma, float *calibratedSigma);
+
+    /**
+     * @brief GyroscopeCalibration as above, from accumulated samples
+     * @param samples a PolynomialAccumulator[3] of x,y,z over temperature, degree >= 2
+     */
+    static bool GyroscopeCalibration(const PolynomialAccumulator *samples, float *resultPoly, float *resultBias, float *inputSigma, float *calibratedSigma);
+
 private:
     static void copyToArray(float *result, Eigen::VectorXf solution, int elements);
+    static void accumulate(PolynomialAccumulator *accumulator, const Eigen::VectorXf & x, const Eigen::VectorXf & y);
     ThermalCalibration();
     static int searchReferenceValue(float value, Eigen::VectorXf values);
 };
@@ -63,6 +63,28 @@ ThermalCalibrationHelper::ThermalCalibrationHelper(QObject *parent) :
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
     connect(telMngr, SIGNAL(disconnected()), this, SLOT(cleanup()));
+
+    qRegisterMetaType<OpenPilot::Results>("OpenPilot::Results");
+
+    m_acquiring    = false;
+    m_baroFitSigma = -1.0f;
+    m_accumulator  = new ThermalSampleAccumulator();
+    m_accumulator->moveToThread(&m_accumulatorThread);
+    connect(&m_accumulatorThread, SIGNAL(finished()), m_accumulator, SLOT(deleteLater()));
+    connect(this, SIGNAL(accumulatorReset()), m_accumulator, SLOT(reset()));
+    connect(this, SIGNAL(baroSampled(float, float)), m_accumulator, SLOT(addBaroSample(float, float)));
+    connect(this, SIGNAL(gyroSampled(float, float, float, float)), m_accumulator, SLOT(addGyroSample(float, float, float, float)));
+    connect(this, SIGNAL(accelSampled(float, float, float, float)), m_accumulator, SLOT(addAccelSample(float, float, float, float)));
+    connect(this, SIGNAL(accumulatorCalculate()), m_accumulator, SLOT(calculate()));
+    connect(m_accumulator, SIGNAL(baroFitUpdated(float, float)), this, SLOT(updateBaroFit(float, float)));
+    connect(m_accumulator, SIGNAL(calculated(OpenPilot::Results)), this, SLOT(calculationDone(OpenPilot::Results)));
+    m_accumulatorThread.start(QThread::LowPriority);
+}
+
+ThermalCalibrationHelper::~ThermalCalibrationHelper()
+{
+    m_accumulatorThread.quit();
+    m_accumulatorThread.wait();
 }
 
 /**
@@ -180,10 +202,8 @@ void ThermalCalibrationHelper::initAcquisition()
     QMutexLocker lock(&sensorsUpdateLock);
 
     // Clear all samples
-    m_accelSamples.clear();
-    m_gyroSamples.clear();
-    m_baroSamples.clear();
-    m_magSamples.clear();
+    emit accumulatorReset();
+    m_baroFitSigma = -1.0f;
 
     m_results.accelCalibrated = false;
     m_results.gyroCalibrated  = false;
@@ -219,22 +239,28 @@ void ThermalCalibrationHelper::collectSample(UAVObject *sample)
 
     switch (sample->getObjID()) {
     case AccelSensor::OBJID:
-        m_accelSamples.append(accelSensor->getData());
-        m_debugStream << "ACCEL:: " << m_accelSamples.last().temperature
+    {
+        AccelSensor::DataFields data = accelSensor->getData();
+        emit accelSampled(data.temperature, data.x, data.y, data.z);
+        m_debugStream << "ACCEL:: " << data.temperature
                       << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_accelSamples.last().x
-                      << "\t" << m_accelSamples.last().y
-                      << "\t" << m_accelSamples.last().z << endl;
+                      << "\t" << data.x
+                      << "\t" << data.y
+                      << "\t" << data.z << endl;
         break;
+    }
 
     case GyroSensor::OBJID:
-        m_gyroSamples.append(gyroSensor->getData());
-        m_debugStream << "GYRO:: " << m_gyroSamples.last().temperature
+    {
+        GyroSensor::DataFields data = gyroSensor->getData();
+        emit gyroSampled(data.temperature, data.x, data.y, data.z);
+        m_debugStream << "GYRO:: " << data.temperature
                       << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_gyroSamples.last().x
-                      << "\t" << m_gyroSamples.last().y
-                      << "\t" << m_gyroSamples.last().z << endl;
+                      << "\t" << data.x
+                      << "\t" << data.y
+                      << "\t" << data.z << endl;
         break;
+    }
 
     case BaroSensor::OBJID:
     {
@@ -244,23 +270,26 @@ void ThermalCalibrationHelper::collectSample(UAVObject *sample)
         data.Temperature = temp;
         data.Pressure   += 10.0f * temp;
 #endif
-        m_baroSamples.append(data);
-        m_debugStream << "BARO:: " << m_baroSamples.last().Temperature
+        emit baroSampled(data.Temperature, data.Pressure);
+        m_debugStream << "BARO:: " << data.Temperature
                       << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_baroSamples.last().Pressure
-                      << "\t" << m_baroSamples.last().Altitude << endl;
+                      << "\t" << data.Pressure
+                      << "\t" << data.Altitude << endl;
         // must be done last as this call might end acquisition and close the debug log file
         updateTemperature(temp);
         break;
     }
 
     case MagSensor::OBJID:
-        m_magSamples.append(magSensor->getData());
+    {
+        // not used by the calibration, only logged
+        MagSensor::DataFields data = magSensor->getData();
         m_debugStream << "MAG:: " << "\t" << QDateTime::currentDateTime().toString("hh.mm.ss.zzz")
-                      << "\t" << m_magSamples.last().x
-                      << "\t" << m_magSamples.last().y
-                      << "\t" << m_magSamples.last().z << endl;
+                      << "\t" << data.x
+                      << "\t" << data.y
+                      << "\t" << data.z << endl;
         break;
+    }
 
     default:
         qDebug() << "Unexpected object" << sample->getObjID();
@@ -300,20 +329,14 @@ void ThermalCalibrationHelper::cleanup()
 
 void ThermalCalibrationHelper::calculate()
 {
-    // baro
-    int count = m_baroSamples.count();
-    Eigen::VectorXf datax(count);
-    Eigen::VectorXf datay(1);
-    Eigen::VectorXf dataz(1);
-    Eigen::VectorXf datat(count);
-
-    for (int x = 0; x < count; x++) {
-        datax[x] = m_baroSamples[x].Pressure;
-        datat[x] = m_baroSamples[x].Temperature;
-    }
+    // queued behind all the samples already sent to the accumulator, completes in calculationDone()
+    emit accumulatorCalculate();
+}
+
+void ThermalCalibrationHelper::calculationDone(OpenPilot::Results results)
+{
+    m_results = results;
 
-    m_results.baroCalibrated = ThermalCalibration::BarometerCalibration(datax, datat, m_results.baro,
-                                                                        &m_results.baroInSigma, &m_results.baroOutSigma);
     if (m_results.baroCalibrated) {
         addInstructions(tr("Barometer is calibrated."));
     } else {
@@ -321,26 +344,6 @@ void ThermalCalibrationHelper::calculate()
         addInstructions(tr("Failed to calibrate barometer!"), WizardModel::Warn);
     }
 
-    m_results.baroTempMin = datat.array().minCoeff();
-    m_results.baroTempMax = datat.array().maxCoeff();
-
-    // gyro
-    count = m_gyroSamples.count();
-    datax.resize(count);
-    datay.resize(count);
-    dataz.resize(count);
-    datat.resize(count);
-
-    for (int x = 0; x < count; x++) {
-        datax[x] = m_gyroSamples[x].x;
-        datay[x] = m_gyroSamples[x].y;
-        dataz[x] = m_gyroSamples[x].z;
-        datat[x] = m_gyroSamples[x].temperature;
-    }
-
-    m_results.gyroCalibrated = ThermalCalibration::GyroscopeCalibration(datax, datay, dataz, datat,
-                                                                        m_results.gyro, m_results.gyroBias,
-                                                                        m_results.gyroInSigma, m_results.gyroOutSigma);
     if (m_results.gyroCalibrated) {
         addInstructions(tr("Gyro is calibrated."));
     } else {
@@ -348,27 +351,6 @@ void ThermalCalibrationHelper::calculate()
         addInstructions(tr("Failed to calibrate gyro!"), WizardModel::Warn);
     }
 
-    // accel
-    m_results.accelGyroTempMin = datat.array().minCoeff();
-    m_results.accelGyroTempMax = datat.array().maxCoeff();
-    // TODO: sanity checks needs to be enforced before accel calibration can be enabled and usable.
-    /*
-       count = m_accelSamples.count();
-       datax.resize(count);
-       datay.resize(count);
-       dataz.resize(count);
-       datat.resize(count);
-
-       for(int x = 0; x < count; x++){
-       datax[x] = m_accelSamples[x].x;
-       datay[x] = m_accelSamples[x].y;
-       dataz[x] = m_accelSamples[x].z;
-       datat[x] = m_accelSamples[x].temperature;
-       }
-
-       m_results.accelCalibrated = ThermalCalibration::AccelerometerCalibration(datax, datay, dataz, datat, m_results.accel);
-     */
-    m_results.accelCalibrated  = false;
     QString str = QStringLiteral("INFO::Calibration results") + "\n";
     str += QStringLiteral("INFO::Baro cal {%1, %2, %3, %4}; initial variance: %5; Calibrated variance %6")
            .arg(m_results.baro[0]).arg(m_results.baro[1]).arg(m_results.baro[2]).arg(m_results.baro[3])
@@ -389,6 +371,16 @@ void ThermalCalibrationHelper::calculate()
     closeDebugLog();
 }
 
+void ThermalCalibrationHelper::updateBaroFit(float inputSigma, float calibratedSigma)
+{
+    if (!m_acquiring) {
+        return;
+    }
+    m_baroFitSigma = calibratedSigma;
+    m_debugStream << "INFO::Trace baro fit sigma " << calibratedSigma << " input sigma " << inputSigma << endl;
+    emit baroFitChanged(inputSigma, calibratedSigma);
+}
+
 /* helper methods */
 void ThermalCalibrationHelper::updateTemperature(float temp)
 {
@@ -577,4 +569,80 @@ UAVObjectManager *ThermalCalibrationHelper::getObjectManager()
     Q_ASSERT(objMngr);
     return objMngr;
 }
+
+ThermalSampleAccumulator::ThermalSampleAccumulator(QObject *parent) :
+    QObject(parent)
+{
+    reset();
+}
+
+void ThermalSampleAccumulator::reset()
+{
+    m_baro.clear();
+    for (int i = 0; i < 3; i++) {
+        m_gyro[i].clear();
+        m_accel[i].clear();
+    }
+    m_baroRefFound = false;
+    m_baroRefZero  = 0.0f;
+}
+
+void ThermalSampleAccumulator::addBaroSample(float temperature, float pressure)
+{
+    // assume the nearest reading to 20°C as the "zero bias" point
+    if (!m_baroRefFound) {
+        m_baroRefFound = !(temperature < 20.0f);
+        m_baroRefZero  = pressure;
+    }
+    m_baro.addSample(temperature, pressure);
+
+    if (m_baro.count() % BaroFitInterval == 0) {
+        float coeff[4];
+        float inputSigma, calibratedSigma;
+        if (ThermalCalibration::BarometerCalibration(m_baro, m_baroRefZero, coeff, &inputSigma, &calibratedSigma)) {
+            emit baroFitUpdated(inputSigma, calibratedSigma);
+        }
+    }
+}
+
+void ThermalSampleAccumulator::addGyroSample(float temperature, float x, float y, float z)
+{
+    m_gyro[0].addSample(temperature, x);
+    m_gyro[1].addSample(temperature, y);
+    m_gyro[2].addSample(temperature, z);
+}
+
+void ThermalSampleAccumulator::addAccelSample(float temperature, float x, float y, float z)
+{
+    m_accel[0].addSample(temperature, x);
+    m_accel[1].addSample(temperature, y);
+    m_accel[2].addSample(temperature, z);
+}
+
+void ThermalSampleAccumulator::calculate()
+{
+    Results results = Results();
+
+    // baro
+    results.baroCalibrated   = ThermalCalibration::BarometerCalibration(m_baro, m_baroRefZero, results.baro,
+                                                                        &results.baroInSigma, &results.baroOutSigma);
+    results.baroTempMin      = m_baro.minX();
+    results.baroTempMax      = m_baro.maxX();
+
+    // gyro
+    results.gyroCalibrated   = ThermalCalibration::GyroscopeCalibration(m_gyro, results.gyro, results.gyroBias,
+                                                                        results.gyroInSigma, results.gyroOutSigma);
+
+    // accel
+    results.accelGyroTempMin = m_gyro[0].minX();
+    results.accelGyroTempMax = m_gyro[0].maxX();
+    // TODO: sanity checks needs to be enforced before accel calibration can be enabled and usable.
+    /*
+       results.accelCalibrated = ThermalCalibration::AccelerometerCalibration(m_accel, results.accel,
+                                                                              results.accelInSigma, results.accelOutSigma);
+     */
+    results.accelCalibrated  = false;
+
+    emit calculated(results);
+}
 }
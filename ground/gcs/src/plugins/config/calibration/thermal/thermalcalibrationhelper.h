@@ -53,6 +53,7 @@
 #include <revosettings.h>
 
 #include "../wizardmodel.h"
+#include "../calibrationutils.h"
 
 namespace OpenPilot {
 typedef struct {
@@ -89,6 +90,42 @@ typedef struct {
     float accelGyroTempMax;
 } Results;
 
+/**
+ * Folds the samples of a thermal sweep into least squares accumulators,
+ * on a worker thread. Memory stays constant however long the sweep runs,
+ * a barometer fit is reported periodically while acquiring and the final
+ * calculation only has to solve the accumulated normal equations.
+ */
+class ThermalSampleAccumulator : public QObject {
+    Q_OBJECT
+
+public:
+    // samples between two live barometer fits
+    const static int BaroFitInterval = 50;
+
+    explicit ThermalSampleAccumulator(QObject *parent = 0);
+
+public slots:
+    void reset();
+    void addBaroSample(float temperature, float pressure);
+    void addGyroSample(float temperature, float x, float y, float z);
+    void addAccelSample(float temperature, float x, float y, float z);
+    void calculate();
+
+signals:
+    void baroFitUpdated(float inputSigma, float calibratedSigma);
+    void calculated(OpenPilot::Results results);
+
+private:
+    PolynomialAccumulator m_baro;
+    PolynomialAccumulator m_gyro[3];
+    PolynomialAccumulator m_accel[3];
+
+    // pressure at the first sample at or above the reference temperature, else at the last sample
+    bool m_baroRefFound;
+    float m_baroRefZero;
+};
+
 class ThermalCalibrationHelper : public QObject {
     Q_OBJECT
 
@@ -97,6 +134,7 @@ public:
     constexpr const static float TargetTempDelta = 10.0f;
 
     explicit ThermalCalibrationHelper(QObject *parent = 0);
+    ~ThermalCalibrationHelper();
 
     float temperature()
     {
@@ -113,6 +151,15 @@ public:
         return fabs(m_maxTemperature - m_minTemperature);
     }
 
+    /**
+     * @brief baroFitSigma standard deviation of the barometer samples left after the current fit,
+     * updated while acquiring. Negative until a first fit is available.
+     */
+    float baroFitSigma()
+    {
+        return m_baroFitSigma;
+    }
+
     int processPercentage()
     {
         return m_progress;
@@ -158,6 +205,14 @@ signals:
 
     void instructionsAdded(QString text, WizardModel::MessageType type = WizardModel::Info);
 
+    void baroFitChanged(float inputSigma, float calibratedSigma);
+
+    // forwarded to the sample accumulator thread
+    void accumulatorReset();
+    void baroSampled(float temperature, float pressure);
+    void gyroSampled(float temperature, float x, float y, float z);
+    void accelSampled(float temperature, float x, float y, float z);
+    void accumulatorCalculate();
 
 public slots:
     /**
@@ -209,6 +264,10 @@ public slots:
 
     void cleanup();
 
+private slots:
+    void updateBaroFit(float inputSigma, float calibratedSigma);
+    void calculationDone(OpenPilot::Results results);
+
 private:
     float getTemperature();
     void updateTemperature(float temp);
@@ -224,10 +283,9 @@ private:
 
     QMutex sensorsUpdateLock;
 
-    QList<AccelSensor::DataFields> m_accelSamples;
-    QList<GyroSensor::DataFields> m_gyroSamples;
-    QList<BaroSensor::DataFields> m_baroSamples;
-    QList<MagSensor::DataFields> m_magSamples;
+    QThread m_accumulatorThread;
+    ThermalSampleAccumulator *m_accumulator;
+    float m_baroFitSigma;
 
     // temperature checkpoints, used to calculate temp gradient
     const static int TimeBetweenCheckpoints = 10;
@@ -279,4 +337,7 @@ private:
     UAVObjectManager *getObjectManager();
 };
 }
+
+Q_DECLARE_METATYPE(OpenPilot::Results)
+
 #endif // THERMALCALIBRATIONHELPER_H
@@ -37,6 +37,7 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings *qSettings, QObj
     settings.manualControlEnabled = true;
     settings.startSim             = false;
     settings.addNoise             = false;
+    settings.fastAsPossible       = false;
     settings.hostAddress          = "127.0.0.1";
     settings.remoteAddress        = "127.0.0.1";
     settings.outPort              = 0;
@@ -82,6 +83,7 @@ HITLConfiguration::HITLConfiguration(QString classId, QSettings *qSettings, QObj
         settings.longitude     = qSettings->value("longitude").toString();
         settings.startSim      = qSettings->value("startSim").toBool();
         settings.addNoise      = qSettings->value("noiseCheckBox").toBool();
+        settings.fastAsPossible = qSettings->value("fastAsPossible").toBool();
 
         settings.gcsReceiverEnabled   = qSettings->value("gcsReceiverEnabled").toBool();
         settings.manualControlEnabled = qSettings->value("manualControlEnabled").toBool();
@@ -138,6 +140,7 @@ void HITLConfiguration::saveConfig(QSettings *qSettings) const
     qSettings->setValue("longitude", settings.longitude);
     qSettings->setValue("addNoise", settings.addNoise);
     qSettings->setValue("startSim", settings.startSim);
+    qSettings->setValue("fastAsPossible", settings.fastAsPossible);
 
     qSettings->setValue("gcsReceiverEnabled", settings.gcsReceiverEnabled);
     qSettings->setValue("manualControlEnabled", settings.manualControlEnabled);
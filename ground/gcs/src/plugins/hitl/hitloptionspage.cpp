@@ -82,6 +82,7 @@ QWidget *HITLOptionsPage::createPage(QWidget *parent)
 
     m_optionsPage->startSim->setChecked(config->Settings().startSim);
     m_optionsPage->noiseCheckBox->setChecked(config->Settings().addNoise);
+    m_optionsPage->fastAsPossible->setChecked(config->Settings().fastAsPossible);
 
     m_optionsPage->hostAddress->setText(config->Settings().hostAddress);
     m_optionsPage->remoteAddress->setText(config->Settings().remoteAddress);
@@ -126,6 +127,7 @@ void HITLOptionsPage::apply()
     settings.dataPath             = m_optionsPage->dataPath->path();
     settings.startSim             = m_optionsPage->startSim->isChecked();
     settings.addNoise             = m_optionsPage->noiseCheckBox->isChecked();
+    settings.fastAsPossible       = m_optionsPage->fastAsPossible->isChecked();
     settings.hostAddress          = m_optionsPage->hostAddress->text();
     settings.remoteAddress        = m_optionsPage->remoteAddress->text();
 
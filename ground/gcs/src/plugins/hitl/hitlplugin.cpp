@@ -32,6 +32,7 @@
 #include "aerosimrcsimulator.h"
 #include "fgsimulator.h"
 #include "il2simulator.h"
+#include "rigidbodysimulator.h"
 #include "xplanesimulator9.h"
 #include "xplanesimulator10.h"
 
@@ -58,6 +59,8 @@ bool HITLPlugin::initialize(const QStringList & args, QString *errMsg)
     addSimulator(new AeroSimRCSimulatorCreator("ASimRC", "AeroSimRC"));
     addSimulator(new FGSimulatorCreator("FG", "FlightGear"));
     addSimulator(new IL2SimulatorCreator("IL2", "IL2"));
+    addSimulator(new RigidBodySimulatorCreator("BuiltInMR", "Built-in multirotor", RigidBodySimulator::MULTIROTOR));
+    addSimulator(new RigidBodySimulatorCreator("BuiltInFW", "Built-in fixed wing", RigidBodySimulator::FIXEDWING));
     addSimulator(new XplaneSimulatorCreator9("X-Plane9", "X-Plane9"));
     addSimulator(new XplaneSimulatorCreator10("X-Plane10", "X-Plane10"));
 
@@ -95,12 +95,13 @@ void HITLWidget::startButtonClicked()
         simulator = NULL;
     }
 
-    if (settings.hostAddress == "" || settings.inPort == 0) {
+    SimulatorCreator *creator = HITLPlugin::getSimulatorCreator(settings.simulatorId);
+
+    if ((!creator || !creator->IsBuiltIn()) && (settings.hostAddress == "" || settings.inPort == 0)) {
         widget->textBrowser->append("Before start, set UDP parameters in options page!");
         return;
     }
 
-    SimulatorCreator *creator = HITLPlugin::getSimulatorCreator(settings.simulatorId);
     simulator = creator->createSimulator(settings);
 
     // move to thread <--[BCH]
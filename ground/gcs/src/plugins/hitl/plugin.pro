@@ -18,6 +18,7 @@ HEADERS += \
     aerosimrcsimulator.h \
     fgsimulator.h \
     il2simulator.h \
+    rigidbodysimulator.h \
     xplanesimulator9.h \
     xplanesimulator10.h
 
@@ -33,6 +34,7 @@ SOURCES += \
     aerosimrcsimulator.cpp \
     fgsimulator.cpp \
     il2simulator.cpp \
+    rigidbodysimulator.cpp \
     xplanesimulator9.cpp \
     xplanesimulator10.cpp
 
@@ -0,0 +1,419 @@
+/**
+ ******************************************************************************
+ *
+ * @file       rigidbodysimulator.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Built-in 6-DOF rigid body model, no external simulator needed
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   hitlplugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * The airframes are deliberately generic, a 1kg quad X on 10" props and a
+ * 1.2kg trainer with 1.4m span. Body frame is forward/right/down, the world
+ * frame is NED with the ground at D = 0.
+ *
+ * Inputs are taken from ActuatorCommand when the GCS receiver is selected,
+ * in the channel order the vehicle setup wizard uses:
+ *   multirotor: 1 NW, 2 NE, 3 SE, 4 SW motor
+ *   fixed wing: 1 aileron, 2 elevator, 3 rudder, 4 throttle
+ * With manual control selected ActuatorDesired is mixed in here instead.
+ */
+
+#include "rigidbodysimulator.h"
+#include <QTimerEvent>
+#include <cmath>
+
+const float RigidBodySimulator::STEP = 0.004f; // [s]
+const int RigidBodySimulator::STEPS_PER_EVENT = 25;
+
+// multirotor
+static const float MR_MASS       = 1.0f; // [kg]
+static const float MR_INERTIA[3] = { 0.012f, 0.012f, 0.02f }; // [kg m^2]
+static const float MR_ARM        = 0.12f; // motor offset along x and y [m]
+static const float MR_MAX_THRUST = 7.0f; // per motor [N]
+static const float MR_MOTOR_TAU  = 0.05f; // [s]
+static const float MR_YAW_TORQUE = 0.02f; // reaction torque per thrust [m]
+static const float MR_DRAG       = 0.25f; // [N/(m/s)]
+static const float MR_ROT_DRAG   = 0.002f; // [Nm/(rad/s)]
+
+// fixed wing
+static const float FW_MASS       = 1.2f; // [kg]
+static const float FW_INERTIA[3] = { 0.05f, 0.06f, 0.1f }; // [kg m^2]
+static const float FW_AREA       = 0.3f; // [m^2]
+static const float FW_SPAN       = 1.4f; // [m]
+static const float FW_CHORD      = 0.22f; // [m]
+static const float FW_MAX_THRUST = 8.0f; // [N]
+static const float FW_CL0        = 0.5f;
+static const float FW_CLA        = 5.0f;
+static const float FW_CL_MIN     = -1.0f;
+static const float FW_CL_MAX     = 1.4f;
+static const float FW_CD0        = 0.06f;
+static const float FW_CDK        = 0.06f;
+static const float FW_CYB        = -0.6f;
+static const float FW_CLB        = -0.08f;
+static const float FW_CLDA       = 0.25f;
+static const float FW_CLP        = -0.5f;
+static const float FW_CM0        = 0.0f;
+static const float FW_CMA        = -1.2f;
+static const float FW_CMDE       = 0.5f;
+static const float FW_CMQ        = -15.0f;
+static const float FW_CNB        = 0.1f;
+static const float FW_CNDR       = 0.08f;
+static const float FW_CNR        = -0.15f;
+
+// ground friction on horizontal speed [1/s]
+static const float MR_GROUND_FRICTION = 5.0f;
+static const float FW_GROUND_FRICTION = 0.3f;
+
+RigidBodySimulator::RigidBodySimulator(const SimulatorSettings & params, Airframe frame) :
+    Simulator(params),
+    airframe(frame),
+    stepTimer(0),
+    steps(0)
+{
+    for (int i = 0; i < 3; i++) {
+        pos[i]   = 0;
+        vel[i]   = 0;
+        rate[i]  = 0;
+        accel[i] = 0;
+    }
+    accel[2] = -GEE;
+    q[0]     = 1;
+    q[1]     = 0;
+    q[2]     = 0;
+    q[3]     = 0;
+    for (int i = 0; i < 4; i++) {
+        motor[i] = 0;
+    }
+
+    resetOutputTimes(outputTime());
+}
+
+RigidBodySimulator::~RigidBodySimulator()
+{
+    if (stepTimer) {
+        killTimer(stepTimer);
+    }
+}
+
+/**
+ * There are no ports to set up, the model runs in process. This is called
+ * on the simulator thread once it started, so the stepping starts here.
+ */
+void RigidBodySimulator::setupUdpPorts(const QString & host, int inPort, int outPort)
+{
+    Q_UNUSED(host) Q_UNUSED(inPort) Q_UNUSED(outPort)
+
+    wallTime.start();
+    stepTimer = startTimer(settings.fastAsPossible ? 0 : (int)(STEP * 1000), Qt::PreciseTimer);
+
+    emit processOutput(QString("Built-in model stepping every %1 ms %2\n")
+                       .arg(STEP * 1000)
+                       .arg(settings.fastAsPossible ? "as fast as possible" : "in real time"));
+}
+
+QTime RigidBodySimulator::outputTime() const
+{
+    return QTime(0, 0).addMSecs((int)(steps * STEP * 1000));
+}
+
+void RigidBodySimulator::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != stepTimer) {
+        Simulator::timerEvent(event);
+        return;
+    }
+
+    simulatorAlive();
+
+    // return to the event loop regularly so telemetry keeps flowing,
+    // in real time drop behind rather than stall when the host is too slow
+    for (int i = 0; i < STEPS_PER_EVENT; i++) {
+        if (!settings.fastAsPossible && steps * STEP * 1000 >= wallTime.elapsed()) {
+            break;
+        }
+        step();
+        output();
+    }
+}
+
+/**
+ * Actuators are read every step, see readControls()
+ */
+void RigidBodySimulator::transmitUpdate()
+{}
+
+void RigidBodySimulator::processUpdate(const QByteArray & data)
+{
+    Q_UNUSED(data)
+}
+
+/**
+ * Multirotor: motor thrust fractions 0..1
+ * Fixed wing: aileron, elevator, rudder -1..1 and throttle 0..1
+ */
+void RigidBodySimulator::readControls(float controls[4])
+{
+    if (settings.gcsReceiverEnabled) {
+        ActuatorCommand::DataFields cmd = actCommand->getData();
+        for (int i = 0; i < 4; i++) {
+            float ch = cmd.Channel[i];
+            if (airframe == MULTIROTOR || i == 3) {
+                controls[i] = ch > 0 ? qBound(0.0f, (ch - 1000.0f) / 1000.0f, 1.0f) : 0.0f;
+            } else {
+                controls[i] = ch > 0 ? qBound(-1.0f, (ch - 1500.0f) / 500.0f, 1.0f) : 0.0f;
+            }
+        }
+        return;
+    }
+
+    ActuatorDesired::DataFields act = actDesired->getData();
+    if (airframe == MULTIROTOR) {
+        // quad X with the mixer values of the setup wizard
+        controls[0] = act.Thrust + 0.5f * (act.Roll + act.Pitch - act.Yaw);
+        controls[1] = act.Thrust + 0.5f * (-act.Roll + act.Pitch + act.Yaw);
+        controls[2] = act.Thrust + 0.5f * (-act.Roll - act.Pitch - act.Yaw);
+        controls[3] = act.Thrust + 0.5f * (act.Roll - act.Pitch + act.Yaw);
+        for (int i = 0; i < 4; i++) {
+            controls[i] = act.Thrust > 0 ? qBound(0.0f, controls[i], 1.0f) : 0.0f;
+        }
+    } else {
+        controls[0] = qBound(-1.0f, act.Roll, 1.0f);
+        controls[1] = qBound(-1.0f, act.Pitch, 1.0f);
+        controls[2] = qBound(-1.0f, act.Yaw, 1.0f);
+        controls[3] = qBound(0.0f, act.Thrust, 1.0f);
+    }
+}
+
+void RigidBodySimulator::multirotorForces(const float controls[4], const float Rbe[3][3], float force[3], float torque[3])
+{
+    static const float arm[4][2] = {
+        { MR_ARM, -MR_ARM }, { MR_ARM, MR_ARM }, { -MR_ARM, MR_ARM }, { -MR_ARM, -MR_ARM }
+    };
+    static const float spin[4]   = { -1, 1, -1, 1 };
+
+    for (int i = 0; i < 4; i++) {
+        motor[i] += (controls[i] - motor[i]) * STEP / MR_MOTOR_TAU;
+        float thrust = MR_MAX_THRUST * motor[i] * motor[i];
+
+        force[2]  -= thrust;
+        torque[0] -= arm[i][1] * thrust;
+        torque[1] += arm[i][0] * thrust;
+        torque[2] += spin[i] * MR_YAW_TORQUE * thrust;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        float velBody = Rbe[i][0] * vel[0] + Rbe[i][1] * vel[1] + Rbe[i][2] * vel[2];
+        force[i]  -= MR_DRAG * velBody;
+        torque[i] -= MR_ROT_DRAG * rate[i];
+    }
+}
+
+void RigidBodySimulator::fixedWingForces(const float controls[4], const float Rbe[3][3], float force[3], float torque[3])
+{
+    float velBody[3];
+
+    for (int i = 0; i < 3; i++) {
+        velBody[i] = Rbe[i][0] * vel[0] + Rbe[i][1] * vel[1] + Rbe[i][2] * vel[2];
+    }
+    float airspeed = sqrtf(velBody[0] * velBody[0] + velBody[1] * velBody[1] + velBody[2] * velBody[2]);
+
+    force[0] += FW_MAX_THRUST * controls[3];
+
+    // no wind, below 1m/s the aerodynamics are irrelevant
+    if (airspeed < 1.0f) {
+        return;
+    }
+
+    float alpha = atan2f(velBody[2], velBody[0]);
+    float beta  = asinf(qBound(-1.0f, velBody[1] / airspeed, 1.0f));
+    float qbar  = 0.5f * getAirParameters().groundDensity * airspeed * airspeed * FW_AREA;
+    float CL    = qBound(FW_CL_MIN, FW_CL0 + FW_CLA * alpha, FW_CL_MAX);
+    float lift  = qbar * CL;
+    float drag  = qbar * (FW_CD0 + FW_CDK * CL * CL);
+
+    force[0]  += lift * sinf(alpha) - drag * cosf(alpha);
+    force[1]  += qbar * FW_CYB * beta;
+    force[2]  += -lift * cosf(alpha) - drag * sinf(alpha);
+
+    // non-dimensional rates for the damping derivatives
+    float pHat = rate[0] * FW_SPAN / (2 * airspeed);
+    float qHat = rate[1] * FW_CHORD / (2 * airspeed);
+    float rHat = rate[2] * FW_SPAN / (2 * airspeed);
+
+    torque[0] += qbar * FW_SPAN * (FW_CLB * beta + FW_CLDA * controls[0] + FW_CLP * pHat);
+    torque[1] += qbar * FW_CHORD * (FW_CM0 + FW_CMA * alpha + FW_CMDE * controls[1] + FW_CMQ * qHat);
+    torque[2] += qbar * FW_SPAN * (FW_CNB * beta + FW_CNDR * controls[2] + FW_CNR * rHat);
+}
+
+void RigidBodySimulator::step()
+{
+    float controls[4];
+    float force[3]  = { 0, 0, 0 };
+    float torque[3] = { 0, 0, 0 };
+    float Rbe[3][3];
+
+    readControls(controls);
+    Utils::CoordinateConversions().Quaternion2R(q, Rbe);
+
+    float mass;
+    const float *inertia;
+    float groundFriction;
+    if (airframe == MULTIROTOR) {
+        multirotorForces(controls, Rbe, force, torque);
+        mass    = MR_MASS;
+        inertia = MR_INERTIA;
+        groundFriction = MR_GROUND_FRICTION;
+    } else {
+        fixedWingForces(controls, Rbe, force, torque);
+        mass    = FW_MASS;
+        inertia = FW_INERTIA;
+        groundFriction = FW_GROUND_FRICTION;
+    }
+
+    // translation in NED, the ground pushes back while resting on it
+    float acc[3];
+    for (int i = 0; i < 3; i++) {
+        acc[i] = (Rbe[0][i] * force[0] + Rbe[1][i] * force[1] + Rbe[2][i] * force[2]) / mass;
+    }
+    acc[2] += GEE;
+    bool resting = pos[2] >= 0 && acc[2] >= 0;
+    if (resting) {
+        acc[2]  = 0;
+        acc[0] -= vel[0] * groundFriction;
+        acc[1] -= vel[1] * groundFriction;
+    }
+
+    // accelerometers measure everything but gravity
+    float specific[3] = { acc[0], acc[1], acc[2] - GEE };
+    for (int i = 0; i < 3; i++) {
+        accel[i] = Rbe[i][0] * specific[0] + Rbe[i][1] * specific[1] + Rbe[i][2] * specific[2];
+        vel[i]  += acc[i] * STEP;
+        pos[i]  += vel[i] * STEP;
+    }
+    if (pos[2] >= 0) {
+        pos[2] = 0;
+        if (vel[2] > 0) {
+            vel[2] = 0;
+        }
+    }
+
+    // rotation, Euler's equations with a diagonal inertia tensor
+    float dRate[3];
+    dRate[0] = (torque[0] - (inertia[2] - inertia[1]) * rate[1] * rate[2]) / inertia[0];
+    dRate[1] = (torque[1] - (inertia[0] - inertia[2]) * rate[2] * rate[0]) / inertia[1];
+    dRate[2] = (torque[2] - (inertia[1] - inertia[0]) * rate[0] * rate[1]) / inertia[2];
+    for (int i = 0; i < 3; i++) {
+        rate[i] += dRate[i] * STEP;
+    }
+    if (resting) {
+        rate[0]  = 0;
+        rate[1]  = 0;
+        rate[2] -= rate[2] * groundFriction * STEP;
+    }
+
+    float qdot[4];
+    qdot[0] = (-q[1] * rate[0] - q[2] * rate[1] - q[3] * rate[2]) * STEP / 2;
+    qdot[1] = (q[0] * rate[0] - q[3] * rate[1] + q[2] * rate[2]) * STEP / 2;
+    qdot[2] = (q[3] * rate[0] + q[0] * rate[1] - q[1] * rate[2]) * STEP / 2;
+    qdot[3] = (-q[2] * rate[0] + q[1] * rate[1] + q[0] * rate[2]) * STEP / 2;
+    float qmag = 0;
+    for (int i = 0; i < 4; i++) {
+        q[i] += qdot[i];
+        qmag += q[i] * q[i];
+    }
+    qmag = sqrtf(qmag);
+    for (int i = 0; i < 4; i++) {
+        q[i] /= qmag;
+    }
+
+    steps++;
+}
+
+void RigidBodySimulator::output()
+{
+    Output2Hardware out;
+
+    memset(&out, 0, sizeof(Output2Hardware));
+
+    AirParameters air = getAirParameters();
+    float altitude    = -pos[2];
+
+    float rpy[3];
+    Utils::CoordinateConversions().Quaternion2RPY(q, rpy);
+
+    float Rbe[3][3];
+    Utils::CoordinateConversions().Quaternion2R(q, Rbe);
+    float velBody[3];
+    for (int i = 0; i < 3; i++) {
+        velBody[i] = Rbe[i][0] * vel[0] + Rbe[i][1] * vel[1] + Rbe[i][2] * vel[2];
+    }
+    float airspeed = sqrtf(velBody[0] * velBody[0] + velBody[1] * velBody[1] + velBody[2] * velBody[2]);
+
+    double HomeLLA[3];
+    double LLA[3];
+    double NED[3];
+    HomeLLA[0]  = settings.latitude.toFloat();
+    HomeLLA[1]  = settings.longitude.toFloat();
+    HomeLLA[2]  = 0;
+    NED[0]      = pos[0];
+    NED[1]      = pos[1];
+    NED[2]      = pos[2];
+    Utils::CoordinateConversions().NED2LLA_HomeLLA(HomeLLA, NED, LLA);
+    out.latitude    = LLA[0] * 1e7;
+    out.longitude   = LLA[1] * 1e7;
+    out.altitude    = altitude;
+    out.agl         = altitude;
+    out.groundspeed = sqrtf(vel[0] * vel[0] + vel[1] * vel[1]);
+
+    out.trueAirspeed       = airspeed;
+    out.calibratedAirspeed = tas2cas(airspeed, altitude, air, GEE);
+    if (airspeed > 1.0f) {
+        out.angleOfAttack = RAD2DEG * atan2f(velBody[2], velBody[0]);
+        out.angleOfSlip   = RAD2DEG * asinf(qBound(-1.0f, velBody[1] / airspeed, 1.0f));
+    }
+
+    out.temperature = air.groundTemp - air.tempLapseRate * altitude - 273.15;
+    out.pressure    = airPressureFromAltitude(altitude, air, GEE);
+
+    out.roll     = rpy[0];
+    out.pitch    = rpy[1];
+    out.heading  = rpy[2];
+
+    out.velNorth = vel[0];
+    out.velEast  = vel[1];
+    out.velDown  = vel[2];
+    out.dstN     = pos[0];
+    out.dstE     = pos[1];
+    out.dstD     = pos[2];
+
+    out.accX      = accel[0];
+    out.accY      = accel[1];
+    out.accZ      = accel[2];
+    out.rollRate  = RAD2DEG * rate[0];
+    out.pitchRate = RAD2DEG * rate[1];
+    out.yawRate   = RAD2DEG * rate[2];
+    out.delT      = STEP;
+
+    out.voltage   = 12.6;
+
+    updateUAVOs(out);
+}
@@ -0,0 +1,107 @@
+/**
+ ******************************************************************************
+ *
+ * @file       rigidbodysimulator.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @brief      Built-in 6-DOF rigid body model, no external simulator needed
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   hitlplugin
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef RIGIDBODYSIMULATOR_H
+#define RIGIDBODYSIMULATOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <simulator.h>
+
+/**
+ * Runs a multirotor or fixed wing model inside the GCS, in fixed steps of
+ * simulated time. Steps are paced to the wall clock, or run as fast as
+ * possible when settings.fastAsPossible is set. Sensor outputs go through
+ * Simulator::updateUAVOs() on simulated time.
+ */
+class RigidBodySimulator : public Simulator {
+    Q_OBJECT
+public:
+    enum Airframe {
+        MULTIROTOR,
+        FIXEDWING
+    };
+
+    RigidBodySimulator(const SimulatorSettings & params, Airframe frame);
+    ~RigidBodySimulator();
+
+    void setupUdpPorts(const QString & host, int inPort, int outPort);
+
+protected:
+    QTime outputTime() const;
+    void timerEvent(QTimerEvent *event);
+
+private slots:
+    void transmitUpdate();
+
+private:
+    static const float STEP;
+    static const int STEPS_PER_EVENT;
+
+    Airframe airframe;
+    int stepTimer;
+    QElapsedTimer wallTime;
+    qint64 steps;
+
+    // state, position and velocity in NED, attitude q rotates NED to body
+    float pos[3];
+    float vel[3];
+    float q[4];
+    float rate[3]; // body [rad/s]
+    float motor[4]; // multirotor motor thrust fraction, lags the command
+    float accel[3]; // specific force in body frame
+
+    void processUpdate(const QByteArray & data);
+    void readControls(float controls[4]);
+    void step();
+    void multirotorForces(const float controls[4], const float Rbe[3][3], float force[3], float torque[3]);
+    void fixedWingForces(const float controls[4], const float Rbe[3][3], float force[3], float torque[3]);
+    void output();
+};
+
+class RigidBodySimulatorCreator : public SimulatorCreator {
+public:
+    RigidBodySimulatorCreator(const QString & classId, const QString & description, RigidBodySimulator::Airframe frame)
+        :  SimulatorCreator(classId, description),
+        airframe(frame)
+    {}
+
+    bool IsBuiltIn() const
+    {
+        return true;
+    }
+
+    Simulator *createSimulator(const SimulatorSettings & params)
+    {
+        return new RigidBodySimulator(params, airframe);
+    }
+
+private:
+    RigidBodySimulator::Airframe airframe;
+};
+
+#endif // RIGIDBODYSIMULATOR_H
@@ -64,14 +64,7 @@ Simulator::Simulator(const SimulatorSettings & params) :
     connect(this, SIGNAL(myStart()), this, SLOT(onStart()), Qt::QueuedConnection);
     emit myStart();
 
-    QTime currentTime = QTime::currentTime();
-    gpsPosTime        = currentTime;
-    groundTruthTime   = currentTime;
-    gcsRcvrTime       = currentTime;
-    attRawTime        = currentTime;
-    baroAltTime       = currentTime;
-    battTime = currentTime;
-    airspeedStateTime = currentTime;
+    resetOutputTimes(QTime::currentTime());
 
     // Define standard atmospheric constants
     airParameters.univGasConstant  = 8.31447; // [J/(mol·K)]
@@ -215,7 +208,18 @@ void Simulator::onStart()
     current.i = 0;
 }
 
-void Simulator::receiveUpdate()
+void Simulator::resetOutputTimes(const QTime & time)
+{
+    gpsPosTime        = time;
+    groundTruthTime   = time;
+    gcsRcvrTime       = time;
+    attRawTime        = time;
+    baroAltTime       = time;
+    battTime          = time;
+    airspeedStateTime = time;
+}
+
+void Simulator::simulatorAlive()
 {
     // Update connection timer and status
     simTimer->setInterval(simTimeout);
@@ -225,6 +229,11 @@ void Simulator::receiveUpdate()
         simConnectionStatus = true;
         emit simulatorConnected();
     }
+}
+
+void Simulator::receiveUpdate()
+{
+    simulatorAlive();
 
     // Process data
     while (inSocket->hasPendingDatagrams()) {
@@ -389,7 +398,7 @@ void Simulator::resetInitialHomePosition()
 
 void Simulator::updateUAVOs(Output2Hardware out)
 {
-    QTime currentTime = QTime::currentTime();
+    QTime currentTime = outputTime();
 
     Noise noise;
     HitlNoiseGeneration noiseSource;
@@ -122,6 +122,7 @@ typedef struct _CONNECTION {
     int     inPort;
     bool    startSim;
     bool    addNoise;
+    bool    fastAsPossible;
     QString latitude;
     QString longitude;
 
@@ -303,6 +304,14 @@ private slots:
     virtual void processUpdate(const QByteArray & data) = 0;
 
 protected:
+    // time the sensor output rates in updateUAVOs() are based on
+    virtual QTime outputTime() const
+    {
+        return QTime::currentTime();
+    }
+    void resetOutputTimes(const QTime & time);
+    void simulatorAlive();
+
     static const float GEE;
     static const float FT2M;
     static const float KT2MPS;
@@ -393,6 +402,11 @@ public:
     {
         return description;
     }
+    // runs in the GCS, needs neither a simulator program nor UDP ports
+    virtual bool IsBuiltIn() const
+    {
+        return false;
+    }
 
     virtual Simulator *createSimulator(const SimulatorSettings & params) = 0;
 
@@ -117,6 +117,13 @@ plugin_systemhealth.depends += plugin_uavobjects
 plugin_systemhealth.depends += plugin_uavtalk
 SUBDIRS += plugin_systemhealth
 
+# Profiler gadget
+plugin_profiler.subdir = profiler
+plugin_profiler.depends = plugin_coreplugin
+plugin_profiler.depends += plugin_uavobjects
+plugin_profiler.depends += plugin_uavtalk
+SUBDIRS += plugin_profiler
+
 # Config gadget
 plugin_config.subdir = config
 plugin_config.depends = plugin_coreplugin
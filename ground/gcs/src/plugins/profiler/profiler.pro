@@ -0,0 +1,22 @@
+TEMPLATE = lib
+TARGET = ProfilerGadget
+
+QT += widgets
+
+include(../../plugin.pri)
+include(../../plugins/coreplugin/coreplugin.pri)
+include(profiler_dependencies.pri)
+
+HEADERS += \
+    profilerplugin.h \
+    profilergadget.h \
+    profilergadgetwidget.h \
+    profilergadgetfactory.h
+
+SOURCES += \
+    profilerplugin.cpp \
+    profilergadget.cpp \
+    profilergadgetfactory.cpp \
+    profilergadgetwidget.cpp
+
+OTHER_FILES += ProfilerGadget.pluginspec
@@ -0,0 +1,65 @@
+/**
+ ******************************************************************************
+ *
+ * @file       profilergadget.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ProfilerPlugin Profiler Plugin
+ * @{
+ * @brief Live CPU time and latency distributions of the flight code
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PROFILERGADGET_H_
+#define PROFILERGADGET_H_
+
+#include <coreplugin/iuavgadget.h>
+
+namespace Core {
+class IUAVGadget;
+}
+class ProfilerGadgetWidget;
+
+using namespace Core;
+
+class ProfilerGadget : public Core::IUAVGadget {
+    Q_OBJECT
+public:
+    ProfilerGadget(QString classId, ProfilerGadgetWidget *widget, QWidget *parent = 0);
+    ~ProfilerGadget();
+
+    QList<int> context() const
+    {
+        return m_context;
+    }
+    QWidget *widget()
+    {
+        return m_widget;
+    }
+    QString contextHelpId() const
+    {
+        return QString();
+    }
+
+private:
+    QWidget *m_widget;
+    QList<int> m_context;
+};
+
+
+#endif // PROFILERGADGET_H_
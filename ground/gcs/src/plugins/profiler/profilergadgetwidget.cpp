@@ -0,0 +1,340 @@
+/**
+ ******************************************************************************
+ *
+ * @file       profilergadgetwidget.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ProfilerPlugin Profiler Plugin
+ * @{
+ * @brief Live CPU time and latency distributions of the flight code
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "profilergadgetwidget.h"
+
+#include "perfcounterstats.h"
+#include "extensionsystem/pluginmanager.h"
+#include "uavobjectmanager.h"
+#include <uavtalk/telemetrymanager.h>
+
+#include <QApplication>
+#include <QHeaderView>
+#include <QPainter>
+#include <QSplitter>
+#include <QStyledItemDelegate>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace {
+enum TaskColumns {
+    TASK_NAME,
+    TASK_CPU,
+    TASK_INSTRUMENTED
+};
+
+enum CounterColumns {
+    COUNTER_ID,
+    COUNTER_TASK,
+    COUNTER_TYPE,
+    COUNTER_RATE,
+    COUNTER_MEAN,
+    COUNTER_CPU,
+    COUNTER_DISTRIBUTION
+};
+
+// TaskInfo is sent every 10s by default, the profiler wants it faster
+const quint16 TASKINFO_PERIOD_MS = 1000;
+
+/**
+ * Draws the log2 histogram stored as a QVariantList in Qt::UserRole
+ */
+class HistogramDelegate : public QStyledItemDelegate {
+public:
+    HistogramDelegate(QObject *parent) : QStyledItemDelegate(parent) {}
+
+    void paint(QPainter *painter, const QStyleOptionViewItem & option, const QModelIndex & index) const
+    {
+        QStyleOptionViewItem opt(option);
+
+        initStyleOption(&opt, index);
+        const QWidget *widget = opt.widget;
+        QStyle *style = widget ? widget->style() : QApplication::style();
+        style->drawPrimitive(QStyle::PE_PanelItemViewItem, &opt, painter, widget);
+
+        QVariantList histogram = index.data(Qt::UserRole).toList();
+        uint max = 0;
+        foreach(QVariant count, histogram) {
+            max = qMax(max, count.toUInt());
+        }
+        if (!max) {
+            return;
+        }
+
+        QRect area = opt.rect.adjusted(2, 2, -2, -2);
+        qreal width = (qreal)area.width() / histogram.size();
+        painter->save();
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(opt.palette.brush(opt.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Highlight));
+        for (int i = 0; i < histogram.size(); ++i) {
+            qreal height = area.height() * histogram[i].toUInt() / max;
+            painter->drawRect(QRectF(area.left() + i * width, area.bottom() - height, qMax(width - 1, (qreal)1), height));
+        }
+        painter->restore();
+    }
+
+    QSize sizeHint(const QStyleOptionViewItem & option, const QModelIndex & index) const
+    {
+        QSize size = QStyledItemDelegate::sizeHint(option, index);
+
+        return QSize(PerfCounterStats::HISTOGRAM_NUMELEM * 6, size.height());
+    }
+};
+
+QString bucketRange(int bucket)
+{
+    if (bucket == 0) {
+        return QString("<= 0");
+    }
+    qint64 low = Q_INT64_C(1) << (bucket - 1);
+    if (bucket == (int)PerfCounterStats::HISTOGRAM_NUMELEM - 1) {
+        return QString(">= %1").arg(low);
+    }
+    return QString("%1 - %2").arg(low).arg(2 * low - 1);
+}
+}
+
+ProfilerGadgetWidget::ProfilerGadgetWidget(QWidget *parent) : QWidget(parent),
+    m_streaming(false)
+{
+    setMinimumSize(128, 128);
+    setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
+
+    m_tasks = new QTreeWidget();
+    m_tasks->setHeaderLabels(QStringList() << tr("Task") << tr("CPU [%]") << tr("Instrumented [%]"));
+    m_tasks->setRootIsDecorated(false);
+    m_tasks->setToolTip(tr("CPU time of each task as reported by the task monitor, "
+                           "and the part of it spent in timed sections"));
+
+    m_counters = new QTreeWidget();
+    m_counters->setHeaderLabels(QStringList() << tr("Counter") << tr("Task") << tr("Type") << tr("Rate [1/s]")
+                                              << tr("Mean") << tr("CPU [%]") << tr("Distribution"));
+    m_counters->setItemDelegateForColumn(COUNTER_DISTRIBUTION, new HistogramDelegate(m_counters));
+    m_counters->header()->setStretchLastSection(true);
+    m_counters->setSortingEnabled(true);
+    m_counters->sortByColumn(COUNTER_ID, Qt::AscendingOrder);
+
+    QSplitter *splitter = new QSplitter(Qt::Vertical);
+    splitter->addWidget(m_tasks);
+    splitter->addWidget(m_counters);
+    splitter->setStretchFactor(1, 2);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(splitter);
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    m_objManager = pm->getObject<UAVObjectManager>();
+
+    UAVObject *taskInfo = m_objManager->getObject(QString("TaskInfo"));
+    if (taskInfo) {
+        // task monitor ids are the element indexes of the TaskInfo fields
+        m_taskNames = taskInfo->getField("RunningTime")->getElementNames();
+        foreach(QString name, m_taskNames) {
+            QTreeWidgetItem *item = new QTreeWidgetItem(m_tasks, QStringList(name));
+            item->setHidden(true);
+        }
+        connect(taskInfo, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(taskInfoUpdated(UAVObject *)));
+    }
+
+    foreach(UAVObject * obj, m_objManager->getObjectInstances(PerfCounterStats::NAME)) {
+        connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(statsUpdated(UAVObject *)));
+    }
+    connect(m_objManager, SIGNAL(newInstance(UAVObject *)), this, SLOT(newInstance(UAVObject *)));
+
+    TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
+    connect(telMngr, SIGNAL(connected()), this, SLOT(onAutopilotConnect()));
+    connect(telMngr, SIGNAL(disconnected()), this, SLOT(onAutopilotDisconnect()));
+    if (telMngr->isConnected()) {
+        startStreaming();
+    }
+}
+
+ProfilerGadgetWidget::~ProfilerGadgetWidget()
+{
+    stopStreaming();
+}
+
+void ProfilerGadgetWidget::newInstance(UAVObject *obj)
+{
+    if (obj->getObjID() == PerfCounterStats::OBJID) {
+        connect(obj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(statsUpdated(UAVObject *)));
+    }
+}
+
+void ProfilerGadgetWidget::onAutopilotConnect()
+{
+    startStreaming();
+}
+
+void ProfilerGadgetWidget::onAutopilotDisconnect()
+{
+    // only restores the local copies, the next board starts with its defaults
+    stopStreaming();
+}
+
+/**
+ * Have the flight side send the statistics as soon as they are published,
+ * the default update modes are restored by stopStreaming()
+ */
+void ProfilerGadgetWidget::startStreaming()
+{
+    UAVObject *stats    = m_objManager->getObject(PerfCounterStats::NAME);
+    UAVObject *taskInfo = m_objManager->getObject(QString("TaskInfo"));
+
+    if (m_streaming || !stats || !taskInfo) {
+        return;
+    }
+
+    m_statsMetadata = stats->getMetadata();
+    UAVObject::Metadata mdata = m_statsMetadata;
+    UAVObject::SetFlightTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_ONCHANGE);
+    stats->setMetadata(mdata);
+
+    m_taskInfoMetadata = taskInfo->getMetadata();
+    mdata = m_taskInfoMetadata;
+    UAVObject::SetFlightTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_PERIODIC);
+    mdata.flightTelemetryUpdatePeriod = TASKINFO_PERIOD_MS;
+    taskInfo->setMetadata(mdata);
+
+    m_streaming = true;
+}
+
+void ProfilerGadgetWidget::stopStreaming()
+{
+    if (!m_streaming) {
+        return;
+    }
+    m_objManager->getObject(PerfCounterStats::NAME)->setMetadata(m_statsMetadata);
+    m_objManager->getObject(QString("TaskInfo"))->setMetadata(m_taskInfoMetadata);
+    m_streaming = false;
+}
+
+/**
+ * Find the row of a counter, counters are grouped by module, the upper half
+ * word of their id
+ */
+QTreeWidgetItem *ProfilerGadgetWidget::counterItem(quint32 id)
+{
+    if (m_counterItems.contains(id)) {
+        return m_counterItems.value(id);
+    }
+
+    quint16 moduleId = id >> 16;
+    QTreeWidgetItem *module = m_moduleItems.value(moduleId);
+    if (!module) {
+        module = new QTreeWidgetItem(m_counters, QStringList(QString("0x%1").arg(moduleId, 4, 16, QChar('0')).toUpper()));
+        module->setExpanded(true);
+        m_moduleItems.insert(moduleId, module);
+    }
+    QTreeWidgetItem *item = new QTreeWidgetItem(module, QStringList(QString("0x%1").arg(id, 8, 16, QChar('0')).toUpper()));
+    m_counterItems.insert(id, item);
+    return item;
+}
+
+void ProfilerGadgetWidget::statsUpdated(UAVObject *obj)
+{
+    PerfCounterStats *stats = dynamic_cast<PerfCounterStats *>(obj);
+
+    if (!stats) {
+        return;
+    }
+    PerfCounterStats::DataFields data = stats->getData();
+    if (!data.Period) {
+        // instance not published by the flight side yet
+        return;
+    }
+
+    QTreeWidgetItem *item = counterItem(data.Id);
+    double period = data.Period / 1000.0;
+    bool timed    = data.Type == PerfCounterStats::TYPE_DURATION || data.Type == PerfCounterStats::TYPE_PERIOD;
+    QString unit  = timed ? tr(" us") : QString();
+
+    item->setText(COUNTER_TASK, data.Task < m_taskNames.size() ? m_taskNames.at(data.Task) : QString("-"));
+    item->setData(COUNTER_TASK, Qt::UserRole, data.Task);
+    item->setText(COUNTER_TYPE, stats->getField("Type")->getValue().toString());
+    item->setText(COUNTER_RATE, QString::number(data.Count / period, 'f', 1));
+    item->setText(COUNTER_MEAN, data.Count ? QString::number((double)data.Total / data.Count, 'f', 1) + unit : QString());
+
+    // only timed sections use the CPU, total is in us
+    double load = data.Type == PerfCounterStats::TYPE_DURATION ? data.Total / (period * 1e4) : 0.0;
+    item->setText(COUNTER_CPU, data.Type == PerfCounterStats::TYPE_DURATION ? QString::number(load, 'f', 2) : QString());
+    item->setData(COUNTER_CPU, Qt::UserRole, load);
+
+    QVariantList histogram;
+    QStringList tooltip;
+    for (uint i = 0; i < PerfCounterStats::HISTOGRAM_NUMELEM; ++i) {
+        histogram << data.Histogram[i];
+        if (data.Histogram[i]) {
+            tooltip << QString("%1%2: %3").arg(bucketRange(i)).arg(unit).arg(data.Histogram[i]);
+        }
+    }
+    item->setData(COUNTER_DISTRIBUTION, Qt::UserRole, histogram);
+    item->setToolTip(COUNTER_DISTRIBUTION, tooltip.join("\n"));
+
+    updateModuleLoads();
+}
+
+/**
+ * Sum the CPU time of the timed sections per module and per task
+ */
+void ProfilerGadgetWidget::updateModuleLoads()
+{
+    QMap<uint, double> taskLoads;
+
+    foreach(QTreeWidgetItem * module, m_moduleItems) {
+        double moduleLoad = 0.0;
+        bool timed = false;
+        for (int i = 0; i < module->childCount(); ++i) {
+            QTreeWidgetItem *item = module->child(i);
+            if (item->text(COUNTER_CPU).isEmpty()) {
+                continue;
+            }
+            double load = item->data(COUNTER_CPU, Qt::UserRole).toDouble();
+            moduleLoad += load;
+            taskLoads[item->data(COUNTER_TASK, Qt::UserRole).toUInt()] += load;
+            timed = true;
+        }
+        module->setText(COUNTER_CPU, timed ? QString::number(moduleLoad, 'f', 2) : QString());
+    }
+
+    for (int n = 0; n < m_tasks->topLevelItemCount(); ++n) {
+        QTreeWidgetItem *item = m_tasks->topLevelItem(n);
+        item->setText(TASK_INSTRUMENTED, taskLoads.contains(n) ? QString::number(taskLoads.value(n), 'f', 2) : QString());
+    }
+}
+
+void ProfilerGadgetWidget::taskInfoUpdated(UAVObject *obj)
+{
+    UAVObjectField *running     = obj->getField("Running");
+    UAVObjectField *runningTime = obj->getField("RunningTime");
+
+    for (int n = 0; n < m_tasks->topLevelItemCount(); ++n) {
+        QTreeWidgetItem *item = m_tasks->topLevelItem(n);
+        item->setHidden(running->getValue(n).toString() != "True");
+        item->setText(TASK_CPU, QString::number(runningTime->getValue(n).toUInt()));
+    }
+}
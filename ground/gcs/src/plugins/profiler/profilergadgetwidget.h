@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ *
+ * @file       profilergadgetwidget.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ProfilerPlugin Profiler Plugin
+ * @{
+ * @brief Live CPU time and latency distributions of the flight code
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PROFILERGADGETWIDGET_H_
+#define PROFILERGADGETWIDGET_H_
+
+#include "uavobject.h"
+
+#include <QWidget>
+#include <QMap>
+#include <QStringList>
+
+class QTreeWidget;
+class QTreeWidgetItem;
+class UAVObjectManager;
+
+/**
+ * Shows the PerfCounterStats snapshots of the flight code: CPU time spent
+ * in the timed sections of each module and task, and the distribution of
+ * every counter. The task CPU time comes from TaskInfo. Both objects are
+ * streamed from the flight controller while the gadget exists.
+ */
+class ProfilerGadgetWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    ProfilerGadgetWidget(QWidget *parent = 0);
+    ~ProfilerGadgetWidget();
+
+private slots:
+    void newInstance(UAVObject *obj);
+    void statsUpdated(UAVObject *obj);
+    void taskInfoUpdated(UAVObject *obj);
+    void onAutopilotConnect();
+    void onAutopilotDisconnect();
+
+private:
+    UAVObjectManager *m_objManager;
+    QTreeWidget *m_tasks;
+    QTreeWidget *m_counters;
+    QMap<quint32, QTreeWidgetItem *> m_counterItems;
+    QMap<quint16, QTreeWidgetItem *> m_moduleItems;
+    QStringList m_taskNames;
+
+    bool m_streaming;
+    UAVObject::Metadata m_statsMetadata;
+    UAVObject::Metadata m_taskInfoMetadata;
+
+    QTreeWidgetItem *counterItem(quint32 id);
+    void updateModuleLoads();
+    void startStreaming();
+    void stopStreaming();
+};
+
+#endif /* PROFILERGADGETWIDGET_H_ */
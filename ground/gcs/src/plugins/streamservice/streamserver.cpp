@@ -0,0 +1,285 @@
+/**
+ ******************************************************************************
+ *
+ * @file       streamserver.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup StreamServicePlugin Plugin
+ * @{
+ * @brief Data UAV Data objects TCP/IP stream service
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "streamserver.h"
+
+#include "../uavobjects/uavdataobject.h"
+
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QStringList>
+#include <QtEndian>
+
+StreamServer::StreamServer(const QHash<QString, quint32> &objectIds) :
+    server(NULL),
+    objectIds(objectIds),
+    clients(0)
+{}
+
+StreamServer::~StreamServer()
+{
+    stop();
+    qDeleteAll(objects);
+}
+
+bool StreamServer::start(quint16 port)
+{
+    server = new QTcpServer(this);
+    if (!server->listen(QHostAddress::Any, port)) {
+        return false;
+    }
+    connect(server, &QTcpServer::newConnection, this, &StreamServer::newConnection);
+    return true;
+}
+
+QString StreamServer::errorString() const
+{
+    return server ? server->errorString() : QString();
+}
+
+void StreamServer::stop()
+{
+    if (server && server->isListening()) {
+        server->close();
+    }
+    foreach(Client * client, clientMap) {
+        disconnect(client->socket, 0, this, 0);
+        // Discard the pending bytes
+        client->socket->abort();
+        client->socket->deleteLater();
+        delete client;
+    }
+    clientMap.clear();
+    clients.storeRelease(0);
+}
+
+void StreamServer::newConnection()
+{
+    QTcpSocket *socket;
+
+    while ((socket = server->nextPendingConnection()) != Q_NULLPTR) {
+        Client *client = new Client;
+        client->socket    = socket;
+        client->binary    = false;
+        client->policy    = POLICY_DROP;
+        client->maxQueued = DEFAULT_QUEUE_LENGTH;
+        client->all       = true;
+        clientMap.insert(socket, client);
+        clients.storeRelease(clientMap.count());
+
+        connect(socket, &QTcpSocket::disconnected, this, &StreamServer::clientDisconnected);
+        connect(socket, &QTcpSocket::readyRead, this, &StreamServer::readCommands);
+        connect(socket, &QTcpSocket::bytesWritten, this, &StreamServer::sendPending);
+        emit clientConnected();
+    }
+}
+
+void StreamServer::clientDisconnected()
+{
+    QTcpSocket *socket = (QTcpSocket *)sender();
+    Client *client     = clientMap.take(socket);
+
+    clients.storeRelease(clientMap.count());
+    disconnect(socket, 0, this, 0);
+    socket->deleteLater();
+    delete client;
+}
+
+void StreamServer::update(const StreamUpdate &update)
+{
+    quint64 key = ((quint64)update.objId << 32) | update.instId;
+
+    if (update.clone) {
+        objects.insert(key, update.clone);
+    }
+    UAVDataObject *obj = objects.value(key);
+    if (!obj) {
+        return;
+    }
+
+    // Serialize once per format actually requested
+    QByteArray json;
+    QByteArray binary;
+    foreach(Client * client, clientMap) {
+        if (!client->all && !client->subscribed.contains(update.objId)) {
+            continue;
+        }
+        if (client->binary) {
+            if (binary.isEmpty()) {
+                binary = toBinary(update);
+            }
+            enqueue(client, key, binary);
+        } else {
+            if (json.isEmpty()) {
+                obj->unpack((const quint8 *)update.data.constData());
+                json = toJson(obj, update.timestamp);
+            }
+            enqueue(client, key, json);
+        }
+        send(client);
+    }
+}
+
+void StreamServer::enqueue(Client *client, quint64 key, const QByteArray &message)
+{
+    if (client->policy == POLICY_COALESCE) {
+        if (!client->coalesced.contains(key)) {
+            client->order.enqueue(key);
+        }
+        client->coalesced.insert(key, message);
+        while (client->order.count() > client->maxQueued) {
+            client->coalesced.remove(client->order.dequeue());
+        }
+    } else {
+        client->queued.enqueue(message);
+        while (client->queued.count() > client->maxQueued) {
+            client->queued.dequeue();
+        }
+    }
+}
+
+void StreamServer::sendPending()
+{
+    Client *client = clientMap.value((QTcpSocket *)sender());
+
+    if (client) {
+        send(client);
+    }
+}
+
+/**
+ * Hand queued messages to the socket while its buffer is not full, the
+ * rest is sent from bytesWritten once the client caught up.
+ */
+void StreamServer::send(Client *client)
+{
+    QTcpSocket *socket = client->socket;
+
+    while (socket->bytesToWrite() < MAX_SOCKET_BUFFER) {
+        if (!client->order.isEmpty()) {
+            socket->write(client->coalesced.take(client->order.dequeue()));
+        } else if (!client->queued.isEmpty()) {
+            socket->write(client->queued.dequeue());
+        } else {
+            break;
+        }
+    }
+}
+
+void StreamServer::readCommands()
+{
+    Client *client = clientMap.value((QTcpSocket *)sender());
+
+    if (!client) {
+        return;
+    }
+    while (client->socket->canReadLine()) {
+        parseCommand(client, client->socket->readLine().trimmed());
+    }
+}
+
+void StreamServer::parseCommand(Client *client, const QByteArray &line)
+{
+    int space = line.indexOf(' ');
+    QByteArray command  = line.left(space).toLower();
+    QByteArray argument = space < 0 ? QByteArray() : line.mid(space + 1).trimmed();
+
+    if (command == "subscribe") {
+        if (argument == "*") {
+            client->all = true;
+            client->subscribed.clear();
+        } else {
+            if (client->all) {
+                client->all = false;
+                client->subscribed.clear();
+            }
+            client->subscribed.unite(resolve(argument));
+        }
+    } else if (command == "unsubscribe") {
+        if (client->all) {
+            client->all = false;
+            client->subscribed = objectIds.values().toSet();
+        }
+        client->subscribed.subtract(resolve(argument));
+    } else if (command == "format") {
+        // Queued messages are in the previous format
+        client->binary = (argument == "binary");
+        client->order.clear();
+        client->coalesced.clear();
+        client->queued.clear();
+    } else if (command == "policy") {
+        client->policy = (argument == "coalesce") ? POLICY_COALESCE : POLICY_DROP;
+    } else if (command == "queue") {
+        client->maxQueued = qMax(1, argument.toInt());
+    }
+}
+
+QSet<quint32> StreamServer::resolve(const QByteArray &names) const
+{
+    QSet<quint32> ids;
+
+    foreach(QString name, QString::fromUtf8(names).split(',', QString::SkipEmptyParts)) {
+        QHash<QString, quint32>::const_iterator it = objectIds.constFind(name.trimmed().toLower());
+        if (it != objectIds.constEnd()) {
+            ids.insert(it.value());
+        }
+    }
+    return ids;
+}
+
+QByteArray StreamServer::toJson(UAVDataObject *obj, qint64 timestamp) const
+{
+    QJsonObject qtjson;
+
+    obj->toJson(qtjson);
+
+    // Adds timestamp: Milliseconds from epoch
+    qtjson.insert("gcs_timestamp_ms", QJsonValue(timestamp));
+
+    return QJsonDocument(qtjson).toJson(QJsonDocument::Compact) + '\n';
+}
+
+QByteArray StreamServer::toBinary(const StreamUpdate &update) const
+{
+    QByteArray frame(2 + 2 + 4 + 2 + 8, 0);
+    uchar *header = (uchar *)frame.data();
+
+    header[0] = 'U';
+    header[1] = 'O';
+    qToLittleEndian<quint16>(update.data.size(), header + 2);
+    qToLittleEndian<quint32>(update.objId, header + 4);
+    qToLittleEndian<quint16>(update.instId, header + 8);
+    qToLittleEndian<qint64>(update.timestamp, header + 10);
+
+    return frame + update.data;
+}
+
+/**
+ * @}
+ * @}
+ */
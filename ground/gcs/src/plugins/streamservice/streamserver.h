@@ -0,0 +1,144 @@
+/**
+ ******************************************************************************
+ *
+ * @file       streamserver.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup StreamServicePlugin Plugin
+ * @{
+ * @brief Data UAV Data objects TCP/IP stream service
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef STREAMSERVER_H
+#define STREAMSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QQueue>
+#include <QSet>
+#include <QAtomicInt>
+
+class QTcpServer;
+class QTcpSocket;
+class UAVDataObject;
+
+/**
+ * One object update as captured on the GUI thread: the packed object and,
+ * the first time an object instance is seen, a private clone used by the
+ * server thread to serialize it.
+ */
+struct StreamUpdate {
+    quint32 objId;
+    quint32 instId;
+    qint64  timestamp;
+    QByteArray data;
+    UAVDataObject *clone;
+};
+
+Q_DECLARE_METATYPE(StreamUpdate)
+
+/**
+ * Serves the object updates to the TCP clients, lives in its own thread.
+ *
+ * Each update is serialized once per format in use and queued to every
+ * client subscribed to the object. A client never blocks the others: its
+ * queue is bounded and the socket is only fed while its write buffer is
+ * below MAX_SOCKET_BUFFER.
+ *
+ * Clients can send commands, one per line:
+ *   subscribe <name>[,<name>...] | *    only receive these objects (default *)
+ *   unsubscribe <name>[,<name>...]
+ *   format json | binary                 (default json)
+ *   policy drop | coalesce               (default drop)
+ *   queue <messages>                     queue bound (default 1024)
+ *
+ * json sends one compact JSON document per line, as UAVObject::toJson()
+ * with an added gcs_timestamp_ms. binary sends packed objects framed as
+ *   'U' 'O', length(2), objId(4), instId(2), gcs timestamp ms(8), data
+ * all little endian, length being the size of data.
+ *
+ * With the drop policy the oldest messages are discarded when the queue is
+ * full. With coalesce a pending update of an object instance is replaced
+ * by the newer one, so a slow client gets the latest values at its own rate.
+ */
+class StreamServer : public QObject {
+    Q_OBJECT
+
+public:
+    StreamServer(const QHash<QString, quint32> &objectIds);
+    ~StreamServer();
+
+    int clientCount() const
+    {
+        return clients.loadAcquire();
+    }
+
+public slots:
+    bool start(quint16 port);
+    void stop();
+    QString errorString() const;
+    void update(const StreamUpdate &update);
+
+signals:
+    void clientConnected();
+
+private slots:
+    void newConnection();
+    void clientDisconnected();
+    void readCommands();
+    void sendPending();
+
+private:
+    static const int DEFAULT_QUEUE_LENGTH = 1024;
+    static const qint64 MAX_SOCKET_BUFFER = 256 * 1024;
+
+    typedef enum { POLICY_DROP, POLICY_COALESCE } Policy;
+
+    typedef struct {
+        QTcpSocket *socket;
+        bool binary;
+        Policy policy;
+        int maxQueued;
+        bool all;
+        QSet<quint32> subscribed;
+        QQueue<quint64> order;
+        QHash<quint64, QByteArray> coalesced;
+        QQueue<QByteArray> queued;
+    } Client;
+
+    QTcpServer *server;
+    QHash<QTcpSocket *, Client *> clientMap;
+    QHash<quint64, UAVDataObject *> objects;
+    QHash<QString, quint32> objectIds;
+    QAtomicInt clients;
+
+    void enqueue(Client *client, quint64 key, const QByteArray &message);
+    void send(Client *client);
+    void parseCommand(Client *client, const QByteArray &line);
+    QSet<quint32> resolve(const QByteArray &names) const;
+    QByteArray toJson(UAVDataObject *obj, qint64 timestamp) const;
+    QByteArray toBinary(const StreamUpdate &update) const;
+};
+
+#endif // STREAMSERVER_H
+
+/**
+ * @}
+ * @}
+ */
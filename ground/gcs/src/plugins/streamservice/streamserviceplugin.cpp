@@ -26,12 +26,7 @@
  */
 #include "streamserviceplugin.h"
 
-#include <QJsonObject>
-#include <QJsonDocument>
-#include <QMessageBox>
 #include <QDateTime>
-#include <QTcpServer>
-#include <QTcpSocket>
 
 #include "extensionsystem/pluginmanager.h"
 #include "../uavobjects/uavobjectmanager.h"
@@ -39,6 +34,7 @@
 
 StreamServicePlugin::StreamServicePlugin() :
     port(7891),
+    pServer(Q_NULLPTR),
     isSubscribed(false) {}
 
 StreamServicePlugin::~StreamServicePlugin()
@@ -46,16 +42,12 @@ StreamServicePlugin::~StreamServicePlugin()
     if (pServer == Q_NULLPTR) {
         return;
     }
-    if (pServer->isListening()) {
-        foreach(QTcpSocket * client, activeClients) {
-            /* Disconnect the client discarding pending
-             * bytes */
-            if (client->isOpen()) {
-                client->close();
-            }
-        }
-        pServer->close();
+    if (serverThread.isRunning()) {
+        QMetaObject::invokeMethod(pServer, "stop", Qt::BlockingQueuedConnection);
+        serverThread.quit();
+        serverThread.wait();
     }
+    delete pServer;
 }
 
 bool StreamServicePlugin::initialize(const QStringList &arguments, QString *errorString)
@@ -63,76 +55,82 @@ bool StreamServicePlugin::initialize(const QStringList &arguments, QString *erro
     Q_UNUSED(arguments);
     Q_UNUSED(errorString);
 
-    pServer = new QTcpServer();
+    qRegisterMetaType<StreamUpdate>("StreamUpdate");
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    Q_ASSERT(objManager);
+
+    // Used by the server thread to resolve the client subscriptions
+    QHash<QString, quint32> objectIds;
+    foreach(QList<UAVDataObject *> list, objManager->getDataObjects()) {
+        objectIds.insert(list.first()->getName().toLower(), list.first()->getObjID());
+    }
 
-    if (!pServer->listen(QHostAddress::Any, port)) {
-        *errorString = tr("Couldn't start StreamService: ") + pServer->errorString();
+    pServer = new StreamServer(objectIds);
+    pServer->moveToThread(&serverThread);
+    serverThread.start();
+
+    bool listening = false;
+    QMetaObject::invokeMethod(pServer, "start", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(bool, listening), Q_ARG(quint16, port));
+    if (!listening) {
+        QString error;
+        QMetaObject::invokeMethod(pServer, "errorString", Qt::BlockingQueuedConnection, Q_RETURN_ARG(QString, error));
+        *errorString = tr("Couldn't start StreamService: ") + error;
         return false;
     }
 
-    connect(pServer, &QTcpServer::newConnection, this, &StreamServicePlugin::clientConnected);
+    connect(pServer, &StreamServer::clientConnected, this, &StreamServicePlugin::clientConnected);
+    connect(this, &StreamServicePlugin::updateReady, pServer, &StreamServer::update);
 
     return true;
 }
 
 void StreamServicePlugin::extensionsInitialized()
-{
-    if (pServer == Q_NULLPTR) {
-        return;
-    }
-
-    pServer->resumeAccepting();
-}
+{}
 
 void StreamServicePlugin::shutdown()
 {
-    if (pServer != Q_NULLPTR) {
-        pServer->pauseAccepting();
-    }
-
-    foreach(QTcpSocket * pClient, activeClients) {
-        pClient->disconnectFromHost();
+    if (pServer != Q_NULLPTR && serverThread.isRunning()) {
+        QMetaObject::invokeMethod(pServer, "stop", Qt::BlockingQueuedConnection);
     }
 }
 
+/**
+ * Only packs the object here, it is serialized and sent by the server thread.
+ */
 void StreamServicePlugin::objectUpdated(UAVObject *pObj)
 {
-    QJsonObject qtjson;
-
-    pObj->toJson(qtjson);
-
-    // Adds timestamp: Milliseconds from epoch
-    qtjson.insert("gcs_timestamp_ms", QJsonValue(QDateTime::currentMSecsSinceEpoch()));
-
-    QJsonDocument jsonDoc(qtjson);
-    QString strJson = QString(jsonDoc.toJson(QJsonDocument::Compact)) + "\n";
+    if (pServer->clientCount() == 0) {
+        return;
+    }
 
-    foreach(QTcpSocket * pClient, activeClients) {
-        if (pClient->isOpen()) {
-            if (pClient->write(strJson.toUtf8().constData(), strJson.length())) {
-                pClient->flush();
-            }
+    StreamUpdate update;
+    update.objId     = pObj->getObjID();
+    update.instId    = pObj->getInstID();
+    update.timestamp = QDateTime::currentMSecsSinceEpoch();
+    update.data.resize(pObj->getNumBytes());
+    pObj->pack((quint8 *)update.data.data());
+    update.clone     = Q_NULLPTR;
+
+    quint64 key = ((quint64)update.objId << 32) | update.instId;
+    if (!clonedObjects.contains(key)) {
+        UAVDataObject *obj = qobject_cast<UAVDataObject *>(pObj);
+        if (obj == Q_NULLPTR) {
+            return;
         }
+        update.clone = obj->clone(update.instId);
+        update.clone->moveToThread(&serverThread);
+        clonedObjects.insert(key);
     }
+
+    emit updateReady(update);
 }
 
 void StreamServicePlugin::clientConnected()
 {
-    QTcpSocket *pending = pServer->nextPendingConnection();
-
-    if (pending == Q_NULLPTR) {
-        return;
-    }
     makeSureIsSubscribed();
-
-    connect(pending, &QTcpSocket::disconnected, this, &StreamServicePlugin::clientDisconnected);
-    activeClients.append(pending);
-}
-
-void StreamServicePlugin::clientDisconnected()
-{
-    disconnect(sender());
-    activeClients.removeAll((QTcpSocket *)sender());
 }
 
 inline void StreamServicePlugin::makeSureIsSubscribed()
@@ -29,11 +29,10 @@
 
 #include <extensionsystem/iplugin.h>
 #include "../uavobjects/uavobject.h"
+#include "streamserver.h"
 
 #include <QtPlugin>
-
-class QTcpServer;
-class QTcpSocket;
+#include <QThread>
 
 class StreamServicePlugin : public ExtensionSystem::IPlugin {
     Q_OBJECT
@@ -50,15 +49,19 @@ public:
 public slots:
     void objectUpdated(UAVObject *pObj);
 
+signals:
+    void updateReady(const StreamUpdate &update);
+
 private slots:
     void clientConnected();
-    void clientDisconnected();
 
 private:
     quint16 port;
 
-    QTcpServer *pServer;
-    QList<QTcpSocket *> activeClients;
+    QThread serverThread;
+    StreamServer *pServer;
+    // Object instances already cloned for the server thread
+    QSet<quint64> clonedObjects;
     bool isSubscribed;
 
     inline void makeSureIsSubscribed();
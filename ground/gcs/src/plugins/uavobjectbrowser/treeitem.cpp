@@ -30,6 +30,9 @@
 /* Constructor */
 HighLightManager::HighLightManager(long checkingInterval)
 {
+    m_clock.start();
+    m_now = 0;
+
     // Start the timer and connect it to the callback
     m_expirationTimer.start(checkingInterval);
     connect(&m_expirationTimer, SIGNAL(timeout()), this, SLOT(checkItemsExpired()));
@@ -65,6 +68,15 @@ bool HighLightManager::remove(TreeItem *itemToRemove)
     return m_items.remove(itemToRemove);
 }
 
+/*
+ * Called before a batch of highlight updates so they all
+ * share the same timestamp.
+ */
+void HighLightManager::updateClock()
+{
+    m_now = m_clock.elapsed();
+}
+
 /*
  * Callback called periodically by the timer.
  * This method checks for expired highlights and
@@ -80,12 +92,12 @@ void HighLightManager::checkItemsExpired()
     QMutableSetIterator<TreeItem *> iter(m_items);
 
     // This is the timestamp to compare with
-    QTime now = QTime::currentTime();
+    updateClock();
 
     // Loop over all items, check if they expired.
     while (iter.hasNext()) {
         TreeItem *item = iter.next();
-        if (item->getHiglightExpires() < now) {
+        if (item->getHiglightExpires() < m_now) {
             // If expired, call removeHighlight
             item->removeHighlight();
 
@@ -102,14 +114,18 @@ TreeItem::TreeItem(const QList<QVariant> &data, TreeItem *parent) :
     m_data(data),
     m_parent(parent),
     m_highlight(false),
-    m_changed(false)
+    m_changed(false),
+    m_highlightExpires(0),
+    m_highlightManager(0)
 {}
 
 TreeItem::TreeItem(const QVariant &data, TreeItem *parent) :
     QObject(0),
     m_parent(parent),
     m_highlight(false),
-    m_changed(false)
+    m_changed(false),
+    m_highlightExpires(0),
+    m_highlightManager(0)
 {
     m_data << data << "" << "";
 }
@@ -184,20 +200,27 @@ void TreeItem::apply()
  */
 void TreeItem::setHighlight(bool highlight)
 {
-    m_highlight = highlight;
-    m_changed   = false;
+    m_changed = false;
     if (highlight) {
-        // Update the expires timestamp
-        m_highlightExpires = QTime::currentTime().addMSecs(m_highlightTimeMs);
+        qint64 expires = m_highlightManager->now() + m_highlightTimeMs;
 
-        // Add to highlightmanager
-        if (m_highlightManager->add(this)) {
-            // Only emit signal if it was added
-            emit updateHighlight(this);
+        // Already highlighted by this batch of updates, and so are the parents
+        if (m_highlight && m_highlightExpires == expires) {
+            return;
         }
-    } else if (m_highlightManager->remove(this)) {
-        // Only emit signal if it was removed
+        m_highlight = true;
+        m_highlightExpires = expires;
+        m_highlightManager->add(this);
+
+        // The value changed, the row needs repainting even if it was highlighted.
+        // The model collects these and flushes them at its display rate.
         emit updateHighlight(this);
+    } else {
+        m_highlight = false;
+        if (m_highlightManager->remove(this)) {
+            // Only emit signal if it was removed
+            emit updateHighlight(this);
+        }
     }
 
     // If we have a parent, call recursively to update highlight status of parents.
@@ -219,7 +242,7 @@ void TreeItem::setHighlightManager(HighLightManager *mgr)
     m_highlightManager = mgr;
 }
 
-QTime TreeItem::getHiglightExpires()
+qint64 TreeItem::getHiglightExpires()
 {
     return m_highlightExpires;
 }
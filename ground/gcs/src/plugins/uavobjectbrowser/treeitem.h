@@ -35,7 +35,7 @@
 #include <QtCore/QLinkedList>
 #include <QtCore/QMap>
 #include <QtCore/QVariant>
-#include <QtCore/QTime>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QTimer>
 #include <QtCore/QObject>
 #include <QtCore/QDebug>
@@ -56,6 +56,8 @@ class TreeItem;
  * Items that are updated during the expiration time are
  * left untouched in the list. This reduces unwanted emits
  * of signals to the repaint/update function.
+ * All expiration timestamps come from the clock of the
+ * manager, read once per batch of updates.
  */
 class HighLightManager : public QObject {
     Q_OBJECT
@@ -70,6 +72,15 @@ public:
     // This is called when an item is set to highlighted = false;
     bool remove(TreeItem *itemToRemove);
 
+    // Read the clock, called once before a batch of updates.
+    void updateClock();
+
+    // Time in ms of the last clock update.
+    qint64 now() const
+    {
+        return m_now;
+    }
+
 private slots:
     // Timer callback method.
     void checkItemsExpired();
@@ -78,6 +89,10 @@ private:
     // The timer checking highlight expiration.
     QTimer m_expirationTimer;
 
+    // The clock all highlight timestamps are taken from.
+    QElapsedTimer m_clock;
+    qint64 m_now;
+
     // The collection holding all items due to be updated.
     QSet<TreeItem *> m_items;
 
@@ -158,7 +173,7 @@ public:
 
     virtual void setHighlightManager(HighLightManager *mgr);
 
-    QTime getHiglightExpires();
+    qint64 getHiglightExpires();
 
     virtual void removeHighlight();
 
@@ -239,7 +254,7 @@ private:
     TreeItem *m_parent;
     bool m_highlight;
     bool m_changed;
-    QTime m_highlightExpires;
+    qint64 m_highlightExpires;
     HighLightManager *m_highlightManager;
 };
 
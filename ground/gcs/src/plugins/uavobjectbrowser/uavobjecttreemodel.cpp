@@ -34,6 +34,7 @@
 #include "extensionsystem/pluginmanager.h"
 #include <QColor>
 #include <QtCore/QTimer>
+#include <QtCore/QHash>
 #include <QtCore/QSignalMapper>
 #include <QtCore/QDebug>
 
@@ -53,6 +54,12 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool categorize, bool us
 
     // Create highlight manager, let it run every 300 ms.
     m_highlightManager = new HighLightManager(300);
+
+    // Flush the collected updates at 20 Hz at most, the timer only runs while there are some.
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(50);
+    connect(&m_updateTimer, SIGNAL(timeout()), this, SLOT(flushUpdates()));
+
     connect(objManager, SIGNAL(newObject(UAVObject *)), this, SLOT(newObject(UAVObject *)));
     connect(objManager, SIGNAL(newInstance(UAVObject *)), this, SLOT(newObject(UAVObject *)));
 
@@ -458,14 +465,53 @@ void UAVObjectTreeModel::highlightUpdatedObject(UAVObject *obj)
     Q_ASSERT(obj);
     ObjectTreeItem *item = findObjectTreeItem(obj);
     Q_ASSERT(item);
-    if (!m_onlyHilightChangedValues) {
-        item->setHighlight(true);
+    // The item is refreshed by the next flush, however many updates arrive until then
+    m_updatedObjects.insert(item);
+    if (!m_updateTimer.isActive()) {
+        m_updateTimer.start();
+    }
+}
+
+void UAVObjectTreeModel::flushUpdates()
+{
+    // All the highlights of this batch expire together
+    m_highlightManager->updateClock();
+
+    foreach(ObjectTreeItem * item, m_updatedObjects) {
+        if (!m_onlyHilightChangedValues) {
+            item->setHighlight(true);
+        }
+        item->update();
+    }
+    m_updatedObjects.clear();
+
+    // One dataChanged range per parent for all its changed children
+    QHash<TreeItem *, QPair<int, int> > ranges;
+    foreach(TreeItem * item, m_changedItems) {
+        if (!item->parent()) {
+            continue;
+        }
+        int row = item->row();
+        QHash<TreeItem *, QPair<int, int> >::iterator range = ranges.find(item->parent());
+        if (range == ranges.end()) {
+            ranges.insert(item->parent(), qMakePair(row, row));
+        } else {
+            range->first  = qMin(range->first, row);
+            range->second = qMax(range->second, row);
+        }
     }
-    item->update();
-    if (!m_onlyHilightChangedValues) {
-        QModelIndex itemIndex = index(item);
-        Q_ASSERT(itemIndex != QModelIndex());
-        emit dataChanged(itemIndex, itemIndex);
+    m_changedItems.clear();
+    // Everything collected while updating the items is flushed here
+    m_updateTimer.stop();
+
+    QHashIterator<TreeItem *, QPair<int, int> > iter(ranges);
+    while (iter.hasNext()) {
+        iter.next();
+        TreeItem *parent = iter.key();
+        int first = iter.value().first;
+        int last  = iter.value().second;
+        emit dataChanged(createIndex(first, TreeItem::TITLE_COLUMN, parent->getChild(first)),
+                         createIndex(last, TreeItem::DATA_COLUMN, parent->getChild(last)));
     }
 }
 
@@ -501,10 +547,11 @@ MetaObjectTreeItem *UAVObjectTreeModel::findMetaObjectTreeItem(UAVMetaObject *ob
 
 void UAVObjectTreeModel::updateHighlight(TreeItem *item)
 {
-    QModelIndex itemIndex = index(item);
-
-    Q_ASSERT(itemIndex != QModelIndex());
-    emit dataChanged(itemIndex, itemIndex.sibling(itemIndex.row(), TreeItem::DATA_COLUMN));
+    // Repainted by the next flush
+    m_changedItems.insert(item);
+    if (!m_updateTimer.isActive()) {
+        m_updateTimer.start();
+    }
 }
 
 void UAVObjectTreeModel::updateIsKnown(TreeItem *item)
@@ -33,6 +33,8 @@
 #include <QtCore/QMap>
 #include <QtCore/QList>
 #include <QColor>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
 
 class TopTreeItem;
 class ObjectTreeItem;
@@ -43,7 +45,6 @@ class UAVMetaObject;
 class UAVObjectField;
 class UAVObjectManager;
 class QSignalMapper;
-class QTimer;
 
 class UAVObjectTreeModel : public QAbstractItemModel {
     Q_OBJECT
@@ -96,6 +97,7 @@ private slots:
     void updateIsKnown(TreeItem *item);
     void highlightUpdatedObject(UAVObject *obj);
     void isKnownChanged(UAVObject *object, bool isKnown);
+    void flushUpdates();
 
 private:
     void setupModelData(UAVObjectManager *objManager);
@@ -126,6 +128,11 @@ private:
 
     // Highlight manager to handle highlighting of tree items.
     HighLightManager *m_highlightManager;
+
+    // Updates are collected here and flushed at the display rate.
+    QTimer m_updateTimer;
+    QSet<ObjectTreeItem *> m_updatedObjects;
+    QSet<TreeItem *> m_changedItems;
 };
 
 #endif // UAVOBJECTTREEMODEL_H
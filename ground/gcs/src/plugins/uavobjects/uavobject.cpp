@@ -30,6 +30,7 @@
 #include <utils/crc.h>
 
 #include <QtEndian>
+#include <QSysInfo>
 #include <QDebug>
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
@@ -67,6 +68,7 @@ UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString & name)
     this->numBytes     = 0;
     this->mutex        = new QMutex(QMutex::Recursive);
     m_isKnown = false;
+    m_rawCopy = false;
 }
 
 /**
@@ -99,6 +101,9 @@ void UAVObject::initializeFields(QList<UAVObjectField *> & fields, quint8 *data,
         offset += fields[n]->getNumBytes();
         connect(fields[n], SIGNAL(fieldUpdated(UAVObjectField *)), this, SLOT(fieldUpdated(UAVObjectField *)));
     }
+    // The data is a packed struct of the fields in wire order, on little endian
+    // hosts it can be copied to and from the wire in one go
+    m_rawCopy = (QSysInfo::ByteOrder == QSysInfo::LittleEndian) && (offset == numBytes);
 }
 
 /**
@@ -297,14 +302,20 @@ UAVObjectField *UAVObject::getField(const QString & name)
 }
 
 /**
- * Pack the object data into a byte array
+ * Pack the object data into a byte array, in one copy when the object
+ * data already has the wire layout
  * @returns The number of bytes copied
  */
 qint32 UAVObject::pack(quint8 *dataOut)
 {
     QMutexLocker locker(mutex);
-    qint32 offset = 0;
 
+    if (m_rawCopy) {
+        memcpy(dataOut, data, numBytes);
+        return numBytes;
+    }
+
+    qint32 offset = 0;
     for (int n = 0; n < fields.length(); ++n) {
         fields[n]->pack(&dataOut[offset]);
         offset += fields[n]->getNumBytes();
@@ -319,11 +330,15 @@ qint32 UAVObject::pack(quint8 *dataOut)
 qint32 UAVObject::unpack(const quint8 *dataIn)
 {
     QMutexLocker locker(mutex);
-    qint32 offset = 0;
 
-    for (int n = 0; n < fields.length(); ++n) {
-        fields[n]->unpack(&dataIn[offset]);
-        offset += fields[n]->getNumBytes();
+    if (m_rawCopy) {
+        memcpy(data, dataIn, numBytes);
+    } else {
+        qint32 offset = 0;
+        for (int n = 0; n < fields.length(); ++n) {
+            fields[n]->unpack(&dataIn[offset]);
+            offset += fields[n]->getNumBytes();
+        }
     }
     emit objectUnpacked(this); // trigger object updated event
     emit objectUpdated(this);
@@ -201,6 +201,7 @@ protected:
 
 private:
     bool m_isKnown;
+    bool m_rawCopy;
 
 private slots:
     void fieldUpdated(UAVObjectField *field);
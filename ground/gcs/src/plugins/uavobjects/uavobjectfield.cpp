@@ -28,6 +28,9 @@
 #include "uavobjectfield.h"
 
 #include <QtEndian>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QHash>
 #include <QDebug>
 #include <QXmlStreamWriter>
 #include <QXmlStreamReader>
@@ -51,19 +54,83 @@ UAVObjectField::UAVObjectField(const QString & name, const QString & description
     constructorInitialize(name, description, units, type, elementNames, options, limits);
 }
 
+UAVObjectField::UAVObjectField(const Info *info)
+{
+    // The details are materialized by d() when first needed
+    baseInitialize(QString::fromLatin1(info->name), info->type, info->numElements);
+    this->info = info;
+}
+
+UAVObjectField::~UAVObjectField()
+{
+    // Details built from an Info are shared with the other instances
+    if (!info) {
+        delete details.load();
+    }
+}
+
+/**
+ * Get the details of the field. For fields described by an Info they are
+ * built on first use, once per Info, and kept for the life of the process.
+ */
+const UAVObjectField::Details &UAVObjectField::d() const
+{
+    const Details *current = details.loadAcquire();
+
+    if (current) {
+        return *current;
+    }
+
+    static QMutex sharedMutex;
+    static QHash<const Info *, const Details *> shared;
+    QMutexLocker locker(&sharedMutex);
+
+    current = shared.value(info);
+    if (!current) {
+        Details *built = new Details();
+        built->description = QCoreApplication::translate(info->context, info->description);
+        built->units = QString::fromLatin1(info->units);
+        for (quint32 n = 0; n < numElements; ++n) {
+            built->elementNames.append(info->elementNames ? QString::fromLatin1(info->elementNames[n]) : QString::number(n));
+        }
+        if (type == BITFIELD) {
+            built->options << tr("0") << tr("1");
+        } else {
+            for (quint32 n = 0; n < info->numOptions; ++n) {
+                built->options.append(QString::fromLatin1(info->options[n]));
+            }
+        }
+        limitsInitialize(built, QString::fromLatin1(info->limits));
+        shared.insert(info, built);
+        current = built;
+    }
+    details.storeRelease(current);
+    return *current;
+}
+
 void UAVObjectField::constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits)
+{
+    baseInitialize(name, type, elementNames.length());
+    Details *built = new Details();
+    built->description  = description;
+    built->units        = units;
+    built->elementNames = elementNames;
+    built->options = (type == BITFIELD) ? QStringList() << tr("0") << tr("1") : options;
+    limitsInitialize(built, limits);
+    details.store(built);
+}
+
+void UAVObjectField::baseInitialize(const QString & name, FieldType type, quint32 numElements)
 {
     // Copy params
-    this->name         = name;
-    this->description  = description;
-    this->units        = units;
-    this->type         = type;
-    this->options      = options;
-    this->numElements  = elementNames.length();
-    this->offset       = 0;
-    this->data         = NULL;
-    this->obj = NULL;
-    this->elementNames = elementNames;
+    this->name        = name;
+    this->type        = type;
+    this->numElements = numElements;
+    this->offset      = 0;
+    this->data        = NULL;
+    this->obj         = NULL;
+    this->info        = NULL;
+    this->details.store(NULL);
     // Set field size
     switch (type) {
     case INT8:
@@ -92,7 +159,6 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
         break;
     case BITFIELD:
         numBytesPerElement = sizeof(quint8);
-        this->options = QStringList() << tr("0") << tr("1");
         break;
     case STRING:
         numBytesPerElement = sizeof(quint8);
@@ -100,10 +166,9 @@ void UAVObjectField::constructorInitialize(const QString & name, const QString &
     default:
         numBytesPerElement = 0;
     }
-    limitsInitialize(limits);
 }
 
-void UAVObjectField::limitsInitialize(const QString &limits)
+void UAVObjectField::limitsInitialize(Details *details, const QString &limits) const
 {
     // Limit string format:
     // %        - start char
@@ -202,7 +267,7 @@ void UAVObjectField::limitsInitialize(const QString &limits)
                 }
             }
         }
-        elementLimits.insert(index, limitList);
+        details->elementLimits.insert(index, limitList);
         ++index;
     }
     // foreach(QList<LimitStruct> limitList, elementLimits) {
@@ -216,11 +281,13 @@ void UAVObjectField::limitsInitialize(const QString &limits)
 }
 bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    const Details &details = d();
+
+    if (!details.elementLimits.keys().contains(index)) {
         return true;
     }
 
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    foreach(LimitStruct struc, details.elementLimits.value(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             continue;
         }
@@ -350,7 +417,7 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 
                 break;
             case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()) && options.indexOf(var.toString()) <= options.indexOf(struc.values.at(1).toString()))) {
+                if (!(details.options.indexOf(var.toString()) >= details.options.indexOf(struc.values.at(0).toString()) && details.options.indexOf(var.toString()) <= details.options.indexOf(struc.values.at(1).toString()))) {
                     return false;
                 }
                 return true;
@@ -400,7 +467,7 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 
                 break;
             case ENUM:
-                if (!(options.indexOf(var.toString()) >= options.indexOf(struc.values.at(0).toString()))) {
+                if (!(details.options.indexOf(var.toString()) >= details.options.indexOf(struc.values.at(0).toString()))) {
                     return false;
                 }
                 return true;
@@ -443,7 +510,7 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 
                 break;
             case ENUM:
-                if (!(options.indexOf(var.toString()) <= options.indexOf(struc.values.at(0).toString()))) {
+                if (!(details.options.indexOf(var.toString()) <= details.options.indexOf(struc.values.at(0).toString()))) {
                     return false;
                 }
                 return true;
@@ -474,8 +541,8 @@ QString UAVObjectField::getLimitsAsString(quint32 index, int board)
 {
     QString limitString;
 
-    if (elementLimits.keys().contains(index)) {
-        foreach(LimitStruct struc, elementLimits.value(index)) {
+    if (d().elementLimits.keys().contains(index)) {
+        foreach(LimitStruct struc, d().elementLimits.value(index)) {
             if ((struc.board != board) && board != 0 && struc.board != 0) {
                 continue;
             }
@@ -524,10 +591,10 @@ QString UAVObjectField::getLimitsAsString(quint32 index, int board)
 
 QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (!d().elementLimits.keys().contains(index)) {
         return QVariant();
     }
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    foreach(LimitStruct struc, d().elementLimits.value(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             continue;
         }
@@ -551,10 +618,10 @@ QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 }
 QVariant UAVObjectField::getMinLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (!d().elementLimits.keys().contains(index)) {
         return QVariant();
     }
-    foreach(LimitStruct struc, elementLimits.value(index)) {
+    foreach(LimitStruct struc, d().elementLimits.value(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0) {
             return QVariant();
         }
@@ -629,7 +696,7 @@ QString UAVObjectField::getTypeAsString()
 
 QStringList UAVObjectField::getElementNames()
 {
-    return elementNames;
+    return d().elementNames;
 }
 
 UAVObject *UAVObjectField::getObject()
@@ -658,17 +725,17 @@ QString UAVObjectField::getName()
 
 QString UAVObjectField::getDescription()
 {
-    return description;
+    return d().description;
 }
 
 QString UAVObjectField::getUnits()
 {
-    return units;
+    return d().units;
 }
 
 QStringList UAVObjectField::getOptions()
 {
-    return options;
+    return d().options;
 }
 
 quint32 UAVObjectField::getNumElements()
@@ -703,7 +770,7 @@ QString UAVObjectField::toString()
     for (unsigned int n = 0; n < numElements; ++n) {
         sout.append(QString("%1 ").arg(getDouble(n)));
     }
-    sout.append(QString("] %1\n").arg(units));
+    sout.append(QString("] %1\n").arg(d().units));
     return sout;
 }
 
@@ -1023,11 +1090,11 @@ QVariant UAVObjectField::getValue(quint32 index)
     {
         quint8 tmpenum;
         memcpy(&tmpenum, &data[offset + numBytesPerElement * index], numBytesPerElement);
-        if (tmpenum >= options.length()) {
+        if (tmpenum >= d().options.length()) {
             qDebug() << "Invalid value for" << name;
             tmpenum = 0;
         }
-        return QVariant(options[tmpenum]);
+        return QVariant(d().options[tmpenum]);
 
         break;
     }
@@ -1080,7 +1147,7 @@ bool UAVObjectField::checkValue(const QVariant & value, quint32 index)
             break;
         case ENUM:
         {
-            qint8 tmpenum = options.indexOf(value.toString());
+            qint8 tmpenum = d().options.indexOf(value.toString());
             return (tmpenum < 0) ? false : true;
 
             break;
@@ -1151,7 +1218,7 @@ void UAVObjectField::setValue(const QVariant & value, quint32 index)
         }
         case ENUM:
         {
-            qint8 tmpenum = options.indexOf(value.toString());
+            qint8 tmpenum = d().options.indexOf(value.toString());
             // Default to 0 on invalid values.
             if (tmpenum < 0) {
                 tmpenum = 0;
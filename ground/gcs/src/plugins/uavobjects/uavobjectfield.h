@@ -35,6 +35,7 @@
 #include <QVariant>
 #include <QList>
 #include <QMap>
+#include <QAtomicPointer>
 
 class UAVObject;
 
@@ -54,8 +55,28 @@ public:
         int board;
     } LimitStruct;
 
+    /**
+     * Static description of a field. Generated objects keep one constant table
+     * of these per object type, the strings are only converted on first use
+     * and then shared by all the instances of the type.
+     */
+    struct Info {
+        const char *context; // translation context of the description
+        const char *name;
+        const char *description;
+        const char *units;
+        FieldType type;
+        quint32    numElements;
+        const char *const *elementNames; // NULL for the default "0", "1", ... names
+        quint32    numOptions;
+        const char *const *options;
+        const char *limits;
+    };
+
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, quint32 numElements, const QStringList & options, const QString & limits = QString());
     UAVObjectField(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString & limits = QString());
+    UAVObjectField(const Info *info);
+    ~UAVObjectField();
     void initialize(quint8 *data, quint32 dataOffset, UAVObject *obj);
     UAVObject *getObject();
     FieldType getType();
@@ -94,21 +115,29 @@ signals:
     void fieldUpdated(UAVObjectField *field);
 
 protected:
+    // The strings describing the field, rarely needed outside of the UI
+    struct Details {
+        QString     description;
+        QString     units;
+        QStringList elementNames;
+        QStringList options;
+        QMap<quint32, QList<LimitStruct> > elementLimits;
+    };
+
     QString name;
-    QString description;
-    QString units;
     FieldType type;
-    QStringList elementNames;
-    QStringList options;
     quint32 numElements;
     quint32 numBytesPerElement;
     quint32 offset;
     quint8 *data;
     UAVObject *obj;
-    QMap<quint32, QList<LimitStruct> > elementLimits;
+    const Info *info;
+    mutable QAtomicPointer<const Details> details;
+    const Details &d() const;
     void clear();
     void constructorInitialize(const QString & name, const QString & description, const QString & units, FieldType type, const QStringList & elementNames, const QStringList & options, const QString &limits);
-    void limitsInitialize(const QString &limits);
+    void baseInitialize(const QString & name, FieldType type, quint32 numElements);
+    void limitsInitialize(Details *details, const QString &limits) const;
 };
 
 #endif // UAVOBJECTFIELD_H
@@ -98,6 +98,7 @@ UAVOBJS = \
     $${UAVOBJ_XML_DIR}/magstate.xml \
     $${UAVOBJ_XML_DIR}/manualcontrolcommand.xml \
     $${UAVOBJ_XML_DIR}/manualcontrolsettings.xml \
+    $${UAVOBJ_XML_DIR}/mempoolstats.xml \
     $${UAVOBJ_XML_DIR}/mixersettings.xml \
     $${UAVOBJ_XML_DIR}/mixerstatus.xml \
     $${UAVOBJ_XML_DIR}/mpugyroaccelsettings.xml \
@@ -115,6 +116,7 @@ UAVOBJS = \
     $${UAVOBJ_XML_DIR}/pathstatus.xml \
     $${UAVOBJ_XML_DIR}/pathsummary.xml \
     $${UAVOBJ_XML_DIR}/perfcounter.xml \
+    $${UAVOBJ_XML_DIR}/perfcounterstats.xml \
     $${UAVOBJ_XML_DIR}/pidstatus.xml \
     $${UAVOBJ_XML_DIR}/poilearnsettings.xml \
     $${UAVOBJ_XML_DIR}/poilocation.xml \
@@ -39,5 +39,8 @@ enum ReceiveState {
     state_unescaped_e
 };
 
+#define SSP_MAX_WINDOW   16  // largest number of unacknowledged packets in windowed mode
+#define SSP_ACK_BUF_SIZE 8   // length + seq. no. + selective ack bitmap + CRC
+
 
 #endif // COMMON_H
@@ -26,7 +26,7 @@
  */
 #include "port.h"
 #include "delay.h"
-port::port(QString name) : mstatus(port::closed)
+port::port(QString name) : windowSize(0), txWindowBuf(NULL), rxWindowBuf(NULL), mstatus(port::closed)
 {
     timer.start();
     sport = new QSerialPort(name);
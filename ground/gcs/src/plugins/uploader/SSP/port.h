@@ -63,6 +63,21 @@ public:
     uint32_t RxError;
     uint32_t TxError;
     uint16_t flags;
+    uint8_t windowSize; // packets allowed in flight, offered to the other end on synchronise. 0 or 1 = stop and wait
+    uint8_t *txWindowBuf; // optional, windowSize * (txBufSize + 2) bytes. Without it sends stay one packet at a time
+    uint8_t *rxWindowBuf; // optional, (windowSize - 1) * (rxBufSize + 2) bytes to keep packets received out of order
+    // sliding window state, only used once a window has been negotiated by ssp_Synchronise
+    uint8_t window; // negotiated window, 0 = stop and wait
+    uint8_t txSlots; // number of transmit slots in use
+    uint8_t txHead; // oldest unacknowledged slot
+    uint8_t txCount; // number of unacknowledged slots
+    uint16_t txAcked; // slots acknowledged, possibly out of order
+    uint16_t txFastRetry; // slots already resent because a later packet was acknowledged
+    uint8_t txSlotSeqNo[SSP_MAX_WINDOW];
+    uint8_t txSlotRetry[SSP_MAX_WINDOW];
+    uint32_t txSlotTimeout[SSP_MAX_WINDOW];
+    uint8_t rxSlotSeqNo[SSP_MAX_WINDOW]; // sequence number kept in each receive slot, 0 = free
+    uint8_t ackBuf[SSP_ACK_BUF_SIZE]; // ACKs are built here so they never overwrite a packet waiting for its own ACK
     port(QString name);
     virtual ~port();
     portstatus status();
@@ -43,6 +43,9 @@
 #define SEQNUM   1
 #define DATA     2
 
+#define SEQ_SPAN       127 // number of data sequence numbers, 1..127
+#define WINDOW_REQUEST 'W' // first payload byte of a synch request (or its ACK) offering a window
+
 
 // Make larger sized integers from smaller sized integers
 #define MAKEWORD16(ub, lb)          ((uint16_t)0x0000 | ((uint16_t)(ub) << 8) | (uint16_t)(lb))
@@ -166,6 +169,10 @@ int16_t qssp::ssp_SendProcess()
 {
     int16_t value = SSP_TX_WAITING;
 
+    if (thisport->window) {
+        return sf_WindowSendProcess();
+    }
+
     if (thisport->SendState == SSP_AWAITING_ACK) {
         if (sf_CheckTimeout() == TRUE) {
             if (thisport->retryCount < thisport->maxRetryCount) {
@@ -278,6 +285,7 @@ uint16_t qssp::ssp_SendDataBlock(uint8_t *data, uint16_t length)
  * \return	SSP_TX_BUFOVERRUN = tried to send too much data
  * \return	SSP_TX_WAITING = data sent and waiting for an ack to arrive
  * \return	SSP_TX_BUSY = a packet has already been sent, but not yet acked
+ *                          (windowed mode: the window is full)
  *
  * \note
  *
@@ -286,6 +294,10 @@ int16_t qssp::ssp_SendData(const uint8_t *data, const uint16_t length)
 {
     int16_t value = SSP_TX_WAITING;
 
+    if (thisport->window) {
+        return sf_WindowSendData(data, length);
+    }
+
     if ((length + 2) > thisport->txBufSize) {
         // TRYING to send too much data.
         value = SSP_TX_BUFOVERRUN;
@@ -360,12 +372,17 @@ uint16_t qssp::ssp_Synchronise()
 {
     int16_t packet_status;
     uint16_t retval = FALSE;
+    const uint8_t request[] = { WINDOW_REQUEST, thisport->windowSize };
+
+    // back to stop and wait until the other end accepts a window again
+    sf_OpenWindow(0);
 
 #ifndef USE_SENDPACKET_DATA
     thisport->txSeqNo = 0; // make this zero to cause the other end to re-synch with us
     SETBIT(thisport->flags, SENT_SYNCH);
     // TODO - should this be using ssp_SendPacketData()??
-    sf_MakePacket(thisport->txBuf, NULL, 0, thisport->txSeqNo); // construct the packet
+    // construct the packet, older receivers ignore the window request
+    sf_MakePacket(thisport->txBuf, request, (thisport->windowSize > 1) ? sizeof(request) : 0, thisport->txSeqNo);
     sf_SendPacket();
     sf_SetSendTimeout();
     thisport->SendState = SSP_AWAITING_ACK;
@@ -405,16 +422,26 @@ uint16_t qssp::ssp_Synchronise()
  * Packet should be formed through the use of sf_MakePacket before calling this function.
  */
 void qssp::sf_SendPacket()
+{
+    sf_SendBuffer(thisport->txBuf);
+    thisport->retryCount++;
+}
+
+/*!
+ * \brief   sends out a preformatted packet from any buffer
+ * \param	buf = packet formed by sf_MakePacket
+ * \return  none.
+ */
+void qssp::sf_SendBuffer(const uint8_t *buf)
 {
     // add 3 to packet data length for: 1 length + 2 CRC (packet overhead)
-    uint8_t packetLen = thisport->txBuf[LENGTH] + 3;
+    uint16_t packetLen = buf[LENGTH] + 3;
 
     // use the raw serial write function so the SYNC byte does not get 'escaped'
     thisport->pfSerialWrite(SYNC);
-    for (uint8_t x = 0; x < packetLen; x++) {
-        sf_write_byte(thisport->txBuf[x]);
+    for (uint16_t x = 0; x < packetLen; x++) {
+        sf_write_byte(buf[x]);
     }
-    thisport->retryCount++;
 }
 
 
@@ -470,8 +497,8 @@ void qssp::sf_SendAckPacket(uint8_t seqNumber)
     uint8_t AckSeqNumber = SETBIT(seqNumber, ACK_BIT);
 
     // create the packet, note we pass AckSequenceNumber directly
-    sf_MakePacket(thisport->txBuf, NULL, 0, AckSeqNumber);
-    sf_SendPacket();
+    sf_MakePacket(thisport->ackBuf, NULL, 0, AckSeqNumber);
+    sf_SendBuffer(thisport->ackBuf);
     if (debug) {
         qDebug() << "Sent ACK PACKET:" << seqNumber;
     }
@@ -737,9 +764,21 @@ int16_t qssp::sf_ReceivePacket()
     int16_t value = FALSE;
 
     if (ISBITSET(thisport->rxBuf[SEQNUM], ACK_BIT)) {
-        // Received an ACK packet, need to check if it matches the previous sent packet
-        if ((thisport->rxBuf[SEQNUM] & 0x7F) == (thisport->txSeqNo & 0x7f)) {
-            // It matches the last packet sent by us
+        if (ISBITSET(thisport->flags, SENT_SYNCH) && (thisport->rxBuf[SEQNUM] & 0x7F) == 0) {
+            // ACK of our synch request, the payload tells if the other end accepted a window
+            CLEARBIT(thisport->flags, SENT_SYNCH);
+            if (thisport->rxBufLen >= 2 && thisport->rxBuf[DATA] == WINDOW_REQUEST) {
+                sf_OpenWindow(thisport->rxBuf[DATA + 1]);
+            }
+            SETBIT(thisport->txSeqNo, ACK_BIT);
+            thisport->SendState = SSP_ACKED;
+            if (debug) {
+                qDebug() << "Received SYNC ACK, window:" << thisport->window;
+            }
+        } else if (thisport->window) {
+            sf_WindowReceiveAck();
+        } else if ((thisport->rxBuf[SEQNUM] & 0x7F) == (thisport->txSeqNo & 0x7f)) {
+            // Received an ACK packet that matches the previous sent packet
             SETBIT(thisport->txSeqNo, ACK_BIT);
             thisport->SendState = SSP_ACKED;
             value = FALSE;
@@ -758,9 +797,22 @@ int16_t qssp::sf_ReceivePacket()
 #ifdef ACTIVE_SYNCH
             thisport->sendSynch = TRUE;
 #endif
-            sf_SendAckPacket(thisport->rxBuf[SEQNUM]);
+            if (thisport->rxBufLen >= 2 && thisport->rxBuf[DATA] == WINDOW_REQUEST) {
+                sf_OpenWindow(thisport->rxBuf[DATA + 1]);
+            } else {
+                sf_OpenWindow(0);
+            }
+            if (thisport->window) {
+                const uint8_t accept[] = { WINDOW_REQUEST, thisport->window };
+                sf_MakePacket(thisport->ackBuf, accept, sizeof(accept), ACK_BIT);
+                sf_SendBuffer(thisport->ackBuf);
+            } else {
+                sf_SendAckPacket(thisport->rxBuf[SEQNUM]);
+            }
             thisport->rxSeqNo   = 0;
             value = FALSE;
+        } else if (thisport->window) {
+            value = sf_WindowReceiveData();
         } else if (thisport->rxBuf[SEQNUM] == thisport->rxSeqNo) {
             // Already seen this packet, just ack it, don't act on the packet.
             sf_SendAckPacket(thisport->rxBuf[SEQNUM]);
@@ -805,6 +857,11 @@ qssp::qssp(port *info, bool debug) : debug(debug)
     thisport->RxError = 0;
     thisport->txSeqNo = 0;
     thisport->rxSeqNo = 0;
+    thisport->flags   = 0;
+    if (thisport->windowSize > SSP_MAX_WINDOW) {
+        thisport->windowSize = SSP_MAX_WINDOW;
+    }
+    sf_OpenWindow(0);
 }
 void qssp::pfCallBack(uint8_t *buf, uint16_t size)
 {
@@ -814,3 +871,296 @@ void qssp::pfCallBack(uint8_t *buf, uint16_t size)
         qDebug() << "receive callback" << buf[0] << buf[1] << buf[2] << buf[3] << buf[4];
     }
 }
+
+/*!
+ * \brief   number of packets that can be sent right now without getting SSP_TX_BUSY
+ * \return  free transmit slots, 0 or 1 in stop and wait mode
+ */
+uint16_t qssp::ssp_TxWindowFree()
+{
+    if (thisport->window) {
+        return thisport->txSlots - thisport->txCount;
+    }
+    return thisport->SendState == SSP_IDLE;
+}
+
+/*!
+ * \brief   negotiated window, 0 = stop and wait
+ */
+uint8_t qssp::ssp_Window()
+{
+    return thisport->window;
+}
+
+/*!
+ * \brief   next data sequence number, 1..127 then back to 1
+ */
+uint8_t qssp::sf_NextSeqNo(uint8_t seqNo)
+{
+    return ((seqNo & 0x7F) % SEQ_SPAN) + 1;
+}
+
+/*!
+ * \brief   number of sequence steps from 'from' to 'to'
+ *
+ * \note
+ * 0 and 127 are the same position, 0 only shows up right after a synchronise.
+ */
+uint8_t qssp::sf_SeqDistance(uint8_t from, uint8_t to)
+{
+    return ((to & 0x7F) % SEQ_SPAN + SEQ_SPAN - (from & 0x7F) % SEQ_SPAN) % SEQ_SPAN;
+}
+
+/*!
+ * \brief   switches between stop and wait and windowed mode, drops anything in flight
+ * \param	window = window offered by the other end, 0 = stop and wait
+ */
+void qssp::sf_OpenWindow(uint8_t window)
+{
+    if (window > thisport->windowSize) {
+        window = thisport->windowSize;
+    }
+    if (window < 2) {
+        window = 0;
+    }
+    thisport->window      = window;
+    thisport->txSlots     = (thisport->txWindowBuf != NULL) ? window : 1;
+    thisport->txHead      = 0;
+    thisport->txCount     = 0;
+    thisport->txAcked     = 0;
+    thisport->txFastRetry = 0;
+    memset(thisport->rxSlotSeqNo, 0, sizeof(thisport->rxSlotSeqNo));
+    if (window) {
+        // both ends count from the synchronise packet again
+        thisport->txSeqNo = 0;
+        thisport->rxSeqNo = 0;
+    }
+}
+
+uint8_t *qssp::sf_TxSlotBuf(uint8_t slot)
+{
+    if (thisport->txWindowBuf == NULL) {
+        return thisport->txBuf;
+    }
+    return thisport->txWindowBuf + slot * (thisport->txBufSize + 2);
+}
+
+uint8_t *qssp::sf_RxSlotBuf(uint8_t slot)
+{
+    return thisport->rxWindowBuf + slot * (thisport->rxBufSize + 2);
+}
+
+void qssp::sf_ResendSlot(uint8_t slot)
+{
+    sf_SendBuffer(sf_TxSlotBuf(slot));
+    thisport->txSlotRetry[slot]++;
+    thisport->txSlotTimeout[slot] = thisport->pfGetTime() + thisport->timeoutLen;
+}
+
+/*!
+ * \brief   windowed version of ssp_SendProcess, every slot has its own timeout.
+ * \return  SSP_TX_ACKED once all the slots have been acknowledged, otherwise same as ssp_SendProcess
+ */
+int16_t qssp::sf_WindowSendProcess()
+{
+    uint32_t current_time;
+
+    if (thisport->SendState == SSP_ACKED) {
+        SETBIT(thisport->flags, ACK_RECEIVED);
+        thisport->SendState = SSP_IDLE;
+        return SSP_TX_ACKED;
+    }
+    if (thisport->txCount == 0) {
+        thisport->SendState = SSP_IDLE;
+        return SSP_TX_IDLE;
+    }
+
+    current_time = thisport->pfGetTime();
+    for (uint8_t n = 0; n < thisport->txCount; n++) {
+        uint8_t slot = (thisport->txHead + n) % thisport->txSlots;
+        if (ISBITSET(thisport->txAcked, 1 << slot) || current_time <= thisport->txSlotTimeout[slot]) {
+            continue;
+        }
+        if (thisport->txSlotRetry[slot] < thisport->maxRetryCount) {
+            sf_ResendSlot(slot);
+        } else {
+            // Give up on the whole window, the other end will not deliver anything past this packet
+            thisport->txCount     = 0;
+            thisport->txAcked     = 0;
+            thisport->txFastRetry = 0;
+            CLEARBIT(thisport->flags, ACK_RECEIVED);
+            thisport->SendState   = SSP_IDLE;
+            if (debug) {
+                qDebug() << "Send TimeOut! seq=" << thisport->txSlotSeqNo[slot];
+            }
+            return SSP_TX_TIMEOUT;
+        }
+    }
+    return SSP_TX_WAITING;
+}
+
+/*!
+ * \brief   windowed version of ssp_SendData, queues the packet in the next free slot.
+ */
+int16_t qssp::sf_WindowSendData(const uint8_t *data, const uint16_t length)
+{
+    uint8_t slot;
+
+    if ((length + 2) > thisport->txBufSize) {
+        return SSP_TX_BUFOVERRUN;
+    }
+    if (thisport->txCount >= thisport->txSlots) {
+        return SSP_TX_BUSY;
+    }
+
+    slot = (thisport->txHead + thisport->txCount) % thisport->txSlots;
+    thisport->txSeqNo = sf_NextSeqNo(thisport->txSeqNo);
+    thisport->txSlotSeqNo[slot] = thisport->txSeqNo;
+    thisport->txSlotRetry[slot] = 0;
+    thisport->txCount++;
+    CLEARBIT(thisport->flags, ACK_RECEIVED);
+    thisport->SendState = SSP_AWAITING_ACK;
+
+    sf_MakePacket(sf_TxSlotBuf(slot), data, length, thisport->txSeqNo);
+    sf_ResendSlot(slot);
+    return SSP_TX_WAITING;
+}
+
+/*!
+ * \brief   delivers an in sequence packet and everything kept behind it, keeps packets ahead of a gap.
+ * \return  true = at least one new packet was delivered
+ */
+int16_t qssp::sf_WindowReceiveData()
+{
+    uint8_t seqNo    = thisport->rxBuf[SEQNUM];
+    uint8_t distance = sf_SeqDistance(sf_NextSeqNo(thisport->rxSeqNo), seqNo);
+    uint8_t rxSlots  = thisport->window - 1;
+    int16_t value    = FALSE;
+
+    if (distance == 0) {
+        thisport->rxSeqNo = seqNo;
+        if (debug) {
+            qDebug() << "Received DATA PACKET seq=" << seqNo;
+        }
+        pfCallBack(&(thisport->rxBuf[DATA]), thisport->rxBufLen);
+        value = TRUE;
+
+        // the gap is filled, hand over what was received after it. Slots are not kept in order.
+        uint8_t found = (thisport->rxWindowBuf != NULL);
+        while (found) {
+            found = FALSE;
+            for (uint8_t slot = 0; slot < rxSlots; slot++) {
+                if (thisport->rxSlotSeqNo[slot] == sf_NextSeqNo(thisport->rxSeqNo)) {
+                    uint8_t *buf = sf_RxSlotBuf(slot);
+                    thisport->rxSeqNo = thisport->rxSlotSeqNo[slot];
+                    thisport->rxSlotSeqNo[slot] = 0;
+                    pfCallBack(&buf[DATA], buf[LENGTH] - 1);
+                    found = TRUE;
+                }
+            }
+        }
+    } else if (distance < thisport->window && thisport->rxWindowBuf != NULL) {
+        uint8_t freeSlot = 0xFF;
+        for (uint8_t slot = 0; slot < rxSlots; slot++) {
+            if (thisport->rxSlotSeqNo[slot] == seqNo) {
+                freeSlot = 0xFF;
+                break;
+            } else if (thisport->rxSlotSeqNo[slot] == 0 && freeSlot == 0xFF) {
+                freeSlot = slot;
+            }
+        }
+        if (freeSlot != 0xFF) {
+            memcpy(sf_RxSlotBuf(freeSlot), thisport->rxBuf, thisport->rxBufLen + DATA);
+            thisport->rxSlotSeqNo[freeSlot] = seqNo;
+        }
+    }
+    // anything else is a packet we already delivered, the ACK below tells the sender again
+    sf_SendWindowAck();
+    return value;
+}
+
+/*!
+ * \brief   sends a cumulative ACK, with the selective ACK bitmap when packets are kept out of order
+ */
+void qssp::sf_SendWindowAck()
+{
+    uint8_t expected  = sf_NextSeqNo(thisport->rxSeqNo);
+    uint16_t received = 0;
+    uint8_t sack[2];
+
+    for (uint8_t slot = 0; slot < thisport->window - 1; slot++) {
+        if (thisport->rxSlotSeqNo[slot] != 0) {
+            uint8_t distance = sf_SeqDistance(expected, thisport->rxSlotSeqNo[slot]);
+            if (distance >= 1 && distance <= SSP_MAX_WINDOW) {
+                SETBIT(received, 1 << (distance - 1));
+            }
+        }
+    }
+    sack[0] = LOWERBYTE(received);
+    sack[1] = UPPERBYTE(received);
+    sf_MakePacket(thisport->ackBuf, sack, received ? sizeof(sack) : 0, thisport->rxSeqNo | ACK_BIT);
+    sf_SendBuffer(thisport->ackBuf);
+}
+
+/*!
+ * \brief   releases the slots covered by a cumulative/selective ACK and slides the window
+ */
+void qssp::sf_WindowReceiveAck()
+{
+    uint8_t cumulative = thisport->rxBuf[SEQNUM] & 0x7F;
+    uint8_t expected   = sf_NextSeqNo(cumulative);
+    uint16_t received  = 0;
+    uint8_t lastKept   = 0;
+    uint8_t resend     = 0;
+    uint8_t slot;
+    uint8_t n;
+
+    if (thisport->rxBufLen >= 2) {
+        received = MAKEWORD16(thisport->rxBuf[DATA + 1], thisport->rxBuf[DATA]);
+    }
+
+    for (n = 0; n < thisport->txCount; n++) {
+        uint8_t distance;
+        slot = (thisport->txHead + n) % thisport->txSlots;
+        if (sf_SeqDistance(thisport->txSlotSeqNo[slot], cumulative) < thisport->window) {
+            SETBIT(thisport->txAcked, 1 << slot);
+            continue;
+        }
+        distance = sf_SeqDistance(expected, thisport->txSlotSeqNo[slot]);
+        if (distance >= 1 && distance <= SSP_MAX_WINDOW && ISBITSET(received, 1 << (distance - 1))) {
+            SETBIT(thisport->txAcked, 1 << slot);
+            lastKept = n + 1;
+        }
+    }
+
+    // a packet sent before one that made it through is most likely lost, resend it once right away.
+    // An ACK that does not move the window means the other end got a packet it could not deliver,
+    // then the oldest one is the suspect.
+    if (lastKept > 0) {
+        resend = lastKept - 1;
+    } else if (thisport->txCount > 0 && ISBITCLEAR(thisport->txAcked, 1 << thisport->txHead)) {
+        resend = 1;
+    }
+    for (n = 0; n < resend; n++) {
+        slot = (thisport->txHead + n) % thisport->txSlots;
+        if (ISBITCLEAR(thisport->txAcked, 1 << slot) && ISBITCLEAR(thisport->txFastRetry, 1 << slot)) {
+            SETBIT(thisport->txFastRetry, 1 << slot);
+            sf_ResendSlot(slot);
+            if (debug) {
+                qDebug() << "Resending DATA PACKET:" << thisport->txSlotSeqNo[slot];
+            }
+        }
+    }
+
+    if (thisport->txCount > 0 && ISBITSET(thisport->txAcked, 1 << thisport->txHead)) {
+        while (thisport->txCount > 0 && ISBITSET(thisport->txAcked, 1 << thisport->txHead)) {
+            CLEARBIT(thisport->txAcked, 1 << thisport->txHead);
+            CLEARBIT(thisport->txFastRetry, 1 << thisport->txHead);
+            thisport->txHead = (thisport->txHead + 1) % thisport->txSlots;
+            thisport->txCount--;
+        }
+        if (thisport->txCount == 0) {
+            thisport->SendState = SSP_ACKED;
+        }
+    }
+}
@@ -96,6 +96,19 @@ private:
     void        sf_SendAckPacket(uint8_t seqNumber);
     void     sf_MakePacket(uint8_t *buf, const uint8_t *pdata, uint16_t length, uint8_t seqNo);
     int16_t     sf_ReceivePacket();
+
+    uint8_t     sf_NextSeqNo(uint8_t seqNo);
+    uint8_t     sf_SeqDistance(uint8_t from, uint8_t to);
+    void        sf_SendBuffer(const uint8_t *buf);
+    void        sf_OpenWindow(uint8_t window);
+    uint8_t *sf_TxSlotBuf(uint8_t slot);
+    uint8_t *sf_RxSlotBuf(uint8_t slot);
+    void        sf_ResendSlot(uint8_t slot);
+    int16_t     sf_WindowSendProcess();
+    int16_t     sf_WindowSendData(const uint8_t *data, const uint16_t length);
+    int16_t     sf_WindowReceiveData();
+    void        sf_WindowReceiveAck();
+    void        sf_SendWindowAck();
     uint16_t ssp_SendDataBlock(uint8_t *data, uint16_t length);
     bool debug;
 public:
@@ -108,6 +121,8 @@ public:
     void        ssp_Init(const PortConfig_t *const info);
     int16_t             ssp_ReceiveByte();
     uint16_t    ssp_Synchronise();
+    uint16_t    ssp_TxWindowFree();
+    uint8_t     ssp_Window();
     qssp(port *info, bool debug);
 };
 
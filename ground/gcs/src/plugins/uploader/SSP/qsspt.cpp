@@ -26,39 +26,83 @@
  */
 #include "qsspt.h"
 
-qsspt::qsspt(port *info, bool debug) : qssp(info, debug), endthread(false), datapending(false), debug(debug)
+qsspt::qsspt(port *info, bool debug) : qssp(info, debug), endthread(false), datapending(false), sendfailed(false), sendstatus(SSP_TX_IDLE), debug(debug)
 {}
 
 void qsspt::run()
 {
-    while (!endthread) {
+    QTime drain;
+
+    while (true) {
+        // let the packets still in the window reach the other end before stopping
+        if (endthread) {
+            if (!drain.isValid()) {
+                drain.start();
+            }
+            if (sendstatus != SSP_TX_WAITING || drain.elapsed() > DRAIN_TIMEOUT) {
+                break;
+            }
+        }
         receivestatus = this->ssp_ReceiveProcess();
         sendstatus    = this->ssp_SendProcess();
+        if (sendstatus == SSP_TX_TIMEOUT) {
+            // the window was dropped, both ends have to count from zero again
+            if (this->ssp_Window() && !endthread) {
+                this->ssp_Synchronise();
+            }
+            sendbufmutex.lock();
+            datapending = false;
+            sendbufmutex.unlock();
+            msendwait.lock();
+            sendfailed = true;
+            sendwait.wakeAll();
+            msendwait.unlock();
+            continue;
+        }
         msleep(1);
+        bool queued = false;
         sendbufmutex.lock();
-        if (datapending && receivestatus == SSP_TX_IDLE) {
+        if (datapending && receivestatus == SSP_TX_IDLE && this->ssp_TxWindowFree() > 0) {
             this->ssp_SendData(mbuf, msize);
             datapending = false;
+            queued = true;
         }
         sendbufmutex.unlock();
-        if (sendstatus == SSP_TX_ACKED) {
+        // with a window the packet is copied to its slot, the caller does not need to wait for the ACK
+        if (sendstatus == SSP_TX_ACKED || (queued && this->ssp_Window())) {
+            msendwait.lock();
             sendwait.wakeAll();
+            msendwait.unlock();
         }
     }
 }
 bool qsspt::sendData(uint8_t *buf, uint16_t size)
 {
+    // held until wait() so that the wake up cannot happen before we wait
+    QMutexLocker locker(&msendwait);
+
     if (datapending) {
         return false;
     }
+    // a packet sent earlier in the window was never acknowledged, the transfer is broken
+    if (sendfailed) {
+        sendfailed = false;
+        return false;
+    }
     sendbufmutex.lock();
     datapending = true;
     mbuf  = buf;
     msize = size;
     sendbufmutex.unlock();
-    msendwait.lock();
-    sendwait.wait(&msendwait, 10000);
-    msendwait.unlock();
+    bool woken = sendwait.wait(&msendwait, 10000);
+    if (!woken || sendfailed) {
+        // buf belongs to the caller again, make sure it is not sent later
+        sendbufmutex.lock();
+        datapending = false;
+        sendbufmutex.unlock();
+        sendfailed = false;
+        return false;
+    }
     return true;
 }
 
@@ -95,5 +139,5 @@ int qsspt::read_Packet(void *data)
 qsspt::~qsspt()
 {
     endthread = true;
-    wait(1000);
+    wait(DRAIN_TIMEOUT + 1000);
 }
@@ -32,6 +32,7 @@
 #include <QQueue>
 #include <QWaitCondition>
 #include <QMutex>
+#include <QTime>
 class qsspt : public qssp, public QThread {
 public:
     qsspt(port *info, bool debug);
@@ -41,6 +42,9 @@ public:
     ~qsspt();
     bool sendData(uint8_t *buf, uint16_t size);
 private:
+    // how long the thread keeps running on exit to get the window acknowledged (ms)
+    static const int DRAIN_TIMEOUT = 500;
+
     virtual void pfCallBack(uint8_t *, uint16_t);
     uint8_t *mbuf;
     uint16_t msize;
@@ -49,6 +53,7 @@ private:
     QMutex sendbufmutex;
     bool endthread;
     bool datapending;
+    bool sendfailed;
     uint16_t sendstatus;
     uint16_t receivestatus;
     QWaitCondition sendwait;
@@ -27,6 +27,8 @@
 
 #include "op_dfu.h"
 #include <cmath>
+#include <QtEndian>
+#include <utils/crc.h>
 #include <qwaitcondition.h>
 #include <QMetaType>
 #include <QtWidgets/QApplication>
@@ -43,12 +45,15 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
 
     if (use_serial) {
         info = new port(portname);
-        info->rxBuf      = sspRxBuf;
-        info->rxBufSize  = MAX_PACKET_DATA_LEN;
-        info->txBuf      = sspTxBuf;
-        info->txBufSize  = MAX_PACKET_DATA_LEN;
-        info->max_retry  = 10;
-        info->timeoutLen = 1000;
+        info->rxBuf       = sspRxBuf;
+        info->rxBufSize   = MAX_PACKET_DATA_LEN;
+        info->txBuf       = sspTxBuf;
+        info->txBufSize   = MAX_PACKET_DATA_LEN;
+        info->max_retry   = 10;
+        info->timeoutLen  = 1000;
+        info->windowSize  = SSP_WINDOW_SIZE;
+        info->txWindowBuf = sspTxWindowBuf;
+        info->rxWindowBuf = sspRxWindowBuf;
         if (info->status() != port::open) {
             cout << "Could not open serial port\n";
             mready = false;
@@ -67,7 +72,7 @@ DFUObject::DFUObject(bool _debug, bool _use_serial, QString portname) :
             mready = false;
             return;
         }
-        qDebug() << "SYNC Succeded";
+        qDebug() << "SYNC Succeded, window:" << serialhandle->ssp_Window();
         serialhandle->start();
     } else {
         mready = false;
@@ -179,8 +184,10 @@ bool DFUObject::enterDFU(int const &devNumber)
    Tells the board to get ready for an upload. It will in particular
    erase the memory to make room for the data. You will have to query
    its status to wait until erase is done before doing the actual upload.
+   With command Delta_Start nothing is erased, see ErasePage.
  */
-bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const & type, quint32 crc)
+bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const & type, quint32 crc,
+                            OP_DFU::Commands command)
 {
     int lastPacketCount;
     qint32 numberOfPackets = numberOfBytes / 4 / 14;
@@ -194,7 +201,7 @@ bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const &
     }
     char buf[BUF_LEN];
     buf[0]  = 0x02; // reportID
-    buf[1]  = setStartBit(OP_DFU::Upload); // DFU Command
+    buf[1]  = setStartBit(command); // DFU Command
     buf[2]  = numberOfPackets >> 24; // DFU Count
     buf[3]  = numberOfPackets >> 16; // DFU Count
     buf[4]  = numberOfPackets >> 8; // DFU Count
@@ -210,7 +217,9 @@ bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const &
     }
 
     int result = sendData(buf, BUF_LEN);
-    delay::msleep(1000);
+    if (command == OP_DFU::Upload) {
+        delay::msleep(1000);
+    }
 
     if (debug) {
         qDebug() << result << " bytes sent";
@@ -221,12 +230,116 @@ bool DFUObject::StartUpload(qint32 const & numberOfBytes, TransferTypes const &
     return false;
 }
 
+/**
+   Asks the bootloader for the CRC of every erase unit of the firmware bank.
+   Returns false if the bootloader does not report any.
+ */
+bool DFUObject::PageCRCs(QList<OP_DFU::page> & pages)
+{
+    char buf[BUF_LEN];
+    int total = 1;
+
+    pages.clear();
+    while (pages.size() < total) {
+        memset(buf, 0, BUF_LEN);
+        buf[0] = 0x02; // reportID
+        buf[1] = OP_DFU::Req_PageCRCs; // DFU Command
+        buf[2] = pages.size() >> 24; // first page
+        buf[3] = pages.size() >> 16;
+        buf[4] = pages.size() >> 8;
+        buf[5] = pages.size();
+        if (sendData(buf, BUF_LEN) < 1) {
+            return false;
+        }
+        if (receiveData(buf, BUF_LEN) < 1 || buf[1] != OP_DFU::Rep_PageCRCs) {
+            return false;
+        }
+        total = (quint8)buf[6] << 8 | (quint8)buf[7];
+        int entries = (quint8)buf[8];
+        if (entries == 0 || entries > PAGE_CRCS_PER_PACKET) {
+            return false;
+        }
+        for (int x = 0; x < entries; ++x) {
+            quint8 *entry = (quint8 *)&buf[9 + 12 * x];
+            OP_DFU::page page;
+            page.Offset = (quint32)entry[0] << 24 | entry[1] << 16 | entry[2] << 8 | entry[3];
+            page.Size   = (quint32)entry[4] << 24 | entry[5] << 16 | entry[6] << 8 | entry[7];
+            page.CRC    = (quint32)entry[8] << 24 | entry[9] << 16 | entry[10] << 8 | entry[11];
+            pages.append(page);
+        }
+    }
+    if (debug) {
+        qDebug() << "Firmware bank has" << pages.size() << "pages";
+    }
+    return true;
+}
+
+/**
+   Compares the new firmware with the page CRCs reported by the bootloader.
+   The page holding the description is always changed as the description
+   is uploaded again after the firmware. Marks the upload packets that
+   overlap a changed page.
+ */
+bool DFUObject::ChangedPages(QByteArray const & fw, int device, QList<OP_DFU::page> & changed, QBitArray & packets)
+{
+    QList<OP_DFU::page> pages;
+
+    if (!PageCRCs(pages)) {
+        return false;
+    }
+
+    quint32 sizeOfCode = devices[device].SizeOfCode;
+    QByteArray padded  = fw;
+    padded.append(QByteArray(sizeOfCode - fw.length(), 255));
+    const quint8 *data = (const quint8 *)padded.constData();
+
+    qint32 numberOfPackets = (fw.length() + 14 * 4 - 1) / (14 * 4);
+    changed.clear();
+    packets = QBitArray(numberOfPackets);
+    foreach(const OP_DFU::page &page, pages) {
+        if (page.Offset + page.Size <= sizeOfCode
+            && page.CRC == Utils::Crc::updateCRC32Words(0xFFFFFFFF, data + page.Offset, page.Size / 4)) {
+            continue;
+        }
+        changed.append(page);
+        for (qint32 x = page.Offset / (14 * 4); x < numberOfPackets && (quint32)x * 14 * 4 < page.Offset + page.Size; ++x) {
+            packets.setBit(x);
+        }
+    }
+    if (debug) {
+        qDebug() << changed.size() << "of" << pages.size() << "pages changed," << packets.count(true) << "packets to send";
+    }
+    return true;
+}
+
+/**
+   Erases the page at offset of a delta upload, waits for the erase to complete
+ */
+bool DFUObject::ErasePage(quint32 offset)
+{
+    char buf[BUF_LEN];
+
+    memset(buf, 0, BUF_LEN);
+    buf[0] = 0x02; // reportID
+    buf[1] = OP_DFU::Erase_Page; // DFU Command
+    buf[2] = offset >> 24; // DFU Count
+    buf[3] = offset >> 16; // DFU Count
+    buf[4] = offset >> 8; // DFU Count
+    buf[5] = offset; // DFU Count
+    if (sendData(buf, BUF_LEN) < 1) {
+        return false;
+    }
+    // the bootloader only answers once the erase is done
+    return StatusRequest() == OP_DFU::uploading;
+}
+
 
 /**
    Does the actual data upload to the board. Needs to be called once the
    board is ready to accept data following a StartUpload command, and it is erased.
+   For a delta upload only the packets set in packets are sent.
  */
-bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
+bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data, const QBitArray *packets)
 {
     int lastPacketCount;
     qint32 numberOfPackets = numberOfBytes / 4 / 14;
@@ -247,8 +360,13 @@ bool DFUObject::UploadData(qint32 const & numberOfBytes, QByteArray & data)
     int packetsize;
     float percentage;
     int laspercentage = 0;
+    int toSend = packets ? packets->count(true) : numberOfPackets;
+    int sent   = 0;
     for (qint32 packetcount = 0; packetcount < numberOfPackets; ++packetcount) {
-        percentage = (float)(packetcount + 1) / numberOfPackets * 100;
+        if (packets && !packets->testBit(packetcount)) {
+            continue;
+        }
+        percentage = (float)(++sent) / toSend * 100;
         if (laspercentage != (int)percentage) {
             printProgBar((int)percentage, "UPLOADING");
         }
@@ -637,8 +755,9 @@ bool DFUObject::findDevices()
     if (buf[1] == OP_DFU::Rep_Capabilities) {
         for (int x = 0; x < numberOfDevices; ++x) {
             device dev;
-            dev.Readable = (bool)(RWFlags >> (x * 2) & 1);
-            dev.Writable = (bool)(RWFlags >> (x * 2 + 1) & 1);
+            dev.Readable    = (bool)(RWFlags >> (x * 2) & 1);
+            dev.Writable    = (bool)(RWFlags >> (x * 2 + 1) & 1);
+            dev.DeltaUpload = false;
             devices.append(dev);
             buf[0] = 0x02; // reportID
             buf[1] = OP_DFU::Req_Capabilities; // DFU Command
@@ -654,8 +773,9 @@ bool DFUObject::findDevices()
             receiveData(buf, BUF_LEN);
             devices[x].ID = buf[14];
             devices[x].ID = devices[x].ID << 8 | (quint8)buf[15];
-            devices[x].BL_Version = buf[7];
-            devices[x].SizeOfDesc = buf[8];
+            devices[x].BL_Version  = buf[7];
+            devices[x].SizeOfDesc  = buf[8];
+            devices[x].DeltaUpload = buf[DFU_CAPS] & DFU_CAP_DELTA_UPLOAD;
 
             quint32 aux;
             aux = (quint8)buf[10];
@@ -683,6 +803,7 @@ bool DFUObject::findDevices()
                 qDebug() << "Device SizeOfDesc=" << devices[x].SizeOfDesc;
                 qDebug() << "BL Version=" << devices[x].BL_Version;
                 qDebug() << "FW CRC=" << devices[x].FW_CRC;
+                qDebug() << "Delta upload=" << devices[x].DeltaUpload;
             }
         }
     }
@@ -774,7 +895,12 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
         qDebug() << "NEW FIRMWARE CRC=" << crc;
     }
 
-    if (!StartUpload(arr.length(), OP_DFU::FW, crc)) {
+    // Only rewrite the pages that differ from what is on the board
+    QList<OP_DFU::page> changed;
+    QBitArray packets;
+    bool delta = devices[device].DeltaUpload && ChangedPages(arr, device, changed, packets);
+
+    if (!StartUpload(arr.length(), OP_DFU::FW, crc, delta ? OP_DFU::Delta_Start : OP_DFU::Upload)) {
         ret = StatusRequest();
         if (debug) {
             qDebug() << "StartUpload failed";
@@ -783,7 +909,11 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
         return ret;
     }
 
-    emit operationProgress(QString("Erasing, please wait..."));
+    if (delta) {
+        emit operationProgress(QString("Erasing %1 changed pages, please wait...").arg(changed.size()));
+    } else {
+        emit operationProgress(QString("Erasing, please wait..."));
+    }
 
     if (debug) {
         qDebug() << "Erasing memory";
@@ -806,8 +936,18 @@ OP_DFU::Status DFUObject::UploadFirmwareT(const QString &sfile, const bool &veri
         }
     }
 
+    foreach(const OP_DFU::page &page, changed) {
+        if (!ErasePage(page.Offset)) {
+            ret = StatusRequest();
+            if (debug) {
+                qDebug() << "Erase of page at" << page.Offset << "failed:" << StatusToString(ret);
+            }
+            return ret;
+        }
+    }
+
     emit operationProgress(QString("Uploading firmware"));
-    if (!UploadData(arr.length(), arr)) {
+    if (!UploadData(arr.length(), arr, delta ? &packets : NULL)) {
         ret = StatusRequest();
         if (debug) {
             qDebug() << "Upload failed (upload data)";
@@ -981,30 +1121,12 @@ void DFUObject::printProgBar(int const & percent, QString const & label)
  */
 quint32 DFUObject::CRC32WideFast(quint32 Crc, quint32 Size, quint32 *Buffer)
 {
-    // Size = Size >> 2; // /4  Size passed in as a byte count, assumed to be a multiple of 4
-
+    // Size is a word count, the words are in host order
     while (Size--) {
-        static const quint32 CrcTable[16] = { // Nibble lookup table for 0x04C11DB7 polynomial
-            0x00000000, 0x04C11DB7, 0x09823B6E, 0x0D4326D9, 0x130476DC, 0x17C56B6B, 0x1A864DB2, 0x1E475005,
-            0x2608EDB8, 0x22C9F00F, 0x2F8AD6D6, 0x2B4BCB61, 0x350C9B64, 0x31CD86D3, 0x3C8EA00A, 0x384FBDBD
-        };
-
-        Crc     = Crc ^ *((quint32 *)Buffer); // Apply all 32-bits
-
-        Buffer += 1;
-
-        // Process 32-bits, 4 at a time, or 8 rounds
-
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28]; // Assumes 32-bit reg, masking index to 4-bits
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28]; // 0x04C11DB7 Polynomial used in STM32
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
-        Crc = (Crc << 4) ^ CrcTable[Crc >> 28];
+        quint8 word[4];
+        qToLittleEndian<quint32>(*Buffer++, word);
+        Crc = Utils::Crc::updateCRC32Words(Crc, word, 1);
     }
-
     return Crc;
 }
 
@@ -1016,23 +1138,7 @@ quint32 DFUObject::CRCFromQBArray(QByteArray array, quint32 Size)
     quint32 pad = Size - array.length();
 
     array.append(QByteArray(pad, 255));
-    quint32 *t  = new quint32[Size / 4];
-    for (int x = 0; x < array.length() / 4; x++) {
-        quint32 aux = 0;
-        aux  = (char)array[x * 4 + 3] & 0xFF;
-        aux  = aux << 8;
-        aux += (char)array[x * 4 + 2] & 0xFF;
-        aux  = aux << 8;
-        aux += (char)array[x * 4 + 1] & 0xFF;
-        aux  = aux << 8;
-        aux += (char)array[x * 4 + 0] & 0xFF;
-        t[x] = aux;
-    }
-    quint32 ret = DFUObject::CRC32WideFast(0xFFFFFFFF, Size / 4, t);
-
-    delete[] t;
-
-    return ret;
+    return Utils::Crc::updateCRC32Words(0xFFFFFFFF, (const quint8 *)array.constData(), Size / 4);
 }
 
 
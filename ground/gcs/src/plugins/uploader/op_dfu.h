@@ -13,6 +13,7 @@
 #include <QMetaType>
 #include <QCryptographicHash>
 #include <QList>
+#include <QBitArray>
 #include <QVariant>
 #include <iostream>
 #include "delay.h"
@@ -29,6 +30,11 @@ using namespace std;
 
 #define MAX_PACKET_DATA_LEN 255
 #define MAX_PACKET_BUF_SIZE (1 + 1 + MAX_PACKET_DATA_LEN + 2)
+#define SSP_WINDOW_SIZE     8 // packets in flight, bootloaders without window support fall back to stop and wait
+
+#define DFU_CAPS             16 // capability flags in the device capabilities reply, 0 on older bootloaders
+#define DFU_CAP_DELTA_UPLOAD 0x01
+#define PAGE_CRCS_PER_PACKET 4
 
 namespace OP_DFU {
 enum TransferTypes {
@@ -86,6 +92,10 @@ enum Commands {
     Download, // 10
     Status_Request, // 11
     Status_Rep, // 12
+    Req_PageCRCs, // 13
+    Rep_PageCRCs, // 14
+    Delta_Start, // 15
+    Erase_Page, // 16
 };
 
 enum eBoardType {
@@ -106,6 +116,14 @@ struct device {
     quint32 SizeOfCode;
     bool    Readable;
     bool    Writable;
+    bool    DeltaUpload;
+};
+
+// One erase unit of the firmware bank, offset from the start of the bank
+struct page {
+    quint32 Offset;
+    quint32 Size;
+    quint32 CRC;
 };
 
 
@@ -180,6 +198,8 @@ private:
     int receiveData(void *data, int size);
     uint8_t sspTxBuf[MAX_PACKET_BUF_SIZE];
     uint8_t sspRxBuf[MAX_PACKET_BUF_SIZE];
+    uint8_t sspTxWindowBuf[SSP_WINDOW_SIZE * (MAX_PACKET_DATA_LEN + 2)];
+    uint8_t sspRxWindowBuf[(SSP_WINDOW_SIZE - 1) * (MAX_PACKET_DATA_LEN + 2)];
     port *info;
 
 
@@ -192,8 +212,12 @@ private:
 
     void CopyWords(char *source, char *destination, int count);
     void printProgBar(int const & percent, QString const & label);
-    bool StartUpload(qint32 const &numberOfBytes, TransferTypes const & type, quint32 crc);
-    bool UploadData(qint32 const & numberOfPackets, QByteArray & data);
+    bool StartUpload(qint32 const &numberOfBytes, TransferTypes const & type, quint32 crc,
+                     OP_DFU::Commands command = OP_DFU::Upload);
+    bool UploadData(qint32 const & numberOfPackets, QByteArray & data, const QBitArray *packets = NULL);
+    bool PageCRCs(QList<OP_DFU::page> & pages);
+    bool ChangedPages(QByteArray const & fw, int device, QList<OP_DFU::page> & changed, QBitArray & packets);
+    bool ErasePage(quint32 offset);
 
     // Thread management:
     // Same as startDownload except that we store in an external array:
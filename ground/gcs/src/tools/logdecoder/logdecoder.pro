@@ -0,0 +1,39 @@
+#
+# Headless UAVObject log decoder and exporter.
+# Copyright (c) 2016, The LibrePilot Team, http://www.librepilot.org
+#
+
+include(../../../gcs.pri)
+include(../../plugins/uavobjects/uavobjects.pri)
+
+TEMPLATE = app
+TARGET   = logdecoder
+DESTDIR  = $$GCS_APP_PATH
+
+QT      -= gui
+CONFIG  += console
+CONFIG  -= app_bundle
+
+isEmpty(PROVIDER):PROVIDER = "$$ORG_BIG_NAME"
+
+# UAVObjects and its dependencies are plugins, not plain libraries
+LIBS += -L$$GCS_PLUGIN_PATH/$$PROVIDER
+
+HEADERS += \
+    logindex.h \
+    objectexporter.h
+
+SOURCES += \
+    main.cpp \
+    logindex.cpp \
+    objectexporter.cpp
+
+!macx:!win32 {
+    QMAKE_RPATHDIR  = $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_LIBRARY_PATH, $$GCS_APP_PATH))
+    QMAKE_RPATHDIR += $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_PLUGIN_PATH/$$PROVIDER, $$GCS_APP_PATH))
+    QMAKE_RPATHDIR += $$shell_quote(\$$ORIGIN/$$relative_path($$GCS_QT_LIBRARY_PATH, $$GCS_APP_PATH))
+    include(../../rpath.pri)
+
+    target.path = /bin
+    INSTALLS   += target
+}
@@ -0,0 +1,266 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logindex.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Headless log decoder
+ * @{
+ * @brief Indexes the UAVObject packets found in a GCS or on-board log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logindex.h"
+
+#include "uavobjectmanager.h"
+#include "debuglogentry.h"
+
+#include <utils/crc.h>
+
+#include <QtEndian>
+#include <QDebug>
+
+using namespace Utils;
+
+LogIndex::LogIndex(UAVObjectManager *objMngr) :
+    m_data(NULL),
+    m_size(0)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    // Only the packed size of each object is needed while indexing
+    QList< QList<UAVDataObject *> > objs = objMngr->getDataObjects();
+    for (int n = 0; n < objs.length(); ++n) {
+        UAVDataObject *obj = objs[n][0];
+        m_objectSizes.insert(obj->getObjID(), obj->getNumBytes());
+    }
+}
+
+LogIndex::~LogIndex()
+{
+    close();
+}
+
+/**
+ * Map the log file and index every object update it contains.
+ * The samples stay valid until close() is called.
+ */
+bool LogIndex::open(const QString & fileName, Format format)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_errorString = m_file.errorString();
+        return false;
+    }
+
+    m_size = m_file.size();
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        m_errorString = m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    switch (format) {
+    case FORMAT_OPL:
+        indexOPL();
+        break;
+    case FORMAT_DEBUGLOG:
+        indexDebugLog();
+        break;
+    }
+
+    return true;
+}
+
+void LogIndex::close()
+{
+    m_samples.clear();
+    memset(&m_stats, 0, sizeof(m_stats));
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_data = NULL;
+    }
+    m_size = 0;
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+}
+
+QList<quint32> LogIndex::objectIds() const
+{
+    return m_samples.keys();
+}
+
+const QVector<LogIndex::Sample> LogIndex::samples(quint32 objId) const
+{
+    return m_samples.value(objId);
+}
+
+LogIndex::Stats LogIndex::getStats() const
+{
+    return m_stats;
+}
+
+QString LogIndex::errorString() const
+{
+    return m_errorString;
+}
+
+/**
+ * Walk the records written by LogFile. Each record holds one or more
+ * UAVTalk packets sent by the logging thread.
+ */
+void LogIndex::indexOPL()
+{
+    const uchar *p   = m_data;
+    const uchar *end = m_data + m_size;
+    const qint64 recordHeaderLength = sizeof(quint32) + sizeof(qint64);
+
+    while (end - p >= recordHeaderLength) {
+        quint32 timestamp = qFromLittleEndian<quint32>(p);
+        qint64 length     = qFromLittleEndian<qint64>(p + sizeof(quint32));
+        p += recordHeaderLength;
+
+        if (length < 1 || length > MAX_RECORD_LENGTH || length > end - p) {
+            qWarning() << "LogIndex - error : logfile corrupted or truncated at offset" << (p - m_data);
+            break;
+        }
+
+        indexPackets(p, length, timestamp);
+        p += length;
+        m_stats.records++;
+    }
+}
+
+/**
+ * Walk a dump of DebugLogEntry records as stored in the flash filesystem.
+ * Multiple objects records are split the same way FlightLogManager does.
+ */
+void LogIndex::indexDebugLog()
+{
+    const quint32 total_len  = sizeof(DebugLogEntry::DataFields);
+    const quint32 data_len   = sizeof(((DebugLogEntry::DataFields *)0)->Data);
+    const quint32 header_len = total_len - data_len;
+
+    for (qint64 pos = 0; pos + (qint64)total_len <= m_size; pos += total_len) {
+        const uchar *record = m_data + pos;
+        const uchar *data   = record + header_len;
+        DebugLogEntry::DataFields fields;
+
+        memcpy(&fields, record, header_len);
+        m_stats.records++;
+
+        if (fields.Type != DebugLogEntry::TYPE_UAVOBJECT && fields.Type != DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+            continue;
+        }
+        if (fields.Size > data_len) {
+            m_stats.sizeErrors++;
+            continue;
+        }
+
+        addSample(fields.ObjectID, fields.InstanceID, fields.FlightTime, fields.Flight, data, fields.Size);
+
+        if (fields.Type == DebugLogEntry::TYPE_MULTIPLEUAVOBJECTS) {
+            quint32 start = fields.Size;
+
+            // empty space is left as 0xFF so the size check ends the loop
+            while (start + header_len + 1 < data_len) {
+                DebugLogEntry::DataFields sub;
+                memcpy(&sub, &data[start], header_len);
+                quint32 toread = header_len + sub.Size;
+                if (!(toread + start > data_len)) {
+                    addSample(sub.ObjectID, sub.InstanceID, sub.FlightTime, sub.Flight, &data[start + header_len], sub.Size);
+                }
+                start += toread;
+            }
+        }
+    }
+}
+
+/**
+ * Frame the UAVTalk packets in a block of bytes, resyncing on errors
+ * the same way the UAVTalk receive state machine does.
+ */
+void LogIndex::indexPackets(const uchar *data, qint64 length, quint32 timestamp)
+{
+    while (length >= HEADER_LENGTH + CHECKSUM_LENGTH) {
+        if (data[0] != SYNC_VAL) {
+            m_stats.syncErrors++;
+            data++;
+            length--;
+            continue;
+        }
+
+        quint8 type       = data[1];
+        quint16 packetLen = qFromLittleEndian<quint16>(data + 2);
+        if ((type & TYPE_MASK) != TYPE_VER
+            || packetLen < HEADER_LENGTH || packetLen > HEADER_LENGTH + MAX_PAYLOAD_LENGTH
+            || packetLen + CHECKSUM_LENGTH > length) {
+            m_stats.sizeErrors++;
+            data++;
+            length--;
+            continue;
+        }
+
+        if (Crc::updateCRC(0, data, packetLen) != data[packetLen]) {
+            m_stats.crcErrors++;
+            data++;
+            length--;
+            continue;
+        }
+
+        m_stats.packets++;
+        if (type == TYPE_OBJ || type == TYPE_OBJ_ACK) {
+            quint32 objId  = qFromLittleEndian<quint32>(data + 4);
+            quint16 instId = qFromLittleEndian<quint16>(data + 8);
+            addSample(objId, instId, timestamp, 0, data + HEADER_LENGTH, packetLen - HEADER_LENGTH);
+        }
+
+        data   += packetLen + CHECKSUM_LENGTH;
+        length -= packetLen + CHECKSUM_LENGTH;
+    }
+}
+
+void LogIndex::addSample(quint32 objId, quint16 instId, quint32 timestamp, quint16 flight, const uchar *data, quint32 length)
+{
+    QHash<quint32, quint32>::const_iterator size = m_objectSizes.constFind(objId);
+
+    if (size == m_objectSizes.constEnd()) {
+        m_stats.unknownObjects++;
+        return;
+    }
+    if (size.value() != length) {
+        m_stats.sizeErrors++;
+        return;
+    }
+
+    Sample sample;
+    sample.timestamp = timestamp;
+    sample.flight    = flight;
+    sample.instId    = instId;
+    sample.data      = data;
+    m_samples[objId].append(sample);
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,111 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logindex.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Headless log decoder
+ * @{
+ * @brief Indexes the UAVObject packets found in a GCS or on-board log
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <QString>
+
+class UAVObjectManager;
+
+/**
+ * Maps a log file into memory and groups the packed payload of every
+ * UAVObject update by object ID. No object is ever unpacked here, the
+ * samples only point into the mapped file so that the exporters can
+ * decode each object type independently (and in parallel).
+ */
+class LogIndex {
+public:
+    typedef enum {
+        FORMAT_OPL, /** GCS log: timestamp(4), size(8), UAVTalk packet */
+        FORMAT_DEBUGLOG /** Raw dump of on-board DebugLogEntry records */
+    } Format;
+
+    typedef struct {
+        quint32 timestamp;
+        quint16 flight;
+        quint16 instId;
+        const uchar *data;
+    } Sample;
+
+    typedef struct {
+        quint32 records;
+        quint32 packets;
+        quint32 syncErrors;
+        quint32 crcErrors;
+        quint32 sizeErrors;
+        quint32 unknownObjects;
+    } Stats;
+
+    LogIndex(UAVObjectManager *objMngr);
+    ~LogIndex();
+
+    bool open(const QString & fileName, Format format);
+    void close();
+
+    QList<quint32> objectIds() const;
+    const QVector<Sample> samples(quint32 objId) const;
+    Stats getStats() const;
+    QString errorString() const;
+
+private:
+    // UAVTalk framing, see UAVTalk
+    static const quint8 SYNC_VAL        = 0x3C;
+    static const int TYPE_MASK          = 0xF8;
+    static const int TYPE_VER           = 0x20;
+    static const int TYPE_OBJ           = (TYPE_VER | 0x00);
+    static const int TYPE_OBJ_ACK       = (TYPE_VER | 0x02);
+    static const int HEADER_LENGTH      = 10;
+    static const int MAX_PAYLOAD_LENGTH = 256;
+    static const int CHECKSUM_LENGTH    = 1;
+
+    // LogFile sanity limit on a single record
+    static const qint64 MAX_RECORD_LENGTH = 1024 * 1024;
+
+    QHash<quint32, quint32> m_objectSizes;
+    QHash<quint32, QVector<Sample> > m_samples;
+    QFile m_file;
+    const uchar *m_data;
+    qint64 m_size;
+    Stats m_stats;
+    QString m_errorString;
+
+    void indexOPL();
+    void indexDebugLog();
+    void indexPackets(const uchar *data, qint64 length, quint32 timestamp);
+    void addSample(quint32 objId, quint16 instId, quint32 timestamp, quint16 flight, const uchar *data, quint32 length);
+};
+
+#endif // LOGINDEX_H
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,180 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Headless log decoder
+ * @{
+ * @brief Decodes .opl and DebugLog dumps into per object columnar files
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logindex.h"
+#include "objectexporter.h"
+
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThreadPool>
+#include <QTextStream>
+#include <QDir>
+
+#include <algorithm>
+
+static QTextStream out(stdout);
+static QTextStream err(stderr);
+
+static bool bySampleCount(const QPair<int, quint32> & a, const QPair<int, quint32> & b)
+{
+    return a.first > b.first;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCoreApplication::setApplicationName("logdecoder");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Decodes GCS .opl logs and on-board DebugLog dumps into one file per UAVObject.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("log", "Log file to decode.");
+
+    QCommandLineOption inputOption(QStringList() << "i" << "input",
+                                   "Input format: opl or debuglog (default: from the file extension).", "format");
+    QCommandLineOption outputDirOption(QStringList() << "o" << "output",
+                                       "Output directory (default: <log>_export).", "dir");
+    QCommandLineOption formatOption(QStringList() << "f" << "format",
+                                    "Output format: csv, binary or all (default: csv).", "format", "csv");
+    QCommandLineOption objectsOption(QStringList() << "O" << "objects",
+                                     "Comma separated list of objects to export (default: all).", "names");
+    QCommandLineOption threadsOption(QStringList() << "j" << "threads",
+                                     "Number of decoding threads (default: one per core).", "count");
+    parser.addOption(inputOption);
+    parser.addOption(outputDirOption);
+    parser.addOption(formatOption);
+    parser.addOption(objectsOption);
+    parser.addOption(threadsOption);
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+
+    QString fileName = parser.positionalArguments().first();
+    QFileInfo fileInfo(fileName);
+
+    LogIndex::Format inputFormat = LogIndex::FORMAT_OPL;
+    QString input = parser.isSet(inputOption) ? parser.value(inputOption) : fileInfo.suffix().toLower();
+    if (input == "debuglog" || input == "bin") {
+        inputFormat = LogIndex::FORMAT_DEBUGLOG;
+    } else if (input != "opl") {
+        err << "Unknown input format " << input << endl;
+        return 1;
+    }
+
+    int outputs = 0;
+    QString format = parser.value(formatOption);
+    if (format == "csv" || format == "all") {
+        outputs |= ObjectExporter::OUTPUT_CSV;
+    }
+    if (format == "binary" || format == "all") {
+        outputs |= ObjectExporter::OUTPUT_BINARY;
+    }
+    if (!outputs) {
+        err << "Unknown output format " << format << endl;
+        return 1;
+    }
+
+    if (parser.isSet(threadsOption)) {
+        bool ok;
+        int threads = parser.value(threadsOption).toInt(&ok);
+        if (!ok || threads < 1) {
+            err << "Invalid thread count " << parser.value(threadsOption) << endl;
+            return 1;
+        }
+        QThreadPool::globalInstance()->setMaxThreadCount(threads);
+    }
+
+    QDir outputDir(parser.isSet(outputDirOption) ? parser.value(outputDirOption) :
+                   fileInfo.absolutePath() + "/" + fileInfo.completeBaseName() + "_export");
+    if (!outputDir.mkpath(".")) {
+        err << "Unable to create " << outputDir.path() << endl;
+        return 1;
+    }
+
+    // The objects are only used as a description of the packed data
+    UAVObjectManager objMngr;
+    UAVObjectsInitialize(&objMngr);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    LogIndex index(&objMngr);
+    if (!index.open(fileName, inputFormat)) {
+        err << "Unable to open " << fileName << ": " << index.errorString() << endl;
+        return 1;
+    }
+
+    LogIndex::Stats stats = index.getStats();
+    out << "Indexed " << stats.packets << " packets in " << stats.records << " records ("
+        << timer.elapsed() << " ms)" << endl;
+    if (stats.syncErrors || stats.crcErrors || stats.sizeErrors || stats.unknownObjects) {
+        out << "Skipped: " << stats.syncErrors << " sync errors, " << stats.crcErrors << " crc errors, "
+            << stats.sizeErrors << " size errors, " << stats.unknownObjects << " unknown objects" << endl;
+    }
+
+    QStringList filter;
+    if (parser.isSet(objectsOption)) {
+        filter = parser.value(objectsOption).split(',', QString::SkipEmptyParts);
+    }
+
+    // Start the largest objects first so that they do not end up last on a busy pool
+    QList<QPair<int, quint32> > work;
+    foreach(quint32 objId, index.objectIds()) {
+        UAVObject *obj = objMngr.getObject(objId);
+        if (filter.isEmpty() || filter.contains(obj->getName(), Qt::CaseInsensitive)) {
+            work << qMakePair(index.samples(objId).size(), objId);
+        }
+    }
+    std::sort(work.begin(), work.end(), bySampleCount);
+
+    timer.restart();
+    for (int n = 0; n < work.size(); ++n) {
+        ObjectLayout layout(objMngr.getObject(work[n].second));
+        QThreadPool::globalInstance()->start(
+            new ObjectExporter(layout, index.samples(layout.objId), outputDir,
+                               outputs, inputFormat == LogIndex::FORMAT_DEBUGLOG));
+    }
+    QThreadPool::globalInstance()->waitForDone();
+
+    out << "Exported " << work.size() << " objects to " << outputDir.path() << " ("
+        << timer.elapsed() << " ms, " << QThreadPool::globalInstance()->maxThreadCount() << " threads)" << endl;
+
+    return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,294 @@
+/**
+ ******************************************************************************
+ *
+ * @file       objectexporter.cpp
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Headless log decoder
+ * @{
+ * @brief Writes the samples of one object type as columnar files
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "objectexporter.h"
+
+#include "uavobject.h"
+
+#include <QFile>
+#include <QtEndian>
+#include <QDebug>
+
+// Flush the output buffers once they grow past this size
+#define WRITE_CHUNK_SIZE (64 * 1024)
+
+const char ObjectExporter::BINARY_MAGIC[8] = { 'U', 'A', 'V', 'O', 'C', 'O', 'L', '1' };
+
+ObjectLayout::ObjectLayout(UAVObject *obj) :
+    name(obj->getName()),
+    objId(obj->getObjID()),
+    numBytes(obj->getNumBytes())
+{
+    foreach(UAVObjectField * field, obj->getFields()) {
+        QStringList elementNames = field->getElementNames();
+        QList<QByteArray> options;
+
+        foreach(QString option, field->getOptions()) {
+            options << option.toUtf8();
+        }
+
+        Column column;
+        column.type    = field->getType();
+        column.options = options;
+        column.bit     = 0;
+
+        if (column.type == UAVObjectField::STRING) {
+            // A string is a single column, not one per character
+            column.name   = field->getName().toUtf8();
+            column.offset = field->getDataOffset();
+            column.size   = field->getNumElements();
+            columns << column;
+            continue;
+        }
+
+        quint32 bytesPerElement = (column.type == UAVObjectField::BITFIELD) ? 1 :
+                                  field->getNumBytes() / field->getNumElements();
+        for (quint32 n = 0; n < field->getNumElements(); ++n) {
+            column.name = field->getName().toUtf8();
+            if (field->getNumElements() > 1) {
+                column.name += '.' + elementNames.at(n).toUtf8();
+            }
+            column.size = bytesPerElement;
+            if (column.type == UAVObjectField::BITFIELD) {
+                column.offset = field->getDataOffset() + n / 8;
+                column.bit    = n % 8;
+            } else {
+                column.offset = field->getDataOffset() + n * bytesPerElement;
+            }
+            columns << column;
+        }
+    }
+}
+
+ObjectExporter::ObjectExporter(const ObjectLayout & layout, const QVector<LogIndex::Sample> & samples,
+                               const QDir & outputDir, int outputs, bool withFlight) :
+    m_layout(layout),
+    m_samples(samples),
+    m_outputDir(outputDir),
+    m_outputs(outputs),
+    m_withFlight(withFlight)
+{}
+
+void ObjectExporter::run()
+{
+    if ((m_outputs & OUTPUT_CSV) && !writeCSV()) {
+        qWarning() << "ObjectExporter - error : unable to write CSV for" << m_layout.name;
+    }
+    if ((m_outputs & OUTPUT_BINARY) && !writeBinary()) {
+        qWarning() << "ObjectExporter - error : unable to write binary for" << m_layout.name;
+    }
+}
+
+/**
+ * Write one row per sample, enums are written as their option text.
+ */
+bool ObjectExporter::writeCSV()
+{
+    QFile file(m_outputDir.filePath(m_layout.name + ".csv"));
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QByteArray buffer;
+    buffer.reserve(WRITE_CHUNK_SIZE + 4096);
+
+    buffer += "timestamp,instance";
+    if (m_withFlight) {
+        buffer += ",flight";
+    }
+    foreach(const ObjectLayout::Column &column, m_layout.columns) {
+        buffer += ',' + column.name;
+    }
+    buffer += '\n';
+
+    foreach(const LogIndex::Sample &sample, m_samples) {
+        buffer += QByteArray::number(sample.timestamp);
+        buffer += ',';
+        buffer += QByteArray::number(sample.instId);
+        if (m_withFlight) {
+            buffer += ',';
+            buffer += QByteArray::number(sample.flight);
+        }
+        foreach(const ObjectLayout::Column &column, m_layout.columns) {
+            buffer += ',';
+            appendValue(buffer, column, sample.data);
+        }
+        buffer += '\n';
+
+        if (buffer.size() >= WRITE_CHUNK_SIZE) {
+            if (file.write(buffer) != buffer.size()) {
+                return false;
+            }
+            buffer.resize(0);
+        }
+    }
+
+    return file.write(buffer) == buffer.size();
+}
+
+void ObjectExporter::appendValue(QByteArray & line, const ObjectLayout::Column & column, const uchar *data)
+{
+    const uchar *value = data + column.offset;
+
+    switch (column.type) {
+    case UAVObjectField::INT8:
+        line += QByteArray::number((qint8)value[0]);
+        break;
+    case UAVObjectField::INT16:
+        line += QByteArray::number(qFromLittleEndian<qint16>(value));
+        break;
+    case UAVObjectField::INT32:
+        line += QByteArray::number(qFromLittleEndian<qint32>(value));
+        break;
+    case UAVObjectField::UINT8:
+        line += QByteArray::number(value[0]);
+        break;
+    case UAVObjectField::UINT16:
+        line += QByteArray::number(qFromLittleEndian<quint16>(value));
+        break;
+    case UAVObjectField::UINT32:
+        line += QByteArray::number(qFromLittleEndian<quint32>(value));
+        break;
+    case UAVObjectField::FLOAT32:
+    {
+        quint32 bits = qFromLittleEndian<quint32>(value);
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        // 9 significant digits round trip any float
+        line += QByteArray::number(f, 'g', 9);
+        break;
+    }
+    case UAVObjectField::ENUM:
+        if (value[0] < column.options.size()) {
+            line += column.options.at(value[0]);
+        } else {
+            line += QByteArray::number(value[0]);
+        }
+        break;
+    case UAVObjectField::BITFIELD:
+        line += ((value[0] >> column.bit) & 1) ? '1' : '0';
+        break;
+    case UAVObjectField::STRING:
+    {
+        QByteArray text((const char *)value, qstrnlen((const char *)value, column.size));
+        line += '"' + text.replace('"', "\"\"") + '"';
+        break;
+    }
+    }
+}
+
+/**
+ * Write the samples column after column:
+ *   magic(8), rows(8), columns(2),
+ *   per column: type(1), size(1), name length(2), name,
+ *   then for each column rows * size bytes, little endian.
+ * The type is the UAVObjectField::FieldType, enums are their raw index and
+ * bitfield elements are one byte each.
+ */
+bool ObjectExporter::writeBinary()
+{
+    QFile file(m_outputDir.filePath(m_layout.name + ".bin"));
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    const quint64 rows = m_samples.size();
+    QList<ObjectLayout::Column> columns;
+    ObjectLayout::Column column;
+    column.bit    = 0;
+    column.offset = 0;
+
+    // Leading columns come from the sample, not from the packed object
+    column.name   = "timestamp";
+    column.type   = UAVObjectField::UINT32;
+    column.size   = sizeof(quint32);
+    columns << column;
+    column.name   = "instance";
+    column.type   = UAVObjectField::UINT16;
+    column.size   = sizeof(quint16);
+    columns << column;
+    if (m_withFlight) {
+        column.name = "flight";
+        columns << column;
+    }
+    const int leading = columns.size();
+    columns << m_layout.columns;
+
+    QByteArray buffer;
+    buffer.reserve(WRITE_CHUNK_SIZE + 256);
+    buffer.append(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+
+    uchar tmp[8];
+    qToLittleEndian<quint64>(rows, tmp);
+    buffer.append((const char *)tmp, sizeof(quint64));
+    qToLittleEndian<quint16>(columns.size(), tmp);
+    buffer.append((const char *)tmp, sizeof(quint16));
+    foreach(const ObjectLayout::Column &c, columns) {
+        buffer += (char)c.type;
+        buffer += (char)c.size;
+        qToLittleEndian<quint16>(c.name.size(), tmp);
+        buffer.append((const char *)tmp, sizeof(quint16));
+        buffer += c.name;
+    }
+
+    for (int n = 0; n < columns.size(); ++n) {
+        const ObjectLayout::Column &c = columns.at(n);
+        foreach(const LogIndex::Sample &sample, m_samples) {
+            if (n == 0) {
+                qToLittleEndian<quint32>(sample.timestamp, tmp);
+                buffer.append((const char *)tmp, sizeof(quint32));
+            } else if (n == 1) {
+                qToLittleEndian<quint16>(sample.instId, tmp);
+                buffer.append((const char *)tmp, sizeof(quint16));
+            } else if (n < leading) {
+                qToLittleEndian<quint16>(sample.flight, tmp);
+                buffer.append((const char *)tmp, sizeof(quint16));
+            } else if (c.type == UAVObjectField::BITFIELD) {
+                buffer += (char)((sample.data[c.offset] >> c.bit) & 1);
+            } else {
+                // The log is already packed little endian, copy as is
+                buffer.append((const char *)sample.data + c.offset, c.size);
+            }
+
+            if (buffer.size() >= WRITE_CHUNK_SIZE) {
+                if (file.write(buffer) != buffer.size()) {
+                    return false;
+                }
+                buffer.resize(0);
+            }
+        }
+    }
+
+    return file.write(buffer) == buffer.size();
+}
+
+/**
+ * @}
+ * @}
+ */
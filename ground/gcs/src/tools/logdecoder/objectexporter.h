@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ *
+ * @file       objectexporter.h
+ * @author     The LibrePilot Project, http://www.librepilot.org Copyright (C) 2016.
+ * @addtogroup GCSTools GCS Tools
+ * @{
+ * @addtogroup LogDecoder Headless log decoder
+ * @{
+ * @brief Writes the samples of one object type as columnar files
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef OBJECTEXPORTER_H
+#define OBJECTEXPORTER_H
+
+#include "logindex.h"
+#include "uavobjectfield.h"
+
+#include <QRunnable>
+#include <QByteArray>
+#include <QList>
+#include <QDir>
+
+class UAVObject;
+class QIODevice;
+
+/**
+ * Plain copy of the field layout of an object. It is built once from the
+ * registered UAVObject on the main thread, the exporters only read it and
+ * never touch the QObject based UAVObject/UAVObjectField instances.
+ */
+class ObjectLayout {
+public:
+    typedef struct {
+        QByteArray name;
+        UAVObjectField::FieldType type;
+        quint32 offset; /** byte offset of the element in the packed object */
+        quint32 size; /** bytes per element in the binary output */
+        quint32 bit; /** bit index for bitfield elements */
+        QList<QByteArray> options;
+    } Column;
+
+    ObjectLayout(UAVObject *obj);
+
+    QString name;
+    quint32 objId;
+    quint32 numBytes;
+    QList<Column> columns;
+};
+
+class ObjectExporter : public QRunnable {
+public:
+    enum {
+        OUTPUT_CSV    = 0x01,
+        OUTPUT_BINARY = 0x02
+    };
+
+    ObjectExporter(const ObjectLayout & layout, const QVector<LogIndex::Sample> & samples,
+                   const QDir & outputDir, int outputs, bool withFlight);
+
+    void run();
+
+    // Binary output file header, followed by the column descriptors
+    static const char BINARY_MAGIC[8];
+
+private:
+    ObjectLayout m_layout;
+    QVector<LogIndex::Sample> m_samples;
+    QDir m_outputDir;
+    int m_outputs;
+    bool m_withFlight;
+
+    bool writeCSV();
+    bool writeBinary();
+    void appendValue(QByteArray & line, const ObjectLayout::Column & column, const uchar *data);
+};
+
+#endif // OBJECTEXPORTER_H
+
+/**
+ * @}
+ * @}
+ */
@@ -66,7 +66,8 @@ struct Context {
     QString    setters;
     QString    notifications;
     // implementation
-    QString    fieldsInit;
+    QString    fieldsTable;
+    QString    fieldsInfoTable;
     QString    fieldsDefault;
     QString    propertiesImpl;
     QString    notificationsImpl;
@@ -271,34 +272,40 @@ void generateFieldInfo(Context &ctxt, FieldContext &fieldCtxt)
     }
 }
 
-void generateFieldInit(Context &ctxt, FieldContext &fieldCtxt)
+void generateFieldTable(Context &ctxt, FieldContext &fieldCtxt)
 {
-    ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    // :fieldName\n");
-
-    // Setup element names
-    ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    QStringList :fieldNameElemNames;\n");
-    QStringList elemNames = fieldCtxt.field->elementNames;
-    ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    :fieldNameElemNames");
-    for (int m = 0; m < elemNames.length(); ++m) {
-        ctxt.fieldsInit += QString(" << \"%1\"").arg(elemNames[m]);
+    // element names, the default "0", "1", ... names are built at runtime
+    QString elemNames = "NULL";
+
+    if (!fieldCtxt.field->defaultElementNames) {
+        elemNames = generate(ctxt, fieldCtxt, ":fieldNameElemNames");
+        ctxt.fieldsTable += generate(ctxt, fieldCtxt, "constexpr const char *:fieldNameElemNames[] = {");
+        QStringList names = fieldCtxt.field->elementNames;
+        for (int m = 0; m < names.length(); ++m) {
+            ctxt.fieldsTable += QString("%1 \"%2\"").arg(m > 0 ? "," : "").arg(names[m]);
+        }
+        ctxt.fieldsTable += " };\n";
     }
-    ctxt.fieldsInit += ";\n";
 
+    QString enumOptions = "NULL";
     if (fieldCtxt.field->type == FIELDTYPE_ENUM) {
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    QStringList :fieldNameEnumOptions;\n");
+        enumOptions = generate(ctxt, fieldCtxt, ":fieldNameEnumOptions");
+        ctxt.fieldsTable += generate(ctxt, fieldCtxt, "constexpr const char *:fieldNameEnumOptions[] = {");
         QStringList options = fieldCtxt.field->options;
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt, "    :fieldNameEnumOptions");
         for (int m = 0; m < options.length(); ++m) {
-            ctxt.fieldsInit += QString(" << \"%1\"").arg(options[m]);
+            ctxt.fieldsTable += QString("%1 \"%2\"").arg(m > 0 ? "," : "").arg(options[m]);
         }
-        ctxt.fieldsInit += ";\n";
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt,
-                                    "    fields.append(new UAVObjectField(\":fieldName\", tr(\":fieldDesc\"), \":fieldUnits\", UAVObjectField::ENUM, :fieldNameElemNames, :fieldNameEnumOptions, \":fieldLimitValues\"));\n");
-    } else {
-        ctxt.fieldsInit += generate(ctxt, fieldCtxt,
-                                    "    fields.append(new UAVObjectField(\":fieldName\", tr(\":fieldDesc\"), \":fieldUnits\", UAVObjectField::%1, :fieldNameElemNames, QStringList(), \":fieldLimitValues\"));\n")
-                           .arg(fieldTypeStrCPPClass(fieldCtxt.field->type));
+        ctxt.fieldsTable += " };\n";
     }
+
+    // arguments first, the limits and descriptions may contain '%'
+    ctxt.fieldsInfoTable += generate(ctxt, fieldCtxt,
+                                     QString("    { \":ClassName\", \":fieldName\", QT_TRANSLATE_NOOP(\":ClassName\", \":fieldDesc\"), \":fieldUnits\", "
+                                             "UAVObjectField::%1, :elementCount, %2, %3, %4, \":fieldLimitValues\" },\n")
+                                     .arg(fieldTypeStrCPPClass(fieldCtxt.field->type))
+                                     .arg(elemNames)
+                                     .arg(fieldCtxt.field->type == FIELDTYPE_ENUM ? fieldCtxt.field->options.length() : 0)
+                                     .arg(enumOptions));
 }
 
 void generateFieldDefault(Context &ctxt, FieldContext &fieldCtxt)
@@ -347,7 +354,7 @@ void generateField(Context &ctxt, FieldContext &fieldCtxt)
         ctxt.fields += generate(ctxt, fieldCtxt, "        :fieldType :fieldName;\n");
     }
     generateFieldInfo(ctxt, fieldCtxt);
-    generateFieldInit(ctxt, fieldCtxt);
+    generateFieldTable(ctxt, fieldCtxt);
     generateFieldDefault(ctxt, fieldCtxt);
 }
 
@@ -371,7 +378,10 @@ void generateEnum(Context &ctxt, FieldContext &fieldCtxt)
                                   "    qmlRegisterType<:ClassName_:PropName>(\"%1.:ClassName\", 1, 0, \":PropName\");\n").arg("UAVTalk");
 }
 
-void generateBaseProperty(Context &ctxt, FieldContext &fieldCtxt)
+/*
+ * member is the data member holding the property value, e.g. "Roll" or "Histogram[3]"
+ */
+void generateBaseProperty(Context &ctxt, FieldContext &fieldCtxt, const QString &member)
 {
     ctxt.properties        += generate(ctxt, fieldCtxt,
                                        "    Q_PROPERTY(:propType :propName READ :propName WRITE set:PropName NOTIFY :propNameChanged)\n");
@@ -380,7 +390,9 @@ void generateBaseProperty(Context &ctxt, FieldContext &fieldCtxt)
     ctxt.setters           += generate(ctxt, fieldCtxt, "    void set:PropName(const :propRefType value);\n");
 
     ctxt.notifications     += generate(ctxt, fieldCtxt, "    void :propNameChanged(const :propRefType value);\n");
-    ctxt.notificationsImpl += generate(ctxt, fieldCtxt, "    emit :propNameChanged(:propName());\n");
+
+    // notify only if the value differs from the last notified one
+    QString emitters = generate(ctxt, fieldCtxt, "        emit :propNameChanged(static_cast<:propType>(data.%1));\n");
 
     if (DEPRECATED) {
         // generate deprecated property for retro compatibility
@@ -397,13 +409,15 @@ void generateBaseProperty(Context &ctxt, FieldContext &fieldCtxt)
                                      "    /*DEPRECATED*/ void set:fieldName(:fieldType value) { set:PropName(static_cast<:propType>(value)); }\n");
         }
         if (fieldCtxt.hasDeprecatedNotification) {
-            ctxt.notifications     += generate(ctxt, fieldCtxt,
-                                               "    /*DEPRECATED*/ void :fieldNameChanged(:fieldType value);\n");
+            ctxt.notifications += generate(ctxt, fieldCtxt,
+                                           "    /*DEPRECATED*/ void :fieldNameChanged(:fieldType value);\n");
 
-            ctxt.notificationsImpl += generate(ctxt, fieldCtxt,
-                                               "    /*DEPRECATED*/ emit :fieldNameChanged(get:fieldName());\n");
+            emitters += generate(ctxt, fieldCtxt,
+                                 "        /*DEPRECATED*/ emit :fieldNameChanged(static_cast<:fieldType>(data.%1));\n");
         }
     }
+
+    ctxt.notificationsImpl += QString("    if (memcmp(&data.%1, &last.%1, sizeof(data.%1))) {\n" + emitters + "    }\n").arg(member);
 }
 
 void generateSimpleProperty(Context &ctxt, FieldContext &fieldCtxt)
@@ -412,7 +426,7 @@ void generateSimpleProperty(Context &ctxt, FieldContext &fieldCtxt)
         generateEnum(ctxt, fieldCtxt);
     }
 
-    generateBaseProperty(ctxt, fieldCtxt);
+    generateBaseProperty(ctxt, fieldCtxt, fieldCtxt.fieldName);
 
     // getter implementation
     ctxt.propertiesImpl += generate(ctxt, fieldCtxt,
@@ -437,6 +451,7 @@ void generateSimpleProperty(Context &ctxt, FieldContext &fieldCtxt)
                                     "   mutex->lock();\n"
                                     "   bool changed = (data_.:fieldName != static_cast<:fieldType>(value));\n"
                                     "   data_.:fieldName = static_cast<:fieldType>(value);\n"
+                                    "   if (changed) { notified_.:fieldName = data_.:fieldName; }\n"
                                     "   mutex->unlock();\n"
                                     "   if (changed) { %1 }\n"
                                     "}\n\n").arg(emitters);
@@ -469,6 +484,7 @@ void generateIndexedProperty(Context &ctxt, FieldContext &fieldCtxt)
     }
 
     // setter implementation
+    // notified_ is left alone, the element properties are notified by emitNotifications()
     ctxt.propertiesImpl += generate(ctxt, fieldCtxt,
                                     "void :ClassName::set:PropName(quint32 index, const :propRefType value)\n"
                                     "{\n"
@@ -522,7 +538,7 @@ void generateIndexedProperty(Context &ctxt, FieldContext &fieldCtxt)
         elementCtxt.hasDeprecatedNotification = ((elementCtxt.fieldName != elementCtxt.propName) || (elementCtxt.fieldType != elementCtxt.propType)) && DEPRECATED;
 
 
-        generateBaseProperty(ctxt, elementCtxt);
+        generateBaseProperty(ctxt, elementCtxt, QString("%1[%2]").arg(fieldCtxt.fieldName).arg(elementIndex));
 
         ctxt.propertiesImpl += generate(ctxt, elementCtxt,
                                         ":propType :ClassName:::propName() const { return %1(%2); }\n").arg(fieldCtxt.propName).arg(elementIndex);
@@ -681,7 +697,8 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo *object)
     outInclude.replace("$(PROPERTY_SETTERS)", ctxt.setters);
     outInclude.replace("$(PROPERTY_NOTIFICATIONS)", ctxt.notifications);
 
-    outCode.replace("$(FIELDSINIT)", ctxt.fieldsInit);
+    outCode.replace("$(FIELDSTABLE)", ctxt.fieldsTable);
+    outCode.replace("$(FIELDSINFO)", ctxt.fieldsInfoTable);
     outCode.replace("$(FIELDSDEFAULT)", ctxt.fieldsDefault);
     outCode.replace("$(PROPERTIES_IMPL)", ctxt.propertiesImpl);
     outCode.replace("$(NOTIFY_PROPERTIES_CHANGED)", ctxt.notificationsImpl);